@@ -586,3 +586,78 @@ TEST_CASE("Complete infinite Action")
 
     CHECK(0 == actionManager->GetNumActions(target));
 }
+
+TEST_CASE("ActionManager removes expired and cancelled targets")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto actionManager = context->GetSubsystem<ActionManager>();
+    actionManager->CancelAllActions();
+
+    auto expiredNode = MakeShared<Node>(context);
+    const auto triggerNode = MakeShared<Node>(context);
+    const auto cancelledNode = MakeShared<Node>(context);
+    const auto movedNode = MakeShared<Node>(context);
+    const auto action = ActionBuilder(context).MoveBy(1.0f, Vector3(10, 0, 0)).Build();
+    actionManager->AddAction(action, expiredNode);
+
+    // Cancel actions of the other target while the update is in progress
+    triggerNode->SubscribeToEvent(triggerNode, "Cancel",
+        [&](VariantMap&) { actionManager->CancelAllActionsFromTarget(cancelledNode); });
+    actionManager->AddAction(ActionBuilder(context).SendEvent("Cancel", {}).Build(), triggerNode);
+
+    actionManager->AddAction(action, cancelledNode);
+    actionManager->AddAction(action, movedNode);
+
+    expiredNode = nullptr;
+    actionManager->Update(0.0f);
+    actionManager->Update(0.5f);
+
+    CHECK(0 == actionManager->GetNumActions(triggerNode));
+    CHECK(0 == actionManager->GetNumActions(cancelledNode));
+    CHECK(1 == actionManager->GetNumActions(movedNode));
+    CHECK(cancelledNode->GetPosition().Equals(Vector3::ZERO));
+    CHECK(movedNode->GetPosition().Equals(Vector3(5, 0, 0)));
+
+    // Target may be added again after removal
+    actionManager->AddAction(action, cancelledNode);
+    actionManager->Update(0.0f);
+    actionManager->Update(1.0f);
+
+    CHECK(0 == actionManager->GetNumActions(movedNode));
+    CHECK(0 == actionManager->GetNumActions(cancelledNode));
+    CHECK(movedNode->GetPosition().Equals(Vector3(10, 0, 0)));
+    CHECK(cancelledNode->GetPosition().Equals(Vector3(10, 0, 0)));
+}
+
+TEST_CASE("Benchmark ActionManager with 100k actions", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto actionManager = context->GetSubsystem<ActionManager>();
+    actionManager->CancelAllActions();
+
+    static constexpr unsigned numTargets = 50000;
+    const auto moveBy = ActionBuilder(context).MoveBy(1000.0f, Vector3(10, 0, 0)).Build();
+    const auto fade = MakeShared<Actions::AttributeFromTo>(context);
+    fade->SetDuration(1000.0f);
+    fade->SetAttributeName("Color");
+    fade->SetFrom(Color::BLACK);
+    fade->SetTo(Color::WHITE);
+
+    ea::vector<SharedPtr<Node>> nodes;
+    ea::vector<SharedPtr<UIElement>> elements;
+    for (unsigned i = 0; i < numTargets; ++i)
+    {
+        nodes.push_back(MakeShared<Node>(context));
+        actionManager->AddAction(moveBy, nodes.back());
+        elements.push_back(MakeShared<UIElement>(context));
+        actionManager->AddAction(fade, elements.back());
+    }
+    actionManager->Update(0.0f);
+
+    BENCHMARK("Update 100k simultaneous actions")
+    {
+        actionManager->Update(0.01f);
+    };
+
+    actionManager->CancelAllActions();
+}
@@ -31,6 +31,8 @@
 #include <Urho3D/Resource/ResourceCache.h>
 #include <Urho3D/Particles/ParticleGraphEffect.h>
 #include <Urho3D/Particles/All.h>
+#include <Urho3D/Particles/DenseKernels.h>
+#include <Urho3D/Particles/ParticleGraphSystem.h>
 #include <Urho3D/Scene/Scene.h>
 #include <EASTL/variant.h>
 
@@ -492,3 +494,461 @@ TEST_CASE("Test Make IntVector2")
     auto attributeSpan = emitter->GetLayer(0)->GetAttributeValues<IntVector2>(0);
     CHECK(attributeSpan[0] == IntVector2(2, 3));
 }
+
+namespace
+{
+
+SharedPtr<ParticleGraphEffect> CreateEmitExpireEffect(Context* context)
+{
+    const auto effect = MakeShared<ParticleGraphEffect>(context);
+    auto xml = R"(<particleGraphEffect>
+    <layers>
+	    <layer type="ParticleGraphLayer" capacity="100">
+		    <emit>
+			    <nodes>
+    			    <node id="1" name="Emit">
+					    <in>
+						    <pin name="count" type="float" value="10" />
+					    </in>
+				    </node>
+			    </nodes>
+		    </emit>
+		    <init>
+			    <nodes>
+			    </nodes>
+		    </init>
+		    <update>
+			    <nodes>
+				    <node id="1" name="Expire">
+					    <in>
+						    <pin name="time" type="float" value="0" />
+						    <pin name="lifetime" type="float" value="1" />
+					    </in>
+				    </node>
+			    </nodes>
+		    </update>
+	    </layer>
+    </layers>
+</particleGraphEffect>)";
+    MemoryBuffer buffer(xml);
+    REQUIRE(effect->Load(buffer));
+    return effect;
+}
+
+}
+
+TEST_CASE("ParticleGraphSystem updates registered emitters")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto system = context->GetSubsystem<ParticleGraphSystem>();
+    const auto effect = CreateEmitExpireEffect(context);
+
+    const unsigned numEmittersBefore = system->GetNumEmitters();
+
+    const auto scene = MakeShared<Scene>(context);
+    ea::vector<ParticleGraphEmitter*> emitters;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        auto emitter = scene->CreateChild()->CreateComponent<ParticleGraphEmitter>();
+        emitter->SetEffect(effect);
+        emitters.push_back(emitter);
+    }
+    REQUIRE(system->GetNumEmitters() == numEmittersBefore + 16);
+
+    emitters[0]->SetEnabled(false);
+    emitters[1]->GetNode()->Remove();
+    REQUIRE(system->GetNumEmitters() == numEmittersBefore + 14);
+
+    Tests::RunFrame(context, 0.1f, 0.1f);
+
+    CHECK(!emitters[0]->CheckActiveParticles());
+    for (unsigned i = 2; i < emitters.size(); ++i)
+        CHECK(emitters[i]->GetLayer(0)->GetNumActiveParticles() == 10);
+
+    emitters[0]->SetEnabled(true);
+    REQUIRE(system->GetNumEmitters() == numEmittersBefore + 15);
+
+    Tests::RunFrame(context, 0.1f, 0.1f);
+    CHECK(emitters[0]->CheckActiveParticles());
+}
+
+TEST_CASE("Benchmark ParticleGraphSystem with 1000 emitters", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto effect = CreateEmitExpireEffect(context);
+
+    const auto scene = MakeShared<Scene>(context);
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        auto node = scene->CreateChild();
+        node->SetPosition(Vector3(static_cast<float>(i % 32), 0.0f, static_cast<float>(i / 32)));
+        node->CreateComponent<ParticleGraphEmitter>()->SetEffect(effect);
+    }
+
+    // Warm up until particle counts are stable
+    Tests::RunFrame(context, 1.0f, 0.1f);
+
+    BENCHMARK("Update 1000 emitters")
+    {
+        Tests::RunFrame(context, 1.0f / 60.0f);
+    };
+}
+
+namespace
+{
+
+SharedPtr<ParticleGraphEffect> CreateDenseUpdateEffect(Context* context, unsigned capacity)
+{
+    const auto effect = MakeShared<ParticleGraphEffect>(context);
+    const ea::string xml = Format(R"(<particleGraphEffect>
+    <layers>
+	    <layer type="ParticleGraphLayer" capacity="{}">
+		    <emit>
+			    <nodes>
+    			    <node id="1" name="Emit">
+					    <in>
+						    <pin name="count" type="float" value="{}" />
+					    </in>
+				    </node>
+			    </nodes>
+		    </emit>
+		    <init>
+			    <nodes>
+			    </nodes>
+		    </init>
+		    <update>
+			    <nodes>
+				    <node id="1" name="Random">
+					    <properties>
+						    <property name="Min" type="Vector3" value="1 2 3" />
+						    <property name="Max" type="Vector3" value="1 2 3" />
+					    </properties>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="2" name="Random">
+					    <properties>
+						    <property name="Min" type="Vector3" value="3 2 1" />
+						    <property name="Max" type="Vector3" value="3 2 1" />
+					    </properties>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="3" name="Add">
+					    <in>
+						    <pin name="x" type="Vector3" node="1" pin="out" />
+						    <pin name="y" type="Vector3" node="2" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="4" name="Lerp">
+					    <in>
+						    <pin name="x" type="Vector3" node="3" pin="out" />
+						    <pin name="y" type="Vector3" node="1" pin="out" />
+						    <pin name="t" type="float" value="0.5" />
+					    </in>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="5" name="Length">
+					    <in>
+						    <pin name="x" type="Vector3" node="4" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="out" type="float" />
+					    </out>
+				    </node>
+				    <node id="6" name="SetAttribute">
+					    <in>
+						    <pin name="" type="Vector3" node="4" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="pos" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="7" name="SetAttribute">
+					    <in>
+						    <pin name="" type="float" node="5" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="len" type="float" />
+					    </out>
+				    </node>
+			    </nodes>
+		    </update>
+	    </layer>
+    </layers>
+</particleGraphEffect>)", capacity, capacity);
+    MemoryBuffer buffer(xml);
+    REQUIRE(effect->Load(buffer));
+    return effect;
+}
+
+ParticleGraphNodes::DenseFloats MakeFloats(const ea::vector<float>& values, unsigned width, bool scalar = false)
+{
+    return ParticleGraphNodes::DenseFloats{values.data(), width, scalar};
+}
+
+ea::vector<float> MakeRandomFloats(unsigned count, float min, float max)
+{
+    ea::vector<float> values(count);
+    for (float& value : values)
+        value = Lerp(min, max, Random());
+    return values;
+}
+
+}
+
+TEST_CASE("Dense particle kernels match scalar evaluation")
+{
+    // Use odd number of particles to cover both vectorized and scalar code paths
+    const unsigned numParticles = 37;
+    const auto x = MakeRandomFloats(numParticles * 3, -10.0f, 10.0f);
+    const auto y = MakeRandomFloats(numParticles * 3, 1.0f, 10.0f);
+    const auto t = MakeRandomFloats(numParticles, 0.0f, 1.0f);
+    const auto limit = MakeRandomFloats(numParticles, 0.0f, 10.0f);
+    const ea::vector<float> scalar{2.0f};
+
+    const auto* xv = reinterpret_cast<const Vector3*>(x.data());
+    const auto* yv = reinterpret_cast<const Vector3*>(y.data());
+    ea::vector<float> out(numParticles * 3);
+    const auto* outv = reinterpret_cast<const Vector3*>(out.data());
+
+    ParticleGraphNodes::DenseAdd(out.data(), MakeFloats(x, 3), MakeFloats(y, 3), numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(outv[i].Equals(xv[i] + yv[i]));
+
+    ParticleGraphNodes::DenseDivide(out.data(), MakeFloats(x, 3), MakeFloats(y, 1), numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(outv[i].Equals(xv[i] / y[i]));
+
+    ParticleGraphNodes::DenseMultiplyAdd(out.data(), MakeFloats(x, 3), MakeFloats(y, 3), 0.5f, numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(outv[i].Equals(xv[i] + yv[i] * 0.5f));
+
+    ParticleGraphNodes::DenseLerp(out.data(), MakeFloats(x, 3), MakeFloats(y, 3), MakeFloats(t, 1), numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(outv[i].Equals(xv[i].Lerp(yv[i], t[i])));
+
+    ParticleGraphNodes::DenseAdd(out.data(), MakeFloats(x, 3), MakeFloats(scalar, 1, true), numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(outv[i].Equals(xv[i] + Vector3::ONE * 2.0f));
+
+    ParticleGraphNodes::DenseClamp01(out.data(), MakeFloats(t, 1), numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(out[i] == Clamp(t[i], 0.0f, 1.0f));
+
+    ParticleGraphNodes::DenseLengthVector3(out.data(), MakeFloats(x, 3), numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+        CHECK(Equals(out[i], xv[i].Length()));
+
+    ParticleGraphNodes::DenseLimitVelocity(out.data(), MakeFloats(x, 3), MakeFloats(limit, 1), 0.5f, numParticles);
+    for (unsigned i = 0; i < numParticles; ++i)
+    {
+        const float length = xv[i].Length();
+        const Vector3 expected = length > limit[i] ? xv[i] * (Lerp(length, limit[i], 0.5f) / length) : xv[i];
+        CHECK(outv[i].Equals(expected));
+    }
+}
+
+TEST_CASE("Dense particle graph update produces per-particle values")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto effect = CreateDenseUpdateEffect(context, 13);
+
+    const auto scene = MakeShared<Scene>(context);
+    auto emitter = scene->CreateChild()->CreateComponent<ParticleGraphEmitter>();
+    emitter->SetEffect(effect);
+
+    Tests::RunFrame(context, 0.1f, 0.1f);
+
+    ParticleGraphLayerInstance* layer = emitter->GetLayer(0);
+    REQUIRE(layer->GetNumActiveParticles() == 13);
+    REQUIRE(layer->GetNumAttributes() == 2);
+
+    const auto positions = layer->GetAttributeValues<Vector3>(0);
+    const auto lengths = layer->GetAttributeValues<float>(1);
+    const Vector3 expectedPosition = Vector3(4.0f, 4.0f, 4.0f).Lerp(Vector3(1.0f, 2.0f, 3.0f), 0.5f);
+    for (unsigned i = 0; i < layer->GetNumActiveParticles(); ++i)
+    {
+        CHECK(positions[i].Equals(expectedPosition));
+        CHECK(Equals(lengths[i], expectedPosition.Length()));
+    }
+}
+
+TEST_CASE("Fused particle graph stages are executed in chunks")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto effect = MakeShared<ParticleGraphEffect>(context);
+    const unsigned capacity = ParticleGraphLayerInstance::FusedChunkSize * 3 + 17;
+    const ea::string xml = Format(R"(<particleGraphEffect>
+    <layers>
+	    <layer type="ParticleGraphLayer" capacity="{}">
+		    <emit>
+			    <nodes>
+			    </nodes>
+		    </emit>
+		    <init>
+			    <nodes>
+				    <node id="1" name="Random">
+					    <properties>
+						    <property name="Min" type="Vector3" value="-1 -1 -1" />
+						    <property name="Max" type="Vector3" value="1 1 1" />
+					    </properties>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="2" name="SetAttribute">
+					    <in>
+						    <pin name="" type="Vector3" node="1" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="pos" type="Vector3" />
+					    </out>
+				    </node>
+			    </nodes>
+		    </init>
+		    <update>
+			    <nodes>
+				    <node id="1" name="GetAttribute">
+					    <out>
+						    <pin name="pos" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="2" name="Add">
+					    <in>
+						    <pin name="x" type="Vector3" node="1" pin="pos" />
+						    <pin name="y" type="Vector3" node="1" pin="pos" />
+					    </in>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="3" name="TimeStep">
+				    </node>
+				    <node id="4" name="Multiply">
+					    <in>
+						    <pin name="x" type="Vector3" node="2" pin="out" />
+						    <pin name="y" type="float" node="3" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="5" name="Add">
+					    <in>
+						    <pin name="x" type="Vector3" node="4" pin="out" />
+						    <pin name="y" type="Vector3" node="2" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="out" type="Vector3" />
+					    </out>
+				    </node>
+				    <node id="6" name="SetAttribute">
+					    <in>
+						    <pin name="" type="Vector3" node="5" pin="out" />
+					    </in>
+					    <out>
+						    <pin name="result" type="Vector3" />
+					    </out>
+				    </node>
+			    </nodes>
+		    </update>
+	    </layer>
+    </layers>
+</particleGraphEffect>)", capacity);
+    MemoryBuffer buffer(xml);
+    REQUIRE(effect->Load(buffer));
+
+    const auto scene = MakeShared<Scene>(context);
+    auto emitter = scene->CreateChild()->CreateComponent<ParticleGraphEmitter>();
+    emitter->SetEffect(effect);
+
+    // GetAttribute and Add are fused, TimeStep is a boundary, Multiply, Add and SetAttribute are fused.
+    REQUIRE(effect->GetLayer(0)->Commit());
+    const auto& plan = effect->GetLayer(0)->GetUpdatePlan();
+    REQUIRE(plan.size() == 3);
+    CHECK(plan[0].fused_);
+    CHECK(plan[0].numNodes_ == 2);
+    CHECK(!plan[1].fused_);
+    CHECK(plan[2].fused_);
+    CHECK(plan[2].numNodes_ == 3);
+
+    ParticleGraphLayerInstance* layer = emitter->GetLayer(0);
+    REQUIRE(layer->EmitNewParticles(static_cast<float>(capacity)));
+    REQUIRE(layer->GetNumActiveParticles() == capacity);
+
+    const float timeStep = 0.5f;
+    layer->Update(timeStep, false);
+
+    const auto positions = layer->GetAttributeValues<Vector3>(0);
+    const auto results = layer->GetAttributeValues<Vector3>(1);
+    for (unsigned i = 0; i < capacity; ++i)
+    {
+        const Vector3 expected = positions[i] * 2.0f * timeStep + positions[i] * 2.0f;
+        CHECK(results[i].Equals(expected));
+    }
+}
+
+TEST_CASE("Benchmark dense particle node throughput", "[.][benchmark]")
+{
+    const unsigned numParticles = 10000;
+    const auto x = MakeRandomFloats(numParticles * 3, -10.0f, 10.0f);
+    const auto y = MakeRandomFloats(numParticles * 3, 1.0f, 10.0f);
+    const auto t = MakeRandomFloats(numParticles, 0.0f, 1.0f);
+    ea::vector<float> out(numParticles * 3);
+
+    BENCHMARK("Add 10000 particles")
+    {
+        ParticleGraphNodes::DenseAdd(out.data(), MakeFloats(x, 3), MakeFloats(y, 3), numParticles);
+        return out[0];
+    };
+    BENCHMARK("Divide 10000 particles")
+    {
+        ParticleGraphNodes::DenseDivide(out.data(), MakeFloats(x, 3), MakeFloats(t, 1), numParticles);
+        return out[0];
+    };
+    BENCHMARK("ApplyForce 10000 particles")
+    {
+        ParticleGraphNodes::DenseMultiplyAdd(out.data(), MakeFloats(x, 3), MakeFloats(y, 3), 1.0f / 60.0f, numParticles);
+        return out[0];
+    };
+    BENCHMARK("Lerp 10000 particles")
+    {
+        ParticleGraphNodes::DenseLerp(out.data(), MakeFloats(x, 3), MakeFloats(y, 3), MakeFloats(t, 1), numParticles);
+        return out[0];
+    };
+    BENCHMARK("Clamp 10000 particles")
+    {
+        ParticleGraphNodes::DenseClamp01(out.data(), MakeFloats(x, 3), numParticles);
+        return out[0];
+    };
+    BENCHMARK("Length 10000 particles")
+    {
+        ParticleGraphNodes::DenseLengthVector3(out.data(), MakeFloats(x, 3), numParticles);
+        return out[0];
+    };
+    BENCHMARK("LimitVelocity 10000 particles")
+    {
+        ParticleGraphNodes::DenseLimitVelocity(out.data(), MakeFloats(x, 3), MakeFloats(t, 1), 0.5f, numParticles);
+        return out[0];
+    };
+
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto effect = CreateDenseUpdateEffect(context, numParticles);
+    const auto scene = MakeShared<Scene>(context);
+    auto emitter = scene->CreateChild()->CreateComponent<ParticleGraphEmitter>();
+    emitter->SetEffect(effect);
+    Tests::RunFrame(context, 0.1f, 0.1f);
+
+    BENCHMARK("Update graph with 10000 particles")
+    {
+        emitter->Tick(1.0f / 60.0f);
+    };
+}
@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IK/IKEvents.h>
+#include <Urho3D/IK/IKLegSolver.h>
+#include <Urho3D/IK/IKSolver.h>
+#include <Urho3D/IK/IKSolverSystem.h>
+#include <Urho3D/Scene/Scene.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+/// Create character with two legs and foot targets.
+Node* CreateLegsCharacter(Scene* scene, const Vector3& position)
+{
+    Node* root = scene->CreateChild("Character");
+    root->SetPosition(position);
+    root->CreateComponent<IKSolver>();
+
+    for (const ea::string side : {"Left", "Right"})
+    {
+        const float offset = side == "Left" ? -0.2f : 0.2f;
+
+        Node* thigh = root->CreateChild(side + "Thigh");
+        thigh->SetPosition({offset, 1.0f, 0.0f});
+        Node* calf = thigh->CreateChild(side + "Calf");
+        calf->SetPosition({0.0f, -0.5f, 0.05f});
+        Node* heel = calf->CreateChild(side + "Heel");
+        heel->SetPosition({0.0f, -0.5f, -0.05f});
+        Node* toe = heel->CreateChild(side + "Toe");
+        toe->SetPosition({0.0f, -0.05f, 0.15f});
+
+        Node* target = root->CreateChild(side + "Target");
+        target->SetPosition({offset, 0.3f, 0.2f});
+
+        auto leg = root->CreateComponent<IKLegSolver>();
+        leg->SetThighBoneName(side + "Thigh");
+        leg->SetCalfBoneName(side + "Calf");
+        leg->SetHeelBoneName(side + "Heel");
+        leg->SetToeBoneName(side + "Toe");
+        leg->SetTargetName(side + "Target");
+    }
+
+    return root;
+}
+
+Vector3 GetHeelPosition(Node* character)
+{
+    return character->GetChild("LeftHeel", true)->GetWorldPosition();
+}
+
+} // namespace
+
+TEST_CASE("IKSolverSystem solves characters in parallel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto system = context->GetSubsystem<IKSolverSystem>();
+    REQUIRE(system);
+
+    const unsigned numSolversBefore = system->GetNumSolvers();
+
+    auto batchedScene = MakeShared<Scene>(context);
+    auto referenceScene = MakeShared<Scene>(context);
+    ea::vector<Node*> batchedCharacters;
+    ea::vector<Node*> referenceCharacters;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const Vector3 position{static_cast<float>(i), 0.0f, 0.0f};
+        batchedCharacters.push_back(CreateLegsCharacter(batchedScene, position));
+        referenceCharacters.push_back(CreateLegsCharacter(referenceScene, position));
+    }
+    REQUIRE(system->GetNumSolvers() == numSolversBefore + 32);
+
+    const Vector3 originalHeelPosition = GetHeelPosition(batchedCharacters[0]);
+
+    system->SolveScene(batchedScene, 0.1f);
+    for (Node* character : referenceCharacters)
+        character->GetComponent<IKSolver>()->Solve(0.1f);
+
+    CHECK(!GetHeelPosition(batchedCharacters[0]).Equals(originalHeelPosition));
+    for (unsigned i = 0; i < batchedCharacters.size(); ++i)
+        CHECK(GetHeelPosition(batchedCharacters[i]).Equals(GetHeelPosition(referenceCharacters[i]), 0.0001f));
+
+    batchedCharacters[0]->GetComponent<IKSolver>()->SetEnabled(false);
+    batchedCharacters[1]->Remove();
+    CHECK(system->GetNumSolvers() == numSolversBefore + 30);
+}
+
+TEST_CASE("IKTransformSnapshot preserves hierarchy of captured nodes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+
+    Node* root = scene->CreateChild("Root");
+    root->SetPosition({1.0f, 2.0f, 3.0f});
+    Node* middle = root->CreateChild("Middle");
+    middle->SetPosition({0.0f, 1.0f, 0.0f});
+    Node* leaf = middle->CreateChild("Leaf");
+    leaf->SetPosition({0.0f, 1.0f, 0.0f});
+
+    // Middle node is not captured, leaf should follow the root anyway
+    IKTransformSnapshot snapshot;
+    snapshot.Initialize(ea::vector<Node*>{leaf, root, leaf});
+    snapshot.Capture();
+
+    const unsigned rootIndex = snapshot.FindNode(root);
+    const unsigned leafIndex = snapshot.FindNode(leaf);
+    REQUIRE(rootIndex != M_MAX_UNSIGNED);
+    REQUIRE(leafIndex != M_MAX_UNSIGNED);
+    REQUIRE(snapshot.FindNode(middle) == M_MAX_UNSIGNED);
+
+    const Quaternion rotation{90.0f, Vector3::FORWARD};
+    snapshot.SetWorldRotation(rootIndex, rotation);
+
+    // Scene is not modified until the snapshot is applied
+    CHECK(root->GetWorldRotation().Equals(Quaternion::IDENTITY));
+    CHECK(leaf->GetWorldPosition().Equals({1.0f, 4.0f, 3.0f}));
+
+    const Vector3 expectedLeafPosition = Vector3{1.0f, 2.0f, 3.0f} + rotation * Vector3{0.0f, 2.0f, 0.0f};
+    CHECK(snapshot.GetWorldTransform(leafIndex).position_.Equals(expectedLeafPosition, 0.0001f));
+
+    snapshot.SetWorldPosition(leafIndex, {5.0f, 5.0f, 5.0f});
+    snapshot.Apply();
+
+    CHECK(root->GetWorldRotation().Equals(rotation, 0.0001f));
+    CHECK(leaf->GetWorldPosition().Equals({5.0f, 5.0f, 5.0f}, 0.0001f));
+    CHECK(middle->GetPosition().Equals({0.0f, 1.0f, 0.0f}));
+}
+
+TEST_CASE("IKSolverSystem solves distant characters at reduced rate")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto system = context->GetSubsystem<IKSolverSystem>();
+    REQUIRE(system);
+
+    auto scene = MakeShared<Scene>(context);
+    Node* observer = scene->CreateChild("Observer");
+    Node* nearCharacter = CreateLegsCharacter(scene, {0.0f, 0.0f, 5.0f});
+    Node* farCharacter = CreateLegsCharacter(scene, {0.0f, 0.0f, 50.0f});
+
+    system->SetObserver(observer);
+    system->SetReducedRateDistance(20.0f);
+    system->SetReducedRateInterval(4);
+
+    unsigned numNearSolves = 0;
+    unsigned numFarSolves = 0;
+    scene->SubscribeToEvent(nearCharacter, E_IKPRESOLVE, [&] { ++numNearSolves; });
+    scene->SubscribeToEvent(farCharacter, E_IKPRESOLVE, [&] { ++numFarSolves; });
+
+    Node* farThigh = farCharacter->GetChild("LeftThigh", true);
+    const Quaternion animatedRotation = farThigh->GetRotation();
+
+    system->SolveScene(scene, 0.1f);
+    const Vector3 solvedHeelPosition = GetHeelPosition(farCharacter);
+    numNearSolves = 0;
+    numFarSolves = 0;
+
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        // Emulate animation that resets bone transforms every frame
+        farThigh->SetRotation(animatedRotation);
+        system->SolveScene(scene, 0.1f);
+        CHECK((GetHeelPosition(farCharacter) - solvedHeelPosition).Length() < 0.001f);
+    }
+
+    CHECK(numNearSolves == 8);
+    CHECK(numFarSolves == 2);
+
+    system->SetObserver(nullptr);
+    system->SetReducedRateInterval(1);
+}
+
+TEST_CASE("Benchmark IKSolverSystem with 500 characters", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto system = context->GetSubsystem<IKSolverSystem>();
+
+    auto scene = MakeShared<Scene>(context);
+    ea::vector<IKSolver*> solvers;
+    for (unsigned i = 0; i < 500; ++i)
+    {
+        const Vector3 position{static_cast<float>(i % 25), 0.0f, static_cast<float>(i / 25)};
+        solvers.push_back(CreateLegsCharacter(scene, position)->GetComponent<IKSolver>());
+    }
+
+    // Initialize solvers
+    system->SolveScene(scene, 1.0f / 60.0f);
+
+    BENCHMARK("Solve foot IK for 500 characters on main thread")
+    {
+        for (IKSolver* solver : solvers)
+            solver->Solve(1.0f / 60.0f);
+    };
+
+    BENCHMARK("Solve foot IK for 500 characters in parallel")
+    {
+        system->SolveScene(scene, 1.0f / 60.0f);
+    };
+
+    Node* observer = scene->CreateChild("Observer");
+    system->SetObserver(observer);
+    system->SetReducedRateDistance(10.0f);
+    system->SetReducedRateInterval(4);
+
+    BENCHMARK("Solve foot IK for 500 characters in parallel with reduced rate")
+    {
+        system->SolveScene(scene, 1.0f / 60.0f);
+    };
+
+    system->SetObserver(nullptr);
+    system->SetReducedRateInterval(1);
+}
@@ -23,6 +23,7 @@
 #include "../CommonUtils.h"
 #include "../SceneUtils.h"
 
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Core/VariantCurve.h>
 #include <Urho3D/Graphics/Material.h>
 #include <Urho3D/Graphics/Model.h>
@@ -31,6 +32,8 @@
 #include <Urho3D/Input/InputMap.h>
 #include <Urho3D/IO/ArchiveSerialization.h>
 #include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
 #include <Urho3D/Resource/BinaryFile.h>
 #include <Urho3D/Resource/JSONArchive.h>
 #include <Urho3D/Resource/ResourceCache.h>
@@ -39,6 +42,13 @@
 
 #include <catch2/catch_amalgamated.hpp>
 
+#include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
 using namespace Urho3D;
 
 namespace
@@ -372,6 +382,23 @@ TEST_CASE("Test structure is serialized to archive")
             REQUIRE(sourceObject == objectFromJSON);
         }
     }
+
+    SECTION("JSON stream archive")
+    {
+        auto jsonFile = MakeShared<JSONFile>(context);
+        REQUIRE(jsonFile->SaveObject("test", sourceObject));
+        const ea::string jsonText = jsonFile->ToString();
+
+        // Small buffer to exercise refills and seeks outside of the buffer
+        for (unsigned bufferSize : {JSONStreamInputArchive::DefaultBufferSize, 16u})
+        {
+            MemoryBuffer buffer{jsonText.data(), jsonText.size()};
+            JSONStreamInputArchive archive{context, buffer, bufferSize};
+            SerializationTestStruct objectFromJSON;
+            SerializeValue(archive, "test", objectFromJSON);
+            REQUIRE(sourceObject == objectFromJSON);
+        }
+    }
 }
 
 TEST_CASE("Test structure is serialized as part of the file")
@@ -518,6 +545,380 @@ TEST_CASE("Scene is serialized to archive")
             REQUIRE(Tests::CompareNodes(*sourceScene, *objectFromJSON));
         }
     }
+
+    SECTION("JSON stream archive")
+    {
+        auto jsonFile = MakeShared<JSONFile>(context);
+        REQUIRE(jsonFile->SaveObject(*sourceScene));
+        const ea::string jsonText = jsonFile->ToString();
+
+        for (unsigned bufferSize : {JSONStreamInputArchive::DefaultBufferSize, 64u})
+        {
+            MemoryBuffer buffer{jsonText.data(), jsonText.size()};
+            JSONStreamInputArchive archive{context, buffer, bufferSize};
+            auto objectFromJSON = MakeShared<Scene>(context);
+            Object& object = *objectFromJSON;
+            SerializeValue(archive, "Scene", object);
+            REQUIRE(Tests::CompareNodes(*sourceScene, *objectFromJSON));
+        }
+    }
+}
+
+TEST_CASE("JSON stream archive reads keys in any order")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const ea::string jsonText = R"(
+    // Comments and trailing commas are accepted like in JSONFile
+    {
+        "unused": { "nested": [1, 2, {"a": "}]"}] },
+        "second": 2.5,
+        /* keys are stored out of order */
+        "first": 1,
+        "array": [ "x", "y", ],
+        "empty": null,
+        "emptyArray": {},
+    })";
+
+    MemoryBuffer buffer{jsonText.data(), jsonText.size()};
+    JSONStreamInputArchive archive{context, buffer, 8};
+
+    auto block = archive.OpenUnorderedBlock("root");
+
+    int first{};
+    float second{};
+    SerializeValue(archive, "first", first);
+    SerializeValue(archive, "second", second);
+    CHECK(first == 1);
+    CHECK(second == 2.5f);
+
+    CHECK(archive.HasElementOrBlock("empty"));
+    CHECK_FALSE(archive.HasElementOrBlock("missing"));
+
+    {
+        auto arrayBlock = archive.OpenArrayBlock("array");
+        REQUIRE(arrayBlock.GetSizeHint() == 2);
+
+        ea::string x;
+        ea::string y;
+        SerializeValue(archive, "element", x);
+        SerializeValue(archive, "element", y);
+        CHECK(x == "x");
+        CHECK(y == "y");
+    }
+
+    {
+        auto emptyBlock = archive.OpenUnorderedBlock("empty");
+        CHECK_FALSE(archive.HasElementOrBlock("value"));
+    }
+
+    {
+        auto emptyArrayBlock = archive.OpenArrayBlock("emptyArray");
+        CHECK(emptyArrayBlock.GetSizeHint() == 0);
+    }
+
+    int missing{};
+    CHECK_THROWS_AS(SerializeValue(archive, "missing", missing), ArchiveException);
+    CHECK_THROWS_AS(SerializeValue(archive, "array", missing), ArchiveException);
+}
+
+namespace
+{
+
+std::size_t currentAllocatedBytes{};
+std::size_t peakAllocatedBytes{};
+
+/// rapidjson allocator that tracks current and peak number of allocated bytes.
+class CountingAllocator
+{
+public:
+    static const bool kNeedFree = true;
+
+    static void Reset()
+    {
+        currentAllocatedBytes = 0;
+        peakAllocatedBytes = 0;
+    }
+
+    static std::size_t GetPeakBytes() { return peakAllocatedBytes; }
+
+    void* Malloc(std::size_t size)
+    {
+        if (!size)
+            return nullptr;
+
+        // Block size is stored in front of the block, aligned like malloc
+        auto header = static_cast<std::max_align_t*>(std::malloc(sizeof(std::max_align_t) + size));
+        *reinterpret_cast<std::size_t*>(header) = size;
+        currentAllocatedBytes += size;
+        peakAllocatedBytes = ea::max(peakAllocatedBytes, currentAllocatedBytes);
+        return header + 1;
+    }
+
+    void* Realloc(void* originalPtr, std::size_t originalSize, std::size_t newSize)
+    {
+        // Both blocks are alive while data is copied, as in the worst case of realloc
+        void* newPtr = Malloc(newSize);
+        if (originalPtr && newPtr)
+            std::memcpy(newPtr, originalPtr, ea::min(originalSize, newSize));
+        Free(originalPtr);
+        return newPtr;
+    }
+
+    static void Free(void* ptr)
+    {
+        if (!ptr)
+            return;
+
+        auto header = static_cast<std::max_align_t*>(ptr) - 1;
+        currentAllocatedBytes -= *reinterpret_cast<std::size_t*>(header);
+        std::free(header);
+    }
+};
+
+}
+
+TEST_CASE("Benchmark JSON scene loading with and without DOM", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto sourceScene = CreateTestScene(context, 20000);
+    ea::string jsonText;
+    {
+        auto jsonFile = MakeShared<JSONFile>(context);
+        REQUIRE(jsonFile->SaveObject(*sourceScene));
+        jsonText = jsonFile->ToString();
+    }
+
+    auto domScene = MakeShared<Scene>(context);
+    auto streamScene = MakeShared<Scene>(context);
+
+    HiresTimer timer;
+    {
+        auto jsonFile = MakeShared<JSONFile>(context);
+        MemoryBuffer buffer{jsonText.data(), jsonText.size()};
+        REQUIRE(jsonFile->Load(buffer));
+        REQUIRE(jsonFile->LoadObject(*domScene));
+    }
+    const long long domTime = timer.GetUSec(true);
+
+    {
+        MemoryBuffer buffer{jsonText.data(), jsonText.size()};
+        JSONStreamInputArchive archive{context, buffer};
+        Object& object = *streamScene;
+        SerializeValue(archive, "Scene", object);
+    }
+    const long long streamTime = timer.GetUSec(true);
+
+    REQUIRE(Tests::CompareNodes(*domScene, *streamScene));
+
+    // Peak memory of parsing, both parsers allocate from the same counting allocator.
+    // JSONFile copies the whole text and builds the document, which is then converted into JSONValue (not counted).
+    // JSONStreamInputArchive reads the source through the fixed-size buffer and keeps only the parser stack.
+    // Objects created from the data are the same for both paths and are not counted.
+    using CountingDocument = rapidjson::GenericDocument<rapidjson::UTF8<>,
+        rapidjson::MemoryPoolAllocator<CountingAllocator>, CountingAllocator>;
+    using CountingReader = rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>, CountingAllocator>;
+
+    CountingAllocator::Reset();
+    {
+        CountingAllocator allocator;
+        auto text = static_cast<char*>(allocator.Malloc(jsonText.size() + 1));
+        std::memcpy(text, jsonText.c_str(), jsonText.size() + 1);
+
+        CountingDocument document;
+        document.Parse<rapidjson::kParseCommentsFlag | rapidjson::kParseTrailingCommasFlag>(text);
+        REQUIRE_FALSE(document.HasParseError());
+
+        CountingAllocator::Free(text);
+    }
+    const std::size_t domPeakBytes = CountingAllocator::GetPeakBytes();
+
+    CountingAllocator::Reset();
+    {
+        CountingReader reader;
+        rapidjson::StringStream stream{jsonText.c_str()};
+        rapidjson::BaseReaderHandler<> handler;
+        REQUIRE_FALSE(reader.Parse<rapidjson::kParseCommentsFlag>(stream, handler).IsError());
+    }
+    const std::size_t streamPeakBytes = CountingAllocator::GetPeakBytes() + JSONStreamInputArchive::DefaultBufferSize;
+
+    WARN(Format("JSON size: {} KB", jsonText.size() / 1024).c_str());
+    WARN(Format("DOM load: {} ms, {} KB peak parsing memory", domTime / 1000, domPeakBytes / 1024).c_str());
+    WARN(Format("Stream load: {} ms, {} KB peak parsing memory", streamTime / 1000, streamPeakBytes / 1024).c_str());
+}
+
+TEST_CASE("Arrays of plain values are serialized in bulk")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const ea::vector<unsigned> sourceIds{1, 2, 3, 5, 8, 1000, 1001, 100000};
+    const ea::vector<int> sourceInts{0, -1, 1, M_MIN_INT, M_MAX_INT, -7, 7};
+    const ea::vector<float> sourceFloats{0.0f, 0.5f, 1.0f, -1.0f, 1.5f, 65536.0f, -0.25f};
+    const ea::vector<unsigned char> sourceBytes{0, 255, 1, 254, 128};
+    const ea::vector<long long> sourceLongs{0, ea::numeric_limits<long long>::min(), ea::numeric_limits<long long>::max(), -1};
+    const ea::array<Vector3, 3> sourceVectors{Vector3::ONE, Vector3::UP, Vector3{1.0f, 2.0f, 3.0f}};
+
+    const auto serialize = [](Archive& archive, auto& ids, auto& ints, auto& floats, auto& bytes, auto& longs, auto& vectors)
+    {
+        auto block = archive.OpenUnorderedBlock("test");
+        SerializeVectorAsPackedDeltas(archive, "ids", ids);
+        SerializeVectorAsPackedDeltas(archive, "ints", ints);
+        SerializeVectorAsPackedDeltas(archive, "floats", floats);
+        SerializeVectorAsPackedDeltas(archive, "bytes", bytes);
+        SerializeVectorAsPackedDeltas(archive, "longs", longs);
+        SerializeValue(archive, "vectors", vectors);
+    };
+
+    auto ids = sourceIds;
+    auto ints = sourceInts;
+    auto floats = sourceFloats;
+    auto bytes = sourceBytes;
+    auto longs = sourceLongs;
+    auto vectors = sourceVectors;
+
+    ea::vector<unsigned> loadedIds;
+    ea::vector<int> loadedInts;
+    ea::vector<float> loadedFloats;
+    ea::vector<unsigned char> loadedBytes;
+    ea::vector<long long> loadedLongs;
+    ea::array<Vector3, 3> loadedVectors{};
+
+    SECTION("binary archive")
+    {
+        VectorBuffer buffer;
+        {
+            BinaryOutputArchive archive{context, buffer};
+            serialize(archive, ids, ints, floats, bytes, longs, vectors);
+        }
+
+        MemoryBuffer readBuffer{buffer.GetBuffer()};
+        BinaryInputArchive archive{context, readBuffer};
+        serialize(archive, loadedIds, loadedInts, loadedFloats, loadedBytes, loadedLongs, loadedVectors);
+    }
+
+    SECTION("JSON archive")
+    {
+        JSONValue root;
+        {
+            JSONOutputArchive archive{context, root};
+            serialize(archive, ids, ints, floats, bytes, longs, vectors);
+        }
+
+        JSONInputArchive archive{context, root};
+        serialize(archive, loadedIds, loadedInts, loadedFloats, loadedBytes, loadedLongs, loadedVectors);
+    }
+
+    CHECK(loadedIds == sourceIds);
+    CHECK(loadedInts == sourceInts);
+    CHECK(loadedFloats == sourceFloats);
+    CHECK(loadedBytes == sourceBytes);
+    CHECK(loadedLongs == sourceLongs);
+    CHECK(loadedVectors == sourceVectors);
+}
+
+TEST_CASE("Packed deltas are compact and validated")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    ea::vector<unsigned> ids(10000);
+    for (unsigned i = 0; i < ids.size(); ++i)
+        ids[i] = 1000000 + i * 3;
+
+    VectorBuffer buffer;
+    {
+        BinaryOutputArchive archive{context, buffer};
+        SerializeVectorAsPackedDeltas(archive, "ids", ids);
+    }
+    CHECK(buffer.GetSize() < ids.size() + 16);
+
+    SECTION("Valid data")
+    {
+        ea::vector<unsigned> loadedIds;
+        MemoryBuffer readBuffer{buffer.GetBuffer()};
+        BinaryInputArchive archive{context, readBuffer};
+        SerializeVectorAsPackedDeltas(archive, "ids", loadedIds);
+        CHECK(loadedIds == ids);
+    }
+
+    SECTION("Corrupted data")
+    {
+        ByteVector data = buffer.GetBuffer();
+        data.back() = 0x80;
+
+        ea::vector<unsigned> loadedIds;
+        MemoryBuffer readBuffer{data};
+        BinaryInputArchive archive{context, readBuffer};
+        CHECK_THROWS_AS(SerializeVectorAsPackedDeltas(archive, "ids", loadedIds), ArchiveException);
+    }
+
+    SECTION("Size larger than input")
+    {
+        VectorBuffer truncatedBuffer;
+        {
+            BinaryOutputArchive archive{context, truncatedBuffer};
+            auto block = archive.OpenUnorderedBlock("ids");
+            unsigned numElements = 4;
+            unsigned sizeInBytes = 0x40000000;
+            archive.SerializeVLE("size", numElements);
+            archive.SerializeVLE("sizeInBytes", sizeInBytes);
+        }
+
+        ea::vector<unsigned> loadedIds;
+        MemoryBuffer readBuffer{truncatedBuffer.GetBuffer()};
+        BinaryInputArchive archive{context, readBuffer};
+        CHECK_THROWS_AS(SerializeVectorAsPackedDeltas(archive, "ids", loadedIds), ArchiveException);
+        CHECK(loadedIds.capacity() == 0);
+    }
+
+    SECTION("Array of wrong size")
+    {
+        ea::array<unsigned, 4> array{};
+        MemoryBuffer readBuffer{buffer.GetBuffer()};
+        BinaryInputArchive archive{context, readBuffer};
+        CHECK_THROWS_AS(SerializeArray(archive, "ids", array), ArchiveException);
+    }
+}
+
+TEST_CASE("Benchmark binary serialization of plain arrays", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const unsigned size = 1024;
+    ea::vector<float> heights(size * size);
+    for (unsigned i = 0; i < heights.size(); ++i)
+        heights[i] = Sin(static_cast<float>(i % size)) * 10.0f + static_cast<float>(i / size) * 0.1f;
+
+    const auto benchmark = [&](const auto& serialize)
+    {
+        HiresTimer timer;
+        VectorBuffer buffer;
+        {
+            BinaryOutputArchive archive{context, buffer};
+            serialize(archive, heights);
+        }
+        const long long saveTime = timer.GetUSec(true);
+
+        ea::vector<float> loadedHeights;
+        {
+            MemoryBuffer readBuffer{buffer.GetBuffer()};
+            BinaryInputArchive archive{context, readBuffer};
+            serialize(archive, loadedHeights);
+        }
+        const long long loadTime = timer.GetUSec(true);
+
+        CHECK(loadedHeights == heights);
+        return Format("save {:.2f} ms, load {:.2f} ms, {} KB", saveTime / 1000.0, loadTime / 1000.0, buffer.GetSize() / 1024);
+    };
+
+    const ea::string objects = benchmark([](Archive& archive, ea::vector<float>& value)
+        { SerializeVectorAsObjects(archive, "heights", value); });
+    const ea::string bytes = benchmark([](Archive& archive, ea::vector<float>& value)
+        { SerializeVector(archive, "heights", value); });
+    const ea::string packed = benchmark([](Archive& archive, ea::vector<float>& value)
+        { SerializeVectorAsPackedDeltas(archive, "heights", value); });
+
+    WARN(Format("{}x{} heightfield: per element {}; bulk {}; packed deltas {}", size, size, objects, bytes, packed).c_str());
 }
 
 TEST_CASE("Enum safe serialization")
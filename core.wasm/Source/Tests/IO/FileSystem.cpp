@@ -22,7 +22,10 @@
 
 #include "../CommonUtils.h"
 
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/MemoryBuffer.h>
 
 TEST_CASE("ResolvePath handles /")
 {
@@ -68,3 +71,54 @@ TEST_CASE("ResolvePath handles .")
     // Eliminate trailing dot
     CHECK(ResolvePath("bla/.") == "bla");
 }
+
+TEST_CASE("Files are read asynchronously in batches")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto fs = context->GetSubsystem<FileSystem>();
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "AsyncReadTest");
+    const ea::string fileName = tempDir.GetPath() + "Data.bin";
+
+    ByteVector content(100000);
+    for (unsigned i = 0; i < content.size(); ++i)
+        content[i] = static_cast<unsigned char>(i * 7 + i / 256);
+
+    {
+        File file(context, fileName, FILE_WRITE);
+        file.Write(content.data(), content.size());
+    }
+
+    auto file = MakeShared<File>(context, fileName);
+    MemoryBuffer memoryBuffer(content);
+    for (AbstractFile* source : {static_cast<AbstractFile*>(file.Get()), static_cast<AbstractFile*>(&memoryBuffer)})
+    {
+        source->Seek(10);
+
+        // Last request is partially out of bounds
+        ea::vector<ByteVector> buffers(16, ByteVector(1000));
+        ea::vector<AsyncReadRequest> requests;
+        for (unsigned i = 0; i < buffers.size(); ++i)
+            requests.push_back(AsyncReadRequest{i * 6640ull, 1000, buffers[i].data()});
+
+        ea::vector<unsigned> bytesRead;
+        source->ReadAsync(workQueue, requests, [&](ea::span<AsyncReadRequest> completed)
+        {
+            for (const AsyncReadRequest& request : completed)
+                bytesRead.push_back(request.bytesRead_);
+        });
+        workQueue->CompleteAll();
+
+        REQUIRE(bytesRead.size() == buffers.size());
+        for (unsigned i = 0; i < buffers.size(); ++i)
+        {
+            const unsigned offset = i * 6640;
+            const unsigned expectedSize = ea::min(1000u, content.size() - offset);
+            REQUIRE(bytesRead[i] == expectedSize);
+            CHECK(ea::equal(buffers[i].begin(), buffers[i].begin() + expectedSize, content.begin() + offset));
+        }
+
+        // Position is not affected
+        CHECK(source->GetPosition() == 10);
+    }
+}
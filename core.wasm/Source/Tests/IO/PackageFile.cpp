@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/PackageBuilder.h>
+#include <Urho3D/IO/PackageFile.h>
+#include <Urho3D/IO/VectorBuffer.h>
+
+#include <fstream>
+
+namespace Tests
+{
+
+namespace
+{
+
+void WriteUncompressedPackage(Context* context, const ea::string& fileName, const StringVariantMap& files)
+{
+    unsigned directorySize = 0;
+    for (const auto& [name, content] : files)
+        directorySize += name.length() + 1 + 3 * sizeof(unsigned);
+
+    const unsigned headerSize = 4 + 2 * sizeof(unsigned);
+    unsigned offset = headerSize + directorySize;
+
+    File file(context, fileName, FILE_WRITE);
+    file.WriteFileID("UPAK");
+    file.WriteUInt(files.size());
+    file.WriteUInt(0);
+    for (const auto& [name, content] : files)
+    {
+        const unsigned size = content.GetString().length();
+        file.WriteString(name);
+        file.WriteUInt(offset);
+        file.WriteUInt(size);
+        file.WriteUInt(0);
+        offset += size;
+    }
+    for (const auto& [name, content] : files)
+        file.Write(content.GetString().data(), content.GetString().length());
+}
+
+} // namespace
+
+TEST_CASE("Uncompressed PackageFile files are read from memory")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto fs = context->GetSubsystem<FileSystem>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "PackageFileTest");
+    const ea::string packageName = tempDir.GetPath() + "Data.pak";
+
+    StringVariantMap files;
+    files["First.txt"] = "First file";
+    files["Dir/Second.txt"] = "Second file content";
+    WriteUncompressedPackage(context, packageName, files);
+
+    auto package = MakeShared<PackageFile>(context, packageName);
+    REQUIRE(package->GetNumFiles() == 2);
+    REQUIRE_FALSE(package->IsCompressed());
+
+    for (const auto& [name, content] : files)
+    {
+        AbstractFilePtr file = package->OpenFile(FileIdentifier{"", name}, FILE_READ);
+        REQUIRE(file);
+        REQUIRE(file->GetSize() == content.GetString().length());
+
+        ea::string text(file->GetSize(), '\0');
+        REQUIRE(file->Read(text.data(), text.length()) == text.length());
+        CHECK(text == content.GetString());
+
+        // Files of mapped package are views of mapped memory
+        CHECK(package->IsMemoryMapped() == (dynamic_cast<MemoryBuffer*>(file.Get()) != nullptr));
+        package->PrefetchFile(name);
+    }
+
+    CHECK_FALSE(package->OpenFile(FileIdentifier{"", "Missing.txt"}, FILE_READ));
+
+    // Mapped views keep the package data alive
+    AbstractFilePtr file = package->OpenFile(FileIdentifier{"", "First.txt"}, FILE_READ);
+    package = nullptr;
+    CHECK(file->ReadLine() == "First file");
+}
+
+TEST_CASE("PackageFile of version 2 is read with mixed compression")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto fs = context->GetSubsystem<FileSystem>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "PackageFileV2Test");
+    const ea::string packageName = tempDir.GetPath() + "Data.pak";
+
+    ea::string compressibleText;
+    for (unsigned i = 0; i < 10000; ++i)
+        compressibleText += Format("Line {} of the compressible file\n", i % 16);
+
+    const ea::vector<ea::pair<ea::string, PackageCodec>> entries = {
+        {"Stored.txt", PACKAGE_CODEC_NONE},
+        {"Dir/Fast.txt", PACKAGE_CODEC_LZ4},
+        {"Dir/High.txt", PACKAGE_CODEC_LZ4HC},
+        {"Tiny.txt", PACKAGE_CODEC_LZ4HC},
+    };
+    const auto getContent = [&](const ea::string& name) { return name == "Tiny.txt" ? ea::string{"x"} : compressibleText; };
+
+    {
+        File file(context, packageName, FILE_WRITE);
+        ea::vector<ea::string> fileNames;
+        for (const auto& [name, codec] : entries)
+            fileNames.push_back(name);
+
+        PackageBuilder builder;
+        REQUIRE(builder.Create(&file, fileNames));
+        for (const auto& [name, codec] : entries)
+        {
+            const ea::string content = getContent(name);
+            const ConstByteSpan data{reinterpret_cast<const unsigned char*>(content.data()), content.length()};
+            REQUIRE(builder.AppendFile(name, data, codec));
+        }
+        REQUIRE(builder.Finalize());
+    }
+
+    auto package = MakeShared<PackageFile>(context, packageName);
+    REQUIRE(package->GetVersion() == 2);
+    REQUIRE(package->GetNumFiles() == entries.size());
+    REQUIRE(package->IsCompressed());
+
+    for (const auto& [name, codec] : entries)
+    {
+        const ea::string content = getContent(name);
+        const PackageEntry* entry = package->GetEntry(name);
+        REQUIRE(entry);
+        REQUIRE(package->GetEntryName(*entry) == name);
+        REQUIRE(entry->size_ == content.length());
+
+        // Compression is skipped when it doesn't make the file smaller
+        const PackageCodec expectedCodec = name == "Tiny.txt" ? PACKAGE_CODEC_NONE : codec;
+        CHECK(entry->codec_ == expectedCodec);
+        if (expectedCodec != PACKAGE_CODEC_NONE)
+            CHECK(entry->packedSize_ < entry->size_);
+
+        AbstractFilePtr file = package->OpenFile(FileIdentifier{"", name}, FILE_READ);
+        REQUIRE(file);
+        REQUIRE(file->GetSize() == content.length());
+
+        ea::string text(file->GetSize(), '\0');
+        REQUIRE(file->Read(text.data(), text.length()) == text.length());
+        CHECK(text == content);
+        CHECK(file->GetChecksum() == entry->checksum_);
+    }
+
+    CHECK_FALSE(package->Exists("Missing.txt"));
+    CHECK_FALSE(package->OpenFile(FileIdentifier{"", "Missing.txt"}, FILE_READ));
+
+    StringVector scanned;
+    package->Scan(scanned, "Dir/", "*.txt", SCAN_FILES);
+    ea::sort(scanned.begin(), scanned.end());
+    CHECK(scanned == StringVector{"Fast.txt", "High.txt"});
+}
+
+TEST_CASE("Compressed PackageFile files support random access")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto fs = context->GetSubsystem<FileSystem>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "PackageFileSeekTest");
+    const ea::string packageName = tempDir.GetPath() + "Data.pak";
+
+    ByteVector content;
+    for (unsigned i = 0; i < 300000; ++i)
+        content.push_back(static_cast<unsigned char>((i / 64 * 31 + i % 4) % 251));
+
+    {
+        File file(context, packageName, FILE_WRITE);
+        PackageBuilder builder;
+        REQUIRE(builder.Create(&file, {"Data.bin"}));
+        REQUIRE(builder.AppendFile("Data.bin", content, PACKAGE_CODEC_LZ4));
+        REQUIRE(builder.Finalize());
+    }
+
+    auto package = MakeShared<PackageFile>(context, packageName);
+    package->SetBlockCacheSize(2);
+    REQUIRE(package->GetEntry("Data.bin")->codec_ == PACKAGE_CODEC_LZ4);
+
+    auto file1 = MakeShared<File>(context, package, "Data.bin");
+    auto file2 = MakeShared<File>(context, package, "Data.bin");
+    REQUIRE(file1->IsOpen());
+    REQUIRE(file2->IsOpen());
+    REQUIRE(package->GetBlockIndex(*package->GetEntry("Data.bin"))->size() == 10);
+
+    // Seek forward and backward, read across block boundaries
+    const unsigned positions[] = {250000, 10, 32760, 299990, 65536, 0, 131070, 200000};
+    for (const unsigned position : positions)
+    {
+        for (File* file : {file1.Get(), file2.Get()})
+        {
+            REQUIRE(file->Seek(position) == position);
+            ByteVector data(ea::min(100u, content.size() - position));
+            REQUIRE(file->Read(data.data(), data.size()) == data.size());
+            CHECK(ea::equal(data.begin(), data.end(), content.begin() + position));
+            CHECK(file->GetPosition() == position + data.size());
+        }
+    }
+
+    // Read whole file after seeks
+    REQUIRE(file1->Seek(0) == 0);
+    CHECK(file1->ReadBinary() == content);
+    CHECK(file1->IsEof());
+}
+
+TEST_CASE("PackageFile of version 2 is read when files are located beyond 4 GB")
+{
+    // Package larger than 4 GB can only be mapped by 64-bit process
+    if (sizeof(void*) < 8)
+        return;
+
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto fs = context->GetSubsystem<FileSystem>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "PackageFileLargeTest");
+    const ea::string packageName = tempDir.GetPath() + "Data.pak";
+
+    ea::string compressibleText;
+    for (unsigned i = 0; i < 1000; ++i)
+        compressibleText += Format("Line {} of the compressible file\n", i % 16);
+    const ea::vector<ea::pair<ea::string, PackageCodec>> entries = {
+        {"Near.txt", PACKAGE_CODEC_NONE},
+        {"Far.txt", PACKAGE_CODEC_NONE},
+        {"FarCompressed.txt", PACKAGE_CODEC_LZ4},
+    };
+
+    VectorBuffer buffer;
+    {
+        PackageBuilder builder;
+        REQUIRE(builder.Create(&buffer, {"Near.txt", "Far.txt", "FarCompressed.txt"}));
+        for (const auto& [name, codec] : entries)
+        {
+            const ConstByteSpan data{reinterpret_cast<const unsigned char*>(compressibleText.data()), compressibleText.length()};
+            REQUIRE(builder.AppendFile(name, data, codec));
+        }
+        REQUIRE(builder.Finalize());
+    }
+
+    // Move everything after the first file beyond 4 GB
+    const unsigned long long shift = 1ull << 32;
+    buffer.Seek(16);
+    const unsigned long long directoryOffset = buffer.ReadUInt64();
+    auto* directory = reinterpret_cast<PackageEntry*>(buffer.GetModifiableData() + directoryOffset);
+
+    unsigned long long splitOffset = 0;
+    for (unsigned i = 0; i < entries.size(); ++i)
+    {
+        if (PackageFile::GetEntryNameHash("Near.txt") == directory[i].nameHash_)
+            splitOffset = directory[i].offset_ + directory[i].packedSize_;
+    }
+    REQUIRE(splitOffset != 0);
+
+    for (unsigned i = 0; i < entries.size(); ++i)
+    {
+        if (directory[i].offset_ >= splitOffset)
+            directory[i].offset_ += shift;
+    }
+    unsigned long long packageSize = 0;
+    memcpy(&packageSize, buffer.GetData() + buffer.GetSize() - sizeof(packageSize), sizeof(packageSize));
+    packageSize += shift;
+    memcpy(buffer.GetModifiableData() + buffer.GetSize() - sizeof(packageSize), &packageSize, sizeof(packageSize));
+
+    // Gap is left unwritten, so the file is sparse on most file systems
+    {
+        const auto data = reinterpret_cast<const char*>(buffer.GetData());
+        std::ofstream stream(packageName.c_str(), std::ios::binary);
+        stream.write(data, splitOffset);
+        stream.seekp(static_cast<std::streamoff>(splitOffset + shift));
+        stream.write(data + splitOffset, buffer.GetSize() - splitOffset);
+        if (!stream)
+        {
+            WARN("Cannot create package file larger than 4 GB, test skipped");
+            return;
+        }
+    }
+
+    auto package = MakeShared<PackageFile>(context, packageName);
+    REQUIRE(package->GetVersion() == 2);
+    REQUIRE(package->GetNumFiles() == entries.size());
+    REQUIRE(package->IsMemoryMapped());
+    CHECK(package->GetTotalSize() == buffer.GetSize() + shift);
+
+    for (const auto& [name, codec] : entries)
+    {
+        const PackageEntry* entry = package->GetEntry(name);
+        REQUIRE(entry);
+        CHECK((entry->offset_ > shift) == (name != "Near.txt"));
+
+        AbstractFilePtr file = package->OpenFile(FileIdentifier{"", name}, FILE_READ);
+        REQUIRE(file);
+        REQUIRE(file->GetSize() == compressibleText.length());
+
+        ea::string text(file->GetSize(), '\0');
+        REQUIRE(file->Read(text.data(), text.length()) == text.length());
+        CHECK(text == compressibleText);
+    }
+}
+
+} // namespace Tests
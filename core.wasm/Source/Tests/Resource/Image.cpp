@@ -23,8 +23,13 @@
 #include "../CommonUtils.h"
 #include "Urho3D/IO/MemoryBuffer.h"
 #include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Resource/Decompress.h>
 #include <Urho3D/Resource/Image.h>
 
+#include <atomic>
+
 namespace Tests
 {
 namespace
@@ -68,8 +73,297 @@ float CompareImages(const Image& lhs, const Image& rhs, bool compareAlpha, float
     return static_cast<float>(Sqrt(errorSum / (size.x_ * size.y_)));
 }
 
+ByteVector CreateRandomBlocks(int width, int height, unsigned bytesPerBlock)
+{
+    ByteVector blocks(((width + 3) / 4) * ((height + 3) / 4) * bytesPerBlock);
+    unsigned state = 12345;
+    for (unsigned char& value : blocks)
+    {
+        state = state * 1103515245u + 12345u;
+        value = static_cast<unsigned char>(state >> 16);
+    }
+    return blocks;
+}
+
+void DecompressBlocks(
+    ByteVector& rgba, const ByteVector& blocks, int width, int height, CompressedFormat format, WorkQueue* workQueue)
+{
+    switch (format)
+    {
+    case CF_DXT1:
+    case CF_DXT3:
+    case CF_DXT5:
+        DecompressImageDXT(rgba.data(), blocks.data(), width, height, 1, format, workQueue);
+        break;
+    case CF_ETC1:
+    case CF_ETC2_RGBA:
+        DecompressImageETC(rgba.data(), blocks.data(), width, height, format == CF_ETC2_RGBA, workQueue);
+        break;
+    default:
+        DecompressImagePVRTC(rgba.data(), blocks.data(), width, height, format, workQueue);
+        break;
+    }
+}
+
+unsigned GetBytesPerBlock(CompressedFormat format)
+{
+    return format == CF_DXT3 || format == CF_DXT5 || format == CF_ETC2_RGBA ? 16 : 8;
+}
+
+SharedPtr<Image> CreateRandomImage(Context* context, int width, int height, unsigned components)
+{
+    auto image = MakeShared<Image>(context);
+    image->SetSize(width, height, components);
+    unsigned char* data = image->GetData();
+    unsigned state = 54321;
+    for (unsigned i = 0; i < width * height * components; ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        data[i] = static_cast<unsigned char>(state >> 16);
+    }
+    return image;
+}
+
+unsigned char GetReferenceMipValue(const Image& image, int x, int y, unsigned component)
+{
+    const unsigned char* data = image.GetData();
+    const int width = image.GetWidth();
+    const unsigned components = image.GetComponents();
+    const auto sample = [&](int sx, int sy) { return static_cast<unsigned>(data[(sy * width + sx) * components + component]); };
+    return static_cast<unsigned char>(
+        (sample(x * 2, y * 2) + sample(x * 2 + 1, y * 2) + sample(x * 2, y * 2 + 1) + sample(x * 2 + 1, y * 2 + 1)) >> 2);
+}
+
 } // namespace
 
+TEST_CASE("Block-compressed images are decompressed identically in parallel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    const CompressedFormat formats[] = {CF_DXT1, CF_DXT3, CF_DXT5, CF_ETC1, CF_ETC2_RGBA, CF_PVRTC_RGBA_4BPP};
+    for (const CompressedFormat format : formats)
+    {
+        // PVRTC supports only square power-of-two images
+        const bool isPVRTC = format == CF_PVRTC_RGBA_4BPP;
+        const int width = isPVRTC ? 256 : 250;
+        const int height = isPVRTC ? 256 : 198;
+
+        const ByteVector blocks = CreateRandomBlocks(width, height, GetBytesPerBlock(format));
+        ByteVector serial(width * height * 4);
+        ByteVector parallel(width * height * 4);
+        DecompressBlocks(serial, blocks, width, height, format, nullptr);
+        DecompressBlocks(parallel, blocks, width, height, format, workQueue);
+        CHECK(serial == parallel);
+    }
+}
+
+TEST_CASE("Block-compressed images are decompressed inside low-priority tasks")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    const int width = 256;
+    const int height = 256;
+    const ByteVector blocks = CreateRandomBlocks(width, height, GetBytesPerBlock(CF_DXT5));
+    ByteVector expected(width * height * 4);
+    DecompressBlocks(expected, blocks, width, height, CF_DXT5, workQueue);
+
+    // Background loading runs as low-priority tasks, which must not wait for Immediate tasks
+    ByteVector actual(width * height * 4);
+    std::atomic_bool done{false};
+    const auto task = [&]()
+    {
+        DecompressBlocks(actual, blocks, width, height, CF_DXT5, workQueue);
+        done = true;
+    };
+    if (workQueue->IsMultithreaded())
+        workQueue->PostTaskForThread(task, TaskPriority::Low, 1);
+    else
+        workQueue->PostTask(task, TaskPriority::Low);
+
+    while (!done)
+        workQueue->CompleteAll();
+
+    CHECK(actual == expected);
+}
+
+TEST_CASE("Benchmark block decompression", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    const int size = 2048;
+    const CompressedFormat formats[] = {CF_DXT1, CF_DXT5, CF_ETC2_RGBA, CF_PVRTC_RGBA_4BPP};
+    const char* formatNames[] = {"DXT1", "DXT5", "ETC2", "PVRTC"};
+    ByteVector rgba(size * size * 4);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const ByteVector blocks = CreateRandomBlocks(size, size, GetBytesPerBlock(formats[i]));
+        for (WorkQueue* queue : {static_cast<WorkQueue*>(nullptr), workQueue})
+        {
+            const unsigned numIterations = 4;
+            HiresTimer timer;
+            for (unsigned j = 0; j < numIterations; ++j)
+                DecompressBlocks(rgba, blocks, size, size, formats[i], queue);
+            const double seconds = timer.GetUSec(false) / 1000000.0;
+            const double megapixels = static_cast<double>(size) * size * numIterations / 1000000.0;
+            WARN(Format("{} {}: {:.1f} MPixel/sec", formatNames[i], queue ? "parallel" : "serial", megapixels / seconds).c_str());
+        }
+
+        BENCHMARK(Format("Decompress {}x{} {} serial", size, size, formatNames[i]).c_str())
+        {
+            DecompressBlocks(rgba, blocks, size, size, formats[i], nullptr);
+        };
+
+        BENCHMARK(Format("Decompress {}x{} {} parallel", size, size, formatNames[i]).c_str())
+        {
+            DecompressBlocks(rgba, blocks, size, size, formats[i], workQueue);
+        };
+    }
+}
+
+TEST_CASE("Image mip levels are box-filtered")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    // Odd size so that SIMD loops have a tail and the last row and column are dropped
+    const int width = 523;
+    const int height = 263;
+    for (unsigned components = 1; components <= 4; ++components)
+    {
+        const auto image = CreateRandomImage(context, width, height, components);
+        const auto mip = image->GetNextLevel();
+        REQUIRE(mip);
+        REQUIRE(mip->GetWidth() == width / 2);
+        REQUIRE(mip->GetHeight() == height / 2);
+        REQUIRE(mip->GetComponents() == components);
+
+        unsigned numMismatches = 0;
+        const unsigned char* mipData = mip->GetData();
+        for (int y = 0; y < mip->GetHeight(); ++y)
+        {
+            for (int x = 0; x < mip->GetWidth(); ++x)
+            {
+                for (unsigned i = 0; i < components; ++i)
+                {
+                    if (mipData[(y * mip->GetWidth() + x) * components + i] != GetReferenceMipValue(*image, x, y, i))
+                        ++numMismatches;
+                }
+            }
+        }
+        CHECK(numMismatches == 0);
+    }
+}
+
+TEST_CASE("Image mip levels are generated inside low-priority tasks")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    // Big enough to be processed in parallel on the main thread
+    const auto image = CreateRandomImage(context, 523, 263, 4);
+    const auto expectedMip = image->GetNextLevel();
+    REQUIRE(expectedMip);
+
+    // Background loading runs as low-priority tasks, which must not wait for Immediate tasks
+    SharedPtr<Image> mip;
+    std::atomic_bool done{false};
+    const auto task = [&]()
+    {
+        mip = image->GetNextLevel();
+        done = true;
+    };
+    if (workQueue->IsMultithreaded())
+        workQueue->PostTaskForThread(task, TaskPriority::Low, 1);
+    else
+        workQueue->PostTask(task, TaskPriority::Low);
+
+    while (!done)
+        workQueue->CompleteAll();
+
+    REQUIRE(mip);
+    REQUIRE(mip->GetSize() == expectedMip->GetSize());
+    CHECK(ea::equal(mip->GetData(), mip->GetData() + mip->GetWidth() * mip->GetHeight() * 4, expectedMip->GetData()));
+}
+
+TEST_CASE("Mip levels of sRGB image are filtered in linear space")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto image = MakeShared<Image>(context);
+    image->SetSize(2, 2, 4);
+    image->SetPixelInt(0, 0, 0x00000000);
+    image->SetPixelInt(1, 0, 0xffffffff);
+    image->SetPixelInt(0, 1, 0x00000000);
+    image->SetPixelInt(1, 1, 0xffffffff);
+
+    const unsigned linearMip = image->GetNextLevel()->GetPixelInt(0, 0);
+    CHECK(linearMip == 0x7f7f7f7f);
+
+    image->SetSRGB(true);
+    const auto srgbMip = image->GetNextLevel();
+    CHECK(srgbMip->IsSRGB());
+
+    // Half intensity in linear space is 188 in sRGB space, alpha is averaged as is
+    const unsigned srgbColor = srgbMip->GetPixelInt(0, 0);
+    CHECK((srgbColor & 0xff) == 188);
+    CHECK(((srgbColor >> 8) & 0xff) == 188);
+    CHECK(((srgbColor >> 16) & 0xff) == 188);
+    CHECK((srgbColor >> 24) == 0x7f);
+}
+
+TEST_CASE("Image is resized by bilinear resampling")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto sourceImage = CreateRandomImage(context, 300, 220, 4);
+    const auto image = CreateRandomImage(context, 300, 220, 4);
+    REQUIRE(image->Resize(410, 170));
+    REQUIRE(image->GetWidth() == 410);
+    REQUIRE(image->GetHeight() == 170);
+
+    for (const IntVector2 pixel : {IntVector2{0, 0}, IntVector2{409, 169}, IntVector2{123, 45}, IntVector2{321, 160}})
+    {
+        const Color expected = sourceImage->GetPixelBilinear(pixel.x_ / 409.0f, pixel.y_ / 169.0f);
+        CHECK(image->GetPixelInt(pixel.x_, pixel.y_) == expected.ToUInt());
+    }
+}
+
+TEST_CASE("Benchmark mip level generation", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    for (const int size : {4096, 8192})
+    {
+        const auto image = CreateRandomImage(context, size, size, 4);
+        for (const bool sRGB : {false, true})
+        {
+            image->SetSRGB(sRGB);
+
+            HiresTimer timer;
+            image->PrecalculateLevels();
+            const double seconds = timer.GetUSec(false) / 1000000.0;
+            const double megapixels = static_cast<double>(size) * size / 1000000.0;
+            WARN(Format("Mip chain {}x{} {}: {:.1f} ms, {:.1f} MPixel/sec", size, size, sRGB ? "sRGB" : "linear",
+                seconds * 1000.0, megapixels / seconds).c_str());
+            image->CleanupLevels();
+        }
+
+        image->SetSRGB(false);
+        BENCHMARK(Format("Precalculate mip levels {}x{}", size, size).c_str())
+        {
+            image->PrecalculateLevels();
+            image->CleanupLevels();
+        };
+    }
+
+    const auto image = CreateRandomImage(context, 4096, 4096, 4);
+    HiresTimer timer;
+    image->Resize(2048, 2048);
+    WARN(Format("Resize 4096x4096 to 2048x2048: {:.1f} ms", timer.GetUSec(false) / 1000.0).c_str());
+}
+
 TEST_CASE("DXT, ETC and PVRTC images are decompressed")
 {
     auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
@@ -22,13 +22,65 @@
 
 #include "../CommonUtils.h"
 
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/MountedExternalMemory.h>
+#include <Urho3D/IO/VectorBuffer.h>
 #include <Urho3D/IO/VirtualFileSystem.h>
+#include <Urho3D/Resource/CookedResourceCache.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/JSONFile.h>
 #include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
 
 namespace Tests
 {
 
+namespace
+{
+
+ea::vector<ea::string> CreateSyntheticXMLFiles(unsigned numFiles, unsigned numElements)
+{
+    ea::vector<ea::string> result(numFiles);
+    for (unsigned fileIndex = 0; fileIndex < numFiles; ++fileIndex)
+    {
+        ea::string& content = result[fileIndex];
+        content = Format("<root index=\"{}\">", fileIndex);
+        for (unsigned i = 0; i < numElements; ++i)
+            content += Format("<element name=\"Element{}\" value=\"{} {} {}\"/>", i, fileIndex, i, i * 0.5f);
+        content += "</root>";
+    }
+    return result;
+}
+
+ByteVector CreateSyntheticPNG(Context* context, int width, int height, unsigned seed)
+{
+    auto image = MakeShared<Image>(context);
+    image->SetSize(width, height, 4);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+            image->SetPixelInt(x, y, (x * 7 + y * 13 + seed) * 0x01030507u | 0xff000000u);
+    }
+
+    VectorBuffer buffer;
+    image->Save(buffer);
+    return buffer.GetBuffer();
+}
+
+void LoadInBackground(Context* context, const ea::vector<ea::string>& names)
+{
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    for (const ea::string& name : names)
+        resourceCache->BackgroundLoadResource<XMLFile>(name);
+
+    while (resourceCache->GetNumBackgroundLoadResources() > 0)
+        Tests::RunFrame(context, 0.01f);
+}
+
+} // namespace
+
 TEST_CASE("ResourceCache loads resources from memory")
 {
     const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
@@ -52,4 +104,286 @@ TEST_CASE("ResourceCache loads resources from memory")
     CHECK(xmlFile->GetRoot().GetName() == "something_else");
 }
 
+TEST_CASE("ResourceCache loads resources in background")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "bgload");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    const auto contents = CreateSyntheticXMLFiles(64, 16);
+    ea::vector<ea::string> names;
+    for (unsigned i = 0; i < contents.size(); ++i)
+    {
+        mountPoint->LinkMemory(Format("file{}.xml", i), contents[i]);
+        names.push_back(Format("bgload://file{}.xml", i));
+    }
+    names.push_back("bgload://missing.xml");
+
+    // Resource requested immediately is loaded on the main thread if needed
+    REQUIRE(resourceCache->BackgroundLoadResource<XMLFile>(names[0]));
+    auto firstFile = resourceCache->GetResource<XMLFile>(names[0]);
+    REQUIRE(firstFile);
+    CHECK(firstFile->GetRoot().GetUInt("index") == 0);
+
+    LoadInBackground(context, names);
+    for (unsigned i = 0; i < contents.size(); ++i)
+    {
+        auto xmlFile = resourceCache->GetExistingResource<XMLFile>(names[i]);
+        REQUIRE(xmlFile);
+        CHECK(xmlFile->GetRoot().GetUInt("index") == i);
+    }
+    CHECK_FALSE(resourceCache->GetExistingResource<XMLFile>("bgload://missing.xml"));
+
+    resourceCache->ReleaseResources(XMLFile::GetTypeStatic(), "bgload://", true);
+}
+
+TEST_CASE("ResourceCache finds resources by handle from worker threads")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    const auto workQueue = context->GetSubsystem<WorkQueue>();
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "handles");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    const auto contents = CreateSyntheticXMLFiles(64, 1);
+    ea::vector<ResourceHandle> handles;
+    for (unsigned i = 0; i < contents.size(); ++i)
+    {
+        mountPoint->LinkMemory(Format("file{}.xml", i), contents[i]);
+        handles.push_back(resourceCache->GetResourceHandle<XMLFile>(Format("handles://file{}.xml", i)));
+    }
+
+    // Handle is valid before the resource is loaded
+    REQUIRE(handles[0].IsValid());
+    CHECK_FALSE(resourceCache->FindCachedResource(handles[0]));
+    CHECK_FALSE(resourceCache->GetResourceHandle<XMLFile>("").IsValid());
+
+    for (unsigned i = 0; i < contents.size(); ++i)
+        REQUIRE(resourceCache->GetResource<XMLFile>(Format("handles://file{}.xml", i)));
+
+    ea::vector<unsigned> indices(handles.size());
+    ForEachParallel(workQueue, handles,
+        [&](unsigned index, const ResourceHandle& handle)
+    {
+        if (const auto xmlFile = resourceCache->FindCachedResource<XMLFile>(handle))
+            indices[index] = xmlFile->GetRoot().GetUInt("index");
+        else
+            indices[index] = M_MAX_UNSIGNED;
+    });
+    for (unsigned i = 0; i < indices.size(); ++i)
+        CHECK(indices[i] == i);
+
+    // Handle of another type doesn't match
+    CHECK_FALSE(resourceCache->FindCachedResource<JSONFile>(handles[0]));
+
+    resourceCache->ReleaseResource<XMLFile>("handles://file0.xml", true);
+    CHECK_FALSE(resourceCache->FindCachedResource(handles[0]));
+    CHECK(resourceCache->FindCachedResource(handles[1]));
+
+    resourceCache->ReleaseResources(XMLFile::GetTypeStatic(), "handles://", true);
+    CHECK_FALSE(resourceCache->FindCachedResource(handles[1]));
+}
+
+TEST_CASE("Benchmark concurrent resource lookup", "[.][benchmark]")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    const auto workQueue = context->GetSubsystem<WorkQueue>();
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "lookup");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    const auto contents = CreateSyntheticXMLFiles(1000, 1);
+    ea::vector<ea::string> names;
+    ea::vector<ResourceHandle> handles;
+    for (unsigned i = 0; i < contents.size(); ++i)
+    {
+        mountPoint->LinkMemory(Format("file{}.xml", i), contents[i]);
+        names.push_back(Format("lookup://file{}.xml", i));
+        REQUIRE(resourceCache->GetResource<XMLFile>(names.back()));
+        handles.push_back(resourceCache->GetResourceHandle<XMLFile>(names.back()));
+    }
+
+    // Each task does 10000 lookups, one task per worker thread
+    const unsigned numLookups = 10000;
+    ea::vector<unsigned> tasks(workQueue->GetNumProcessingThreads() + 1);
+
+    BENCHMARK("Lookup by name on main thread")
+    {
+        unsigned found = 0;
+        for (unsigned i = 0; i < numLookups * tasks.size(); ++i)
+            found += resourceCache->GetExistingResource<XMLFile>(names[i % names.size()]) != nullptr;
+        return found;
+    };
+
+    BENCHMARK("Lookup by handle on main thread")
+    {
+        unsigned found = 0;
+        for (unsigned i = 0; i < numLookups * tasks.size(); ++i)
+            found += resourceCache->FindCachedResource(handles[i % handles.size()]) != nullptr;
+        return found;
+    };
+
+    BENCHMARK("Lookup by handle on all threads")
+    {
+        ForEachParallel(workQueue, tasks,
+            [&](unsigned index, unsigned& found)
+        {
+            found = 0;
+            for (unsigned i = 0; i < numLookups; ++i)
+                found += resourceCache->FindCachedResource(handles[(index * 7919 + i) % handles.size()]) != nullptr;
+        });
+        return tasks[0];
+    };
+
+    resourceCache->ReleaseResources(XMLFile::GetTypeStatic(), "lookup://", true);
+}
+
+TEST_CASE("ResourceCache loads cooked resources from content-addressed cache")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    const auto fs = context->GetSubsystem<FileSystem>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "CookedResourceCacheTest");
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "cooked");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    const ByteVector png = CreateSyntheticPNG(context, 64, 32, 0);
+    mountPoint->LinkMemory("image.png", MemoryBuffer(png));
+    mountPoint->LinkMemory("copy.png", MemoryBuffer(png));
+
+    resourceCache->SetCookedResourceDir(tempDir.GetPath());
+    CookedResourceCache* cookedCache = resourceCache->GetCookedResourceCache();
+    REQUIRE(cookedCache);
+
+    // First load decodes the source and stores cooked file
+    const SharedPtr<Image> sourceImage{resourceCache->GetResource<Image>("cooked://image.png")};
+    REQUIRE(sourceImage);
+    CHECK(cookedCache->GetNumHits() == 0);
+    CHECK(cookedCache->GetNumMisses() == 1);
+    resourceCache->ReleaseResource<Image>("cooked://image.png", true);
+
+    // Second load reads cooked image with the complete mip chain
+    auto cookedImage = resourceCache->GetResource<Image>("cooked://image.png");
+    REQUIRE(cookedImage);
+    CHECK(cookedCache->GetNumHits() == 1);
+
+    // Cooked file is found by content regardless of the name
+    auto copyImage = resourceCache->GetResource<Image>("cooked://copy.png");
+    REQUIRE(copyImage);
+    CHECK(cookedCache->GetNumHits() == 2);
+
+    ea::vector<Image*> levels;
+    cookedImage->GetLevels(levels);
+    REQUIRE(levels.size() == 7);
+
+    SharedPtr<Image> expectedLevel{sourceImage};
+    for (Image* level : levels)
+    {
+        REQUIRE(level->GetSize() == expectedLevel->GetSize());
+        REQUIRE(level->GetComponents() == expectedLevel->GetComponents());
+        const unsigned size = level->GetWidth() * level->GetHeight() * level->GetComponents();
+        CHECK(memcmp(level->GetData(), expectedLevel->GetData(), size) == 0);
+        expectedLevel = expectedLevel->GetNextLevel();
+    }
+
+    resourceCache->ReleaseResources(Image::GetTypeStatic(), "cooked://", true);
+    resourceCache->SetCookedResourceDir(EMPTY_STRING);
+}
+
+TEST_CASE("Benchmark startup with cooked resource cache", "[.][benchmark]")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    const auto fs = context->GetSubsystem<FileSystem>();
+    const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "CookedResourceCacheBenchmark");
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "startup");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    // 32 images of 512x512 pixels with complete mip chains
+    ea::vector<ByteVector> contents;
+    ea::vector<ea::string> names;
+    for (unsigned i = 0; i < 32; ++i)
+    {
+        contents.push_back(CreateSyntheticPNG(context, 512, 512, i));
+        mountPoint->LinkMemory(Format("image{}.png", i), MemoryBuffer(contents.back()));
+        names.push_back(Format("startup://image{}.png", i));
+    }
+
+    const auto loadAll = [&]()
+    {
+        resourceCache->ReleaseResources(Image::GetTypeStatic(), "startup://", true);
+        for (const ea::string& name : names)
+        {
+            Image* image = resourceCache->GetResource<Image>(name);
+            REQUIRE(image);
+            image->PrecalculateLevels();
+        }
+    };
+
+    resourceCache->SetCookedResourceDir(tempDir.GetPath());
+    CookedResourceCache* cookedCache = resourceCache->GetCookedResourceCache();
+
+    HiresTimer timer;
+    cookedCache->Clear();
+    loadAll();
+    const long long coldTime = timer.GetUSec(true);
+    loadAll();
+    const long long warmTime = timer.GetUSec(true);
+    WARN(Format("Cold startup: {} ms, warm startup: {} ms", coldTime / 1000, warmTime / 1000).c_str());
+
+    BENCHMARK("Load 32 images without cooked cache")
+    {
+        resourceCache->SetCookedResourceDir(EMPTY_STRING);
+        loadAll();
+        resourceCache->SetCookedResourceDir(tempDir.GetPath());
+    };
+
+    BENCHMARK("Load 32 images with cold cooked cache")
+    {
+        resourceCache->GetCookedResourceCache()->Clear();
+        loadAll();
+    };
+
+    BENCHMARK("Load 32 images with warm cooked cache")
+    {
+        loadAll();
+    };
+
+    resourceCache->ReleaseResources(Image::GetTypeStatic(), "startup://", true);
+    resourceCache->SetCookedResourceDir(EMPTY_STRING);
+}
+
+TEST_CASE("Benchmark background loading of many resources", "[.][benchmark]")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto resourceCache = context->GetSubsystem<ResourceCache>();
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "bgload");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    // 2000 files of about 100 Kb each
+    const auto contents = CreateSyntheticXMLFiles(2000, 2000);
+    ea::vector<ea::string> names;
+    for (unsigned i = 0; i < contents.size(); ++i)
+    {
+        mountPoint->LinkMemory(Format("file{}.xml", i), contents[i]);
+        names.push_back(Format("bgload://file{}.xml", i));
+    }
+
+    BENCHMARK("Load 2000 resources on main thread")
+    {
+        resourceCache->ReleaseResources(XMLFile::GetTypeStatic(), "bgload://", true);
+        for (const ea::string& name : names)
+            resourceCache->GetResource<XMLFile>(name);
+    };
+
+    BENCHMARK("Load 2000 resources in background")
+    {
+        resourceCache->ReleaseResources(XMLFile::GetTypeStatic(), "bgload://", true);
+        LoadInBackground(context, names);
+    };
+
+    resourceCache->ReleaseResources(XMLFile::GetTypeStatic(), "bgload://", true);
+}
+
 } // namespace Tests
@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include <PugiXml/pugixml.hpp>
+
+#include <EASTL/shared_array.h>
+
+#include <atomic>
+
+namespace Tests
+{
+
+namespace
+{
+
+std::atomic<unsigned> numPugiAllocations{};
+
+void* CountingAllocate(size_t size)
+{
+    ++numPugiAllocations;
+    return malloc(size);
+}
+
+void CountingDeallocate(void* ptr)
+{
+    free(ptr);
+}
+
+/// Count allocations made by pugixml while the guard is alive.
+class PugiAllocationCounter
+{
+public:
+    PugiAllocationCounter()
+        : allocate_(pugi::get_memory_allocation_function())
+        , deallocate_(pugi::get_memory_deallocation_function())
+    {
+        numPugiAllocations = 0;
+        pugi::set_memory_management_functions(CountingAllocate, CountingDeallocate);
+    }
+
+    ~PugiAllocationCounter() { pugi::set_memory_management_functions(allocate_, deallocate_); }
+
+    unsigned GetNumAllocations() const { return numPugiAllocations; }
+
+private:
+    pugi::allocation_function allocate_{};
+    pugi::deallocation_function deallocate_{};
+};
+
+ea::string CreateMaterialXML(unsigned index)
+{
+    return Format(R"(<?xml version="1.0"?>
+<material>
+    <technique name="Techniques/NoTexture.xml" quality="0" />
+    <parameter name="MatDiffColor" value="{} 0.5 0.25 1" />
+    <parameter name="MatSpecColor" value="0.3 0.3 0.3 16" />
+    <parameter name="MatEmissiveColor" value="0 0 0" />
+    <parameter name="UOffset" value="1 0 0 {}" />
+    <parameter name="VOffset" value="0 1 0 0" />
+    <cull value="ccw" />
+    <shadowcull value="ccw" />
+    <fill value="solid" />
+    <depthbias constant="0" slopescaled="0" />
+    <renderorder value="128" />
+</material>
+)", (index % 100) / 100.0f, index);
+}
+
+/// Load XMLFile the way XMLFile::BeginLoad did before parsing in place: read into temporary array and let pugixml copy it.
+/// Patching of inherited files is the same in both paths and is not replicated.
+bool LoadXMLFileWithCopy(XMLFile* xmlFile, Deserializer& source)
+{
+    const unsigned dataSize = source.GetSize();
+    ea::shared_array<char> buffer(new char[dataSize]);
+    if (source.Read(buffer.get(), dataSize) != dataSize)
+        return false;
+
+    pugi::xml_document* document = xmlFile->GetDocument();
+    if (!document->load_buffer(buffer.get(), dataSize))
+    {
+        document->reset();
+        return false;
+    }
+
+    const XMLElement rootElem = xmlFile->GetRoot();
+    return rootElem.GetAttribute("inherit").empty();
+}
+
+} // namespace
+
+TEST_CASE("XMLFile is parsed in place and typed attributes are read without copies")
+{
+    auto context = GetOrCreateContext(CreateCompleteContext);
+
+    const ea::string text = R"(<root name="Root" flag="true" count="42" scale="1.5" position="1 2 3" color="0.1 0.2 0.3 1"><child value="text &amp; more" /></root>)";
+
+    auto xmlFile = MakeShared<XMLFile>(context);
+    MemoryBuffer buffer{text.data(), text.size()};
+    REQUIRE(xmlFile->Load(buffer));
+
+    const XMLElement root = xmlFile->GetRoot("root");
+    REQUIRE(root);
+    CHECK(root.GetAttribute("name") == "Root");
+    CHECK(root.GetBool("flag"));
+    CHECK(root.GetInt("count") == 42);
+    CHECK(root.GetUInt("count") == 42u);
+    CHECK(root.GetFloat("scale") == 1.5f);
+    CHECK(root.GetVector3("position") == Vector3{1.0f, 2.0f, 3.0f});
+    CHECK(root.GetColor("color").Equals(Color{0.1f, 0.2f, 0.3f, 1.0f}));
+    CHECK(root.GetVector3("missing") == Vector3::ZERO);
+    CHECK(root.GetChild("child").GetAttribute("value") == "text & more");
+
+    // Source buffer is not referenced after loading
+    ea::string mutableText = text;
+    MemoryBuffer mutableBuffer{mutableText.data(), mutableText.size()};
+    REQUIRE(xmlFile->Load(mutableBuffer));
+    ea::fill(mutableText.begin(), mutableText.end(), ' ');
+    CHECK(xmlFile->GetRoot().GetAttribute("name") == "Root");
+
+    // Malformed data is rejected
+    const ea::string malformedText = "<root><child></root>";
+    MemoryBuffer malformedBuffer{malformedText.data(), malformedText.size()};
+    CHECK_FALSE(xmlFile->Load(malformedBuffer));
+}
+
+TEST_CASE("Benchmark loading of many material XMLs", "[.][benchmark]")
+{
+    auto context = GetOrCreateContext(CreateCompleteContext);
+
+    ea::vector<ea::string> sources;
+    for (unsigned i = 0; i < 5000; ++i)
+        sources.push_back(CreateMaterialXML(i));
+
+    {
+        PugiAllocationCounter counter;
+        for (const ea::string& source : sources)
+        {
+            auto xmlFile = MakeShared<XMLFile>(context);
+            MemoryBuffer buffer{source.data(), source.size()};
+            REQUIRE(LoadXMLFileWithCopy(xmlFile, buffer));
+        }
+        // Temporary array is allocated outside of pugixml once per file
+        const unsigned copyAllocations = counter.GetNumAllocations() + sources.size();
+
+        numPugiAllocations = 0;
+        for (const ea::string& source : sources)
+        {
+            auto xmlFile = MakeShared<XMLFile>(context);
+            MemoryBuffer buffer{source.data(), source.size()};
+            REQUIRE(xmlFile->Load(buffer));
+        }
+        const unsigned inPlaceAllocations = counter.GetNumAllocations();
+
+        WARN(Format("Allocations for loading {} material XMLFiles: {} with copy, {} in place", sources.size(),
+            copyAllocations, inPlaceAllocations).c_str());
+    }
+
+    BENCHMARK("Load 5000 material XMLFiles with copy")
+    {
+        for (const ea::string& source : sources)
+        {
+            auto xmlFile = MakeShared<XMLFile>(context);
+            MemoryBuffer buffer{source.data(), source.size()};
+            LoadXMLFileWithCopy(xmlFile, buffer);
+        }
+    };
+
+    BENCHMARK("Load 5000 material XMLFiles in place")
+    {
+        for (const ea::string& source : sources)
+        {
+            auto xmlFile = MakeShared<XMLFile>(context);
+            MemoryBuffer buffer{source.data(), source.size()};
+            xmlFile->Load(buffer);
+        }
+    };
+
+    BENCHMARK("Load 5000 materials")
+    {
+        for (const ea::string& source : sources)
+        {
+            auto material = MakeShared<Material>(context);
+            MemoryBuffer buffer{source.data(), source.size()};
+            material->Load(buffer);
+        }
+    };
+}
+
+} // namespace Tests
@@ -0,0 +1,359 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Scene/IncrementalSceneSaver.h>
+#include <Urho3D/Scene/SceneResource.h>
+#include <Urho3D/Scene/SplinePath.h>
+
+namespace
+{
+
+ByteVector SaveBase(IncrementalSceneSaver& saver)
+{
+    VectorBuffer buffer;
+    REQUIRE(saver.SaveBase(buffer));
+    CHECK(saver.GetLastSaveSize() == buffer.GetSize());
+    return buffer.GetBuffer();
+}
+
+ByteVector SaveDelta(IncrementalSceneSaver& saver)
+{
+    VectorBuffer buffer;
+    REQUIRE(saver.SaveDelta(buffer));
+    CHECK(saver.GetLastSaveSize() == buffer.GetSize());
+    return buffer.GetBuffer();
+}
+
+template <class T> bool LoadChain(Scene* scene, const T& chain)
+{
+    ea::vector<MemoryBuffer> buffers;
+    for (const ByteVector& data : chain)
+        buffers.emplace_back(data);
+
+    ea::vector<Deserializer*> deserializers;
+    for (MemoryBuffer& buffer : buffers)
+        deserializers.push_back(&buffer);
+
+    return IncrementalSceneSaver::LoadChain(scene, deserializers);
+}
+
+template <class T> ByteVector CompactChain(Context* context, const T& chain)
+{
+    ea::vector<MemoryBuffer> buffers;
+    for (const ByteVector& data : chain)
+        buffers.emplace_back(data);
+
+    ea::vector<Deserializer*> deserializers;
+    for (MemoryBuffer& buffer : buffers)
+        deserializers.push_back(&buffer);
+
+    VectorBuffer result;
+    REQUIRE(IncrementalSceneSaver::CompactChain(context, deserializers, result));
+    return result.GetBuffer();
+}
+
+bool HasNode(const SceneDelta& delta, Node* node)
+{
+    return ea::any_of(delta.GetNodes().begin(), delta.GetNodes().end(),
+        [&](const SceneDelta::NodeRecord& record) { return record.prefab_.GetId() == static_cast<SerializableId>(node->GetID()); });
+}
+
+bool HasComponent(const SceneDelta& delta, Component* component)
+{
+    return ea::any_of(delta.GetComponents().begin(), delta.GetComponents().end(),
+        [&](const SceneDelta::ComponentRecord& record)
+    { return record.prefab_.GetId() == static_cast<SerializableId>(component->GetID()); });
+}
+
+} // namespace
+
+TEST_CASE("Scene delta contains only changed objects")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto scene = Tests::CreateTestScene(context);
+    Node* world = scene->GetChild("World");
+
+    IncrementalSceneSaver saver{scene};
+
+    const SceneDelta base = saver.CaptureBase();
+    CHECK(base.IsBase());
+    CHECK(base.GetSequence() == 0);
+    CHECK(base.GetNodes().size() == 1 + 2 + 3 + 3 * 3 + 3 * 3 * 3);
+    CHECK(base.GetComponents().size() == 1 + 3 + 3 * 3 + 3 * 3 * 3 + scene->GetNumComponents());
+    CHECK(base.GetRemovedNodes().empty());
+    CHECK(base.GetRemovedComponents().empty());
+
+    CHECK(saver.CaptureDelta().GetNumChanges() == 0);
+    CHECK(saver.GetLastNumChanges() == 0);
+
+    Node* movedNode = world->GetChild("World_1_2", true);
+    movedNode->SetPosition(Vector3::ONE * 10.0f);
+    {
+        const SceneDelta delta = saver.CaptureDelta();
+        CHECK_FALSE(delta.IsBase());
+        CHECK(delta.GetSequence() == 2);
+        CHECK(delta.GetNumChanges() == 1);
+        CHECK(HasNode(delta, movedNode));
+    }
+
+    auto staticModel = world->GetChild("World_0", true)->GetComponent<StaticModel>();
+    staticModel->SetCastShadows(!staticModel->GetCastShadows());
+    {
+        const SceneDelta delta = saver.CaptureDelta();
+        CHECK(delta.GetNumChanges() == 1);
+        CHECK(HasComponent(delta, staticModel));
+    }
+
+    Node* removedNode = world->GetChild("World_2_1_0", true);
+    const unsigned removedNodeId = removedNode->GetID();
+    const unsigned removedComponentId = removedNode->GetComponent<StaticModel>()->GetID();
+    removedNode->Remove();
+    {
+        const SceneDelta delta = saver.CaptureDelta();
+        CHECK(delta.GetNodes().empty());
+        CHECK(delta.GetComponents().empty());
+        CHECK(delta.GetRemovedNodes() == ea::vector<unsigned>{removedNodeId});
+        CHECK(delta.GetRemovedComponents() == ea::vector<unsigned>{removedComponentId});
+    }
+
+    Node* addedNode = movedNode->CreateChild("Added");
+    auto addedComponent = addedNode->CreateComponent<StaticModel>();
+    addedNode->CreateChild("Temporary")->SetTemporary(true);
+    addedNode->CreateComponent<StaticModel>()->SetTemporary(true);
+    {
+        const SceneDelta delta = saver.CaptureDelta();
+        CHECK(HasNode(delta, addedNode));
+        CHECK(HasComponent(delta, addedComponent));
+        CHECK(delta.GetComponents().size() == 1);
+        CHECK(delta.GetRemovedNodes().empty());
+        CHECK(delta.GetRemovedComponents().empty());
+    }
+}
+
+TEST_CASE("Scene is loaded from chain of scene deltas")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceScene = Tests::CreateTestScene(context);
+    Node* world = sourceScene->GetChild("World");
+
+    IncrementalSceneSaver saver{sourceScene};
+    ea::vector<ByteVector> chain;
+    chain.push_back(SaveBase(saver));
+
+    world->GetChild("World_0", true)->SetRotation(Quaternion{45.0f, Vector3::UP});
+    world->SetVar("Level", 4);
+    chain.push_back(SaveDelta(saver));
+
+    world->GetChild("World_1_1", true)->Remove();
+    world->GetChild("World_2_2", true)->AddChild(world->GetChild("World_0_0", true));
+    chain.push_back(SaveDelta(saver));
+
+    Node* addedNode = world->CreateChild("Added");
+    addedNode->CreateComponent<StaticModel>()->SetCastShadows(true);
+    sourceScene->SetTimeScale(2.0f);
+    chain.push_back(SaveDelta(saver));
+    CHECK(saver.GetChainLength() == 3);
+
+    const auto scene = MakeShared<Scene>(context);
+    scene->CreateChild("Garbage");
+    REQUIRE(LoadChain(scene, chain));
+    CHECK(Tests::CompareNodes(*sourceScene, *scene));
+    CHECK(scene->GetTimeScale() == 2.0f);
+    CHECK(scene->GetChild("World")->GetVar("Level") == Variant{4});
+    CHECK_FALSE(scene->GetChild("World_1_1", true));
+    CHECK(scene->GetChild("World_0_0", true)->GetParent()->GetName() == "World_2_2");
+    REQUIRE(scene->GetChild("Path")->GetComponent<SplinePath>()->GetControlledNode());
+    CHECK(scene->GetChild("Path")->GetComponent<SplinePath>()->GetControlledNode()->GetName() == "World_2");
+
+    // Compacted chain is the same as the whole chain and accepts newer deltas
+    const ea::vector<ByteVector> compactedChain{CompactChain(context, chain)};
+    const auto compactedScene = MakeShared<Scene>(context);
+    REQUIRE(LoadChain(compactedScene, compactedChain));
+    CHECK(Tests::CompareNodes(*sourceScene, *compactedScene));
+
+    addedNode->SetName("Renamed");
+    const ea::vector<ByteVector> extendedChain{compactedChain[0], SaveDelta(saver)};
+    REQUIRE(LoadChain(compactedScene, extendedChain));
+    CHECK(Tests::CompareNodes(*sourceScene, *compactedScene));
+    CHECK(compactedScene->GetChild("Renamed", true));
+}
+
+TEST_CASE("Broken chain of scene deltas is rejected")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceScene = Tests::CreateTestScene(context);
+
+    IncrementalSceneSaver saver{sourceScene};
+    const ByteVector base = SaveBase(saver);
+    sourceScene->GetChild("World")->SetPosition(Vector3::ONE);
+    const ByteVector delta1 = SaveDelta(saver);
+    sourceScene->GetChild("Path")->SetPosition(Vector3::ONE);
+    const ByteVector delta2 = SaveDelta(saver);
+
+    const auto scene = MakeShared<Scene>(context);
+    CHECK_FALSE(LoadChain(scene, ea::vector<ByteVector>{base, delta2}));
+    CHECK_FALSE(LoadChain(scene, ea::vector<ByteVector>{delta1, delta2}));
+    CHECK_FALSE(LoadChain(scene, ea::vector<ByteVector>{base, ByteVector{'X', 'X', 'X', 'X'}}));
+    CHECK(LoadChain(scene, ea::vector<ByteVector>{base, delta1, delta2}));
+}
+
+TEST_CASE("Changes of failed scene delta write are saved again")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceScene = Tests::CreateTestScene(context);
+    Node* world = sourceScene->GetChild("World");
+
+    IncrementalSceneSaver saver{sourceScene};
+    ea::vector<ByteVector> chain;
+    chain.push_back(SaveBase(saver));
+
+    Node* movedNode = world->GetChild("World_1_2", true);
+    movedNode->SetPosition(Vector3::ONE * 10.0f);
+    world->GetChild("World_2_1_0", true)->Remove();
+    Node* addedNode = world->CreateChild("Added");
+
+    // Destination is too small for the delta
+    ByteVector smallStorage(4);
+    MemoryBuffer smallBuffer{smallStorage};
+    CHECK_FALSE(saver.SaveDelta(smallBuffer));
+    CHECK(saver.GetChainLength() == 0);
+
+    const SceneDelta delta = saver.CaptureDelta();
+    CHECK(delta.GetSequence() == 1);
+    CHECK(HasNode(delta, movedNode));
+    CHECK(HasNode(delta, addedNode));
+    CHECK(delta.GetRemovedNodes().size() == 1);
+
+    // Failed base is not used as base for the following deltas either
+    saver.RevertCapture();
+    CHECK_FALSE(saver.SaveBase(smallBuffer));
+    chain.push_back(SaveDelta(saver));
+    CHECK(saver.GetChainLength() == 1);
+
+    const auto scene = MakeShared<Scene>(context);
+    REQUIRE(LoadChain(scene, chain));
+    CHECK(Tests::CompareNodes(*sourceScene, *scene));
+}
+
+TEST_CASE("Scene changes are scanned over several frames")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceScene = Tests::CreateTestScene(context);
+    Node* world = sourceScene->GetChild("World");
+
+    IncrementalSceneSaver saver{sourceScene};
+    CHECK_FALSE(saver.ScanChanges(0));
+
+    ea::vector<ByteVector> chain;
+    chain.push_back(SaveBase(saver));
+
+    Node* movedNode = world->GetChild("World_1_2", true);
+    movedNode->SetPosition(Vector3::ONE * 10.0f);
+
+    // Zero budget scans one node per call
+    unsigned numScans = 1;
+    while (!saver.ScanChanges(0))
+        ++numScans;
+    CHECK(numScans > 1);
+
+    // Nodes removed or moved after the pass are captured by the next delta
+    Node* reparentedNode = world->GetChild("World_0_0", true);
+    world->GetChild("World_2_2", true)->AddChild(reparentedNode);
+    world->GetChild("World_1_1", true)->Remove();
+    {
+        const SceneDelta delta = saver.CaptureDelta();
+        CHECK(HasNode(delta, movedNode));
+        CHECK(HasNode(delta, reparentedNode));
+        CHECK(delta.GetRemovedNodes().size() == 1 + 3);
+        saver.RevertCapture();
+    }
+    chain.push_back(SaveDelta(saver));
+
+    // Attributes changed after the pass are captured by the delta after the next one
+    while (!saver.ScanChanges(0))
+    {
+    }
+    movedNode->SetPosition(Vector3::ZERO);
+    chain.push_back(SaveDelta(saver));
+    CHECK(saver.GetLastNumChanges() == 0);
+    chain.push_back(SaveDelta(saver));
+    CHECK(saver.GetLastNumChanges() == 1);
+
+    const auto scene = MakeShared<Scene>(context);
+    REQUIRE(LoadChain(scene, chain));
+    CHECK(Tests::CompareNodes(*sourceScene, *scene));
+}
+
+TEST_CASE("Benchmark incremental scene saving", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto resource = MakeShared<SceneResource>(context);
+    Scene* scene = resource->GetScene();
+    Node* world = scene->CreateChild("World");
+    Tests::CreateTestHierarchy(world, 4, 10);
+
+    IncrementalSceneSaver saver{scene};
+    VectorBuffer baseBuffer;
+    REQUIRE(saver.SaveBase(baseBuffer));
+
+    HiresTimer timer;
+    VectorBuffer binaryBuffer;
+    REQUIRE(resource->Save(binaryBuffer, InternalResourceFormat::Binary));
+    const long long binaryTime = timer.GetUSec(true);
+
+    for (unsigned i = 0; i < 10; ++i)
+        world->GetChild(i)->Translate(Vector3::UP);
+
+    VectorBuffer deltaBuffer;
+    REQUIRE(saver.SaveDelta(deltaBuffer));
+    CHECK(saver.GetLastNumChanges() == 10);
+    const long long fullCaptureTime = saver.GetLastCaptureTime();
+
+    // Scan the scene within 1 ms per frame before the next delta
+    for (unsigned i = 0; i < 10; ++i)
+        world->GetChild(i)->Translate(Vector3::DOWN);
+
+    unsigned numFrames = 1;
+    timer.Reset();
+    while (!saver.ScanChanges(1000))
+        ++numFrames;
+    const long long scanTime = timer.GetUSec(false);
+
+    VectorBuffer scannedDeltaBuffer;
+    REQUIRE(saver.SaveDelta(scannedDeltaBuffer));
+    CHECK(saver.GetLastNumChanges() == 10);
+
+    WARN(Format("Scene saved: binary archive {:.1f} ms ({} bytes), delta {:.1f} ms ({} bytes), capture {:.1f} ms",
+        binaryTime / 1000.0, binaryBuffer.GetSize(), saver.GetLastSaveTime() / 1000.0, saver.GetLastSaveSize(),
+        fullCaptureTime / 1000.0).c_str());
+    WARN(Format("Scene scanned in {} frames ({:.1f} ms total), capture after scan {:.1f} ms", numFrames,
+        scanTime / 1000.0, saver.GetLastCaptureTime() / 1000.0).c_str());
+}
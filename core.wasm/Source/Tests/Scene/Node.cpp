@@ -22,7 +22,32 @@
 
 #include "../CommonUtils.h"
 #include "../SceneUtils.h"
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Scene/LogicComponent.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+namespace
+{
+
+class ChurnLogicComponent : public LogicComponent
+{
+    URHO3D_OBJECT(ChurnLogicComponent, LogicComponent);
+
+public:
+    using LogicComponent::LogicComponent;
+
+    static void RegisterObject(Context* context) { context->AddFactoryReflection<ChurnLogicComponent>(); }
+
+    float value_{};
+};
+
+void CreateChurnComponent(Node* node)
+{
+    node->CreateComponent<ChurnLogicComponent>();
+}
+
+}
 
 TEST_CASE("Load node from XML node file")
 {
@@ -44,3 +69,150 @@ TEST_CASE("Load node from XML node file")
     CHECK(child->GetName() == "NodeName");
     CHECK(child->GetComponent<StaticModel>());
 };
+
+TEST_CASE("Node subtree is destroyed in bulk")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<ChurnLogicComponent>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    Node* root = scene->CreateChild("Root");
+    Tests::CreateTestHierarchy(root, 2, 3, CreateChurnComponent);
+
+    Node* grandChild = root->GetChild(1u)->GetChild(2u);
+    WeakPtr<Node> weakChild{root->GetChild(0u)};
+    WeakPtr<Node> weakGrandChild{grandChild};
+    const unsigned grandChildId = grandChild->GetID();
+    REQUIRE(scene->GetNode(grandChildId) == grandChild);
+
+    unsigned numNodeRemovedEvents = 0;
+    scene->SubscribeToEvent(scene, E_NODEREMOVED, [&] { ++numNodeRemovedEvents; });
+
+    SECTION("DestroyAllChildren")
+    {
+        root->DestroyAllChildren();
+
+        CHECK(numNodeRemovedEvents == 3);
+        CHECK(root->GetNumChildren() == 0);
+        CHECK(scene->GetNode(root->GetID()) == root);
+    }
+
+    SECTION("Destroy")
+    {
+        root->Destroy();
+
+        CHECK(numNodeRemovedEvents == 1);
+        CHECK(scene->GetNumChildren() == 0);
+    }
+
+    CHECK_FALSE(weakChild);
+    CHECK_FALSE(weakGrandChild);
+    CHECK(scene->GetNode(grandChildId) == nullptr);
+    CHECK(scene->GetComponentIndex<StaticModel>().empty());
+}
+
+TEST_CASE("Node subtree referenced elsewhere is detached on bulk destroy")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto scene = MakeShared<Scene>(context);
+    Node* root = scene->CreateChild("Root");
+    SharedPtr<Node> child{root->CreateChild("Child")};
+    child->SetPosition(Vector3::ONE);
+    SharedPtr<Node> grandChild{child->CreateChild("GrandChild")};
+    grandChild->SetPosition(Vector3::ONE);
+    REQUIRE(grandChild->GetWorldPosition() == Vector3{2.0f, 2.0f, 2.0f});
+
+    root->DestroyAllChildren();
+
+    CHECK(child->GetParent() == nullptr);
+    CHECK(child->GetScene() == nullptr);
+    CHECK(child->GetNumChildren() == 0);
+    CHECK(grandChild->GetParent() == nullptr);
+    CHECK(grandChild->GetScene() == nullptr);
+    CHECK(grandChild->GetWorldPosition() == Vector3::ONE);
+}
+
+TEST_CASE("Pooled nodes and components reuse memory")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<ChurnLogicComponent>(context);
+
+    const unsigned numNodes = Node::GetPoolAllocator().GetNumAllocations();
+    const unsigned numLogicComponents = LogicComponent::GetPoolAllocator().GetNumAllocations();
+
+    auto node = MakeShared<Node>(context);
+    auto component = node->CreateComponent<ChurnLogicComponent>();
+    CHECK(Node::GetPoolAllocator().GetNumAllocations() == numNodes + 1);
+    CHECK(LogicComponent::GetPoolAllocator().GetNumAllocations() == numLogicComponents + 1);
+
+    const void* nodeAddress = node.Get();
+    const void* componentAddress = component;
+    node = nullptr;
+    CHECK(Node::GetPoolAllocator().GetNumAllocations() == numNodes);
+    CHECK(LogicComponent::GetPoolAllocator().GetNumAllocations() == numLogicComponents);
+
+    // Last freed block is reused first
+    node = MakeShared<Node>(context);
+    component = node->CreateComponent<ChurnLogicComponent>();
+    CHECK(node.Get() == nodeAddress);
+    CHECK(static_cast<const void*>(component) == componentAddress);
+
+    // Scene is too large for the node pool
+    auto scene = MakeShared<Scene>(context);
+    CHECK(Node::GetPoolAllocator().GetNumAllocations() == numNodes + 1);
+}
+
+TEST_CASE("Pooled allocations are aligned for any object")
+{
+    PoolAllocator pool{256, 2};
+
+    ea::vector<ea::pair<void*, size_t>> allocations;
+    for (size_t size : {1, 4, 8, 12, 16, 24, 40, 100, 256})
+    {
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            void* ptr = pool.Allocate(size);
+            CHECK(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t) == 0);
+            allocations.emplace_back(ptr, size);
+        }
+    }
+
+    for (const auto& [ptr, size] : allocations)
+        pool.Deallocate(ptr, size);
+    CHECK(pool.GetNumAllocations() == 0);
+}
+
+TEST_CASE("Benchmark node spawn and despawn churn", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<ChurnLogicComponent>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    Node* root = scene->CreateChild("Root");
+
+    const unsigned numIterations = 20;
+    const unsigned numNodesPerIteration = 5 * 5 * 5 * 5 + 5 * 5 * 5 + 5 * 5 + 5;
+
+    for (const bool bulk : {false, true})
+    {
+        long long spawnTime = 0;
+        long long despawnTime = 0;
+        for (unsigned i = 0; i < numIterations; ++i)
+        {
+            HiresTimer timer;
+            Tests::CreateTestHierarchy(root, 3, 5, CreateChurnComponent);
+            spawnTime += timer.GetUSec(true);
+
+            if (bulk)
+                root->DestroyAllChildren();
+            else
+                root->RemoveAllChildren();
+            despawnTime += timer.GetUSec(true);
+        }
+
+        WARN(Format("{} nodes spawned and despawned {} times ({}): spawn {:.1f} ms, despawn {:.1f} ms",
+            numNodesPerIteration, numIterations, bulk ? "bulk" : "one by one", spawnTime / 1000.0,
+            despawnTime / 1000.0).c_str());
+    }
+}
@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/JSONArchive.h>
+#include <Urho3D/Scene/ParallelSceneLoader.h>
+#include <Urho3D/Scene/SceneResource.h>
+#include <Urho3D/Scene/SplinePath.h>
+
+namespace
+{
+
+SharedPtr<SceneResource> CreateTestSceneResource(Context* context)
+{
+    auto resource = MakeShared<SceneResource>(context);
+
+    // Single root node with all the content should still be split
+    Tests::CreateTestSceneContent(resource->GetScene(), 3, 5);
+
+    return resource;
+}
+
+ConstByteSpan GetArchiveData(const ByteVector& data, InternalResourceFormat format)
+{
+    const ConstByteSpan span{data};
+    return format == InternalResourceFormat::Binary ? span.subspan(BinaryMagicSize) : span;
+}
+
+} // namespace
+
+TEST_CASE("Scene is loaded by subtrees in parallel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceResource = CreateTestSceneResource(context);
+    Scene* sourceScene = sourceResource->GetScene();
+
+    for (const auto format : {InternalResourceFormat::Binary, InternalResourceFormat::Json})
+    {
+        VectorBuffer buffer;
+        REQUIRE(sourceResource->Save(buffer, format));
+
+        // Load via loader directly
+        {
+            auto scene = MakeShared<Scene>(context);
+            scene->CreateChild("Garbage");
+
+            ParallelSceneLoader loader{context, format, GetArchiveData(buffer.GetBuffer(), format), "Test"};
+            loader.Load(scene, SceneResource::GetXmlRootName());
+
+            CHECK(loader.GetNumSubtrees() > sourceScene->GetNumChildren());
+            REQUIRE(Tests::CompareNodes(*sourceScene, *scene));
+            CHECK(scene->GetFileName() == "Test");
+
+            const auto splinePath = scene->GetChild("Path")->GetComponent<SplinePath>();
+            REQUIRE(splinePath);
+            REQUIRE(splinePath->GetControlledNode());
+            CHECK(splinePath->GetControlledNode()->GetName() == "World_4");
+        }
+
+        // Load via resource
+        {
+            auto resource = MakeShared<SceneResource>(context);
+            MemoryBuffer readBuffer{buffer.GetBuffer()};
+            REQUIRE(resource->Load(readBuffer));
+            REQUIRE(Tests::CompareNodes(*sourceScene, *resource->GetScene()));
+        }
+    }
+}
+
+TEST_CASE("JSON scene is streamed from the middle of the source")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceResource = CreateTestSceneResource(context);
+    Scene* sourceScene = sourceResource->GetScene();
+
+    VectorBuffer buffer;
+    buffer.WriteString("Header");
+    const unsigned sceneOffset = buffer.GetPosition();
+    REQUIRE(sourceResource->Save(buffer, InternalResourceFormat::Json));
+    buffer.WriteString("Footer");
+
+    ParallelSceneLoader loader{context, "Test"};
+    {
+        MemoryBuffer readBuffer{buffer.GetBuffer()};
+        readBuffer.Seek(sceneOffset);
+        loader.Read(readBuffer, SceneResource::GetXmlRootName());
+    }
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateChild("Garbage");
+    loader.Instantiate(scene);
+
+    CHECK(loader.GetNumSubtrees() > sourceScene->GetNumChildren());
+    REQUIRE(Tests::CompareNodes(*sourceScene, *scene));
+    CHECK(scene->GetFileName() == "Test");
+
+    const auto splinePath = scene->GetChild("Path")->GetComponent<SplinePath>();
+    REQUIRE(splinePath);
+    REQUIRE(splinePath->GetControlledNode());
+    CHECK(splinePath->GetControlledNode()->GetName() == "World_4");
+}
+
+TEST_CASE("Scene loading fails on malformed subtree")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceResource = CreateTestSceneResource(context);
+
+    VectorBuffer buffer;
+    REQUIRE(sourceResource->Save(buffer, InternalResourceFormat::Json));
+
+    // Damage the value of the last node attribute in the file
+    ea::string text{reinterpret_cast<const char*>(buffer.GetData()), buffer.GetSize()};
+    const unsigned position = text.rfind("\"World_4_4_4_4\"");
+    REQUIRE(position != ea::string::npos);
+    text.replace(position, 1, "{");
+
+    auto scene = MakeShared<Scene>(context);
+    const ConstByteSpan data{reinterpret_cast<const unsigned char*>(text.data()), text.size()};
+    ParallelSceneLoader loader{context, InternalResourceFormat::Json, data, "Test"};
+    CHECK_THROWS_AS(loader.Load(scene, SceneResource::GetXmlRootName()), ArchiveException);
+
+    // Streamed subtrees are deserialized on instantiation
+    auto resource = MakeShared<SceneResource>(context);
+    MemoryBuffer readBuffer{ea::string_view{text}};
+    CHECK_FALSE(resource->Load(readBuffer));
+}
+
+TEST_CASE("Benchmark parallel scene loading", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto sourceResource = MakeShared<SceneResource>(context);
+    Node* world = sourceResource->GetScene()->CreateChild("World");
+    Tests::CreateTestHierarchy(world, 4, 10);
+
+    for (const auto format : {InternalResourceFormat::Binary, InternalResourceFormat::Json})
+    {
+        VectorBuffer buffer;
+        REQUIRE(sourceResource->Save(buffer, format));
+        const ConstByteSpan data = GetArchiveData(buffer.GetBuffer(), format);
+        const char* formatName = format == InternalResourceFormat::Binary ? "Binary" : "JSON";
+
+        HiresTimer timer;
+        {
+            auto scene = MakeShared<Scene>(context);
+            MemoryBuffer readBuffer{data.data(), data.size()};
+            if (format == InternalResourceFormat::Binary)
+            {
+                BinaryInputArchive archive{context, readBuffer};
+                ArchiveBlock block = archive.OpenUnorderedBlock(SceneResource::GetXmlRootName());
+                scene->SerializeInBlock(archive, false, PrefabSaveFlag::None, PrefabLoadFlag::None);
+            }
+            else
+            {
+                JSONStreamInputArchive archive{context, readBuffer};
+                ArchiveBlock block = archive.OpenUnorderedBlock(SceneResource::GetXmlRootName());
+                scene->SerializeInBlock(archive, false, PrefabSaveFlag::None, PrefabLoadFlag::None);
+            }
+        }
+        const long long serialTime = timer.GetUSec(true);
+
+        unsigned numSubtrees = 0;
+        {
+            auto scene = MakeShared<Scene>(context);
+            ParallelSceneLoader loader{context, format, data, "Benchmark"};
+            loader.Load(scene, SceneResource::GetXmlRootName());
+            numSubtrees = loader.GetNumSubtrees();
+        }
+        const long long parallelTime = timer.GetUSec(true);
+
+        // JSON resources are streamed by ParallelSceneLoader::Read and ParallelSceneLoader::Instantiate
+        {
+            auto resource = MakeShared<SceneResource>(context);
+            MemoryBuffer readBuffer{buffer.GetBuffer()};
+            REQUIRE(resource->Load(readBuffer));
+        }
+        const long long resourceTime = timer.GetUSec(true);
+
+        WARN(Format("{} scene loaded: serial {:.1f} ms, parallel {:.1f} ms in {} subtrees, resource {:.1f} ms",
+            formatName, serialTime / 1000.0, parallelTime / 1000.0, numSubtrees, resourceTime / 1000.0).c_str());
+    }
+}
@@ -24,6 +24,8 @@
 #include "../SceneUtils.h"
 #include "Urho3D/Graphics/StaticModel.h"
 
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/IO/BinaryArchive.h>
 #include <Urho3D/IO/MemoryBuffer.h>
 #include <Urho3D/Resource/BinaryFile.h>
@@ -33,6 +35,7 @@
 #include <Urho3D/Physics/Constraint.h>
 #include <Urho3D/Physics/RigidBody.h>
 
+#include <Urho3D/Scene/PrefabInstantiationPlan.h>
 #include <Urho3D/Scene/PrefabReference.h>
 #include <Urho3D/Scene/PrefabReader.h>
 #include <Urho3D/Scene/PrefabResource.h>
@@ -933,3 +936,156 @@ TEST_CASE("Prefab reference is reloaded")
     REQUIRE(node->GetChild(2u)->GetNumComponents() == 0);
     REQUIRE(node->GetChild(2u)->GetNumChildren() == 1);
 }
+
+TEST_CASE("Compiled prefab is instantiated same as loaded prefab")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    const NodePrefab source = MakeTestPrefab();
+    const PrefabInstantiationPlan plan{context, source};
+    CHECK(plan.GetNumNodes() == 7);
+    CHECK(plan.GetNumComponents() == 6);
+
+    auto scene = MakeShared<Scene>(context);
+
+    const PrefabLoadFlags flagsToTest[] = {
+        PrefabLoadFlag::None,
+        PrefabLoadFlag::DiscardIds,
+        PrefabLoadFlag::KeepExistingComponents | PrefabLoadFlag::KeepExistingChildren | PrefabLoadFlag::LoadAsTemporary
+            | PrefabLoadFlag::IgnoreRootAttributes,
+    };
+
+    for (const PrefabLoadFlags flags : flagsToTest)
+    {
+        auto loadedNode = scene->CreateChild();
+        PrefabReaderFromMemory reader{source};
+        REQUIRE(loadedNode->Load(reader, flags));
+
+        auto instantiatedNode = scene->CreateChild();
+        plan.Instantiate(instantiatedNode, flags);
+
+        CHECK(Tests::CompareNodes(*loadedNode, *instantiatedNode));
+        CHECK(instantiatedNode->GetName() == loadedNode->GetName());
+        CHECK(instantiatedNode->GetPosition() == loadedNode->GetPosition());
+
+        REQUIRE(instantiatedNode->GetNumComponents() == 2);
+        CHECK(instantiatedNode->GetComponent<TestComponent>()->enum_ == TestEnum::Blue);
+        CHECK(instantiatedNode->GetComponents()[0]->IsTemporary() == loadedNode->GetComponents()[0]->IsTemporary());
+
+        REQUIRE(instantiatedNode->GetNumChildren() == 4);
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            const Node* instantiatedChild = instantiatedNode->GetChildren()[i];
+            const Node* loadedChild = loadedNode->GetChildren()[i];
+            CHECK(instantiatedChild->GetName() == loadedChild->GetName());
+            CHECK(instantiatedChild->IsTemporary() == loadedChild->IsTemporary());
+            CHECK(instantiatedChild->GetNumComponents() == loadedChild->GetNumComponents());
+            CHECK(instantiatedChild->GetNumChildren() == loadedChild->GetNumChildren());
+        }
+    }
+}
+
+TEST_CASE("Prefab is instantiated in batch")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+
+    auto scene = MakeShared<Scene>(context);
+
+    const Transform transforms[] = {
+        Transform{Vector3{1, 0, 0}},
+        Transform{Vector3{0, 2, 0}, Quaternion{90.0f, Vector3::UP}},
+        Transform{Vector3{0, 0, 3}, Quaternion::IDENTITY, Vector3{2, 2, 2}},
+    };
+    const ea::vector<Node*> instances = scene->InstantiatePrefabs(prefabResource, transforms);
+
+    REQUIRE(instances.size() == 3);
+    REQUIRE(scene->GetNumChildren() == 3);
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        Node* instance = instances[i];
+        CHECK(instance == scene->GetChildren()[i]);
+        CHECK(instance->GetName() == "Apple");
+        CHECK(instance->GetPosition() == transforms[i].position_);
+        CHECK(instance->GetRotation().Equals(transforms[i].rotation_));
+        CHECK(instance->GetScale() == transforms[i].scale_);
+        REQUIRE(instance->GetNumComponents() == 2);
+        CHECK(instance->GetComponent<TestComponent>()->enum_ == TestEnum::Blue);
+        CHECK(instance->GetNumChildren() == 4);
+    }
+
+    // Plan is recompiled when prefab is changed
+    prefabResource->GetMutableNodePrefab().GetMutableChildren().clear();
+    Node* instance = scene->InstantiatePrefab(prefabResource);
+    REQUIRE(instance);
+    CHECK(instance->GetNumComponents() == 2);
+    CHECK(instance->GetNumChildren() == 0);
+
+    // Empty prefab is not instantiated
+    prefabResource->GetMutableNodePrefab().Clear();
+    CHECK(scene->InstantiatePrefab(prefabResource) == nullptr);
+    CHECK(scene->InstantiatePrefabs(prefabResource, transforms).empty());
+    CHECK(scene->GetNumChildren() == 4);
+}
+
+TEST_CASE("Benchmark prefab instantiation", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+
+    const unsigned numInstances = 10000;
+    ea::vector<Transform> transforms(numInstances);
+    for (unsigned i = 0; i < numInstances; ++i)
+        transforms[i].position_ = Vector3{static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100)};
+
+    {
+        auto scene = MakeShared<Scene>(context);
+        HiresTimer timer;
+        for (const Transform& transform : transforms)
+        {
+            Node* node = scene->CreateChild();
+            PrefabReaderFromMemory reader{prefabResource->GetNodePrefab()};
+            node->Load(reader);
+            node->SetTransform(transform);
+        }
+        WARN(Format("{} instances loaded from prefab: {:.1f} ms", numInstances, timer.GetUSec(false) / 1000.0).c_str());
+    }
+
+    {
+        auto scene = MakeShared<Scene>(context);
+        HiresTimer timer;
+        for (const Transform& transform : transforms)
+            scene->InstantiatePrefab(prefabResource, transform.position_, transform.rotation_);
+        WARN(Format("{} instances instantiated one by one: {:.1f} ms", numInstances, timer.GetUSec(false) / 1000.0).c_str());
+    }
+
+    {
+        auto scene = MakeShared<Scene>(context);
+        HiresTimer timer;
+        scene->InstantiatePrefabs(prefabResource, transforms);
+        WARN(Format("{} instances instantiated in batch: {:.1f} ms", numInstances, timer.GetUSec(false) / 1000.0).c_str());
+    }
+
+    BENCHMARK("Load 1000 instances from prefab")
+    {
+        auto scene = MakeShared<Scene>(context);
+        for (unsigned i = 0; i < 1000; ++i)
+        {
+            PrefabReaderFromMemory reader{prefabResource->GetNodePrefab()};
+            scene->CreateChild()->Load(reader);
+        }
+    };
+
+    BENCHMARK("Instantiate 1000 instances in batch")
+    {
+        auto scene = MakeShared<Scene>(context);
+        scene->InstantiatePrefabs(prefabResource, ea::span<const Transform>{transforms.data(), 1000});
+    };
+}
@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Scene/SceneFork.h>
+
+TEST_CASE("SceneFork changes are isolated from the scene and other forks")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    Node* node = scene->CreateChild("Node");
+    node->SetPosition(Vector3{1.0f, 0.0f, 0.0f});
+
+    auto fork = MakeShared<SceneFork>(scene);
+    fork->SetPosition(node, Vector3{2.0f, 0.0f, 0.0f});
+    CHECK(fork->GetPosition(node) == Vector3{2.0f, 0.0f, 0.0f});
+    CHECK(node->GetPosition() == Vector3{1.0f, 0.0f, 0.0f});
+    CHECK(fork->GetNumChanges() == 1);
+
+    // Child fork inherits changes made so far
+    const auto childFork = fork->Fork();
+    CHECK(childFork->GetPosition(node) == Vector3{2.0f, 0.0f, 0.0f});
+    CHECK(childFork->GetNumChanges() == 0);
+    CHECK(fork->GetNumChanges() == 0);
+
+    childFork->SetPosition(node, Vector3{3.0f, 0.0f, 0.0f});
+    fork->SetScale(node, Vector3{2.0f, 2.0f, 2.0f});
+    CHECK(childFork->GetPosition(node) == Vector3{3.0f, 0.0f, 0.0f});
+    CHECK(childFork->GetScale(node) == Vector3::ONE);
+    CHECK(fork->GetPosition(node) == Vector3{2.0f, 0.0f, 0.0f});
+    CHECK(fork->GetScale(node) == Vector3{2.0f, 2.0f, 2.0f});
+
+    // Sibling fork doesn't see changes of another child
+    const auto siblingFork = fork->Fork();
+    CHECK(siblingFork->GetPosition(node) == Vector3{2.0f, 0.0f, 0.0f});
+    CHECK(siblingFork->GetScale(node) == Vector3{2.0f, 2.0f, 2.0f});
+
+    // Discard drops only own changes
+    childFork->Discard();
+    CHECK(childFork->GetPosition(node) == Vector3{2.0f, 0.0f, 0.0f});
+
+    CHECK(node->GetPosition() == Vector3{1.0f, 0.0f, 0.0f});
+    CHECK(node->GetScale() == Vector3::ONE);
+}
+
+TEST_CASE("SceneFork stores component attributes and node variables")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    Node* node = scene->CreateChild("Node");
+    node->SetVar("Health", 100);
+    auto staticModel = node->CreateComponent<StaticModel>();
+    staticModel->SetCastShadows(false);
+
+    auto fork = MakeShared<SceneFork>(scene);
+    CHECK(fork->SetAttribute(staticModel, "Cast Shadows", true));
+    CHECK_FALSE(fork->SetAttribute(staticModel, "Cast Shadows", 1.0f));
+    CHECK_FALSE(fork->SetAttribute(staticModel, "Unknown Attribute", true));
+    fork->SetVar(node, "Health", 50);
+    fork->SetEnabled(node, false);
+
+    CHECK(fork->GetAttribute(staticModel, "Cast Shadows") == Variant{true});
+    CHECK(fork->GetAttribute(staticModel, "Unknown Attribute").IsEmpty());
+    CHECK(fork->GetVar(node, "Health") == Variant{50});
+    CHECK(fork->GetVar(node, "Unknown").IsEmpty());
+    CHECK_FALSE(fork->IsEnabled(node));
+
+    CHECK_FALSE(staticModel->GetCastShadows());
+    CHECK(node->GetVar("Health") == Variant{100});
+    CHECK(node->IsEnabled());
+
+    fork->Apply();
+    CHECK(staticModel->GetCastShadows());
+    CHECK(node->GetVar("Health") == Variant{50});
+    CHECK_FALSE(node->IsEnabled());
+}
+
+TEST_CASE("SceneFork evaluates world transforms from forked local transforms")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    Node* parent = scene->CreateChild("Parent");
+    parent->SetPosition(Vector3{10.0f, 0.0f, 0.0f});
+    Node* root = parent->CreateChild("Root");
+    Node* child = root->CreateChild("Child");
+    child->SetPosition(Vector3{0.0f, 0.0f, 1.0f});
+
+    auto fork = MakeShared<SceneFork>(root);
+    fork->SetRotation(root, Quaternion{90.0f, Vector3::UP});
+    fork->SetPosition(root, Vector3{0.0f, 5.0f, 0.0f});
+
+    CHECK(fork->GetWorldPosition(child).Equals(Vector3{11.0f, 5.0f, 0.0f}));
+    CHECK(child->GetWorldPosition().Equals(Vector3{10.0f, 0.0f, 1.0f}));
+
+    // Nodes outside of the fork are not affected
+    fork->SetPosition(parent, Vector3::ZERO);
+    CHECK(fork->GetWorldPosition(parent) == parent->GetWorldPosition());
+}
+
+TEST_CASE("SceneFork ignores values of removed objects")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    auto fork = MakeShared<SceneFork>(scene);
+
+    WeakPtr<Node> removedNode{scene->CreateChild("Node")};
+    fork->SetPosition(removedNode, Vector3::ONE);
+    fork->SetVar(removedNode, "Key", 1);
+    removedNode->Remove();
+    REQUIRE_FALSE(removedNode);
+
+    // New node may be allocated at the same address
+    Node* node = scene->CreateChild("Node");
+    CHECK(fork->GetPosition(node) == Vector3::ZERO);
+    CHECK(fork->GetVar(node, "Key").IsEmpty());
+
+    fork->Apply();
+    CHECK(node->GetPosition() == Vector3::ZERO);
+}
+
+TEST_CASE("SceneFork merges shared layers of deep fork chains")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    Node* node = scene->CreateChild("Node");
+
+    auto fork = MakeShared<SceneFork>(scene);
+    for (unsigned i = 0; i < 3 * SceneFork::MaxSharedLayers; ++i)
+    {
+        fork->SetVar(node, Format("Key{}", i), i);
+        fork->SetPosition(node, Vector3{static_cast<float>(i), 0.0f, 0.0f});
+        fork = fork->Fork();
+        CHECK(fork->GetNumSharedLayers() <= SceneFork::MaxSharedLayers);
+    }
+
+    const unsigned lastIndex = 3 * SceneFork::MaxSharedLayers - 1;
+    CHECK(fork->GetPosition(node) == Vector3{static_cast<float>(lastIndex), 0.0f, 0.0f});
+    for (unsigned i = 0; i <= lastIndex; ++i)
+        CHECK(fork->GetVar(node, Format("Key{}", i)) == Variant{i});
+}
+
+TEST_CASE("Benchmark SceneFork against hierarchy cloning", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    Node* world = scene->CreateChild("World");
+    Tests::CreateTestHierarchy(world, 3, 10);
+
+    const unsigned numSimulations = 100;
+    Node* movedNode = world->GetChild("World_5_5_5", true);
+    REQUIRE(movedNode);
+
+    HiresTimer timer;
+    for (unsigned i = 0; i < numSimulations; ++i)
+    {
+        Node* clone = world->Clone();
+        clone->GetChild("World_5_5_5", true)->SetPosition(Vector3::ONE);
+        clone->Remove();
+    }
+    const long long cloneTime = timer.GetUSec(true);
+
+    for (unsigned i = 0; i < numSimulations; ++i)
+    {
+        auto fork = MakeShared<SceneFork>(world);
+        fork->SetPosition(movedNode, Vector3::ONE);
+        fork->Discard();
+    }
+    const long long forkTime = timer.GetUSec(true);
+
+    WARN(Format("{} simulations of {} nodes: clone {:.3f} ms, fork {:.3f} ms", numSimulations,
+        world->GetNumChildren(true), cloneTime / 1000.0, forkTime / 1000.0).c_str());
+}
@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Scene/SceneResource.h>
+#include <Urho3D/Scene/SceneSnapshot.h>
+#include <Urho3D/Scene/SplinePath.h>
+
+namespace
+{
+
+ByteVector SaveSnapshot(Scene* scene)
+{
+    VectorBuffer buffer;
+    REQUIRE(SceneSnapshot::Save(scene, buffer));
+    return buffer.GetBuffer();
+}
+
+} // namespace
+
+TEST_CASE("Scene is saved to snapshot and loaded back")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceScene = Tests::CreateTestScene(context);
+    const ByteVector data = SaveSnapshot(sourceScene);
+
+    SceneSnapshot snapshot{context};
+    REQUIRE(snapshot.SetData(data, "Test"));
+    CHECK(snapshot.GetNumNodes() == 3 + 3 * 3 * 3 + 3 * 3 + 3);
+    CHECK(snapshot.GetNumComponents() == 1 + 3 * 3 * 3 + 3 * 3 + 3 + sourceScene->GetNumComponents());
+    CHECK(snapshot.GetNumTypes() == 4 + sourceScene->GetNumComponents());
+
+    // Load twice to make sure existing content is replaced
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateChild("Garbage");
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        snapshot.Load(scene);
+
+        REQUIRE(Tests::CompareNodes(*sourceScene, *scene));
+        CHECK(scene->GetFileName() == "Test");
+        CHECK(scene->GetTimeScale() == 0.5f);
+
+        Node* world = scene->GetChild("World");
+        REQUIRE(world);
+        CHECK(world->GetID() == sourceScene->GetChild("World")->GetID());
+        CHECK(world->HasTag("Static"));
+        CHECK(world->GetVar("Level") == Variant{3});
+
+        Node* disabledNode = world->GetChild("World_1");
+        REQUIRE(disabledNode);
+        CHECK_FALSE(disabledNode->IsEnabled());
+        CHECK_FALSE(disabledNode->GetComponent<StaticModel>()->IsEnabledEffective());
+
+        const auto splinePath = scene->GetChild("Path")->GetComponent<SplinePath>();
+        REQUIRE(splinePath);
+        REQUIRE(splinePath->GetControlledNode());
+        CHECK(splinePath->GetControlledNode()->GetName() == "World_2");
+    }
+}
+
+TEST_CASE("Scene snapshot is loaded via SceneResource and from mapped file")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto fs = context->GetSubsystem<FileSystem>();
+    const auto sourceScene = Tests::CreateTestScene(context);
+    const ByteVector data = SaveSnapshot(sourceScene);
+
+    SECTION("SceneResource")
+    {
+        auto resource = MakeShared<SceneResource>(context);
+        MemoryBuffer buffer{data};
+        REQUIRE(resource->Load(buffer));
+        CHECK(Tests::CompareNodes(*sourceScene, *resource->GetScene()));
+    }
+
+    SECTION("File")
+    {
+        const TemporaryDir tempDir(context, fs->GetTemporaryDir() + "SceneSnapshotTest");
+        const ea::string fileName = tempDir.GetPath() + "Scene.snapshot";
+        {
+            File file(context, fileName, FILE_WRITE);
+            REQUIRE(file.Write(data.data(), data.size()) == data.size());
+        }
+
+        SceneSnapshot snapshot{context};
+        REQUIRE(snapshot.Open(fileName));
+
+        auto scene = MakeShared<Scene>(context);
+        snapshot.Load(scene);
+        CHECK(Tests::CompareNodes(*sourceScene, *scene));
+
+        // SceneResource maps loose files instead of reading them
+        auto resource = MakeShared<SceneResource>(context);
+        File file(context, fileName);
+        REQUIRE(resource->Load(file));
+        CHECK(Tests::CompareNodes(*sourceScene, *resource->GetScene()));
+    }
+}
+
+TEST_CASE("Temporary objects are not saved to scene snapshot")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto sourceScene = MakeShared<Scene>(context);
+    Node* node = sourceScene->CreateChild("Node");
+    node->CreateComponent<StaticModel>()->SetTemporary(true);
+    sourceScene->CreateChild("Temporary")->SetTemporary(true);
+
+    SceneSnapshot snapshot{context};
+    const ByteVector data = SaveSnapshot(sourceScene);
+    REQUIRE(snapshot.SetData(data));
+
+    auto scene = MakeShared<Scene>(context);
+    snapshot.Load(scene);
+    CHECK(scene->GetNumChildren() == 1);
+    REQUIRE(scene->GetChild("Node"));
+    CHECK(scene->GetChild("Node")->GetNumComponents() == 0);
+}
+
+TEST_CASE("Corrupted scene snapshot is rejected")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto sourceScene = Tests::CreateTestScene(context);
+    ByteVector data = SaveSnapshot(sourceScene);
+
+    SceneSnapshot snapshot{context};
+    REQUIRE(snapshot.SetData(data));
+
+    SECTION("Truncated")
+    {
+        data.resize(data.size() / 2);
+        CHECK_FALSE(snapshot.SetData(data));
+    }
+
+    SECTION("Wrong magic")
+    {
+        data[0] = 'X';
+        CHECK_FALSE(snapshot.SetData(data));
+    }
+
+    SECTION("Wrong section")
+    {
+        auto header = reinterpret_cast<SceneSnapshotHeader*>(data.data());
+        header->nodes_.size_ = header->totalSize_;
+        CHECK_FALSE(snapshot.SetData(data));
+    }
+
+    CHECK_FALSE(snapshot.IsOpen());
+    auto scene = MakeShared<Scene>(context);
+    CHECK_THROWS_AS(snapshot.Load(scene), ArchiveException);
+}
+
+TEST_CASE("Benchmark scene snapshot loading", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto sourceResource = MakeShared<SceneResource>(context);
+    Node* world = sourceResource->GetScene()->CreateChild("World");
+    Tests::CreateTestHierarchy(world, 4, 10);
+
+    VectorBuffer binaryBuffer;
+    REQUIRE(sourceResource->Save(binaryBuffer, InternalResourceFormat::Binary));
+    const ByteVector snapshotData = SaveSnapshot(sourceResource->GetScene());
+
+    HiresTimer timer;
+    {
+        auto scene = MakeShared<Scene>(context);
+        MemoryBuffer readBuffer{binaryBuffer.GetData() + BinaryMagicSize, binaryBuffer.GetSize() - BinaryMagicSize};
+        BinaryInputArchive archive{context, readBuffer};
+        ArchiveBlock block = archive.OpenUnorderedBlock(SceneResource::GetXmlRootName());
+        scene->SerializeInBlock(archive, false, PrefabSaveFlag::None, PrefabLoadFlag::None);
+    }
+    const long long binaryTime = timer.GetUSec(true);
+
+    {
+        auto scene = MakeShared<Scene>(context);
+        SceneSnapshot snapshot{context};
+        REQUIRE(snapshot.SetData(snapshotData));
+        snapshot.Load(scene);
+    }
+    const long long snapshotTime = timer.GetUSec(true);
+
+    WARN(Format("Scene loaded: binary archive {:.1f} ms ({} bytes), snapshot {:.1f} ms ({} bytes)",
+        binaryTime / 1000.0, binaryBuffer.GetSize(), snapshotTime / 1000.0, snapshotData.size()).c_str());
+}
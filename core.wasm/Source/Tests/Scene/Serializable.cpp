@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Resource/BinaryFile.h>
+#include <Urho3D/Scene/NodePrefab.h>
+
+namespace
+{
+
+enum class TestEnum
+{
+    Red,
+    Green,
+    Blue,
+};
+
+const StringVector testEnumNames{"Red", "Green", "Blue"};
+
+class TypedAttributesComponent : public Component
+{
+    URHO3D_OBJECT(TypedAttributesComponent, Component);
+
+public:
+    explicit TypedAttributesComponent(Context* context) : Component(context) {}
+
+    static void RegisterObject(Context* context)
+    {
+        context->RegisterFactory<TypedAttributesComponent>();
+
+        URHO3D_ATTRIBUTE("Float", float, float_, 1.0f, AM_DEFAULT);
+        URHO3D_ATTRIBUTE("Position", Vector3, position_, Vector3::ZERO, AM_DEFAULT);
+        URHO3D_ATTRIBUTE("Rotation", Quaternion, rotation_, Quaternion::IDENTITY, AM_DEFAULT);
+        URHO3D_ATTRIBUTE("Color", Color, color_, Color::WHITE, AM_DEFAULT);
+        URHO3D_ACCESSOR_ATTRIBUTE("Name", GetName, SetName, ea::string, EMPTY_STRING, AM_DEFAULT);
+        URHO3D_ACCESSOR_ATTRIBUTE("Count", GetCount, SetCount, int, 0, AM_DEFAULT);
+        URHO3D_ATTRIBUTE("Unsigned", unsigned, unsigned_, 0, AM_DEFAULT);
+        URHO3D_ENUM_ATTRIBUTE("Enum", enum_, testEnumNames, TestEnum::Red, AM_DEFAULT);
+    }
+
+    void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override
+    {
+        Component::OnSetAttribute(attr, src);
+        ++numVariantSets_;
+    }
+
+    void OnSetAttributeTyped(const AttributeInfo& attr, const void* src) override
+    {
+        Component::OnSetAttributeTyped(attr, src);
+        ++numTypedSets_;
+    }
+
+    const ea::string& GetName() const { return name_; }
+    void SetName(const ea::string& name) { name_ = name; }
+    unsigned GetCount() const { return count_; }
+    void SetCount(int count) { count_ = count; }
+
+    float float_{1.0f};
+    Vector3 position_{};
+    Quaternion rotation_{};
+    Color color_{};
+    ea::string name_;
+    unsigned count_{};
+    unsigned unsigned_{};
+    TestEnum enum_{};
+
+    unsigned numVariantSets_{};
+    unsigned numTypedSets_{};
+};
+
+void RandomizeAttributes(TypedAttributesComponent& component, unsigned seed)
+{
+    component.float_ = static_cast<float>(seed) * 0.5f;
+    component.position_ = Vector3{static_cast<float>(seed), 1.0f, 2.0f};
+    component.rotation_ = Quaternion{static_cast<float>(seed % 360), Vector3::UP};
+    component.color_ = Color{0.1f, 0.2f, 0.3f};
+    component.name_ = Format("Component {}", seed);
+    component.count_ = seed;
+    component.unsigned_ = seed + 1;
+    component.enum_ = TestEnum::Blue;
+}
+
+bool HaveSameAttributes(const TypedAttributesComponent& lhs, const TypedAttributesComponent& rhs)
+{
+    return lhs.float_ == rhs.float_ && lhs.position_ == rhs.position_ && lhs.rotation_ == rhs.rotation_
+        && lhs.color_ == rhs.color_ && lhs.name_ == rhs.name_ && lhs.count_ == rhs.count_
+        && lhs.unsigned_ == rhs.unsigned_ && lhs.enum_ == rhs.enum_;
+}
+
+}
+
+TEST_CASE("Attributes of Variant types support typed access")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TypedAttributesComponent>>(context);
+
+    const auto& attributes = context->GetReflection<TypedAttributesComponent>()->GetAttributes();
+    const auto getTypedAccessType = [&](const char* name)
+    {
+        const auto iter = ea::find_if(attributes.begin(), attributes.end(),
+            [&](const AttributeInfo& attr) { return attr.name_ == name; });
+        REQUIRE(iter != attributes.end());
+        return iter->accessor_->GetTypedAccessType();
+    };
+
+    CHECK(getTypedAccessType("Float") == VAR_FLOAT);
+    CHECK(getTypedAccessType("Position") == VAR_VECTOR3);
+    CHECK(getTypedAccessType("Rotation") == VAR_QUATERNION);
+    CHECK(getTypedAccessType("Color") == VAR_COLOR);
+    CHECK(getTypedAccessType("Name") == VAR_STRING);
+    // Getter returns different type
+    CHECK(getTypedAccessType("Count") == VAR_NONE);
+    // Type is not stored in Variant as is
+    CHECK(getTypedAccessType("Unsigned") == VAR_NONE);
+    CHECK(getTypedAccessType("Enum") == VAR_NONE);
+
+    auto component = MakeShared<TypedAttributesComponent>(context);
+    RandomizeAttributes(*component, 10);
+
+    Vector3 position;
+    component->OnGetAttributeTyped(attributes[1], &position);
+    CHECK(position == component->position_);
+
+    const ea::string name = "Typed name";
+    component->OnSetAttributeTyped(attributes[4], &name);
+    CHECK(component->name_ == name);
+    CHECK(component->GetAttribute("Name") == Variant{name});
+}
+
+TEST_CASE("Attributes are copied without Variant when possible")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TypedAttributesComponent>>(context);
+
+    auto scene = MakeShared<Scene>(context);
+    auto sourceNode = scene->CreateChild("Source");
+    sourceNode->SetPosition({1.0f, 2.0f, 3.0f});
+    auto source = sourceNode->CreateComponent<TypedAttributesComponent>();
+    RandomizeAttributes(*source, 7);
+
+    SECTION("CopyAttributes")
+    {
+        auto dest = MakeShared<TypedAttributesComponent>(context);
+        dest->CopyAttributes(source, false);
+
+        CHECK(HaveSameAttributes(*source, *dest));
+        CHECK(dest->numTypedSets_ == 5);
+        CHECK(dest->numVariantSets_ == 3);
+    }
+
+    SECTION("Node::Clone")
+    {
+        Node* cloneNode = sourceNode->Clone();
+        auto dest = cloneNode->GetComponent<TypedAttributesComponent>();
+        REQUIRE(dest);
+
+        CHECK(cloneNode->GetPosition() == sourceNode->GetPosition());
+        CHECK(cloneNode->GetName() == sourceNode->GetName());
+        CHECK(HaveSameAttributes(*source, *dest));
+        CHECK(dest->numTypedSets_ == 5);
+        CHECK(dest->numVariantSets_ == 3);
+    }
+
+    SECTION("Instance default")
+    {
+        auto dest = MakeShared<TypedAttributesComponent>(context);
+        dest->SetInstanceDefault(true);
+        dest->CopyAttributes(source, false);
+        dest->SetInstanceDefault(false);
+
+        CHECK(HaveSameAttributes(*source, *dest));
+        CHECK(dest->GetInstanceDefault("Position") == Variant{source->position_});
+        CHECK(dest->GetInstanceDefault("Name") == Variant{source->name_});
+        CHECK(dest->GetAttributeDefault("Position") == Variant{source->position_});
+    }
+}
+
+TEST_CASE("Default attributes are skipped without Variant when possible")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TypedAttributesComponent>>(context);
+
+    auto component = MakeShared<TypedAttributesComponent>(context);
+    component->float_ = 1.0f;
+    component->position_ = Vector3::ONE;
+    component->count_ = 5;
+    component->unsigned_ = 0;
+    component->name_ = "Name";
+
+    const auto& attributes = context->GetReflection<TypedAttributesComponent>()->GetAttributes();
+
+    Variant value;
+    CHECK_FALSE(component->GetNonDefaultAttribute(attributes[0], value));
+    CHECK(value.IsEmpty());
+    CHECK(component->GetNonDefaultAttribute(attributes[1], value));
+    CHECK(value == Variant{Vector3::ONE});
+    CHECK(component->GetNonDefaultAttribute(attributes[4], value));
+    CHECK(value == Variant{"Name"});
+    CHECK(component->GetNonDefaultAttribute(attributes[5], value));
+    CHECK(value == Variant{5});
+    CHECK_FALSE(component->GetNonDefaultAttribute(attributes[6], value));
+
+    SerializablePrefab prefab;
+    prefab.Import(component);
+    REQUIRE(prefab.GetAttributes().size() == 3);
+    CHECK(prefab.GetAttributes()[0].GetValue() == Variant{Vector3::ONE});
+    CHECK(prefab.GetAttributes()[1].GetValue() == Variant{"Name"});
+    CHECK(prefab.GetAttributes()[2].GetValue() == Variant{5});
+
+    auto dest = MakeShared<TypedAttributesComponent>(context);
+    prefab.Export(dest);
+    CHECK(HaveSameAttributes(*component, *dest));
+    CHECK(dest->numTypedSets_ == 2);
+    CHECK(dest->numVariantSets_ == 1);
+}
+
+TEST_CASE("Benchmark scene save, load and clone", "[.][benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TypedAttributesComponent>>(context);
+
+    const unsigned numNodes = 10000;
+    const unsigned numComponentsPerNode = 10;
+
+    auto scene = MakeShared<Scene>(context);
+    Node* root = scene->CreateChild("Root");
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = root->CreateChild(Format("Node {}", i));
+        node->SetPosition(Vector3{static_cast<float>(i), 0.0f, 0.0f});
+        for (unsigned j = 0; j < numComponentsPerNode; ++j)
+            RandomizeAttributes(*node->CreateComponent<TypedAttributesComponent>(), i * numComponentsPerNode + j);
+    }
+
+    BinaryFile file(context);
+    {
+        HiresTimer timer;
+        REQUIRE(file.SaveObject(*scene));
+        WARN(Format("Scene with {} components saved: {:.1f} ms", numNodes * numComponentsPerNode,
+            timer.GetUSec(false) / 1000.0).c_str());
+    }
+
+    {
+        auto loadedScene = MakeShared<Scene>(context);
+        HiresTimer timer;
+        REQUIRE(file.LoadObject(*loadedScene));
+        WARN(Format("Scene with {} components loaded: {:.1f} ms", numNodes * numComponentsPerNode,
+            timer.GetUSec(false) / 1000.0).c_str());
+    }
+
+    {
+        HiresTimer timer;
+        Node* clone = root->Clone();
+        WARN(Format("Scene with {} components cloned: {:.1f} ms", numNodes * numComponentsPerNode,
+            timer.GetUSec(false) / 1000.0).c_str());
+        clone->Remove();
+    }
+
+    {
+        ea::vector<TypedAttributesComponent*> components;
+        root->GetComponents<TypedAttributesComponent>(components, true);
+        auto dest = MakeShared<TypedAttributesComponent>(context);
+        const auto& attributes = context->GetReflection<TypedAttributesComponent>()->GetAttributes();
+
+        HiresTimer timer;
+        for (TypedAttributesComponent* component : components)
+        {
+            for (const AttributeInfo& attr : attributes)
+            {
+                Variant value;
+                component->OnGetAttribute(attr, value);
+                dest->OnSetAttribute(attr, value);
+            }
+        }
+        const double variantTime = timer.GetUSec(true) / 1000.0;
+
+        for (TypedAttributesComponent* component : components)
+            dest->CopyAttributes(component, false);
+        const double typedTime = timer.GetUSec(false) / 1000.0;
+
+        WARN(Format("Attributes of {} components copied via Variant: {:.1f} ms, typed: {:.1f} ms",
+            components.size(), variantTime, typedTime).c_str());
+    }
+}
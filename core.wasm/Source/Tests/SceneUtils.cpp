@@ -22,9 +22,11 @@
 
 #include "SceneUtils.h"
 
+#include <Urho3D/Graphics/StaticModel.h>
 #include <Urho3D/Resource/XMLFile.h>
 #include <Urho3D/Scene/Component.h>
 #include <Urho3D/Scene/PrefabWriter.h>
+#include <Urho3D/Scene/SplinePath.h>
 
 namespace Tests
 {
@@ -46,6 +48,43 @@ SharedPtr<PrefabResource> ConvertNodeToPrefab(Node* node)
     return prefab;
 }
 
+void CreateTestHierarchy(Node* parent, unsigned depth, unsigned numChildren, const ea::function<void(Node* node)>& callback)
+{
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        Node* child = parent->CreateChild(Format("{}_{}", parent->GetName(), i));
+        child->SetPosition(Vector3{static_cast<float>(i), static_cast<float>(depth), 0.0f});
+        child->SetRotation(Quaternion{static_cast<float>(i) * 10.0f, Vector3::UP});
+        child->SetEnabled(i != 1);
+        child->CreateComponent<StaticModel>()->SetCastShadows(i % 2 == 0);
+        if (callback)
+            callback(child);
+        if (depth > 0)
+            CreateTestHierarchy(child, depth - 1, numChildren, callback);
+    }
+}
+
+void CreateTestSceneContent(Scene* scene, unsigned depth, unsigned numChildren)
+{
+    scene->SetTimeScale(0.5f);
+
+    Node* world = scene->CreateChild("World");
+    world->AddTag("Static");
+    world->SetVar("Level", 3);
+    CreateTestHierarchy(world, depth, numChildren);
+
+    Node* path = scene->CreateChild("Path");
+    auto splinePath = path->CreateComponent<SplinePath>();
+    splinePath->SetControlledNode(world->GetChild(Format("World_{}", numChildren - 1)));
+}
+
+SharedPtr<Scene> CreateTestScene(Context* context, unsigned depth, unsigned numChildren)
+{
+    auto scene = MakeShared<Scene>(context);
+    CreateTestSceneContent(scene, depth, numChildren);
+    return scene;
+}
+
 Variant GetAttributeValue(const ea::pair<Serializable*, unsigned>& ref)
 {
     return ref.first->GetAttribute(ref.second);
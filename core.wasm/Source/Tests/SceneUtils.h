@@ -25,6 +25,8 @@
 #include <Urho3D/Scene/PrefabResource.h>
 #include <Urho3D/Scene/Scene.h>
 
+#include <EASTL/functional.h>
+
 using namespace Urho3D;
 
 namespace Tests
@@ -39,6 +41,15 @@ SharedPtr<PrefabResource> ConvertNodeToPrefab(Node* node);
 /// Return attribute value as variant.
 Variant GetAttributeValue(const ea::pair<Serializable*, unsigned>& ref);
 
+/// Create hierarchy of nodes with StaticModel components named after the parent, e.g. "World_1_2".
+/// Each node has numChildren children down to the depth of zero. Callback is called for each created node.
+void CreateTestHierarchy(Node* parent, unsigned depth, unsigned numChildren,
+    const ea::function<void(Node* node)>& callback = {});
+/// Fill scene with "World" node with test hierarchy and "Path" node with SplinePath that references the last child of "World".
+void CreateTestSceneContent(Scene* scene, unsigned depth = 2, unsigned numChildren = 3);
+/// Create scene with test content.
+SharedPtr<Scene> CreateTestScene(Context* context, unsigned depth = 2, unsigned numChildren = 3);
+
 /// Compare aspects of the scene.
 bool CompareAttributeValues(const Variant& lhs, const Variant& rhs);
 bool CompareSerializables(const Serializable& lhs, const Serializable& rhs);
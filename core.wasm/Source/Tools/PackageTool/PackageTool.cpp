@@ -20,58 +20,269 @@
 // THE SOFTWARE.
 //
 
+#include <EASTL/map.h>
 #include <EASTL/sort.h>
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/PackageBuilder.h>
 #include <Urho3D/IO/PackageFile.h>
 
 #ifdef WIN32
     #include <windows.h>
 #endif
 
-#include <EASTL/unique_ptr.h>
-#include <LZ4/lz4.h>
-#include <LZ4/lz4hc.h>
 #include <Urho3D/DebugNew.h>
 
 using namespace Urho3D;
 
-static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
+// Files are compressed in chunks of this size so big files are spread between threads
+static const unsigned CHUNK_SIZE = 32 * PackageBuilder::BlockSize;
+// Maximum amount of source data kept in memory at once
+static const unsigned long long MAX_BATCH_SIZE = 256 * 1024 * 1024;
 
-struct FileEntry
+struct ManifestRecord
 {
-    ea::string name_;
+    unsigned     size_{};
+    FileTime     modifiedTime_{};
+    unsigned     checksum_{};
+    PackageCodec codec_{};
+};
+
+struct SourceFile
+{
+    ea::string          name_;
+    ea::string          entryName_;
+    unsigned            size_{};
+    FileTime            modifiedTime_{};
+    PackageCodec        codec_{};
+    const PackageEntry* reusedEntry_{};
+    ByteVector          data_;
+    bool                readFailed_{};
+    PackageEncodedFile  encoded_;
+    unsigned            checksum_{};
+    unsigned            packedSize_{};
+    unsigned            packedCodec_{};
+    unsigned            firstChunk_{};
+    unsigned            numChunks_{};
+    long long           encodeTime_{};
+};
+
+struct Chunk
+{
+    unsigned   fileIndex_{};
     unsigned   offset_{};
     unsigned   size_{};
-    unsigned   checksum_{};
+    ByteVector data_;
+    bool       success_{};
+    long long  time_{};
+};
+
+struct ExtensionStats
+{
+    unsigned           numFiles_{};
+    unsigned           numReused_{};
+    unsigned long long inputSize_{};
+    unsigned long long outputSize_{};
+    long long          encodeTime_{};
 };
 
-Context*                context_    = nullptr;
-FileSystem*             fileSystem_ = nullptr;
-ea::string              basePath_;
-ea::vector< FileEntry > entries_;
-unsigned                checksum_  = 0;
-bool                    compress_  = false;
-bool                    quiet_     = false;
-unsigned                blockSize_ = COMPRESSED_BLOCK_SIZE;
+Context*                 context_    = nullptr;
+FileSystem*              fileSystem_ = nullptr;
+WorkQueue*               workQueue_  = nullptr;
+ea::string               basePath_;
+ea::vector< ea::string > fileNames_;
+PackageCodec             codec_   = PACKAGE_CODEC_NONE;
+bool                     quiet_   = false;
+bool                     stats_   = false;
+bool                     rebuild_ = false;
 
-ea::string ignoreExtensions_[] = { ".bak", ".rule" };
+ea::string ignoreExtensions_[] = { ".bak", ".rule", ".manifest" };
+
+// Files of these types are already compressed and are stored as is
+ea::string compressedExtensions_[] = { ".png", ".jpg", ".jpeg", ".webp", ".dds", ".ktx", ".pvr", ".ogg", ".mp3", ".zip", ".gz" };
 
 int  main( int argc, char** argv );
 void Run( const ea::vector< ea::string >& arguments );
-void ProcessFile( const ea::string& fileName, const ea::string& rootDir );
 void WritePackageFile( const ea::string& fileName, const ea::string& rootDir );
-void WriteHeader( File& dest );
+void ReadBatch( ea::vector< SourceFile >& files, unsigned begin, unsigned end, const ea::string& rootDir );
+void EncodeBatch( ea::vector< SourceFile >& files, unsigned begin, unsigned end );
+ea::unordered_map< ea::string, ManifestRecord > ReadManifest( const ea::string& fileName );
+void WriteManifest( const ea::string& fileName, const ea::vector< SourceFile >& files );
+void PrintStats( const ea::vector< SourceFile >& files );
+PackageCodec GetFileCodec( const ea::string& fileName );
+const char* GetCodecName( unsigned codec );
+
+void ReadBatch( ea::vector< SourceFile >& files, unsigned begin, unsigned end, const ea::string& rootDir )
+{
+    ea::vector< SourceFile* > pendingFiles;
+    for ( unsigned i = begin; i < end; ++i )
+    {
+        if ( ! files[ i ].reusedEntry_ )
+            pendingFiles.push_back( &files[ i ] );
+    }
+
+    // Read files and calculate checksums in parallel
+    ForEachParallel( workQueue_, pendingFiles, [ & ]( unsigned, SourceFile* file ) {
+        File srcFile( context_, rootDir + "/" + file->name_ );
+        file->data_.resize( file->size_ );
+        if ( ! srcFile.IsOpen() || srcFile.Read( file->data_.data(), file->size_ ) != file->size_ )
+        {
+            file->readFailed_ = true;
+            return;
+        }
+
+        unsigned checksum = 0;
+        for ( const unsigned char byte : file->data_ )
+            checksum = SDBMHash( checksum, byte );
+        file->checksum_ = checksum;
+    } );
+}
+
+void EncodeBatch( ea::vector< SourceFile >& files, unsigned begin, unsigned end )
+{
+    // Split files into chunks so big files are compressed by multiple threads
+    ea::vector< Chunk > chunks;
+    for ( unsigned i = begin; i < end; ++i )
+    {
+        SourceFile& file = files[ i ];
+        file.firstChunk_ = chunks.size();
+        file.numChunks_  = 0;
+        if ( file.reusedEntry_ || file.codec_ == PACKAGE_CODEC_NONE )
+            continue;
+
+        for ( unsigned offset = 0; offset < file.size_; offset += CHUNK_SIZE )
+        {
+            Chunk& chunk     = chunks.emplace_back();
+            chunk.fileIndex_ = i;
+            chunk.offset_    = offset;
+            chunk.size_      = ea::min( CHUNK_SIZE, file.size_ - offset );
+            ++file.numChunks_;
+        }
+    }
+
+    ForEachParallel( workQueue_, chunks, [ & ]( unsigned, Chunk& chunk ) {
+        HiresTimer     timer;
+        const auto&    file = files[ chunk.fileIndex_ ];
+        const ConstByteSpan data( file.data_.data() + chunk.offset_, chunk.size_ );
+        chunk.success_ = PackageBuilder::EncodeBlocks( data, PackageBuilder::GetSupportedCodec( file.codec_ ), chunk.data_ );
+        chunk.time_    = timer.GetUSec( false );
+    } );
+
+    // Concatenate chunks. Store files as is if compression doesn't help
+    for ( unsigned i = begin; i < end; ++i )
+    {
+        SourceFile& file = files[ i ];
+        if ( file.reusedEntry_ )
+            continue;
+
+        PackageEncodedFile& encoded = file.encoded_;
+        encoded.size_               = file.size_;
+        encoded.checksum_           = file.checksum_;
+
+        bool               success    = file.numChunks_ > 0;
+        unsigned long long packedSize = 0;
+        for ( unsigned j = file.firstChunk_; j < file.firstChunk_ + file.numChunks_; ++j )
+        {
+            success &= chunks[ j ].success_;
+            packedSize += chunks[ j ].data_.size();
+            file.encodeTime_ += chunks[ j ].time_;
+        }
+
+        if ( success && packedSize < file.size_ )
+        {
+            encoded.codec_ = PackageBuilder::GetSupportedCodec( file.codec_ );
+            encoded.data_.reserve( packedSize );
+            for ( unsigned j = file.firstChunk_; j < file.firstChunk_ + file.numChunks_; ++j )
+                encoded.data_.insert( encoded.data_.end(), chunks[ j ].data_.begin(), chunks[ j ].data_.end() );
+        }
+        else
+        {
+            encoded.codec_ = PACKAGE_CODEC_NONE;
+            encoded.data_  = ea::move( file.data_ );
+        }
+
+        file.data_.clear();
+        file.data_.shrink_to_fit();
+    }
+}
+
+ea::unordered_map< ea::string, ManifestRecord > ReadManifest( const ea::string& fileName )
+{
+    ea::unordered_map< ea::string, ManifestRecord > manifest;
+
+    File file( context_, fileName );
+    while ( file.IsOpen() && ! file.IsEof() )
+    {
+        // Size, modification time, checksum, codec and file name separated by tabs
+        const ea::string line  = file.ReadLine();
+        const auto       parts = line.split( '\t' );
+        if ( parts.size() != 5 )
+            continue;
+
+        ManifestRecord record;
+        record.size_         = ToUInt( parts[ 0 ] );
+        record.modifiedTime_ = ToUInt( parts[ 1 ] );
+        record.checksum_     = ToUInt( parts[ 2 ] );
+        record.codec_        = static_cast< PackageCodec >( ToUInt( parts[ 3 ] ) );
+        manifest[ parts[ 4 ] ] = record;
+    }
+    return manifest;
+}
+
+void WriteManifest( const ea::string& fileName, const ea::vector< SourceFile >& files )
+{
+    File file( context_ );
+    if ( ! file.Open( fileName, FILE_WRITE ) )
+    {
+        PrintLine( "Could not write manifest " + fileName, true );
+        return;
+    }
+
+    for ( const SourceFile& sourceFile : files )
+    {
+        file.WriteLine( ea::string{}.sprintf( "%u\t%u\t%u\t%u\t%s", sourceFile.size_, sourceFile.modifiedTime_, sourceFile.checksum_,
+                                              static_cast< unsigned >( sourceFile.codec_ ), sourceFile.entryName_.c_str() ) );
+    }
+}
+
+void PrintStats( const ea::vector< SourceFile >& files )
+{
+    ea::map< ea::string, ExtensionStats > statsByExtension;
+    for ( const SourceFile& file : files )
+    {
+        ExtensionStats& stats = statsByExtension[ GetExtension( file.name_ ) ];
+        ++stats.numFiles_;
+        stats.numReused_ += file.reusedEntry_ ? 1 : 0;
+        stats.inputSize_ += file.size_;
+        stats.outputSize_ += file.packedSize_;
+        stats.encodeTime_ += file.encodeTime_;
+    }
+
+    PrintLine( "Extension\tFiles\tUnchanged\tIn\tOut\tRatio\tEncode (thread s)" );
+    for ( const auto& [ extension, stats ] : statsByExtension )
+    {
+        PrintLine( ea::string{}.sprintf( "%s\t%u\t%u\t%llu\t%llu\t%f\t%.3f", extension.empty() ? "(none)" : extension.c_str(), stats.numFiles_,
+                                         stats.numReused_, stats.inputSize_, stats.outputSize_,
+                                         stats.outputSize_ ? 1.0 * stats.inputSize_ / stats.outputSize_ : 0.0, stats.encodeTime_ / 1000000.0 ) );
+    }
+}
 
 int main( int argc, char** argv )
 {
     SharedPtr< Context >     context( new Context() );
     SharedPtr< FileSystem >  fileSystem( new FileSystem( context ) );
+    SharedPtr< WorkQueue >   workQueue( new WorkQueue( context ) );
     ea::vector< ea::string > arguments;
     context_    = context;
     fileSystem_ = fileSystem;
+    workQueue_  = workQueue;
+    context->RegisterSubsystem( workQueue );
+    workQueue->Initialize( GetNumLogicalCPUs() > 1 ? GetNumLogicalCPUs() - 1 : 0 );
 
 #ifdef WIN32
     arguments = ParseArguments( GetCommandLineW() );
@@ -89,15 +300,21 @@ void Run( const ea::vector< ea::string >& arguments )
         ErrorExit( "Usage: PackageTool <directory to process> <package name> [basepath] [options]\n"
                    "\n"
                    "Options:\n"
-                   "-c      Enable package file LZ4 compression\n"
+                   "-c      Enable package file LZ4 compression in high compression mode\n"
+                   "-f      Enable package file LZ4 compression in fast mode\n"
                    "-q      Enable quiet mode\n"
+                   "-r      Rebuild the package from scratch, ignoring the manifest\n"
+                   "--stats Output compression ratio and timings per file extension\n"
                    "\n"
-                   "Basepath is an optional prefix that will be added to the file entries.\n\n"
+                   "Basepath is an optional prefix that will be added to the file entries.\n"
+                   "Files that are already compressed (images, sounds, archives) are always stored as is.\n"
+                   "Files are compressed on all CPU cores. Manifest <package name>.manifest stores content hashes\n"
+                   "of packaged files, unchanged files are copied from the previous package without recompression.\n\n"
                    "Alternative output usage: PackageTool <output option> <package name>\n"
                    "Output option:\n"
                    "-i      Output package file information\n"
                    "-l      Output file names (including their paths) contained in the package\n"
-                   "-L      Similar to -l but also output compression ratio (compressed package file only)\n" );
+                   "-L      Similar to -l but also output compression codec and ratio\n" );
 
     const ea::string& dirName      = arguments[ 0 ];
     const ea::string& packageName  = arguments[ 1 ];
@@ -108,6 +325,8 @@ void Run( const ea::vector< ea::string >& arguments )
         {
             if ( arguments[ i ][ 0 ] != '-' )
                 basePath_ = AddTrailingSlash( arguments[ i ] );
+            else if ( arguments[ i ] == "--stats" )
+                stats_ = true;
             else
             {
                 if ( arguments[ i ].length() > 1 )
@@ -115,11 +334,17 @@ void Run( const ea::vector< ea::string >& arguments )
                     switch ( arguments[ i ][ 1 ] )
                     {
                         case 'c':
-                            compress_ = true;
+                            codec_ = PACKAGE_CODEC_LZ4HC;
+                            break;
+                        case 'f':
+                            codec_ = PACKAGE_CODEC_LZ4;
                             break;
                         case 'q':
                             quiet_ = true;
                             break;
+                        case 'r':
+                            rebuild_ = true;
+                            break;
                         default:
                             ErrorExit( "Unrecognized option" );
                     }
@@ -143,9 +368,9 @@ void Run( const ea::vector< ea::string >& arguments )
         for ( unsigned i = fileNames.size() - 1; i < fileNames.size(); --i )
         {
             ea::string extension = GetExtension( fileNames[ i ] );
-            for ( unsigned j = 0; j < ignoreExtensions_[ j ].length(); ++j )
+            for ( const ea::string& ignoreExtension : ignoreExtensions_ )
             {
-                if ( extension == ignoreExtensions_[ j ] )
+                if ( extension == ignoreExtension )
                 {
                     fileNames.erase( fileNames.begin() + i );
                     break;
@@ -157,7 +382,7 @@ void Run( const ea::vector< ea::string >& arguments )
         ea::quick_sort( fileNames.begin(), fileNames.end() );
 
         // Check if up to date
-        if ( fileSystem_->Exists( packageName ) )
+        if ( ! rebuild_ && fileSystem_->Exists( packageName ) )
         {
             unsigned                 packageTime = fileSystem_->GetLastModifiedTime( packageName );
             SharedPtr< PackageFile > packageFile( new PackageFile( context_, packageName ) );
@@ -166,7 +391,7 @@ void Run( const ea::vector< ea::string >& arguments )
                 bool filesOutOfDate = false;
                 for ( const ea::string& fileName : fileNames )
                 {
-                    if ( fileSystem_->GetLastModifiedTime( fileName ) > packageTime )
+                    if ( fileSystem_->GetLastModifiedTime( dirName + "/" + fileName ) > packageTime )
                     {
                         filesOutOfDate = true;
                         break;
@@ -181,9 +406,7 @@ void Run( const ea::vector< ea::string >& arguments )
             }
         }
 
-        for ( unsigned i = 0; i < fileNames.size(); ++i )
-            ProcessFile( fileNames[ i ], dirName );
-
+        fileNames_ = ea::move( fileNames );
         WritePackageFile( packageName, dirName );
     }
     else
@@ -193,6 +416,7 @@ void Run( const ea::vector< ea::string >& arguments )
         switch ( arguments[ 0 ][ 1 ] )
         {
             case 'i':
+                PrintLine( "Version: " + ea::to_string( packageFile->GetVersion() ) );
                 PrintLine( "Number of files: " + ea::to_string( packageFile->GetNumFiles() ) );
                 PrintLine( "File data size: " + ea::to_string( packageFile->GetTotalDataSize() ) );
                 PrintLine( "Package size: " + ea::to_string( packageFile->GetTotalSize() ) );
@@ -200,20 +424,16 @@ void Run( const ea::vector< ea::string >& arguments )
                 PrintLine( "Compressed: " + ea::string( packageFile->IsCompressed() ? "yes" : "no" ) );
                 break;
             case 'L':
-                if ( ! packageFile->IsCompressed() )
-                    ErrorExit( "Invalid output option: -L is applicable for compressed package file only" );
                 outputCompressionRatio = true;
                 // Fallthrough
             case 'l': {
-                const ea::unordered_map< ea::string, PackageEntry >& entries = packageFile->GetEntries();
-                for ( auto i = entries.begin(); i != entries.end(); )
+                for ( const PackageEntry& entry : packageFile->GetEntries() )
                 {
-                    auto       current = i++;
-                    ea::string fileEntry( current->first );
+                    ea::string fileEntry( packageFile->GetEntryName( entry ) );
                     if ( outputCompressionRatio )
                     {
-                        unsigned compressedSize = ( i == entries.end() ? packageFile->GetTotalSize() - sizeof( unsigned ) : i->second.offset_ ) - current->second.offset_;
-                        fileEntry.append_sprintf( "\tin: %u\tout: %u\tratio: %f", current->second.size_, compressedSize, compressedSize ? 1.f * current->second.size_ / compressedSize : 0.f );
+                        fileEntry.append_sprintf( "\t%s\tin: %u\tout: %u\tratio: %f", GetCodecName( entry.codec_ ), entry.size_, entry.packedSize_,
+                                                  entry.packedSize_ ? 1.f * entry.size_ / entry.packedSize_ : 0.f );
                     }
                     PrintLine( fileEntry );
                 }
@@ -225,140 +445,213 @@ void Run( const ea::vector< ea::string >& arguments )
     }
 }
 
-void ProcessFile( const ea::string& fileName, const ea::string& rootDir )
-{
-    ea::string fullPath = rootDir + "/" + fileName;
-    File       file( context_ );
-    if ( ! file.Open( fullPath ) )
-        ErrorExit( "Could not open file " + fileName );
-
-    FileEntry newEntry;
-    newEntry.name_     = fileName;
-    newEntry.offset_   = 0;  // Offset not yet known
-    newEntry.size_     = file.GetSize();
-    newEntry.checksum_ = 0;  // Will be calculated later
-    entries_.push_back( newEntry );
-}
-
 void WritePackageFile( const ea::string& fileName, const ea::string& rootDir )
 {
-    if ( ! quiet_ )
-        PrintLine( "Writing package" );
-
-    File dest( context_ );
-    if ( ! dest.Open( fileName, FILE_WRITE ) )
-        ErrorExit( "Could not open output file " + fileName );
+    HiresTimer totalTimer;
 
-    // Write ID, number of files & placeholder for checksum
-    WriteHeader( dest );
+    const ea::string manifestName = fileName + ".manifest";
+    const ea::string tempName     = fileName + ".tmp";
 
-    for ( unsigned i = 0; i < entries_.size(); ++i )
+    // Previous package is reused only if its files may be copied directly from memory
+    SharedPtr< PackageFile >                        previousPackage;
+    ea::unordered_map< ea::string, ManifestRecord > manifest;
+    if ( ! rebuild_ && fileSystem_->Exists( fileName ) && fileSystem_->Exists( manifestName ) )
     {
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest.WriteString( basePath_ + entries_[ i ].name_ );
-        dest.WriteUInt( entries_[ i ].offset_ );
-        dest.WriteUInt( entries_[ i ].size_ );
-        dest.WriteUInt( entries_[ i ].checksum_ );
+        previousPackage = new PackageFile( context_ );
+        if ( previousPackage->Open( fileName ) && previousPackage->GetVersion() == 2 && previousPackage->IsMemoryMapped() )
+            manifest = ReadManifest( manifestName );
+        else
+            previousPackage = nullptr;
     }
 
-    unsigned totalDataSize = 0;
-    unsigned lastOffset;
-
-    // Write file data, calculate checksums & correct offsets
-    for ( unsigned i = 0; i < entries_.size(); ++i )
+    ea::vector< SourceFile > files( fileNames_.size() );
+    for ( unsigned i = 0; i < fileNames_.size(); ++i )
     {
-        lastOffset = entries_[ i ].offset_ = dest.GetSize();
-        ea::string fileFullPath            = rootDir + "/" + entries_[ i ].name_;
+        SourceFile& file   = files[ i ];
+        file.name_         = fileNames_[ i ];
+        file.entryName_    = basePath_ + fileNames_[ i ];
+        file.codec_        = GetFileCodec( file.name_ );
+        file.modifiedTime_ = fileSystem_->GetLastModifiedTime( rootDir + "/" + file.name_ );
 
-        File srcFile( context_, fileFullPath );
+        File srcFile( context_, rootDir + "/" + file.name_ );
         if ( ! srcFile.IsOpen() )
-            ErrorExit( "Could not open file " + fileFullPath );
-
-        unsigned dataSize = entries_[ i ].size_;
-        totalDataSize += dataSize;
-        ea::unique_ptr< unsigned char[] > buffer( new unsigned char[ dataSize ] );
-
-        if ( srcFile.Read( &buffer[ 0 ], dataSize ) != dataSize )
-            ErrorExit( "Could not read file " + fileFullPath );
-        srcFile.Close();
+            ErrorExit( "Could not open file " + file.name_ );
+        file.size_ = srcFile.GetSize();
 
-        for ( unsigned j = 0; j < dataSize; ++j )
+        // Skip reading of files that are not modified since previous build
+        const auto record = manifest.find( file.entryName_ );
+        if ( record != manifest.end() && record->second.size_ == file.size_ && record->second.modifiedTime_ == file.modifiedTime_
+             && record->second.codec_ == file.codec_ )
         {
-            checksum_               = SDBMHash( checksum_, buffer[ j ] );
-            entries_[ i ].checksum_ = SDBMHash( entries_[ i ].checksum_, buffer[ j ] );
+            const PackageEntry* entry = previousPackage->GetEntry( file.entryName_ );
+            if ( entry && entry->size_ == file.size_ && entry->checksum_ == record->second.checksum_ )
+                file.reusedEntry_ = entry;
         }
+    }
+
+    if ( ! quiet_ )
+        PrintLine( "Writing package" );
 
-        if ( ! compress_ )
+    File dest( context_ );
+    if ( ! dest.Open( tempName, FILE_WRITE ) )
+        ErrorExit( "Could not open output file " + tempName );
+
+    ea::vector< ea::string > entryNames;
+    for ( const SourceFile& file : files )
+        entryNames.push_back( file.entryName_ );
+
+    // Reserve space for header and directory, they are written after all files
+    PackageBuilder builder;
+    if ( ! builder.Create( &dest, entryNames ) )
+        ErrorExit( "Could not create package " + tempName );
+
+    long long          readTime   = 0;
+    long long          encodeTime = 0;
+    long long          writeTime  = 0;
+    unsigned long long totalDataSize = 0;
+    unsigned           numReused  = 0;
+
+    // Process files in batches to limit memory usage, write them in order
+    for ( unsigned batchBegin = 0; batchBegin < files.size(); )
+    {
+        unsigned           batchEnd  = batchBegin;
+        unsigned long long batchSize = 0;
+        while ( batchEnd < files.size() )
         {
-            if ( ! quiet_ )
-                PrintLine( entries_[ i ].name_ + " size " + ea::to_string( dataSize ) );
-            dest.Write( &buffer[ 0 ], entries_[ i ].size_ );
+            const SourceFile& file = files[ batchEnd ];
+            if ( ! file.reusedEntry_ )
+            {
+                if ( batchEnd != batchBegin && batchSize + file.size_ > MAX_BATCH_SIZE )
+                    break;
+                batchSize += file.size_;
+            }
+            ++batchEnd;
         }
-        else
-        {
-            ea::unique_ptr< unsigned char[] > compressBuffer( new unsigned char[ LZ4_compressBound( blockSize_ ) ] );
 
-            unsigned pos = 0;
+        HiresTimer readTimer;
+        ReadBatch( files, batchBegin, batchEnd, rootDir );
+        readTime += readTimer.GetUSec( false );
 
-            while ( pos < dataSize )
+        // Files with unchanged content are not recompressed even if modification time has changed
+        for ( unsigned i = batchBegin; i < batchEnd; ++i )
+        {
+            SourceFile& file = files[ i ];
+            if ( file.reusedEntry_ )
+                continue;
+            if ( file.readFailed_ )
+                ErrorExit( "Could not read file " + file.name_ );
+
+            const auto record = manifest.find( file.entryName_ );
+            if ( record == manifest.end() || record->second.codec_ != file.codec_ )
+                continue;
+
+            const PackageEntry* entry = previousPackage->GetEntry( file.entryName_ );
+            if ( entry && entry->size_ == file.size_ && entry->checksum_ == file.checksum_ )
             {
-                unsigned unpackedSize = blockSize_;
-                if ( pos + unpackedSize > dataSize )
-                    unpackedSize = dataSize - pos;
-
-                auto packedSize = ( unsigned )LZ4_compress_HC( ( const char* )&buffer[ pos ], ( char* )compressBuffer.get(), unpackedSize, LZ4_compressBound( unpackedSize ), 0 );
-                if ( ! packedSize )
-                    ErrorExit( "LZ4 compression failed for file " + entries_[ i ].name_ + " at offset " + ea::to_string( pos ) );
+                file.reusedEntry_ = entry;
+                file.data_.clear();
+                file.data_.shrink_to_fit();
+            }
+        }
 
-                dest.WriteUShort( ( unsigned short )unpackedSize );
-                dest.WriteUShort( ( unsigned short )packedSize );
-                dest.Write( compressBuffer.get(), packedSize );
+        HiresTimer encodeTimer;
+        EncodeBatch( files, batchBegin, batchEnd );
+        encodeTime += encodeTimer.GetUSec( false );
 
-                pos += unpackedSize;
+        HiresTimer writeTimer;
+        for ( unsigned i = batchBegin; i < batchEnd; ++i )
+        {
+            SourceFile& file = files[ i ];
+            bool        success;
+            if ( file.reusedEntry_ )
+            {
+                success = builder.AppendFile( file.entryName_, *file.reusedEntry_, previousPackage->GetMappedData( *file.reusedEntry_ ) );
+                ++numReused;
             }
+            else
+                success = builder.AppendFile( file.entryName_, file.encoded_ );
 
-            if ( ! quiet_ )
+            if ( ! success )
+                ErrorExit( "Could not write file " + file.name_ );
+
+            file.checksum_    = file.reusedEntry_ ? file.reusedEntry_->checksum_ : file.encoded_.checksum_;
+            file.packedSize_  = file.reusedEntry_ ? file.reusedEntry_->packedSize_ : file.encoded_.data_.size();
+            file.packedCodec_ = file.reusedEntry_ ? file.reusedEntry_->codec_ : static_cast< unsigned >( file.encoded_.codec_ );
+            if ( ! quiet_ && ! stats_ )
             {
-                unsigned   totalPackedBytes = dest.GetSize() - lastOffset;
-                ea::string fileEntry( entries_[ i ].name_ );
-                fileEntry.append_sprintf( "\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes, totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f );
+                ea::string fileEntry( file.name_ );
+                fileEntry.append_sprintf( "\t%s\tin: %u\tout: %u\tratio: %f%s", GetCodecName( file.packedCodec_ ), file.size_, file.packedSize_,
+                                          file.packedSize_ ? 1.f * file.size_ / file.packedSize_ : 0.f, file.reusedEntry_ ? "\t(unchanged)" : "" );
                 PrintLine( fileEntry );
             }
+
+            totalDataSize += file.size_;
+
+            // Keep only what's needed for the manifest and statistics
+            file.encoded_.data_.clear();
+            file.encoded_.data_.shrink_to_fit();
         }
+        writeTime += writeTimer.GetUSec( false );
+
+        batchBegin = batchEnd;
     }
 
-    // Write package size to the end of file to allow finding it linked to an executable file
-    unsigned currentSize = dest.GetSize();
-    dest.WriteUInt( currentSize + sizeof( unsigned ) );
+    if ( ! builder.Finalize() )
+        ErrorExit( "Could not write package directory" );
+    dest.Close();
 
-    // Write header again with correct offsets & checksums
-    dest.Seek( 0 );
-    WriteHeader( dest );
+    // Replace previous package
+    previousPackage = nullptr;
+    if ( fileSystem_->Exists( fileName ) && ! fileSystem_->Delete( fileName ) )
+        ErrorExit( "Could not replace package " + fileName );
+    if ( ! fileSystem_->Rename( tempName, fileName ) )
+        ErrorExit( "Could not rename " + tempName + " to " + fileName );
 
-    for ( unsigned i = 0; i < entries_.size(); ++i )
-    {
-        dest.WriteString( basePath_ + entries_[ i ].name_ );
-        dest.WriteUInt( entries_[ i ].offset_ );
-        dest.WriteUInt( entries_[ i ].size_ );
-        dest.WriteUInt( entries_[ i ].checksum_ );
-    }
+    WriteManifest( manifestName, files );
 
     if ( ! quiet_ )
     {
-        PrintLine( "Number of files: " + ea::to_string( entries_.size() ) );
+        PrintLine( "Number of files: " + ea::to_string( files.size() ) );
+        PrintLine( "Unchanged files: " + ea::to_string( numReused ) );
         PrintLine( "File data size: " + ea::to_string( totalDataSize ) );
-        PrintLine( "Package size: " + ea::to_string( dest.GetSize() ) );
-        PrintLine( "Checksum: " + ea::to_string( checksum_ ) );
-        PrintLine( "Compressed: " + ea::string( compress_ ? "yes" : "no" ) );
+        PrintLine( "Package size: " + ea::to_string( builder.GetTotalSize() ) );
+        PrintLine( "Checksum: " + ea::to_string( builder.GetChecksum() ) );
+        PrintLine( "Compressed: " + ea::string( builder.IsCompressed() ? "yes" : "no" ) );
+    }
+
+    if ( stats_ )
+    {
+        PrintStats( files );
+        PrintLine( ea::string{}.sprintf( "Read: %.3f s\tEncode: %.3f s\tWrite: %.3f s\tTotal: %.3f s\tThreads: %u", readTime / 1000000.0,
+                                         encodeTime / 1000000.0, writeTime / 1000000.0, totalTimer.GetUSec( false ) / 1000000.0,
+                                         workQueue_->GetNumProcessingThreads() ) );
     }
 }
 
-void WriteHeader( File& dest )
+PackageCodec GetFileCodec( const ea::string& fileName )
 {
-    if ( ! compress_ )
-        dest.WriteFileID( "UPAK" );
-    else
-        dest.WriteFileID( "ULZ4" );
-    dest.WriteUInt( entries_.size() );
-    dest.WriteUInt( checksum_ );
+    const ea::string extension = GetExtension( fileName );
+    for ( const ea::string& compressedExtension : compressedExtensions_ )
+    {
+        if ( extension == compressedExtension )
+            return PACKAGE_CODEC_NONE;
+    }
+    return codec_;
+}
+
+const char* GetCodecName( unsigned codec )
+{
+    switch ( codec )
+    {
+        case PACKAGE_CODEC_NONE:
+            return "none";
+        case PACKAGE_CODEC_LZ4:
+            return "lz4";
+        case PACKAGE_CODEC_LZ4HC:
+            return "lz4hc";
+        case PACKAGE_CODEC_ZSTD:
+            return "zstd";
+        default:
+            return "unknown";
+    }
 }
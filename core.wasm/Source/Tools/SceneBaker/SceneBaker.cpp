@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Scene/SceneResource.h>
+#include <Urho3D/Scene/SceneSnapshot.h>
+
+#ifdef WIN32
+    #include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+int main(int argc, char** argv);
+void Run(ea::vector<ea::string>& arguments);
+
+void Help()
+{
+    ErrorExit("Usage: SceneBaker -options <input scene> <output snapshot>\n"
+        "\n"
+        "Bakes scene saved in XML, JSON or binary format into snapshot that is loaded without parsing.\n"
+        "Scene components should be registered by the engine, unknown components are not baked properly.\n"
+        "\n"
+        "Options:\n"
+        "-h Shows this help message.\n"
+        "-p <paths> Resource prefix paths separated by ';'. Defaults to the program directory.\n"
+        "-r <paths> Resource paths separated by ';'. Defaults to 'CoreData;Data'.\n"
+        "-q Enable quiet mode.\n");
+}
+
+int main(int argc, char** argv)
+{
+    ea::vector<ea::string> arguments;
+
+#ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+#else
+    arguments = ParseArguments(argc, argv);
+#endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(ea::vector<ea::string>& arguments)
+{
+    ea::vector<ea::string> fileNames;
+    ea::string resourcePrefixPaths;
+    ea::string resourcePaths = "CoreData;Data";
+    bool quiet = false;
+
+    while (!arguments.empty())
+    {
+        const ea::string arg = arguments.front();
+        arguments.pop_front();
+
+        if (arg.empty())
+            continue;
+
+        if (arg.starts_with("-"))
+        {
+            if (arg == "-p" && !arguments.empty())
+            {
+                resourcePrefixPaths = arguments.front();
+                arguments.pop_front();
+            }
+            else if (arg == "-r" && !arguments.empty())
+            {
+                resourcePaths = arguments.front();
+                arguments.pop_front();
+            }
+            else if (arg == "-q")
+                quiet = true;
+            else
+                Help();
+        }
+        else
+            fileNames.push_back(arg);
+    }
+
+    if (fileNames.size() != 2)
+        Help();
+
+    const ea::string& inputFileName = fileNames[0];
+    const ea::string& outputFileName = fileNames[1];
+
+    SharedPtr<Context> context(new Context());
+    auto engine = new Engine(context);
+
+    // Components may request resources, so the engine should be able to find them
+    const ea::string programDir = GetParentPath(context->GetSubsystem<FileSystem>()->GetProgramFileName());
+    StringVariantMap parameters;
+    parameters[EP_HEADLESS] = true;
+    parameters[EP_LOG_QUIET] = quiet;
+    parameters[EP_LOG_NAME] = EMPTY_STRING;
+    parameters[EP_RESOURCE_PATHS] = resourcePaths;
+    parameters[EP_RESOURCE_PREFIX_PATHS] = resourcePrefixPaths.empty() ? programDir : resourcePrefixPaths;
+    if (!engine->Initialize(parameters, {}))
+        ErrorExit("Could not initialize engine");
+
+    HiresTimer timer;
+
+    File inputFile(context);
+    if (!inputFile.Open(inputFileName))
+        ErrorExit("Could not open input file " + inputFileName);
+
+    auto sceneResource = MakeShared<SceneResource>(context);
+    sceneResource->SetName(inputFileName);
+    if (!sceneResource->Load(inputFile))
+        ErrorExit("Could not load scene from " + inputFileName);
+
+    const long long loadTime = timer.GetUSec(true);
+
+    File outputFile(context);
+    if (!outputFile.Open(outputFileName, FILE_WRITE))
+        ErrorExit("Could not open output file " + outputFileName);
+
+    Scene* scene = sceneResource->GetScene();
+    if (!SceneSnapshot::Save(scene, outputFile))
+        ErrorExit("Could not bake scene snapshot " + outputFileName);
+
+    const long long bakeTime = timer.GetUSec(false);
+
+    if (!quiet)
+    {
+        PrintLine(Format("Baked {} ({} bytes) into {} ({} bytes) in {:.1f} ms, source loaded in {:.1f} ms",
+            inputFileName, inputFile.GetSize(), outputFileName, outputFile.GetSize(), bakeTime / 1000.0,
+            loadTime / 1000.0));
+    }
+}
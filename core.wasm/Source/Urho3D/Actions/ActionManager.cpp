@@ -154,44 +154,25 @@ void ActionManager::HandleUpdate(StringHash eventType, VariantMap& eventData)
 
 void ActionManager::CompleteAllActions()
 {
-    if (targets_.empty())
-        return;
-
-    auto count = targets_.size();
-
-    tmpKeysArray_.clear();
-    tmpKeysArray_.reserve(targets_.size() * 2);
-
-    for (auto target : targets_)
+    // Targets added while actions are completed are kept
+    const unsigned count = targets_.size();
+    for (unsigned i = 0; i < count; ++i)
     {
-        tmpKeysArray_.push_back(target.first);
-    }
-
-    for (auto target : tmpKeysArray_)
-    {
-        CompleteAllActionsOnTarget(target);
+        if (!targets_[i].Removed)
+            CompleteAllActionsOnTarget(targets_[i].Key);
     }
+    SweepTargets();
 }
 
 void ActionManager::CancelAllActions()
 {
-    if (targets_.empty())
-        return;
-
-    auto count = targets_.size();
-
-    tmpKeysArray_.clear();
-    tmpKeysArray_.reserve(targets_.size() * 2);
-
-    for (auto target : targets_)
+    const unsigned count = targets_.size();
+    for (unsigned i = 0; i < count; ++i)
     {
-        tmpKeysArray_.push_back(target.first);
-    }
-
-    for (auto target : tmpKeysArray_)
-    {
-        CancelAllActionsFromTarget(target);
+        if (!targets_[i].Removed)
+            RemoveTarget(i);
     }
+    SweepTargets();
 }
 
 void ActionManager::CancelAllActionsFromTarget(Object* target)
@@ -199,24 +180,9 @@ void ActionManager::CancelAllActionsFromTarget(Object* target)
     if (target == nullptr)
         return;
 
-    const auto targetIt = targets_.find(target);
-    if (targetIt != targets_.end())
-    {
-        HashElement& element = targetIt->second;
-
-        if (element.ActionStates.contains(element.CurrentActionState) && !element.CurrentActionSalvaged)
-            element.CurrentActionSalvaged = true;
-
-        element.ActionStates.clear();
-        if (currentTarget_ == target)
-        {
-            currentTargetSalvaged_ = true;
-        }
-        else
-        {
-            targets_.erase(targetIt);
-        }
-    }
+    const unsigned index = FindTarget(target);
+    if (index != M_MAX_UNSIGNED)
+        RemoveTarget(index);
 }
 
 void ActionManager::CompleteAllActionsOnTarget(Object* target)
@@ -224,53 +190,44 @@ void ActionManager::CompleteAllActionsOnTarget(Object* target)
     if (target == nullptr)
         return;
 
-    const auto targetIt = targets_.find(target);
-    if (targetIt != targets_.end())
-    {
-        HashElement& element = targetIt->second;
-
-        if (element.ActionStates.contains(element.CurrentActionState) && !element.CurrentActionSalvaged)
-            element.CurrentActionSalvaged = true;
+    const unsigned index = FindTarget(target);
+    if (index == M_MAX_UNSIGNED)
+        return;
 
-        for (const auto& action: element.ActionStates)
+    // Element may be reallocated if actions are added while completing, so copy the list.
+    const auto actionStates = targets_[index].ActionStates;
+    for (const auto& action : actionStates)
+    {
+        // Do a zero step to be sure that the action is initialized.
+        action->Step(0.0f);
+        float duration = ea::numeric_limits<float>::max();
+        const auto finiteTimeAction = dynamic_cast<FiniteTimeAction*>(action->GetAction());
+        if (finiteTimeAction)
         {
-            // Do a zero step to be sure that the action is initialized.
-            action->Step(0.0f);
-            float duration = ea::numeric_limits<float>::max();
-            const auto finiteTimeAction = dynamic_cast<FiniteTimeAction*>(action->GetAction());
-            if (finiteTimeAction)
+            duration = finiteTimeAction->GetDuration();
+            if (duration >= ea::numeric_limits<float>::max())
             {
-                duration = finiteTimeAction->GetDuration();
-                if (duration >= ea::numeric_limits<float>::max())
-                {
-                    duration = 0.0f;
-                }
+                duration = 0.0f;
             }
-            // Do a step beyond duration to complete the action.
-            action->Step(duration * 2.0f);
-        }
-        element.ActionStates.clear();
-        if (currentTarget_ == target)
-        {
-            currentTargetSalvaged_ = true;
-        }
-        else
-        {
-            targets_.erase(targetIt);
         }
+        // Do a step beyond duration to complete the action.
+        action->Step(duration * 2.0f);
     }
+
+    const unsigned completedIndex = FindTarget(target);
+    if (completedIndex != M_MAX_UNSIGNED)
+        RemoveTarget(completedIndex);
 }
+
 void ActionManager::CancelAction(ActionState* actionState)
 {
     if (!actionState || !actionState->GetOriginalTarget())
         return;
 
-    auto target = actionState->GetOriginalTarget();
-
-    auto targetIt = targets_.find(target);
-    if (targetIt != targets_.end())
+    const unsigned index = FindTarget(actionState->GetOriginalTarget());
+    if (index != M_MAX_UNSIGNED)
     {
-        HashElement& element = targetIt->second;
+        TargetElement& element = targets_[index];
         ea::erase_if(
             element.ActionStates, [&](const SharedPtr<ActionState>& state) { return state.Get() == actionState; });
     }
@@ -280,10 +237,10 @@ unsigned ActionManager::GetNumActions(Object* target) const
 {
     if (!target)
         return 0;
-    const auto existingTargetIt = targets_.find(target);
-    if (existingTargetIt == targets_.end())
+    const unsigned index = FindTarget(target);
+    if (index == M_MAX_UNSIGNED)
         return 0;
-    return existingTargetIt->second.ActionStates.size();
+    return targets_[index].ActionStates.size();
 }
 
 ActionState* ActionManager::AddAction(BaseAction* action, Object* target, bool paused)
@@ -299,24 +256,25 @@ ActionState* ActionManager::AddAction(BaseAction* action, Object* target, bool p
         return nullptr;
     }
 
-    const auto existingTargetIt = targets_.find(target);
-    HashElement* element = nullptr;
-    // Check if element is missing or if we have a record with conflicting pointer (happens in unit tests).
-    if (existingTargetIt == targets_.end() || existingTargetIt->second.Target.Expired())
+    unsigned index = FindTarget(target);
+    // Check if we have a record with conflicting pointer (happens in unit tests).
+    if (index != M_MAX_UNSIGNED && targets_[index].Target.Expired())
     {
-        element = &targets_[target];
-        // Hack to handle expired target with reused pointer.
-        element->ActionStates.clear();
-        element->Paused = paused;
-        element->Target = target;
+        RemoveTarget(index);
+        index = M_MAX_UNSIGNED;
     }
-    else
+
+    if (index == M_MAX_UNSIGNED)
     {
-        element = &existingTargetIt->second;
+        index = targets_.size();
+        TargetElement& element = targets_.emplace_back();
+        element.Paused = paused;
+        element.Key = target;
+        element.Target = target;
+        targetIndices_[target] = index;
     }
 
-    auto isActionRunning = false;
-    for (auto& existingState : element->ActionStates)
+    for (auto& existingState : targets_[index].ActionStates)
     {
         if (existingState->GetAction() == action)
         {
@@ -325,7 +283,8 @@ ActionState* ActionManager::AddAction(BaseAction* action, Object* target, bool p
         }
     }
     auto state = action->StartAction(target);
-    element->ActionStates.push_back(state);
+    // Element may be reallocated if actions are added to other targets from StartAction
+    targets_[index].ActionStates.push_back(state);
 
     return state;
 }
@@ -335,75 +294,106 @@ void ActionManager::Update(float dt)
     if (targets_.empty())
         return;
 
-    const auto count = targets_.size();
-
-    tmpKeysArray_.clear();
-    if (tmpKeysArray_.capacity() < count)
-        tmpKeysArray_.reserve(count * 2);
-    for (auto target : targets_)
-    {
-        tmpKeysArray_.push_back(target.first);
-    }
+    updating_ = true;
 
+    // Targets added during this update are processed on the next one.
+    // Action states may add actions to other targets, so elements are accessed by index.
+    const unsigned count = targets_.size();
     for (unsigned i = 0; i < count; i++)
     {
-        auto elementlt = targets_.find(tmpKeysArray_[i]);
-        if (elementlt == targets_.end())
+        if (targets_[i].Removed)
             continue;
 
-        auto& element = elementlt->second;
-        if (element.Target.Expired())
+        if (targets_[i].Target.Expired())
         {
-            targets_.erase(elementlt);
+            RemoveTarget(i);
             continue;
         }
 
-        currentTarget_ = element.Target.Get();
-        currentTargetSalvaged_ = false;
+        if (targets_[i].Paused)
+            continue;
+
+        currentTarget_ = targets_[i].Target.Get();
 
-        if (!element.Paused)
+        // The 'actions' may change while inside this loop.
+        for (unsigned actionIndex = 0; actionIndex < targets_[i].ActionStates.size(); actionIndex++)
         {
-            // The 'actions' may change while inside this loop.
-            for (element.ActionIndex = 0; element.ActionIndex < element.ActionStates.size(); element.ActionIndex++)
-            {
-                element.CurrentActionState = element.ActionStates[element.ActionIndex];
-                if (!element.CurrentActionState)
-                    continue;
-                if (element.Target.Expired())
-                    break;
+            const SharedPtr<ActionState> actionState = targets_[i].ActionStates[actionIndex];
+            if (!actionState)
+                continue;
+            if (targets_[i].Target.Expired())
+                break;
 
-                element.CurrentActionSalvaged = false;
+            actionState->Step(dt);
 
-                element.CurrentActionState->Step(dt);
+            // All actions on the target were cancelled or completed during the step.
+            if (targets_[i].Removed)
+                break;
 
-                if (element.CurrentActionSalvaged)
-                {
-                    // The currentAction told the node to remove it. To prevent the action from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
+            if (actionState->IsDone())
+            {
+                actionState->Stop();
 
-                    // currentTarget->currentAction->release();
-                }
-                else if (element.CurrentActionState->IsDone())
+                auto& actionStates = targets_[i].ActionStates;
+                if (actionIndex < actionStates.size() && actionStates[actionIndex] == actionState)
                 {
-                    element.CurrentActionState->Stop();
-
-                    auto actionState = element.CurrentActionState;
-                    // Make currentAction nil to prevent removeAction from salvaging it.
-                    element.CurrentActionState.Reset();
-                    CancelAction(actionState);
+                    actionStates.erase(actionStates.begin() + actionIndex);
+                    --actionIndex;
                 }
-
-                element.CurrentActionState.Reset();
+                else
+                    CancelAction(actionState);
             }
         }
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (currentTargetSalvaged_ && element.ActionStates.empty())
-            targets_.erase(elementlt);
+        if (!targets_[i].Removed && targets_[i].ActionStates.empty())
+            RemoveTarget(i);
     }
 
     currentTarget_ = nullptr;
+    updating_ = false;
+
+    SweepTargets();
+}
+
+unsigned ActionManager::FindTarget(Object* target) const
+{
+    const auto iter = targetIndices_.find(target);
+    return iter != targetIndices_.end() ? iter->second : M_MAX_UNSIGNED;
+}
+
+void ActionManager::RemoveTarget(unsigned index)
+{
+    TargetElement& element = targets_[index];
+    if (element.Removed)
+        return;
+
+    element.Removed = true;
+    element.ActionStates.clear();
+    targetIndices_.erase(element.Key);
+    hasRemovedTargets_ = true;
+}
+
+void ActionManager::SweepTargets()
+{
+    if (!hasRemovedTargets_ || updating_)
+        return;
+
+    hasRemovedTargets_ = false;
+
+    unsigned numTargets = 0;
+    for (unsigned i = 0; i < targets_.size(); ++i)
+    {
+        if (targets_[i].Removed)
+            continue;
+
+        if (numTargets != i)
+        {
+            targets_[numTargets] = ea::move(targets_[i]);
+            targetIndices_[targets_[numTargets].Key] = numTargets;
+        }
+        ++numTargets;
+    }
+    targets_.erase(targets_.begin() + numTargets, targets_.end());
 }
 
 FiniteTimeAction* ActionManager::GetEmptyAction() { return emptyAction_; }
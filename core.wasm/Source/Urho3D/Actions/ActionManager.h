@@ -42,13 +42,14 @@ class URHO3D_API ActionManager
 {
     URHO3D_OBJECT(ActionManager, Object)
 private:
-    struct HashElement
+    struct TargetElement
     {
-        int ActionIndex {};
         ea::vector<SharedPtr<Actions::ActionState>> ActionStates;
-        SharedPtr<Actions::ActionState> CurrentActionState;
-        bool CurrentActionSalvaged {};
         bool Paused {};
+        /// Whether the element is removed and waits to be swept.
+        bool Removed {};
+        /// Target pointer used as a key in index map. May be dangling if target is expired.
+        Object* Key {};
         WeakPtr<Object> Target;
     };
 
@@ -81,12 +82,24 @@ public:
 private:
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
 
+    /// Return index of target element or M_MAX_UNSIGNED if target has no actions.
+    unsigned FindTarget(Object* target) const;
+    /// Mark target element as removed. Element memory is reclaimed by SweepTargets.
+    void RemoveTarget(unsigned index);
+    /// Compact array of target elements. Does nothing during update.
+    void SweepTargets();
+
 private:
     // Current target strong pointer to keep target alive while manager operates on actions.
     SharedPtr<Object> currentTarget_{};
-    bool currentTargetSalvaged_{};
-    ea::unordered_map<Object*, HashElement> targets_;
-    ea::vector<Object*> tmpKeysArray_;
+    /// Dense array of targets that is iterated linearly on update.
+    ea::vector<TargetElement> targets_;
+    /// Index of the target in targets_ array.
+    ea::unordered_map<Object*, unsigned> targetIndices_;
+    /// Whether there are removed target elements.
+    bool hasRemovedTargets_{};
+    /// Whether the update is in progress.
+    bool updating_{};
     SharedPtr<Actions::FiniteTimeAction> emptyAction_;
 };
 
@@ -36,6 +36,61 @@ namespace Actions
 
 namespace
 {
+
+float InterpolateValue(float from, float to, float time) { return Lerp(from, to, time); }
+Vector2 InterpolateValue(const Vector2& from, const Vector2& to, float time) { return from.Lerp(to, time); }
+Vector3 InterpolateValue(const Vector3& from, const Vector3& to, float time) { return from.Lerp(to, time); }
+Vector4 InterpolateValue(const Vector4& from, const Vector4& to, float time) { return from.Lerp(to, time); }
+Quaternion InterpolateValue(const Quaternion& from, const Quaternion& to, float time) { return from.Slerp(to, time); }
+Color InterpolateValue(const Color& from, const Color& to, float time) { return from.Lerp(to, time); }
+
+/// Interpolates attribute of known type without intermediate Variant values.
+template <class T> class AttributeTypedState : public AttributeActionState
+{
+    T from_;
+    T to_;
+
+public:
+    AttributeTypedState(FiniteTimeAction* action, Object* target, AttributeInfo* attribute, const T& from, const T& to)
+        : AttributeActionState(action, target, attribute)
+        , from_(from)
+        , to_(to)
+    {
+    }
+
+    void Update(float time) override
+    {
+        if (attribute_)
+            SetTyped(InterpolateValue(from_, to_, time));
+    }
+};
+
+/// Create typed interpolation state if values and attribute have the same supported type.
+SharedPtr<ActionState> CreateTypedState(
+    FiniteTimeAction* action, Object* target, AttributeInfo* attribute, const Variant& from, const Variant& to)
+{
+    if (!attribute || attribute->type_ != from.GetType() || attribute->type_ != to.GetType())
+        return nullptr;
+
+    switch (attribute->type_)
+    {
+    case VAR_FLOAT:
+        return MakeShared<AttributeTypedState<float>>(action, target, attribute, from.GetFloat(), to.GetFloat());
+    case VAR_VECTOR2:
+        return MakeShared<AttributeTypedState<Vector2>>(action, target, attribute, from.GetVector2(), to.GetVector2());
+    case VAR_VECTOR3:
+        return MakeShared<AttributeTypedState<Vector3>>(action, target, attribute, from.GetVector3(), to.GetVector3());
+    case VAR_VECTOR4:
+        return MakeShared<AttributeTypedState<Vector4>>(action, target, attribute, from.GetVector4(), to.GetVector4());
+    case VAR_QUATERNION:
+        return MakeShared<AttributeTypedState<Quaternion>>(
+            action, target, attribute, from.GetQuaternion(), to.GetQuaternion());
+    case VAR_COLOR:
+        return MakeShared<AttributeTypedState<Color>>(action, target, attribute, from.GetColor(), to.GetColor());
+    default: return nullptr;
+    }
+}
+
 class AttributeFromToState : public AttributeActionState
 {
     Variant from_;
@@ -106,7 +161,10 @@ void AttributeFromTo::SerializeInBlock(Archive& archive)
 /// Create new action state from the action.
 SharedPtr<ActionState> AttributeFromTo::StartAction(Object* target)
 {
-    return MakeShared<AttributeFromToState>(this, target, GetAttribute(target));
+    AttributeInfo* attribute = GetAttribute(target);
+    if (auto state = CreateTypedState(this, target, attribute, from_, to_))
+        return state;
+    return MakeShared<AttributeFromToState>(this, target, attribute);
 }
 
 /// Construct.
@@ -128,7 +186,15 @@ void AttributeTo::SerializeInBlock(Archive& archive)
 /// Create new action state from the action.
 SharedPtr<ActionState> AttributeTo::StartAction(Object* target)
 {
-    return MakeShared<AttributeToState>(this, target, GetAttribute(target));
+    AttributeInfo* attribute = GetAttribute(target);
+    if (attribute)
+    {
+        Variant from;
+        attribute->accessor_->Get(static_cast<const Serializable*>(target), from);
+        if (auto state = CreateTypedState(this, target, attribute, from, to_))
+            return state;
+    }
+    return MakeShared<AttributeToState>(this, target, attribute);
 }
 
 /// Construct.
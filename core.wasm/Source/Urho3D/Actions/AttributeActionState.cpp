@@ -68,10 +68,9 @@ void AttributeActionState::Update(float dt)
     if (!attribute_)
         return;
 
-    Variant dst;
-    Get(dst);
-    Update(dt, dst);
-    Set(dst);
+    Get(cachedValue_);
+    Update(dt, cachedValue_);
+    Set(cachedValue_);
 }
 
 SetAttributeState::SetAttributeState(
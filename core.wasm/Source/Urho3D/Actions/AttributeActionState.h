@@ -59,11 +59,33 @@ protected:
         return tmp.Get<T>();
     }
 
-private:
+    /// Set attribute value of known type. Attributes without typed access are set via cached Variant.
+    template <typename T> void SetTyped(const T& value)
+    {
+        if (!attribute_)
+            return;
+
+        if (attribute_->accessor_->GetTypedAccessType() == GetVariantType<T>())
+        {
+            auto* serializable = static_cast<Serializable*>(GetTarget());
+            serializable->OnSetAttributeTyped(*attribute_, &value);
+        }
+        else
+        {
+            cachedValue_ = value;
+            Set(cachedValue_);
+        }
+    }
+
+    /// Called every frame with it's delta time. Typed states may override it to skip generic Variant update.
     void Update(float dt) override;
 
 protected:
     AttributeInfo* attribute_{};
+
+private:
+    /// Attribute value reused between updates.
+    Variant cachedValue_;
 };
 
 class SetAttributeState : public AttributeActionState
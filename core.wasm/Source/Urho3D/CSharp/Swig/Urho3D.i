@@ -330,6 +330,9 @@ namespace SDL
 
 %include "Object.i"
 %director Urho3D::AttributeAccessor;
+%ignore Urho3D::AttributeAccessor::GetTyped;
+%ignore Urho3D::AttributeAccessor::SetTyped;
+%ignore Urho3D::AttributeAccessor::typedAccessType_;
 
 %include "generated/Urho3D/_pre_plugins.i"
 %include "generated/Urho3D/_pre_utility.i"
@@ -427,6 +430,10 @@ public:
 %include "Urho3D/IO/Deserializer.h"
 %interface_custom("%s", "I%s", Urho3D::AbstractFile);
 URHO3D_REFCOUNTED_INTERFACE(Urho3D::AbstractFile, Urho3D::RefCounted);
+%ignore Urho3D::AsyncReadRequest;
+%ignore Urho3D::AbstractFile::ReadAsync;
+%ignore Urho3D::File::ReadAsync;
+%ignore Urho3D::MountPoint::ReadAsync;
 %include "Urho3D/IO/AbstractFile.h"
 %include "Urho3D/IO/ScanFlags.h"
 %include "Urho3D/IO/Compression.h"
@@ -438,6 +445,9 @@ URHO3D_REFCOUNTED_INTERFACE(Urho3D::AbstractFile, Urho3D::RefCounted);
 %include "Urho3D/IO/FileIdentifier.h"
 %include "Urho3D/IO/MountPoint.h"
 %include "Urho3D/IO/VirtualFileSystem.h"
+%ignore Urho3D::PackageFile::GetEntries;
+%ignore Urho3D::PackageFile::GetEntryName(const PackageEntry&) const;
+%ignore Urho3D::PackageFile::GetEntryNameHash;
 %include "Urho3D/IO/PackageFile.h"
 
 %ignore Urho3D::NonCopyable;
@@ -479,11 +489,12 @@ public:
 
 // These expose iterators of underlying collection. Iterate object through GetObject() instead.
 %ignore Urho3D::BackgroundLoadItem;
-%ignore Urho3D::BackgroundLoader::ThreadFunction;
 %ignore Urho3D::ImageCube::CalculateSphericalHarmonics;
 %rename(GetValueType) Urho3D::PListValue::GetType;
 
 %include "generated/Urho3D/_pre_resource.i"
+%ignore Urho3D::Resource::Load(Deserializer& source, CookedResourceCache* cookedCache);
+%ignore Urho3D::ResourceCache::GetCookedResourceCache;
 %include "Urho3D/Resource/Resource.h"
 #if defined(URHO3D_THREADING)
 %include "Urho3D/Resource/BackgroundLoader.h"
@@ -510,6 +521,8 @@ public:
 %ignore Urho3D::Serializable::networkState_;
 %ignore Urho3D::Serializable::instanceDefaultValues_;
 %ignore Urho3D::Serializable::temporary_;
+%ignore Urho3D::Serializable::OnSetAttributeTyped;
+%ignore Urho3D::Serializable::OnGetAttributeTyped;
 %ignore Urho3D::Component::CleanupConnection;
 %ignore Urho3D::Scene::CleanupConnection;
 %ignore Urho3D::Node::CleanupConnection;
@@ -523,6 +536,8 @@ public:
 %ignore Urho3D::Component::node_;
 %ignore Urho3D::Component::id_;
 %ignore Urho3D::Component::enabled_;
+%ignore Urho3D::Node::InstantiatePrefabs;
+%ignore Urho3D::PrefabResource::GetInstantiationPlan;
 
 %include "generated/Urho3D/_pre_scene.i"
 %include "Urho3D/Scene/AnimationDefs.h"
@@ -1044,7 +1059,6 @@ using ImGuiConfigFlags = unsigned;
 %template(VariantMap)                   eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, eastl::allocator, false>;
 %template(StringVariantMap)             eastl::unordered_map<eastl::string, Urho3D::Variant, eastl::hash<eastl::string>, eastl::equal_to<eastl::string>, eastl::allocator, true>;
 %template(AttributeMap)                 eastl::unordered_map<Urho3D::StringHash, eastl::vector<Urho3D::AttributeInfo>>;
-%template(PackageMap)                   eastl::unordered_map<eastl::string, Urho3D::PackageEntry>;
 %template(JSONObject)                   eastl::map<eastl::string, Urho3D::JSONValue>;
 %template(ResourceGroupMap)             eastl::unordered_map<Urho3D::StringHash, Urho3D::ResourceGroup>;
 %template(ResourceMap)                  eastl::unordered_map<Urho3D::StringHash, Urho3D::SharedPtr<Urho3D::Resource>>;
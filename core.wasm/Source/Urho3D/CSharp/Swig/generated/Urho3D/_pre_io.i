@@ -51,11 +51,10 @@ using ScanFlags = Urho3D::ScanFlag;
 %csattribute(Urho3D::MountedRoot, %arg(ea::string), Name, GetName);
 %csattribute(Urho3D::MultiFileWatcher, %arg(float), Delay, GetDelay, SetDelay);
 %csattribute(Urho3D::NamedPipe, %arg(bool), IsServer, IsServer);
-%csattribute(Urho3D::PackageFile, %arg(ea::unordered_map<ea::string, PackageEntry>), Entries, GetEntries);
 %csattribute(Urho3D::PackageFile, %arg(Urho3D::StringHash), NameHash, GetNameHash);
 %csattribute(Urho3D::PackageFile, %arg(unsigned int), NumFiles, GetNumFiles);
-%csattribute(Urho3D::PackageFile, %arg(unsigned int), TotalSize, GetTotalSize);
-%csattribute(Urho3D::PackageFile, %arg(unsigned int), TotalDataSize, GetTotalDataSize);
+%csattribute(Urho3D::PackageFile, %arg(unsigned long long), TotalSize, GetTotalSize);
+%csattribute(Urho3D::PackageFile, %arg(unsigned long long), TotalDataSize, GetTotalDataSize);
 %csattribute(Urho3D::PackageFile, %arg(unsigned int), Checksum, GetChecksum);
 %csattribute(Urho3D::PackageFile, %arg(bool), IsCompressed, IsCompressed);
 %csattribute(Urho3D::PackageFile, %arg(ea::vector<ea::string>), EntryNames, GetEntryNames);
@@ -49,7 +49,11 @@ AllocatorBlock* AllocatorReserveBlock(AllocatorBlock* allocator, unsigned nodeSi
     if (!capacity)
         capacity = 1;
 
-    auto* blockPtr = new unsigned char[sizeof(AllocatorBlock) + capacity * (sizeof(AllocatorNode) + nodeSize)];
+    // Pad the node data so that every node in the block stays aligned
+    constexpr unsigned nodeAlignment = alignof(AllocatorNode);
+    const unsigned nodeStride = sizeof(AllocatorNode) + (nodeSize + nodeAlignment - 1) / nodeAlignment * nodeAlignment;
+
+    auto* blockPtr = new unsigned char[sizeof(AllocatorBlock) + capacity * nodeStride];
     auto* newBlock = reinterpret_cast<AllocatorBlock*>(blockPtr);
     newBlock->nodeSize_ = nodeSize;
     newBlock->capacity_ = capacity;
@@ -71,8 +75,8 @@ AllocatorBlock* AllocatorReserveBlock(AllocatorBlock* allocator, unsigned nodeSi
     for (unsigned i = 0; i < capacity - 1; ++i)
     {
         auto* newNode = reinterpret_cast<AllocatorNode*>(nodePtr);
-        newNode->next_ = reinterpret_cast<AllocatorNode*>(nodePtr + sizeof(AllocatorNode) + nodeSize);
-        nodePtr += sizeof(AllocatorNode) + nodeSize;
+        newNode->next_ = reinterpret_cast<AllocatorNode*>(nodePtr + nodeStride);
+        nodePtr += nodeStride;
     }
     // i == capacity - 1
     {
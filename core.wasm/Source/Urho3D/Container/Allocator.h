@@ -36,8 +36,8 @@ namespace Urho3D
 struct AllocatorBlock;
 struct AllocatorNode;
 
-/// %Allocator memory block.
-struct AllocatorBlock
+/// %Allocator memory block. Aligned so that the nodes following it are suitably aligned for any object.
+struct alignas(std::max_align_t) AllocatorBlock
 {
     /// Size of a node.
     unsigned nodeSize_;
@@ -50,8 +50,8 @@ struct AllocatorBlock
     /// Nodes follow.
 };
 
-/// %Allocator node.
-struct AllocatorNode
+/// %Allocator node. Aligned so that the data following it is suitably aligned for any object.
+struct alignas(std::max_align_t) AllocatorNode
 {
     /// Next free node.
     AllocatorNode* next_;
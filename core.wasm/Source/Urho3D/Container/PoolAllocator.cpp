@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/PoolAllocator.h"
+#include "../Core/Assert.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+unsigned GetSizeClass(size_t size)
+{
+    return (static_cast<unsigned>(size) + PoolAllocator::Granularity - 1) / PoolAllocator::Granularity;
+}
+
+}
+
+PoolAllocator::PoolAllocator(unsigned maxSize, unsigned initialCapacity)
+    : maxSize_(ea::min(maxSize, MaxSizeClasses * Granularity))
+    , initialCapacity_(initialCapacity)
+{
+}
+
+PoolAllocator::~PoolAllocator()
+{
+    URHO3D_ASSERT(numAllocations_ == 0);
+    for (AllocatorBlock* allocator : allocators_)
+        AllocatorUninitialize(allocator);
+}
+
+void* PoolAllocator::Allocate(size_t size)
+{
+    if (size == 0 || size > maxSize_)
+        return ::operator new(size);
+
+    const unsigned sizeClass = GetSizeClass(size);
+
+    MutexLock<SpinLockMutex> lock(mutex_);
+    AllocatorBlock*& allocator = allocators_[sizeClass - 1];
+    if (!allocator)
+        allocator = AllocatorInitialize(sizeClass * Granularity, initialCapacity_);
+
+    ++numAllocations_;
+    return AllocatorReserve(allocator);
+}
+
+void PoolAllocator::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size == 0 || size > maxSize_)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    const unsigned sizeClass = GetSizeClass(size);
+
+    MutexLock<SpinLockMutex> lock(mutex_);
+    URHO3D_ASSERT(numAllocations_ > 0);
+    --numAllocations_;
+    AllocatorFree(allocators_[sizeClass - 1], ptr);
+}
+
+}
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Core/Mutex.h"
+
+#include <EASTL/array.h>
+
+namespace Urho3D
+{
+
+/// Thread-safe pool of memory for objects of similar size.
+/// Sizes are rounded up to size classes, each size class is served by fixed-size Allocator.
+/// Allocations larger than maximum size are forwarded to the heap.
+/// Memory is kept in the pool for reuse and is not returned to the heap.
+class URHO3D_API PoolAllocator : private NonCopyable
+{
+public:
+    /// Size class granularity in bytes.
+    static constexpr unsigned Granularity = 16;
+    /// Maximum number of size classes.
+    static constexpr unsigned MaxSizeClasses = 128;
+
+    /// Construct. Maximum size is limited by the number of size classes.
+    PoolAllocator(unsigned maxSize, unsigned initialCapacity);
+    /// Destruct. All objects should be deallocated.
+    ~PoolAllocator();
+
+    /// Allocate memory.
+    void* Allocate(size_t size);
+    /// Deallocate memory. Size should be the same as passed to Allocate.
+    void Deallocate(void* ptr, size_t size);
+
+    /// Return maximum size of the pooled allocation.
+    unsigned GetMaxSize() const { return maxSize_; }
+    /// Return number of live allocations served by the pool.
+    unsigned GetNumAllocations() const { return numAllocations_; }
+
+private:
+    /// Maximum size of the pooled allocation.
+    const unsigned maxSize_{};
+    /// Initial capacity of each size class.
+    const unsigned initialCapacity_{};
+    /// Allocators for each size class, initialized on demand.
+    ea::array<AllocatorBlock*, MaxSizeClasses> allocators_{};
+    /// Number of live allocations.
+    unsigned numAllocations_{};
+    /// Allocation mutex.
+    SpinLockMutex mutex_;
+};
+
+}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+    #define URHO3D_POOLED_DEBUG_NEW() \
+        static void* operator new(size_t size, int, const char*, int) { return GetPoolAllocator().Allocate(size); }
+#else
+    #define URHO3D_POOLED_DEBUG_NEW()
+#endif
+
+#ifndef SWIG
+/// Declare class-specific allocation functions that use the pool of the class.
+/// Derived classes are allocated from the same pool if they are not too large.
+#define URHO3D_POOLED_ALLOCATION() \
+    public: \
+        static Urho3D::PoolAllocator& GetPoolAllocator(); \
+        static void* operator new(size_t size) { return GetPoolAllocator().Allocate(size); } \
+        static void* operator new(size_t size, void* ptr) { return ptr; } \
+        static void operator delete(void* ptr, size_t size) { GetPoolAllocator().Deallocate(ptr, size); } \
+        static void operator delete(void* ptr, void* place) {} \
+        URHO3D_POOLED_DEBUG_NEW()
+
+/// Define the pool of the class. Pool serves objects up to specified size.
+/// Pool is never destroyed because objects may outlive static storage.
+#define URHO3D_DEFINE_POOLED_ALLOCATION(className, maxSize, initialCapacity) \
+    Urho3D::PoolAllocator& className::GetPoolAllocator() \
+    { \
+        static auto* allocator = new Urho3D::PoolAllocator(maxSize, initialCapacity); \
+        return *allocator; \
+    }
+#else
+#define URHO3D_POOLED_ALLOCATION()
+#define URHO3D_DEFINE_POOLED_ALLOCATION(className, maxSize, initialCapacity)
+#endif
@@ -76,6 +76,57 @@ enum class AttributeScopeHint
 
 class Serializable;
 
+/// Whether the attribute of the type may be accessed directly, without Variant.
+/// Only types stored in Variant as is are supported, so typed value and Variant value are interchangeable.
+template <class T> constexpr bool IsTypedAttributeType = ea::is_same_v<T, bool> || ea::is_same_v<T, int>
+    || ea::is_same_v<T, long long> || ea::is_same_v<T, float> || ea::is_same_v<T, double>
+    || ea::is_same_v<T, Vector2> || ea::is_same_v<T, Vector3> || ea::is_same_v<T, Vector4>
+    || ea::is_same_v<T, Quaternion> || ea::is_same_v<T, Color> || ea::is_same_v<T, IntVector2>
+    || ea::is_same_v<T, IntVector3> || ea::is_same_v<T, Rect> || ea::is_same_v<T, IntRect>
+    || ea::is_same_v<T, Matrix3> || ea::is_same_v<T, Matrix3x4> || ea::is_same_v<T, Matrix4>
+    || ea::is_same_v<T, ea::string> || ea::is_same_v<T, ResourceRef>;
+
+/// Invoke callback with `ea::type_identity<T>` for the type T of typed attribute access.
+/// Return false if typed access is not supported for the Variant type.
+template <class T> bool VisitTypedAttributeType(VariantType type, T&& callback)
+{
+    switch (type)
+    {
+    case VAR_BOOL: callback(ea::type_identity<bool>{}); return true;
+    case VAR_INT: callback(ea::type_identity<int>{}); return true;
+    case VAR_INT64: callback(ea::type_identity<long long>{}); return true;
+    case VAR_FLOAT: callback(ea::type_identity<float>{}); return true;
+    case VAR_DOUBLE: callback(ea::type_identity<double>{}); return true;
+    case VAR_VECTOR2: callback(ea::type_identity<Vector2>{}); return true;
+    case VAR_VECTOR3: callback(ea::type_identity<Vector3>{}); return true;
+    case VAR_VECTOR4: callback(ea::type_identity<Vector4>{}); return true;
+    case VAR_QUATERNION: callback(ea::type_identity<Quaternion>{}); return true;
+    case VAR_COLOR: callback(ea::type_identity<Color>{}); return true;
+    case VAR_INTVECTOR2: callback(ea::type_identity<IntVector2>{}); return true;
+    case VAR_INTVECTOR3: callback(ea::type_identity<IntVector3>{}); return true;
+    case VAR_RECT: callback(ea::type_identity<Rect>{}); return true;
+    case VAR_INTRECT: callback(ea::type_identity<IntRect>{}); return true;
+    case VAR_MATRIX3: callback(ea::type_identity<Matrix3>{}); return true;
+    case VAR_MATRIX3X4: callback(ea::type_identity<Matrix3x4>{}); return true;
+    case VAR_MATRIX4: callback(ea::type_identity<Matrix4>{}); return true;
+    case VAR_STRING: callback(ea::type_identity<ea::string>{}); return true;
+    case VAR_RESOURCEREF: callback(ea::type_identity<ResourceRef>{}); return true;
+    default: return false;
+    }
+}
+
+/// Return value of typed attribute stored in Variant without copying it if possible. Variant type should match.
+template <class T> decltype(auto) GetTypedAttributeValue(const Variant& value)
+{
+    static_assert(IsTypedAttributeType<T>, "Typed attribute access is not supported for this type");
+    if constexpr (ea::is_arithmetic_v<T>)
+        return value.Get<T>();
+    else if constexpr (ea::is_same_v<T, ResourceRef>)
+        return value.GetResourceRef();
+    else
+        return value.Get<const T&>();
+}
+
 /// Abstract base class for invoking attribute accessors.
 class URHO3D_API AttributeAccessor : public RefCounted
 {
@@ -86,6 +137,17 @@ public:
     virtual void Get(const Serializable* ptr, Variant& dest) const = 0;
     /// Set the attribute.
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
+
+    /// Return type of typed access, or VAR_NONE if the attribute can be accessed only via Variant.
+    VariantType GetTypedAccessType() const { return typedAccessType_; }
+    /// Get the attribute without Variant. Destination should point to the value of typed access type.
+    virtual void GetTyped(const Serializable* ptr, void* dest) const { }
+    /// Set the attribute without Variant. Source should point to the value of typed access type.
+    virtual void SetTyped(Serializable* ptr, const void* src) { }
+
+protected:
+    /// Type of typed access.
+    VariantType typedAccessType_{VAR_NONE};
 };
 
 /// Description of an automatically serializable variable.
@@ -56,6 +56,7 @@
 #endif
 #ifdef URHO3D_IK
     #include "../IK/IK.h"
+    #include "../IK/IKSolverSystem.h"
 #endif
 #ifdef URHO3D_NAVIGATION
     #include "../Navigation/NavigationMesh.h"
@@ -374,6 +375,9 @@ bool Engine::Initialize(const StringVariantMap& applicationParameters, const Str
 #ifdef URHO3D_PARTICLE_GRAPH
     context_->RegisterSubsystem(new ParticleGraphSystem(context_));
 #endif
+#ifdef URHO3D_IK
+    context_->RegisterSubsystem(new IKSolverSystem(context_));
+#endif
 
 #ifdef URHO3D_URHO2D
     // 2D graphics library is dependent on 3D graphics library
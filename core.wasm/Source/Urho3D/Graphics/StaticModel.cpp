@@ -41,6 +41,8 @@
 namespace Urho3D
 {
 
+    URHO3D_DEFINE_POOLED_ALLOCATION( StaticModel, sizeof( StaticModel ), 64 )
+
     StaticModel::StaticModel( Context* context ) : Drawable( context, DRAWABLE_GEOMETRY ), occlusionLodLevel_( M_MAX_UNSIGNED ), materialsAttr_( Material::GetTypeStatic() ) {}
 
     StaticModel::~StaticModel() = default;
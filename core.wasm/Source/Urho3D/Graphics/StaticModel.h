@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/PoolAllocator.h"
 #include "../Graphics/Drawable.h"
 
 namespace Urho3D
@@ -42,6 +43,7 @@ namespace Urho3D
     class URHO3D_API StaticModel : public Drawable
     {
         URHO3D_OBJECT( StaticModel, Drawable );
+        URHO3D_POOLED_ALLOCATION();
     public:
         /// Construct.
         explicit StaticModel( Context* context );
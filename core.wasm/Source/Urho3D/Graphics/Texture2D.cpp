@@ -61,9 +61,11 @@ bool Texture2D::BeginLoad(Deserializer& source)
     if (!graphics)
         return true;
 
+    auto* cache = GetSubsystem<ResourceCache>();
+
     // Load the image data for EndLoad()
     loadImage_ = MakeShared<Image>(context_);
-    if (!loadImage_->Load(source))
+    if (!loadImage_->Load(source, cache->GetCookedResourceCache()))
     {
         loadImage_.Reset();
         return false;
@@ -74,7 +76,6 @@ bool Texture2D::BeginLoad(Deserializer& source)
         loadImage_->PrecalculateLevels();
 
     // Load the optional parameters file
-    auto* cache = GetSubsystem<ResourceCache>();
     ea::string xmlName = ReplaceExtension(GetName(), ".xml");
     loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
 
@@ -150,7 +150,7 @@ void IKArmSolver::SolveInternal(const Transform& frameOfReference, const IKSetti
     shoulderSegment_.endNode_->position_ = frameOfReference * local_.armOffset_;
     shoulderSegment_.endNode_->rotation_ = frameOfReference * local_.armRotation_;
 
-    const Vector3 handTargetPosition = target_->GetWorldPosition();
+    const Vector3 handTargetPosition = GetNodeWorldPosition(target_);
     const auto [originalDirection, currentDirection] = CalculateBendDirections(frameOfReference, handTargetPosition);
 
     const Quaternion maxShoulderRotation = CalculateMaxShoulderRotation(handTargetPosition);
@@ -170,7 +170,7 @@ void IKArmSolver::SolveInternal(const Transform& frameOfReference, const IKSetti
     // Apply target rotation if needed
     if (rotationWeight_ > 0.0f)
     {
-        const Quaternion targetRotation = target_->GetWorldRotation() * handBone.localOriginalRotation_;
+        const Quaternion targetRotation = GetNodeWorldRotation(target_) * handBone.localOriginalRotation_;
         handBone.rotation_ = handBone.rotation_.Slerp(targetRotation, rotationWeight_);
     }
 }
@@ -187,13 +187,14 @@ ea::pair<Vector3, Vector3> IKArmSolver::CalculateBendDirections(
 {
     BendCalculationParams params;
 
-    params.parentNodeRotation_ = node_->GetWorldRotation();
+    params.parentNodeRotation_ = GetNodeWorldRotation(node_);
     params.startPosition_ = shoulderSegment_.beginNode_->position_;
     params.targetPosition_ = handTargetPosition;
     params.targetDirectionInLocalSpace_ = local_.targetDirection_;
     params.bendDirectionInNodeSpace_ = bendDirection_;
     params.bendDirectionInLocalSpace_ = local_.bendDirection_;
-    params.bendTarget_ = bendTarget_;
+    if (bendTarget_)
+        params.bendTargetPosition_ = GetNodeWorldPosition(bendTarget_);
     params.bendTargetWeight_ = bendWeight_;
 
     return CalculateBendDirectionsInternal(frameOfReference, params);
@@ -79,7 +79,7 @@ void IKChainSolver::UpdateChainLengths(const Transform& inverseFrameOfReference)
 
 void IKChainSolver::SolveInternal(const Transform& frameOfReference, const IKSettings& settings, float timeStep)
 {
-    chain_.Solve(target_->GetWorldPosition(), settings);
+    chain_.Solve(GetNodeWorldPosition(target_), settings);
 }
 
 } // namespace Urho3D
@@ -119,7 +119,7 @@ void IKHeadSolver::SolvePosition()
     IKNode& neckBone = *neckSegment_.beginNode_;
     IKNode& headBone = *neckSegment_.endNode_;
 
-    const Vector3 targetPosition = target_->GetWorldPosition();
+    const Vector3 targetPosition = GetNodeWorldPosition(target_);
     const Quaternion rotation{headBone.position_ - neckBone.position_, targetPosition - neckBone.position_};
     const Quaternion scaledRotation = Quaternion::IDENTITY.Slerp(rotation, positionWeight_);
 
@@ -134,7 +134,7 @@ void IKHeadSolver::SolveRotation()
 {
     IKNode& headBone = *neckSegment_.endNode_;
 
-    const Quaternion targetRotation = target_->GetWorldRotation() * headBone.localOriginalRotation_;
+    const Quaternion targetRotation = GetNodeWorldRotation(target_) * headBone.localOriginalRotation_;
 
     headBone.rotation_ = headBone.rotation_.Slerp(targetRotation, rotationWeight_);
 
@@ -145,7 +145,7 @@ void IKHeadSolver::SolveDirection()
 {
     IKNode& headBone = *neckSegment_.endNode_;
 
-    const Vector3 direction = target_->GetWorldDirection();
+    const Vector3 direction = GetNodeWorldRotation(target_) * Vector3::FORWARD;
     const Quaternion rotation = headChain_.SolveLookTo(direction);
     const Quaternion scaledRotation = Quaternion::IDENTITY.Slerp(rotation, directionWeight_);
 
@@ -170,7 +170,7 @@ void IKHeadSolver::SolveLookAt(const Transform& frameOfReference, const IKSettin
     neckBone.StorePreviousTransform();
     headBone.StorePreviousTransform();
 
-    const Vector3 lookAtTarget = lookAtTarget_->GetWorldPosition();
+    const Vector3 lookAtTarget = GetNodeWorldPosition(lookAtTarget_);
 
     const Quaternion neckRotation = neckChain_.SolveLookAt(lookAtTarget, settings);
     const Quaternion neckRotationWeighted = Quaternion::IDENTITY.Slerp(neckRotation, neckWeight_);
@@ -54,7 +54,7 @@ void IKIdentitySolver::UpdateRotationOffset()
 {
     Node* boneNode = node_->GetChild(boneName_, true);
     if (boneNode)
-        rotationOffset_ = node_->GetWorldRotation().Inverse() * boneNode->GetWorldRotation();
+        rotationOffset_ = GetNodeWorldRotation(node_).Inverse() * GetNodeWorldRotation(boneNode);
 }
 
 void IKIdentitySolver::EnsureInitialized()
@@ -84,8 +84,8 @@ void IKIdentitySolver::SolveInternal(const Transform& frameOfReference, const IK
 {
     EnsureInitialized();
 
-    boneNode_->position_ = target_->GetWorldPosition();
-    boneNode_->rotation_ = target_->GetWorldRotation() * rotationOffset_;
+    boneNode_->position_ = GetNodeWorldPosition(target_);
+    boneNode_->rotation_ = GetNodeWorldRotation(target_) * rotationOffset_;
 
     boneNode_->MarkPositionDirty();
     boneNode_->MarkRotationDirty();
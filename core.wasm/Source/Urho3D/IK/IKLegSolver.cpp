@@ -201,7 +201,7 @@ void IKLegSolver::UpdateHeelGroundOffset()
     Node* heelNode = node_->GetChild(heelBoneName_, true);
     if (heelNode)
     {
-        const Vector3 heelOffset = heelNode->GetWorldPosition() - node_->GetWorldPosition();
+        const Vector3 heelOffset = GetNodeWorldPosition(heelNode) - GetNodeWorldPosition(node_);
         heelGroundOffset_ = ea::max(0.0f, heelOffset.y_);
     }
 }
@@ -213,22 +213,22 @@ Vector3 IKLegSolver::GetTargetPosition() const
     const float minDistance = 0.001f;
     const float maxDistance = GetToeReachDistance();
     const Vector3& origin = firstBone.position_;
-    const Vector3& target = target_->GetWorldPosition();
+    const Vector3 target = GetNodeWorldPosition(target_);
     return origin + (target - origin).ReNormalized(minDistance, maxDistance);
 }
 
 Plane IKLegSolver::GetGroundPlane() const
 {
     Node* groundNode = groundTarget_ ? groundTarget_ : node_;
-    return Plane{groundNode->GetWorldUp(), groundNode->GetWorldPosition()};
+    return Plane{GetNodeWorldRotation(groundNode) * Vector3::UP, GetNodeWorldPosition(groundNode)};
 }
 
 Vector2 IKLegSolver::ProjectOnGround(const Vector3& position) const
 {
     Node* groundNode = groundTarget_ ? groundTarget_ : node_;
-    const Vector3 right = groundNode->GetWorldRotation() * Vector3::RIGHT;
-    const Vector3 forward = groundNode->GetWorldRotation() * Vector3::FORWARD;
-    const Vector3 localPos = position - groundNode->GetWorldPosition();
+    const Vector3 right = GetNodeWorldRotation(groundNode) * Vector3::RIGHT;
+    const Vector3 forward = GetNodeWorldRotation(groundNode) * Vector3::FORWARD;
+    const Vector3 localPos = position - GetNodeWorldPosition(groundNode);
     return {right.DotProduct(localPos), forward.DotProduct(localPos)};
 }
 
@@ -286,13 +286,14 @@ ea::pair<Vector3, Vector3> IKLegSolver::CalculateBendDirections(
 {
     BendCalculationParams params;
 
-    params.parentNodeRotation_ = node_->GetWorldRotation();
+    params.parentNodeRotation_ = GetNodeWorldRotation(node_);
     params.startPosition_ = legChain_.GetBeginNode()->position_;
     params.targetPosition_ = toeTargetPosition;
     params.targetDirectionInLocalSpace_ = local_.targetDirection_;
     params.bendDirectionInNodeSpace_ = bendDirection_;
     params.bendDirectionInLocalSpace_ = local_.bendDirection_;
-    params.bendTarget_ = bendTarget_;
+    if (bendTarget_)
+        params.bendTargetPosition_ = GetNodeWorldPosition(bendTarget_);
     params.bendTargetWeight_ = bendWeight_;
 
     return CalculateBendDirectionsInternal(frameOfReference, params);
@@ -342,7 +343,7 @@ Quaternion IKLegSolver::CalculateFootRotation(const Transform& frameOfReference,
     const IKNode& toeBone = *footSegment_.endNode_;
 
     const Quaternion baseToeRotation = frameOfReference * local_.toeRotation_;
-    const Quaternion currentToeRotation = target_->GetWorldRotation() * toeBone.localOriginalRotation_;
+    const Quaternion currentToeRotation = GetNodeWorldRotation(target_) * toeBone.localOriginalRotation_;
 
     const Quaternion delta = currentToeRotation * baseToeRotation.Inverse();
     const auto [_, deltaTwist] = delta.ToSwingTwist(toeTargetPosition - thighBone.position_);
@@ -357,7 +358,7 @@ Vector3 IKLegSolver::CalculateToeToHeel(const Transform& frameOfReference, float
     const auto legRotation = CalculateLegRotation(toeTargetPosition, originalDirection, currentDirection);
     const Vector3 approximateBendDirection = legRotation * originalDirection;
 
-    const Vector3 toeToHeelMin = footRotation * legRotation * node_->GetWorldRotation() * local_.toeToHeel_;
+    const Vector3 toeToHeelMin = footRotation * legRotation * GetNodeWorldRotation(node_) * local_.toeToHeel_;
     const Vector3 toeToHeelMax = CalculateToeToHeelBent(toeTargetPosition, approximateBendDirection);
 
     const Vector3 toeToHeelDirection = Lerp(toeToHeelMin, toeToHeelMax, tiptoeFactor);
@@ -403,7 +404,7 @@ void IKLegSolver::SolveInternal(const Transform& frameOfReference, const IKSetti
     // Apply target rotation if needed
     if (rotationWeight_ > 0.0f)
     {
-        const Quaternion targetRotation = target_->GetWorldRotation() * toeBone.localOriginalRotation_;
+        const Quaternion targetRotation = GetNodeWorldRotation(target_) * toeBone.localOriginalRotation_;
         toeBone.rotation_ = toeBone.rotation_.Slerp(targetRotation, rotationWeight_);
     }
 }
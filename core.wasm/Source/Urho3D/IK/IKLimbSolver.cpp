@@ -138,7 +138,7 @@ void IKLimbSolver::SolveInternal(const Transform& frameOfReference, const IKSett
     // Apply target rotation if needed
     if (rotationWeight_ > 0.0f)
     {
-        const Quaternion targetRotation = target_->GetWorldRotation() * thirdBone.localOriginalRotation_;
+        const Quaternion targetRotation = GetNodeWorldRotation(target_) * thirdBone.localOriginalRotation_;
         thirdBone.rotation_ = thirdBone.rotation_.Slerp(targetRotation, rotationWeight_);
     }
 }
@@ -150,7 +150,7 @@ Vector3 IKLimbSolver::GetTargetPosition() const
     const float minDistance = 0.001f;
     const float maxDistance = GetMaxDistance(chain_, maxAngle_);
     const Vector3& origin = firstBone.position_;
-    const Vector3& target = target_->GetWorldPosition();
+    const Vector3 target = GetNodeWorldPosition(target_);
     return origin + (target - origin).ReNormalized(minDistance, maxDistance);
 }
 
@@ -159,13 +159,14 @@ ea::pair<Vector3, Vector3> IKLimbSolver::CalculateBendDirections(
 {
     BendCalculationParams params;
 
-    params.parentNodeRotation_ = node_->GetWorldRotation();
+    params.parentNodeRotation_ = GetNodeWorldRotation(node_);
     params.startPosition_ = chain_.GetBeginNode()->position_;
     params.targetPosition_ = targetPosition;
     params.targetDirectionInLocalSpace_ = local_.targetDirection_;
     params.bendDirectionInNodeSpace_ = bendDirection_;
     params.bendDirectionInLocalSpace_ = local_.bendDirection_;
-    params.bendTarget_ = bendTarget_;
+    if (bendTarget_)
+        params.bendTargetPosition_ = GetNodeWorldPosition(bendTarget_);
     params.bendTargetWeight_ = bendWeight_;
 
     return CalculateBendDirectionsInternal(frameOfReference, params);
@@ -28,20 +28,29 @@
 #include "Urho3D/Graphics/AnimatedModel.h"
 #include "Urho3D/Graphics/AnimationController.h"
 #include "Urho3D/IK/IKEvents.h"
+#include "Urho3D/IK/IKSolverSystem.h"
 #include "Urho3D/IO/Log.h"
 #include "Urho3D/Scene/Node.h"
 #include "Urho3D/Scene/Scene.h"
 
+#include <EASTL/sort.h>
+
 namespace Urho3D
 {
 
 IKSolver::IKSolver(Context* context)
     : LogicComponent(context)
+    , system_(context->GetSubsystem<IKSolverSystem>())
 {
+    // IKSolverSystem solves all characters in the scene at once
+    if (system_)
+        SetUpdateEventMask(USE_NO_EVENT);
 }
 
 IKSolver::~IKSolver()
 {
+    if (system_)
+        system_->RemoveSolver(this);
 }
 
 void IKSolver::RegisterObject(Context* context)
@@ -69,22 +78,123 @@ void IKSolver::OnNodeSet(Node* previousNode, Node* currentNode)
     }
 }
 
+void IKSolver::OnSceneSet(Scene* scene)
+{
+    LogicComponent::OnSceneSet(scene);
+    UpdateSystemRegistration();
+}
+
+void IKSolver::OnSetEnabled()
+{
+    LogicComponent::OnSetEnabled();
+    UpdateSystemRegistration();
+}
+
+void IKSolver::UpdateSystemRegistration()
+{
+    if (!system_)
+        return;
+
+    if (GetScene() && IsEnabledEffective())
+        system_->AddSolver(this);
+    else
+        system_->RemoveSolver(this);
+}
+
 void IKSolver::PostUpdate(float timeStep)
+{
+    if (IsSolveNeeded())
+        Solve(timeStep);
+}
+
+bool IKSolver::IsSolveNeeded() const
 {
     if (!node_)
-        return;
+        return false;
 
     auto scene = GetScene();
+    if (!scene)
+        return false;
 
     // Cannot solve when paused if there's no AnimatedModel because it will disturb original pose.
-    if (solveWhenPaused_ && !node_->HasComponent<AnimatedModel>())
-        solveWhenPaused_ = false;
-
-    if (scene->IsUpdateEnabled() || solveWhenPaused_)
-        Solve(timeStep);
+    const bool solveWhenPaused = solveWhenPaused_ && node_->HasComponent<AnimatedModel>();
+    return scene->IsUpdateEnabled() || solveWhenPaused;
 }
 
 void IKSolver::Solve(float timeStep)
+{
+    if (!UpdateSolvers())
+        return;
+
+    SendIKEvent(true);
+    SolveInternal(timeStep);
+    SendIKEvent(false);
+
+    cachedPose_.clear();
+    UpdateBoneBoundingBox();
+}
+
+bool IKSolver::BeginBatchedSolve(float timeStep, bool cachePose, bool skipFrame, bool useSnapshot)
+{
+    pendingTimeStep_ += timeStep;
+
+    if (!UpdateSolvers())
+    {
+        // Time is not accumulated while there is nothing to solve
+        pendingTimeStep_ = 0.0f;
+        cachedPose_.clear();
+        return false;
+    }
+
+    cachePose_ = cachePose;
+    useCachedPose_ = cachePose && skipFrame && !cachedPose_.empty();
+    useSnapshot_ = useSnapshot && !useCachedPose_;
+    if (!cachePose)
+        cachedPose_.clear();
+
+    if (useCachedPose_)
+        return true;
+
+    SendIKEvent(true);
+
+    // Capture transforms after the event so the targets moved by event handlers are up to date.
+    // Reading the scene from worker threads is safe because nothing modifies it until EndBatchedSolve.
+    if (useSnapshot_)
+    {
+        if (snapshot_.IsEmpty())
+            InitializeSnapshot();
+        snapshot_.Capture();
+    }
+
+    return true;
+}
+
+void IKSolver::SolveBatched()
+{
+    if (useCachedPose_)
+        return;
+
+    SolveInternal(pendingTimeStep_, useSnapshot_ ? &snapshot_ : nullptr);
+    pendingTimeStep_ = 0.0f;
+}
+
+void IKSolver::EndBatchedSolve()
+{
+    if (useCachedPose_)
+        ApplyCachedPose();
+    else
+    {
+        if (useSnapshot_)
+            snapshot_.Apply();
+        if (cachePose_)
+            CachePose();
+        SendIKEvent(false);
+    }
+
+    UpdateBoneBoundingBox();
+}
+
+bool IKSolver::UpdateSolvers()
 {
     if (IsChainTreeExpired())
         solversDirty_ = true;
@@ -92,22 +202,62 @@ void IKSolver::Solve(float timeStep)
     if (solversDirty_)
     {
         solversDirty_ = false;
+        cachedPose_.clear();
+        snapshot_.Clear();
         node_->GetDerivedComponents(solvers_, true);
         RebuildSolvers();
     }
 
-    if (solvers_.empty() || solverNodes_.empty())
-        return;
+    return !solvers_.empty() && !solverNodes_.empty();
+}
+
+void IKSolver::InitializeSnapshot()
+{
+    ea::vector<Node*> nodes;
+    nodes.push_back(node_);
+    for (const auto& [node, _] : solverNodes_)
+        nodes.push_back(node.Get());
+    for (IKSolverComponent* solver : solvers_)
+        solver->CollectSnapshotNodes(nodes);
+
+    snapshot_.Initialize(nodes);
+}
+
+void IKSolver::SolveInternal(float timeStep, IKTransformSnapshot* snapshot)
+{
+    modifiedNodes_.clear();
 
-    SendIKEvent(true);
     UpdateOriginalTransforms();
     for (IKSolverComponent* solver : solvers_)
     {
         URHO3D_ASSERT(solver);
-        solver->Solve(settings_, timeStep);
+        solver->Solve(settings_, timeStep, snapshot);
+        solver->CollectModifiedNodes(modifiedNodes_);
     }
-    SendIKEvent(false);
+}
+
+void IKSolver::CachePose()
+{
+    ea::sort(modifiedNodes_.begin(), modifiedNodes_.end());
+    modifiedNodes_.erase(ea::unique(modifiedNodes_.begin(), modifiedNodes_.end()), modifiedNodes_.end());
+
+    cachedPose_.clear();
+    for (Node* node : modifiedNodes_)
+        cachedPose_.push_back(CachedNodeTransform{WeakPtr<Node>(node), node->GetPosition(), node->GetRotation()});
+}
 
+void IKSolver::ApplyCachedPose()
+{
+    // Local transforms are applied so cached pose follows the character
+    for (const CachedNodeTransform& cachedTransform : cachedPose_)
+    {
+        if (cachedTransform.node_)
+            cachedTransform.node_->SetTransform(cachedTransform.position_, cachedTransform.rotation_);
+    }
+}
+
+void IKSolver::UpdateBoneBoundingBox()
+{
     if (auto animatedModel = node_->GetComponent<AnimatedModel>())
         animatedModel->UpdateBoneBoundingBox();
 }
@@ -29,6 +29,8 @@
 namespace Urho3D
 {
 
+class IKSolverSystem;
+
 class IKSolver : public LogicComponent
 {
     URHO3D_OBJECT(IKSolver, LogicComponent);
@@ -42,6 +44,8 @@ public:
     void MarkSolversDirty() { solversDirty_ = true; }
     /// Solve the IK forcibly.
     void Solve(float timeStep);
+    /// Return whether the IK should be solved in the current scene state.
+    bool IsSolveNeeded() const;
 
     void PostUpdate(float timeStep) override;
     StringHash GetPostUpdateEvent() const override { return E_SCENEDRAWABLEUPDATEFINISHED; }
@@ -57,8 +61,38 @@ public:
     /// Find bone data by Node.
     const IKNode* GetNodeData(Node* node) const;
 
+    /// Batched solving. Internal, used by IKSolverSystem.
+    /// @{
+    /// Prepare solve on the main thread. Return false if there is nothing to solve.
+    /// If the pose is cached and the frame is skipped, cached bone transforms will be applied instead of solving.
+    /// If snapshot is used, solve doesn't modify the scene and may be performed on worker thread.
+    bool BeginBatchedSolve(float timeStep, bool cachePose, bool skipFrame, bool useSnapshot);
+    /// Solve IK. Scene nodes are not modified if snapshot is used.
+    void SolveBatched();
+    /// Finish solve on the main thread. Solved or cached pose is applied to the scene nodes.
+    void EndBatchedSolve();
+    /// @}
+
 private:
+    /// Cached local transform of bone node modified by IK.
+    struct CachedNodeTransform
+    {
+        WeakPtr<Node> node_;
+        Vector3 position_;
+        Quaternion rotation_;
+    };
+
     void OnNodeSet(Node* previousNode, Node* currentNode) override;
+    void OnSceneSet(Scene* scene) override;
+    void OnSetEnabled() override;
+    void UpdateSystemRegistration();
+
+    bool UpdateSolvers();
+    void InitializeSnapshot();
+    void SolveInternal(float timeStep, IKTransformSnapshot* snapshot = nullptr);
+    void CachePose();
+    void ApplyCachedPose();
+    void UpdateBoneBoundingBox();
 
     bool IsChainTreeExpired() const;
     void RebuildSolvers();
@@ -74,6 +108,21 @@ private:
     ea::vector<WeakPtr<IKSolverComponent>> solvers_;
 
     IKNodeCache solverNodes_;
+
+    /// Batched solve state.
+    /// @{
+    WeakPtr<IKSolverSystem> system_;
+    unsigned systemIndex_{M_MAX_UNSIGNED};
+    float pendingTimeStep_{};
+    bool cachePose_{};
+    bool useCachedPose_{};
+    bool useSnapshot_{};
+    IKTransformSnapshot snapshot_;
+    ea::vector<CachedNodeTransform> cachedPose_;
+    ea::vector<Node*> modifiedNodes_;
+    /// @}
+
+    friend class IKSolverSystem;
 };
 
 } // namespace Urho3D
@@ -6,6 +6,7 @@
 
 #include "Urho3D/IK/IKSolverComponent.h"
 
+#include "Urho3D/Core/Assert.h"
 #include "Urho3D/Core/Context.h"
 #include "Urho3D/Graphics/DebugRenderer.h"
 #include "Urho3D/IK/IKSolver.h"
@@ -13,6 +14,8 @@
 #include "Urho3D/Math/Sphere.h"
 #include "Urho3D/Scene/Node.h"
 
+#include <EASTL/sort.h>
+
 namespace Urho3D
 {
 
@@ -33,8 +36,130 @@ void DrawNode(DebugRenderer* debug, bool oriented, const Vector3& position, cons
     }
 }
 
+unsigned GetNodeDepth(const Node* node)
+{
+    unsigned depth = 0;
+    for (const Node* parent = node->GetParent(); parent; parent = parent->GetParent())
+        ++depth;
+    return depth;
+}
+
 } // namespace
 
+void IKTransformSnapshot::Initialize(ea::span<Node* const> nodes)
+{
+    Clear();
+
+    ea::vector<ea::pair<unsigned, Node*>> sortedNodes;
+    for (Node* node : nodes)
+    {
+        if (node && nodeToIndex_.emplace(node, 0).second)
+            sortedNodes.emplace_back(GetNodeDepth(node), node);
+    }
+    ea::stable_sort(sortedNodes.begin(), sortedNodes.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    entries_.resize(sortedNodes.size());
+    for (unsigned i = 0; i < sortedNodes.size(); ++i)
+    {
+        Node* node = sortedNodes[i].second;
+        nodeToIndex_[node] = i;
+
+        Entry& entry = entries_[i];
+        entry.node_ = node;
+        for (const Node* parent = node->GetParent(); parent; parent = parent->GetParent())
+        {
+            const unsigned parentIndex = FindNode(parent);
+            if (parentIndex != M_MAX_UNSIGNED)
+            {
+                entry.parentIndex_ = parentIndex;
+                break;
+            }
+        }
+    }
+}
+
+void IKTransformSnapshot::Clear()
+{
+    entries_.clear();
+    nodeToIndex_.clear();
+}
+
+void IKTransformSnapshot::Capture()
+{
+    for (unsigned i = 0; i < entries_.size(); ++i)
+    {
+        Entry& entry = entries_[i];
+        entry.worldTransform_ = Transform{
+            entry.node_->GetWorldPosition(), entry.node_->GetWorldRotation(), entry.node_->GetWorldScale()};
+        entry.positionModified_ = false;
+        entry.rotationModified_ = false;
+        UpdateLocalTransform(i);
+    }
+}
+
+void IKTransformSnapshot::Apply() const
+{
+    // Ancestors are applied first, so world transforms of descendants are evaluated correctly
+    for (const Entry& entry : entries_)
+    {
+        if (entry.positionModified_)
+            entry.node_->SetWorldPosition(entry.worldTransform_.position_);
+        if (entry.rotationModified_)
+            entry.node_->SetWorldRotation(entry.worldTransform_.rotation_);
+    }
+}
+
+unsigned IKTransformSnapshot::FindNode(const Node* node) const
+{
+    const auto iter = nodeToIndex_.find(node);
+    return iter != nodeToIndex_.end() ? iter->second : M_MAX_UNSIGNED;
+}
+
+void IKTransformSnapshot::SetWorldPosition(unsigned index, const Vector3& position)
+{
+    Entry& entry = entries_[index];
+    entry.worldTransform_.position_ = position;
+    entry.positionModified_ = true;
+    UpdateLocalTransform(index);
+    UpdateChildren(index);
+}
+
+void IKTransformSnapshot::SetWorldRotation(unsigned index, const Quaternion& rotation)
+{
+    Entry& entry = entries_[index];
+    entry.worldTransform_.rotation_ = rotation;
+    entry.rotationModified_ = true;
+    UpdateLocalTransform(index);
+    UpdateChildren(index);
+}
+
+void IKTransformSnapshot::UpdateLocalTransform(unsigned index)
+{
+    Entry& entry = entries_[index];
+    if (entry.parentIndex_ != M_MAX_UNSIGNED)
+        entry.localTransform_ = entries_[entry.parentIndex_].worldTransform_.Inverse() * entry.worldTransform_;
+    else
+        entry.localTransform_ = entry.worldTransform_;
+}
+
+void IKTransformSnapshot::UpdateChildren(unsigned index)
+{
+    // Descendants are always located after the ancestor
+    entries_[index].updateMark_ = true;
+    for (unsigned i = index + 1; i < entries_.size(); ++i)
+    {
+        Entry& entry = entries_[i];
+        if (entry.parentIndex_ != M_MAX_UNSIGNED && entries_[entry.parentIndex_].updateMark_)
+        {
+            entry.worldTransform_ = entries_[entry.parentIndex_].worldTransform_ * entry.localTransform_;
+            entry.updateMark_ = true;
+        }
+    }
+    for (unsigned i = index; i < entries_.size(); ++i)
+        entries_[i].updateMark_ = false;
+}
+
 IKSolverComponent::IKSolverComponent(Context* context)
     : Component(context)
 {
@@ -72,7 +197,7 @@ bool IKSolverComponent::Initialize(IKNodeCache& nodeCache)
 Transform IKSolverComponent::GetFrameOfReferenceTransform() const
 {
     if (frameOfReferenceNode_)
-        return {frameOfReferenceNode_->GetWorldPosition(), frameOfReferenceNode_->GetWorldRotation()};
+        return {GetNodeWorldPosition(frameOfReferenceNode_), GetNodeWorldRotation(frameOfReferenceNode_)};
     else
         return {};
 }
@@ -83,13 +208,15 @@ void IKSolverComponent::NotifyPositionsReady()
     UpdateChainLengths(frameOfReference.Inverse());
 }
 
-void IKSolverComponent::Solve(const IKSettings& settings, float timeStep)
+void IKSolverComponent::Solve(const IKSettings& settings, float timeStep, IKTransformSnapshot* snapshot)
 {
+    snapshot_ = snapshot;
+
     for (const auto& [node, solverNode] : solverNodes_)
     {
         solverNode->StorePreviousTransform();
-        solverNode->position_ = node->GetWorldPosition();
-        solverNode->rotation_ = node->GetWorldRotation();
+        solverNode->position_ = GetNodeWorldPosition(node);
+        solverNode->rotation_ = GetNodeWorldRotation(node);
     }
 
     const Transform frameOfReference = GetFrameOfReferenceTransform();
@@ -98,9 +225,27 @@ void IKSolverComponent::Solve(const IKSettings& settings, float timeStep)
     for (const auto& [node, solverNode] : solverNodes_)
     {
         if (solverNode->positionDirty_)
-            node->SetWorldPosition(solverNode->position_);
+            SetNodeWorldPosition(node, solverNode->position_);
         if (solverNode->rotationDirty_)
-            node->SetWorldRotation(solverNode->rotation_);
+            SetNodeWorldRotation(node, solverNode->rotation_);
+    }
+
+    snapshot_ = nullptr;
+}
+
+void IKSolverComponent::CollectSnapshotNodes(ea::vector<Node*>& nodes) const
+{
+    nodes.push_back(node_);
+    if (frameOfReferenceNode_)
+        nodes.push_back(frameOfReferenceNode_);
+}
+
+void IKSolverComponent::CollectModifiedNodes(ea::vector<Node*>& nodes) const
+{
+    for (const auto& [node, solverNode] : solverNodes_)
+    {
+        if (solverNode->positionDirty_ || solverNode->rotationDirty_)
+            nodes.push_back(node);
     }
 }
 
@@ -177,6 +322,44 @@ void IKSolverComponent::SetParentAsFrameOfReference(const IKNode& childNode)
     SetFrameOfReference(parent);
 }
 
+Vector3 IKSolverComponent::GetNodeWorldPosition(const Node* node) const
+{
+    const unsigned index = snapshot_ ? snapshot_->FindNode(node) : M_MAX_UNSIGNED;
+    return index != M_MAX_UNSIGNED ? snapshot_->GetWorldTransform(index).position_ : node->GetWorldPosition();
+}
+
+Quaternion IKSolverComponent::GetNodeWorldRotation(const Node* node) const
+{
+    const unsigned index = snapshot_ ? snapshot_->FindNode(node) : M_MAX_UNSIGNED;
+    return index != M_MAX_UNSIGNED ? snapshot_->GetWorldTransform(index).rotation_ : node->GetWorldRotation();
+}
+
+void IKSolverComponent::SetNodeWorldPosition(Node* node, const Vector3& position)
+{
+    if (!snapshot_)
+    {
+        node->SetWorldPosition(position);
+        return;
+    }
+
+    const unsigned index = snapshot_->FindNode(node);
+    URHO3D_ASSERT(index != M_MAX_UNSIGNED, "Node modified by IK solver is not in the snapshot");
+    snapshot_->SetWorldPosition(index, position);
+}
+
+void IKSolverComponent::SetNodeWorldRotation(Node* node, const Quaternion& rotation)
+{
+    if (!snapshot_)
+    {
+        node->SetWorldRotation(rotation);
+        return;
+    }
+
+    const unsigned index = snapshot_->FindNode(node);
+    URHO3D_ASSERT(index != M_MAX_UNSIGNED, "Node modified by IK solver is not in the snapshot");
+    snapshot_->SetWorldRotation(index, rotation);
+}
+
 void IKSolverComponent::DrawIKNode(DebugRenderer* debug, const IKNode& node, bool oriented) const
 {
     static const float radius = 0.02f;
@@ -224,8 +407,8 @@ void IKSolverComponent::DrawDirection(
 ea::pair<Vector3, Vector3> IKSolverComponent::CalculateBendDirectionsInternal(
     const Transform& frameOfReference, const BendCalculationParams& params)
 {
-    const float bendTargetWeight = params.bendTarget_ ? params.bendTargetWeight_ : 0.0f;
-    const Vector3 bendTargetPosition = params.bendTarget_ ? params.bendTarget_->GetWorldPosition() : Vector3::ZERO;
+    const float bendTargetWeight = params.bendTargetPosition_ ? params.bendTargetWeight_ : 0.0f;
+    const Vector3 bendTargetPosition = params.bendTargetPosition_.value_or(Vector3::ZERO);
     const Vector3 bendTargetDirection = bendTargetPosition - Lerp(params.startPosition_, params.targetPosition_, 0.5f);
 
     const Quaternion chainRotation{frameOfReference.rotation_ * params.targetDirectionInLocalSpace_,
@@ -9,11 +9,62 @@
 #include "Urho3D/Math/Transform.h"
 #include "Urho3D/Scene/Component.h"
 
+#include <EASTL/optional.h>
+#include <EASTL/span.h>
+
 namespace Urho3D
 {
 
 using IKNodeCache = ea::unordered_map<WeakPtr<Node>, IKNode>;
 
+/// Snapshot of world transforms of the nodes accessed by solvers of one character.
+/// Solvers read and write the snapshot instead of scene nodes, so IK can be solved on worker threads.
+/// Hierarchy between snapshot nodes is preserved: moving a node moves its snapshot descendants.
+class URHO3D_API IKTransformSnapshot
+{
+public:
+    /// Set nodes to snapshot. Duplicates are ignored. Should be called from main thread.
+    void Initialize(ea::span<Node* const> nodes);
+    /// Forget all nodes.
+    void Clear();
+    /// Read current world transforms of the nodes. Should be called from main thread.
+    void Capture();
+    /// Write modified transforms to the nodes. Should be called from main thread.
+    void Apply() const;
+
+    /// Return index of the node in the snapshot or M_MAX_UNSIGNED if not found.
+    unsigned FindNode(const Node* node) const;
+    /// Return world transform of the node in the snapshot.
+    const Transform& GetWorldTransform(unsigned index) const { return entries_[index].worldTransform_; }
+    /// Set world position of the node in the snapshot.
+    void SetWorldPosition(unsigned index, const Vector3& position);
+    /// Set world rotation of the node in the snapshot.
+    void SetWorldRotation(unsigned index, const Quaternion& rotation);
+
+    bool IsEmpty() const { return entries_.empty(); }
+
+private:
+    struct Entry
+    {
+        Node* node_{};
+        /// Index of the closest ancestor in the snapshot.
+        unsigned parentIndex_{M_MAX_UNSIGNED};
+        /// Transform relative to the closest ancestor in the snapshot, or world transform if there is none.
+        Transform localTransform_;
+        Transform worldTransform_;
+        bool positionModified_{};
+        bool rotationModified_{};
+        bool updateMark_{};
+    };
+
+    void UpdateLocalTransform(unsigned index);
+    void UpdateChildren(unsigned index);
+
+    /// Entries sorted so that ancestors go before descendants.
+    ea::vector<Entry> entries_;
+    ea::unordered_map<const Node*, unsigned> nodeToIndex_;
+};
+
 /// Base component for all IK solvers.
 class URHO3D_API IKSolverComponent : public Component
 {
@@ -26,7 +77,12 @@ public:
 
     bool Initialize(IKNodeCache& nodeCache);
     void NotifyPositionsReady();
-    void Solve(const IKSettings& settings, float timeStep);
+    /// Solve IK. If snapshot is provided, nodes are accessed via the snapshot and scene is not modified.
+    void Solve(const IKSettings& settings, float timeStep, IKTransformSnapshot* snapshot = nullptr);
+    /// Append nodes accessed by the solver besides the ones in node cache.
+    void CollectSnapshotNodes(ea::vector<Node*>& nodes) const;
+    /// Append nodes modified by the last Solve call.
+    void CollectModifiedNodes(ea::vector<Node*>& nodes) const;
 
     /// Internal. Marks chain tree as dirty.
     void OnTreeDirty();
@@ -50,6 +106,14 @@ protected:
     /// Same as SetFrameOfReference, except it accepts first child of the node.
     void SetParentAsFrameOfReference(const IKNode& childNode);
 
+    /// Access world transforms of the nodes during solve. Snapshot is used if solving on worker thread.
+    /// @{
+    Vector3 GetNodeWorldPosition(const Node* node) const;
+    Quaternion GetNodeWorldRotation(const Node* node) const;
+    void SetNodeWorldPosition(Node* node, const Vector3& position);
+    void SetNodeWorldRotation(Node* node, const Quaternion& rotation);
+    /// @}
+
     /// Draw IK node in DebugRenderer.
     void DrawIKNode(DebugRenderer* debug, const IKNode& node, bool oriented) const;
     /// Draw IK segment line in DebugRenderer.
@@ -72,7 +136,7 @@ protected:
         Vector3 bendDirectionInNodeSpace_;
         Vector3 bendDirectionInLocalSpace_;
 
-        Node* bendTarget_{};
+        ea::optional<Vector3> bendTargetPosition_;
         float bendTargetWeight_{};
     };
 
@@ -86,6 +150,8 @@ private:
 
     ea::vector<ea::pair<Node*, IKNode*>> solverNodes_;
     WeakPtr<Node> frameOfReferenceNode_;
+    /// Snapshot used by current solve, if any.
+    IKTransformSnapshot* snapshot_{};
 };
 
 } // namespace Urho3D
@@ -0,0 +1,133 @@
+// Copyright (c) 2022-2023 the rbfx project.
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT> or the accompanying LICENSE file.
+
+#include "Urho3D/Precompiled.h"
+
+#include "Urho3D/IK/IKSolverSystem.h"
+
+#include "Urho3D/Core/Assert.h"
+#include "Urho3D/Core/Profiler.h"
+#include "Urho3D/Core/WorkQueue.h"
+#include "Urho3D/IK/IKSolver.h"
+#include "Urho3D/Scene/Node.h"
+#include "Urho3D/Scene/Scene.h"
+#include "Urho3D/Scene/SceneEvents.h"
+
+namespace Urho3D
+{
+
+IKSolverSystem::IKSolverSystem(Context* context)
+    : Object(context)
+{
+    SubscribeToEvent(E_SCENEDRAWABLEUPDATEFINISHED, URHO3D_HANDLER(IKSolverSystem, HandleSceneDrawableUpdateFinished));
+}
+
+IKSolverSystem::~IKSolverSystem()
+{
+    for (IKSolver* solver : solvers_)
+        solver->systemIndex_ = M_MAX_UNSIGNED;
+}
+
+void IKSolverSystem::AddSolver(IKSolver* solver)
+{
+    if (solver->systemIndex_ != M_MAX_UNSIGNED)
+        return;
+
+    solver->systemIndex_ = solvers_.size();
+    solvers_.push_back(solver);
+}
+
+void IKSolverSystem::RemoveSolver(IKSolver* solver)
+{
+    const unsigned index = solver->systemIndex_;
+    if (index == M_MAX_UNSIGNED)
+        return;
+
+    URHO3D_ASSERT(index < solvers_.size() && solvers_[index] == solver);
+
+    solvers_[index] = solvers_.back();
+    solvers_[index]->systemIndex_ = index;
+    solvers_.pop_back();
+    solver->systemIndex_ = M_MAX_UNSIGNED;
+}
+
+void IKSolverSystem::SetObserver(Node* node)
+{
+    observer_ = node;
+}
+
+void IKSolverSystem::SolveScene(Scene* scene, float timeStep)
+{
+    URHO3D_PROFILE("SolveIK");
+
+    ++frameIndex_;
+
+    parallelSolvers_.clear();
+    serialSolvers_.clear();
+    for (IKSolver* solver : solvers_)
+    {
+        if (solver->GetScene() != scene || !solver->IsSolveNeeded())
+            continue;
+
+        const bool reducedRate = IsReducedRate(solver, scene);
+        // Spread solves of distant characters evenly between frames
+        const bool skipFrame = reducedRate && (frameIndex_ + solver->systemIndex_) % reducedRateInterval_ != 0;
+        // Nested characters depend on the pose of the parent character and are solved after it on the main thread
+        const bool isNested = IsNestedSolver(solver);
+        if (!solver->BeginBatchedSolve(timeStep, reducedRate, skipFrame, !isNested))
+            continue;
+
+        if (isNested)
+            serialSolvers_.push_back(solver);
+        else
+            parallelSolvers_.push_back(solver);
+    }
+
+    // Characters are solved into their own transform snapshots, the scene is not modified from worker threads.
+    if (!parallelSolvers_.empty())
+    {
+        auto* workQueue = GetSubsystem<WorkQueue>();
+        ForEachParallel(workQueue, parallelSolvers_, [](unsigned, IKSolver* solver) { solver->SolveBatched(); });
+    }
+
+    for (IKSolver* solver : parallelSolvers_)
+        solver->EndBatchedSolve();
+
+    for (IKSolver* solver : serialSolvers_)
+    {
+        solver->SolveBatched();
+        solver->EndBatchedSolve();
+    }
+}
+
+bool IKSolverSystem::IsNestedSolver(IKSolver* solver) const
+{
+    for (Node* parent = solver->GetNode()->GetParent(); parent; parent = parent->GetParent())
+    {
+        if (parent->HasComponent<IKSolver>())
+            return true;
+    }
+    return false;
+}
+
+bool IKSolverSystem::IsReducedRate(IKSolver* solver, Scene* scene) const
+{
+    if (reducedRateInterval_ <= 1 || !observer_ || observer_->GetScene() != scene)
+        return false;
+
+    const Vector3 offset = solver->GetNode()->GetWorldPosition() - observer_->GetWorldPosition();
+    return offset.LengthSquared() > reducedRateDistance_ * reducedRateDistance_;
+}
+
+void IKSolverSystem::HandleSceneDrawableUpdateFinished(StringHash eventType, VariantMap& eventData)
+{
+    using namespace SceneDrawableUpdateFinished;
+
+    auto* scene = static_cast<Scene*>(eventData[P_SCENE].GetPtr());
+    const float timeStep = eventData[P_TIMESTEP].GetFloat();
+    if (scene)
+        SolveScene(scene, timeStep);
+}
+
+} // namespace Urho3D
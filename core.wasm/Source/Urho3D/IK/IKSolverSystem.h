@@ -0,0 +1,73 @@
+// Copyright (c) 2022-2023 the rbfx project.
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT> or the accompanying LICENSE file.
+
+#pragma once
+
+#include "Urho3D/Core/Object.h"
+#include "Urho3D/Container/Ptr.h"
+
+namespace Urho3D
+{
+
+class IKSolver;
+class Node;
+class Scene;
+
+/// Subsystem that solves IK of all characters in the scene on WorkQueue threads.
+/// Transforms are captured and applied on the main thread, characters are solved in parallel into snapshots.
+/// Characters far from observer node may be solved at reduced rate, reusing cached pose in between.
+class URHO3D_API IKSolverSystem : public Object
+{
+    URHO3D_OBJECT(IKSolverSystem, Object);
+
+public:
+    explicit IKSolverSystem(Context* context);
+    ~IKSolverSystem() override;
+
+    /// Add solver to the registry of active solvers. Called by IKSolver.
+    void AddSolver(IKSolver* solver);
+    /// Remove solver from the registry of active solvers. Called by IKSolver.
+    void RemoveSolver(IKSolver* solver);
+    /// Solve all active IK solvers in the scene.
+    void SolveScene(Scene* scene, float timeStep);
+
+    /// Attributes.
+    /// @{
+    void SetObserver(Node* node);
+    Node* GetObserver() const { return observer_; }
+    void SetReducedRateDistance(float distance) { reducedRateDistance_ = distance; }
+    float GetReducedRateDistance() const { return reducedRateDistance_; }
+    void SetReducedRateInterval(unsigned interval) { reducedRateInterval_ = ea::max(interval, 1u); }
+    unsigned GetReducedRateInterval() const { return reducedRateInterval_; }
+    /// @}
+
+    /// Return number of active solvers in all scenes.
+    unsigned GetNumSolvers() const { return solvers_.size(); }
+
+private:
+    /// Handle drawable update finished event.
+    void HandleSceneDrawableUpdateFinished(StringHash eventType, VariantMap& eventData);
+    /// Return whether the solver is a descendant of another character.
+    bool IsNestedSolver(IKSolver* solver) const;
+    /// Return whether the solver should use reduced rate.
+    bool IsReducedRate(IKSolver* solver, Scene* scene) const;
+
+    /// Active solvers in all scenes.
+    ea::vector<IKSolver*> solvers_;
+    /// Independent solvers processed in parallel this frame.
+    ea::vector<IKSolver*> parallelSolvers_;
+    /// Nested solvers processed on the main thread this frame.
+    ea::vector<IKSolver*> serialSolvers_;
+
+    /// Node used to evaluate distance to characters.
+    WeakPtr<Node> observer_;
+    /// Distance from observer after which reduced rate is used.
+    float reducedRateDistance_{M_LARGE_VALUE};
+    /// Solve interval in frames for distant characters.
+    unsigned reducedRateInterval_{1};
+    /// Frame counter used to distribute reduced rate solves between frames.
+    unsigned frameIndex_{};
+};
+
+} // namespace Urho3D
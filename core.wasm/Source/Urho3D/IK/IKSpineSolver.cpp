@@ -151,7 +151,7 @@ void IKSpineSolver::UpdateTwistRotationOffset()
         const ea::string& twistBoneName = boneNames_[boneNames_.size() - 2];
         Node* boneNode = node_->GetChild(twistBoneName, true);
         if (boneNode)
-            twistRotationOffset_ = node_->GetWorldRotation().Inverse() * boneNode->GetWorldRotation();
+            twistRotationOffset_ = GetNodeWorldRotation(node_).Inverse() * GetNodeWorldRotation(boneNode);
     }
 }
 
@@ -192,7 +192,7 @@ void IKSpineSolver::SolveInternal(const Transform& frameOfReference, const IKSet
     SetOriginalTransforms(frameOfReference);
     const Vector3 baseDirection = frameOfReference.rotation_ * local_.baseDirection_;
     const auto weightFunction = [this](float x) { return WeightFunction(x); };
-    chain_.Solve(target_->GetWorldPosition(), baseDirection, maxAngle_, settings, weightFunction);
+    chain_.Solve(GetNodeWorldPosition(target_), baseDirection, maxAngle_, settings, weightFunction);
 
     // Interpolate rotation to apply solver weight
     for (size_t i = 0; i < bones.size(); ++i)
@@ -207,7 +207,7 @@ void IKSpineSolver::SolveInternal(const Transform& frameOfReference, const IKSet
     if (rotationWeight_ > 0.0f)
     {
         IKNode& lastBone = *bones.back();
-        const Quaternion targetRotation = target_->GetWorldRotation() * lastBone.localOriginalRotation_;
+        const Quaternion targetRotation = GetNodeWorldRotation(target_) * lastBone.localOriginalRotation_;
         lastBone.rotation_ = lastBone.rotation_.Slerp(targetRotation, rotationWeight_);
     }
 }
@@ -216,7 +216,7 @@ float IKSpineSolver::GetTwistAngle(
     const Transform& frameOfReference, const IKNodeSegment& segment, Node* targetNode) const
 {
     const Quaternion zeroTwistBoneRotation = frameOfReference.rotation_ * local_.zeroTwistRotation_;
-    const Quaternion targetBoneRotation = targetNode->GetWorldRotation() * segment.beginNode_->localOriginalRotation_;
+    const Quaternion targetBoneRotation = GetNodeWorldRotation(targetNode) * segment.beginNode_->localOriginalRotation_;
     const Quaternion deltaRotation = targetBoneRotation * zeroTwistBoneRotation.Inverse();
 
     const Vector3 direction = (segment.endNode_->position_ - segment.beginNode_->position_).Normalized();
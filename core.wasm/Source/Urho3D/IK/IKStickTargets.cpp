@@ -86,7 +86,7 @@ void IKStickTargets::SolveInternal(const Transform& frameOfReference, const IKSe
 void IKStickTargets::CollectDesiredWorldTransforms()
 {
     for (TargetInfo& info : targets_)
-        info.desiredWorldTransform_ = Transform{info.node_->GetWorldPosition(), info.node_->GetWorldRotation()};
+        info.desiredWorldTransform_ = Transform{GetNodeWorldPosition(info.node_), GetNodeWorldRotation(info.node_)};
 }
 
 void IKStickTargets::ApplyWorldMovement(float timeStep)
@@ -196,9 +196,9 @@ void IKStickTargets::CommitWorldTransforms()
         {
             const Transform transform = info.GetCurrentTransform();
             if (isPositionSticky_)
-                info.node_->SetWorldPosition(transform.position_);
+                SetNodeWorldPosition(info.node_, transform.position_);
             if (isRotationSticky_)
-                info.node_->SetWorldRotation(transform.rotation_);
+                SetNodeWorldRotation(info.node_, transform.rotation_);
         }
     }
 }
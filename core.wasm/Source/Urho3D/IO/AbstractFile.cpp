@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2008-2022 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/WorkQueue.h"
+#include "../IO/AbstractFile.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void AbstractFile::ReadAsync(WorkQueue* workQueue, ea::vector<AsyncReadRequest> requests, AsyncReadCallback callback)
+{
+    // Generic file cannot be read concurrently, read now and keep position intact
+    const unsigned oldPosition = GetPosition();
+    for (AsyncReadRequest& request : requests)
+    {
+        request.bytesRead_ = 0;
+        if (request.offset_ < GetSize() && Seek(static_cast<unsigned>(request.offset_)) == request.offset_)
+            request.bytesRead_ = Read(request.buffer_, request.size_);
+    }
+    Seek(oldPosition);
+
+    auto batch = ea::make_shared<ea::pair<ea::vector<AsyncReadRequest>, AsyncReadCallback>>(ea::move(requests), ea::move(callback));
+    workQueue->PostTask([batch]() { batch->second(batch->first); });
+}
+
+}
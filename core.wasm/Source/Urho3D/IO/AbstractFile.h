@@ -25,8 +25,14 @@
 #include "../IO/Serializer.h"
 #include "../IO/Deserializer.h"
 
+#include <EASTL/functional.h>
+#include <EASTL/span.h>
+
 namespace Urho3D
 {
+
+class WorkQueue;
+
 /// File open mode.
 enum FileMode
 {
@@ -35,6 +41,22 @@ enum FileMode
     FILE_READWRITE
 };
 
+/// Request to read a range of the file asynchronously.
+struct AsyncReadRequest
+{
+    /// Offset from the beginning of the file.
+    unsigned long long offset_{};
+    /// Number of bytes to read.
+    unsigned size_{};
+    /// Destination buffer. Should stay alive until completion.
+    void* buffer_{};
+    /// Number of bytes actually read. Set on completion.
+    unsigned bytesRead_{};
+};
+
+/// Callback executed when all requests of the batch are completed.
+using AsyncReadCallback = ea::function<void(ea::span<AsyncReadRequest> requests)>;
+
 /// A common root class for objects that implement both Serializer and Deserializer.
 class URHO3D_API AbstractFile : public Deserializer, public Serializer
 {
@@ -56,6 +78,10 @@ public:
     virtual const ea::string& GetAbsoluteName() const { return name_; }
     /// Close the file.
     virtual void Close() {}
+    /// Read multiple ranges of the file. Callback is executed as WorkQueue task when all requests are completed.
+    /// Reads don't depend on and don't change current position. The file should stay alive until completion.
+    /// Default implementation reads synchronously and only delivers completion asynchronously.
+    virtual void ReadAsync(WorkQueue* workQueue, ea::vector<AsyncReadRequest> requests, AsyncReadCallback callback);
 
 #ifndef SWIG
     // A workaround for SWIG failing to generate bindings because both IAbstractFile and IDeserializer provide GetName() method. This is
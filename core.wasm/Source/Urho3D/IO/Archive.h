@@ -24,6 +24,7 @@
 
 #include "../Core/Exception.h"
 #include "../Core/NonCopyable.h"
+#include "../Math/MathDefs.h"
 
 #include <EASTL/string.h>
 #include <EASTL/utility.h>
@@ -130,6 +131,9 @@ public:
     virtual bool HasElementOrBlock(const char* name) const = 0;
     /// Whether the archive can no longer be serialized.
     virtual bool IsEOF() const = 0;
+    /// Return upper bound of the number of bytes that can still be read from input archive.
+    /// Used to validate sizes read from the archive before allocating memory. M_MAX_UNSIGNED if unknown.
+    virtual unsigned GetMaxRemainingInputSize() const { return M_MAX_UNSIGNED; }
     /// Return current string stack.
     virtual ea::string GetCurrentBlockPath() const = 0;
 
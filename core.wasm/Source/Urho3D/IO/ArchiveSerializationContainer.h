@@ -22,9 +22,14 @@
 
 #pragma once
 
+#include "../Container/ByteVector.h"
 #include "../IO/ArchiveSerializationBasic.h"
 #include "../IO/ArchiveSerializationVariant.h"
 
+#include <EASTL/array.h>
+
+#include <cstring>
+
 namespace Urho3D
 {
 
@@ -80,6 +85,73 @@ URHO3D_TYPE_TRAIT(IsSetType, (\
     std::declval<typename T::key_type&>() = *std::declval<T&>().begin()\
 ));
 
+/// Unsigned integer with the same bits as the value. Used to compute deltas of packed values.
+template <class T> struct PackedValueBits { using Type = ea::make_unsigned_t<T>; };
+template <> struct PackedValueBits<float> { using Type = unsigned; };
+template <> struct PackedValueBits<double> { using Type = unsigned long long; };
+
+/// Encode values as zigzag-encoded deltas between consecutive values written as variable-length integers.
+template <class T> void EncodePackedDeltas(const T* values, unsigned numValues, ByteVector& dest)
+{
+    using Bits = typename PackedValueBits<T>::Type;
+    static constexpr unsigned numBits = sizeof(Bits) * 8;
+    static constexpr unsigned maxEncodedSize = (numBits + 6) / 7;
+
+    dest.resize(numValues * maxEncodedSize);
+    unsigned char* ptr = dest.data();
+
+    Bits previous{};
+    for (unsigned i = 0; i < numValues; ++i)
+    {
+        Bits bits{};
+        memcpy(&bits, &values[i], sizeof(Bits));
+        const auto delta = static_cast<Bits>(bits - previous);
+        previous = bits;
+
+        auto encoded = static_cast<Bits>(static_cast<Bits>(delta << 1) ^ static_cast<Bits>(0 - (delta >> (numBits - 1))));
+        while (encoded >= 0x80)
+        {
+            *ptr++ = static_cast<unsigned char>(encoded | 0x80);
+            encoded = static_cast<Bits>(encoded >> 7);
+        }
+        *ptr++ = static_cast<unsigned char>(encoded);
+    }
+
+    dest.resize(static_cast<unsigned>(ptr - dest.data()));
+}
+
+/// Decode values encoded by EncodePackedDeltas. Return false if data is corrupted.
+template <class T> bool DecodePackedDeltas(const unsigned char* data, unsigned size, T* values, unsigned numValues)
+{
+    using Bits = typename PackedValueBits<T>::Type;
+    static constexpr unsigned numBits = sizeof(Bits) * 8;
+
+    const unsigned char* ptr = data;
+    const unsigned char* end = data + size;
+
+    Bits previous{};
+    for (unsigned i = 0; i < numValues; ++i)
+    {
+        Bits encoded{};
+        for (unsigned shift = 0;; shift += 7)
+        {
+            if (ptr == end || shift >= numBits)
+                return false;
+
+            const unsigned char byte = *ptr++;
+            encoded = static_cast<Bits>(encoded | static_cast<Bits>(static_cast<Bits>(byte & 0x7f) << shift));
+            if (!(byte & 0x80))
+                break;
+        }
+
+        const auto delta = static_cast<Bits>((encoded >> 1) ^ static_cast<Bits>(0 - (encoded & 1)));
+        previous = static_cast<Bits>(previous + delta);
+        memcpy(&values[i], &previous, sizeof(Bits));
+    }
+
+    return ptr == end;
+}
+
 }
 
 /// Serialize vector with standard interface. Content is serialized as separate objects.
@@ -177,6 +249,93 @@ void SerializeVector(Archive& archive, const char* name, T& vector, const char*
     SerializeVectorAsObjects(archive, name, vector, element);
 }
 
+/// Serialize array with standard interface (compatible with ea::span, ea::array, etc). Content is serialized as bytes.
+template <class T>
+void SerializeArrayAsBytes(Archive& archive, const char* name, T& array)
+{
+    using ValueType = ea::remove_cv_t<ea::remove_reference_t<decltype(*array.data())>>;
+    static_assert(std::is_standard_layout<ValueType>::value, "Type should have standard layout to safely use byte serialization");
+    static_assert(std::is_trivially_copyable<ValueType>::value, "Type should be trivially copyable to safely use byte serialization");
+
+    ArchiveBlock block = archive.OpenUnorderedBlock(name);
+
+    const unsigned expectedSizeInBytes = array.size() * sizeof(ValueType);
+    unsigned sizeInBytes = expectedSizeInBytes;
+    archive.SerializeVLE("size", sizeInBytes);
+
+    if (archive.IsInput() && sizeInBytes != expectedSizeInBytes)
+        throw ArchiveException("'{}/{}' has unexpected array size", archive.GetCurrentBlockPath(), name);
+
+    archive.SerializeBytes("data", array.data(), sizeInBytes);
+}
+
+/// Serialize array in the best possible format.
+template <class T>
+void SerializeArray(Archive& archive, const char* name, T& array, const char* element = "element")
+{
+    using ValueType = ea::remove_cv_t<ea::remove_reference_t<decltype(*array.data())>>;
+    static constexpr bool standardLayout = std::is_standard_layout<ValueType>::value;
+    static constexpr bool triviallyCopyable = std::is_trivially_copyable<ValueType>::value;
+
+    if constexpr (standardLayout && triviallyCopyable)
+    {
+        if (!archive.IsHumanReadable())
+        {
+            SerializeArrayAsBytes(archive, name, array);
+            return;
+        }
+    }
+
+    SerializeArrayAsObjects(archive, name, array, element);
+}
+
+/// Serialize vector of integers or floating-point values as deltas between consecutive elements.
+/// Deltas are stored as variable-length integers, so monotonic and slowly changing sequences
+/// like sorted IDs, indices or timestamps take 1-2 bytes per element. Values are restored bit-exact.
+/// Human-readable archives store elements as separate objects.
+template <class T>
+void SerializeVectorAsPackedDeltas(Archive& archive, const char* name, T& vector, const char* element = "element")
+{
+    using ValueType = typename T::value_type;
+    static_assert((ea::is_integral_v<ValueType> && !ea::is_same_v<ValueType, bool>) || ea::is_floating_point_v<ValueType>,
+        "Only integer and floating-point values can be packed");
+
+    if (archive.IsHumanReadable())
+    {
+        SerializeVectorAsObjects(archive, name, vector, element);
+        return;
+    }
+
+    const bool loading = archive.IsInput();
+    ArchiveBlock block = archive.OpenUnorderedBlock(name);
+
+    ByteVector data;
+    if (!loading)
+        Detail::EncodePackedDeltas(vector.data(), vector.size(), data);
+
+    unsigned numElements = vector.size();
+    unsigned sizeInBytes = data.size();
+    archive.SerializeVLE("size", numElements);
+    archive.SerializeVLE("sizeInBytes", sizeInBytes);
+
+    if (loading)
+    {
+        // Each element takes at least one byte, and data cannot be larger than the rest of the input
+        if (sizeInBytes < numElements || sizeInBytes > archive.GetMaxRemainingInputSize())
+            throw ArchiveException("'{}/{}' has unexpected size in bytes", archive.GetCurrentBlockPath(), name);
+        data.resize(sizeInBytes);
+    }
+
+    archive.SerializeBytes("data", data.data(), sizeInBytes);
+
+    if (loading)
+    {
+        vector.resize(numElements);
+        if (!Detail::DecodePackedDeltas(data.data(), sizeInBytes, vector.data(), numElements))
+            throw ArchiveException("'{}/{}' has corrupted packed data", archive.GetCurrentBlockPath(), name);
+    }
+}
+
 /// Serialize custom vector.
 /// While writing, serializer may skip vector elements. Size should match actual number of elements to be written.
 /// While reading, serializer must push elements into vector on its own.
@@ -347,6 +506,8 @@ template <class T, std::enable_if_t<Detail::IsMapType<T>::value, int> = 0>
 void SerializeValue(Archive& archive, const char* name, T& map) { SerializeMap(archive, name, map); }
 template <class T, std::enable_if_t<Detail::IsSetType<T>::value, int> = 0>
 void SerializeValue(Archive& archive, const char* name, T& set) { SerializeSet(archive, name, set); }
+template <class T, size_t N>
+void SerializeValue(Archive& archive, const char* name, ea::array<T, N>& array) { SerializeArray(archive, name, array); }
 template <class T, std::enable_if_t<std::is_base_of<Object, T>::value, int> = 0>
 void SerializeValue(Archive& archive, const char* name, SharedPtr<T>& value) { SerializeSharedPtr(archive, name, value); }
 /// @}
@@ -232,6 +232,13 @@ void BinaryInputArchive::BeginBlock(const char* name, unsigned& sizeHint, bool s
     }
 }
 
+unsigned BinaryInputArchive::GetMaxRemainingInputSize() const
+{
+    const unsigned size = deserializer_->GetSize();
+    const unsigned position = deserializer_->GetPosition();
+    return position < size ? size - position : 0;
+}
+
 void BinaryInputArchive::SerializeBytes(const char* name, void* bytes, unsigned size)
 {
     CheckBeforeElement(name);
@@ -137,6 +137,7 @@ public:
     /// @{
     ea::string_view GetName() const final { return deserializer_->GetName(); }
     unsigned GetChecksum() final { return deserializer_->GetChecksum(); }
+    unsigned GetMaxRemainingInputSize() const final;
 
     void BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type) final;
 
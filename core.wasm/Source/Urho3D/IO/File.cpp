@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -37,6 +38,13 @@
 #include <emscripten/emscripten.h>
 #endif
 
+#if !defined(_WIN32)
+#define URHO3D_POSITIONAL_READ
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include <atomic>
 #include <cstdio>
 #include <LZ4/lz4.h>
 
@@ -66,7 +74,40 @@ static const char* openMode[] =
 #ifdef __ANDROID__
 static const unsigned READ_BUFFER_SIZE = 32768;
 #endif
-static const unsigned SKIP_BUFFER_SIZE = 1024;
+static const unsigned BLOCK_HEADER_SIZE = 4;
+static const unsigned MAX_PACKED_BLOCK_SIZE = 65535;
+
+#ifdef URHO3D_POSITIONAL_READ
+namespace
+{
+
+/// Batch of asynchronous reads in flight.
+struct AsyncReadBatch
+{
+    ea::vector<AsyncReadRequest> requests_;
+    AsyncReadCallback callback_;
+    std::atomic<unsigned> numPending_{};
+};
+
+/// Read the range of file descriptor without changing file position.
+unsigned ReadAt(int fd, unsigned long long offset, void* dest, unsigned size)
+{
+    unsigned bytesRead = 0;
+    while (bytesRead < size)
+    {
+        const ssize_t result = pread(fd, static_cast<unsigned char*>(dest) + bytesRead, size - bytesRead,
+            static_cast<off_t>(offset + bytesRead));
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            break;
+        bytesRead += static_cast<unsigned>(result);
+    }
+    return bytesRead;
+}
+
+}
+#endif
 
 File::File(Context* context) :
     Object(context),
@@ -147,11 +188,24 @@ bool File::Open(PackageFile* package, const ea::string& fileName)
         return false;
     }
 
+    if (entry->codec_ != PACKAGE_CODEC_NONE && entry->codec_ != PACKAGE_CODEC_LZ4 && entry->codec_ != PACKAGE_CODEC_LZ4HC)
+    {
+        URHO3D_LOGERROR("Unsupported compression of package file " + fileName);
+        Close();
+        return false;
+    }
+
     name_ = fileName;
-    offset_ = entry->offset_;
+    offset_ = package->GetDataOffset(*entry);
     checksum_ = entry->checksum_;
     size_ = entry->size_;
-    compressed_ = package->IsCompressed();
+    compressed_ = entry->codec_ != PACKAGE_CODEC_NONE;
+
+    if (compressed_ && !OpenBlockIndex(package, *entry))
+    {
+        Close();
+        return false;
+    }
 
     // Seek to beginning of package entry's file data
     SeekInternal(offset_);
@@ -219,38 +273,22 @@ unsigned File::Read(void* dest, unsigned size)
 
         while (sizeLeft)
         {
-            if (!readBuffer_ || readBufferOffset_ >= readBufferSize_)
+            if (!LoadBlock(position_))
             {
-                unsigned char blockHeaderBytes[4];
-                ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
-
-                MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
-                unsigned unpackedSize = blockHeader.ReadUShort();
-                unsigned packedSize = blockHeader.ReadUShort();
-
-                if (!readBuffer_)
-                {
-                    readBuffer_ = new unsigned char[unpackedSize];
-                    inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
-                }
-
-                /// \todo Handle errors
-                ReadInternal(inputBuffer_.get(), packedSize);
-                LZ4_decompress_fast((const char*)inputBuffer_.get(), (char*)readBuffer_.get(), unpackedSize);
-
-                readBufferSize_ = unpackedSize;
-                readBufferOffset_ = 0;
+                URHO3D_LOGERROR("Error while reading from compressed file " + GetName());
+                break;
             }
 
-            unsigned copySize = Min((readBufferSize_ - readBufferOffset_), sizeLeft);
-            memcpy(destPtr, readBuffer_.get() + readBufferOffset_, copySize);
+            const PackageBlock& block = (*blockIndex_)[currentBlock_];
+            const unsigned blockOffset = position_ - block.unpackedOffset_;
+            const unsigned copySize = Min(block.unpackedSize_ - blockOffset, sizeLeft);
+            memcpy(destPtr, blockData_->data() + blockOffset, copySize);
             destPtr += copySize;
             sizeLeft -= copySize;
-            readBufferOffset_ += copySize;
             position_ += copySize;
         }
 
-        return size;
+        return size - sizeLeft;
     }
 
     // Need to reassign the position due to internal buffering when transitioning from writing to reading
@@ -285,26 +323,10 @@ unsigned File::Seek(unsigned position)
     if (mode_ == FILE_READ && position > size_)
         position = size_;
 
+    // Block containing the position is decompressed on read
     if (compressed_)
     {
-        // Start over from the beginning
-        if (position == 0)
-        {
-            position_ = 0;
-            readBufferOffset_ = 0;
-            readBufferSize_ = 0;
-            SeekInternal(offset_);
-        }
-        // Skip bytes
-        else if (position >= position_)
-        {
-            unsigned char skipBuffer[SKIP_BUFFER_SIZE];
-            while (position > position_)
-                Read(skipBuffer, Min(position - position_, SKIP_BUFFER_SIZE));
-        }
-        else
-            URHO3D_LOGERROR("Seeking backward in a compressed file is not supported");
-
+        position_ = position;
         return position_;
     }
 
@@ -402,6 +424,12 @@ void File::Close()
     readBuffer_.reset();
     inputBuffer_.reset();
 
+    package_ = nullptr;
+    packedData_ = {};
+    blockIndex_ = nullptr;
+    blockData_ = nullptr;
+    currentBlock_ = M_MAX_UNSIGNED;
+
     if (handle_)
     {
         fclose((FILE*)handle_);
@@ -553,7 +581,7 @@ bool File::ReadInternal(void* dest, unsigned size)
         return fread(dest, size, 1, (FILE*)handle_) == 1;
 }
 
-void File::SeekInternal(unsigned newPosition)
+void File::SeekInternal(unsigned long long newPosition)
 {
 #ifdef __ANDROID__
     if (assetHandle_)
@@ -565,7 +593,155 @@ void File::SeekInternal(unsigned newPosition)
     }
     else
 #endif
-        fseek((FILE*)handle_, newPosition, SEEK_SET);
+#ifdef _WIN32
+        _fseeki64((FILE*)handle_, static_cast<__int64>(newPosition), SEEK_SET);
+#else
+        fseeko((FILE*)handle_, static_cast<off_t>(newPosition), SEEK_SET);
+#endif
+}
+
+void File::ReadAsync(WorkQueue* workQueue, ea::vector<AsyncReadRequest> requests, AsyncReadCallback callback)
+{
+#ifdef URHO3D_POSITIONAL_READ
+    // Reads of uncompressed files don't share any state, so they may be executed in parallel
+    if (handle_ && !compressed_ && mode_ == FILE_READ && !requests.empty())
+    {
+        const int fd = fileno(static_cast<FILE*>(handle_));
+        auto batch = ea::make_shared<AsyncReadBatch>();
+        batch->requests_ = ea::move(requests);
+        batch->callback_ = ea::move(callback);
+        batch->numPending_ = batch->requests_.size();
+
+        const unsigned long long fileOffset = offset_;
+        const unsigned fileSize = size_;
+        for (unsigned i = 0; i < batch->requests_.size(); ++i)
+        {
+            workQueue->PostTask([batch, i, fd, fileOffset, fileSize]()
+            {
+                AsyncReadRequest& request = batch->requests_[i];
+                request.bytesRead_ = 0;
+                if (request.offset_ < fileSize)
+                {
+                    const auto size = static_cast<unsigned>(ea::min<unsigned long long>(request.size_, fileSize - request.offset_));
+                    request.bytesRead_ = ReadAt(fd, fileOffset + request.offset_, request.buffer_, size);
+                }
+
+                if (batch->numPending_.fetch_sub(1) == 1)
+                    batch->callback_(batch->requests_);
+            });
+        }
+        return;
+    }
+#endif
+
+    AbstractFile::ReadAsync(workQueue, ea::move(requests), ea::move(callback));
+}
+
+bool File::OpenBlockIndex(PackageFile* package, const PackageEntry& entry)
+{
+    package_ = package;
+    packedData_ = package->GetMappedData(entry);
+    blockIndex_ = package->GetBlockIndex(entry);
+    if (blockIndex_)
+        return true;
+
+    // Scan block headers once per package entry, files opened later reuse the index
+    PackageBlockIndex index;
+    unsigned unpackedOffset = 0;
+    unsigned packedOffset = 0;
+    while (unpackedOffset < size_)
+    {
+        unsigned char blockHeaderBytes[BLOCK_HEADER_SIZE];
+        if (packedOffset + BLOCK_HEADER_SIZE > entry.packedSize_)
+        {
+            URHO3D_LOGERROR("Unexpected end of compressed file " + name_);
+            return false;
+        }
+
+        if (!packedData_.empty())
+            memcpy(blockHeaderBytes, packedData_.data() + packedOffset, BLOCK_HEADER_SIZE);
+        else
+        {
+            SeekInternal(offset_ + packedOffset);
+            if (!ReadInternal(blockHeaderBytes, BLOCK_HEADER_SIZE))
+            {
+                URHO3D_LOGERROR("Error while reading compressed file " + name_);
+                return false;
+            }
+        }
+
+        MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
+        PackageBlock block;
+        block.unpackedOffset_ = unpackedOffset;
+        block.packedOffset_ = packedOffset;
+        block.unpackedSize_ = blockHeader.ReadUShort();
+        block.packedSize_ = blockHeader.ReadUShort();
+        if (!block.unpackedSize_ || packedOffset + BLOCK_HEADER_SIZE + block.packedSize_ > entry.packedSize_)
+        {
+            URHO3D_LOGERROR("Corrupted compressed file " + name_);
+            return false;
+        }
+
+        index.push_back(block);
+        unpackedOffset += block.unpackedSize_;
+        packedOffset += BLOCK_HEADER_SIZE + block.packedSize_;
+    }
+
+    blockIndex_ = package->StoreBlockIndex(entry, ea::move(index));
+    return true;
+}
+
+bool File::LoadBlock(unsigned position)
+{
+    const PackageBlockIndex& blocks = *blockIndex_;
+    if (currentBlock_ < blocks.size())
+    {
+        const PackageBlock& block = blocks[currentBlock_];
+        if (position >= block.unpackedOffset_ && position < block.unpackedOffset_ + block.unpackedSize_)
+            return true;
+    }
+
+    const auto iter = ea::upper_bound(blocks.begin(), blocks.end(), position,
+        [](unsigned value, const PackageBlock& block) { return value < block.unpackedOffset_; });
+    if (iter == blocks.begin())
+        return false;
+
+    const unsigned blockIndex = static_cast<unsigned>(iter - blocks.begin()) - 1;
+    const PackageBlock& block = blocks[blockIndex];
+    if (position >= block.unpackedOffset_ + block.unpackedSize_)
+        return false;
+
+    // Blocks are shared between all files opened from the package
+    const unsigned long long blockOffset = offset_ + block.packedOffset_;
+    SharedByteVector data = package_->GetCachedBlock(blockOffset);
+    if (!data)
+    {
+        const unsigned char* packedBlock = nullptr;
+        if (!packedData_.empty())
+            packedBlock = packedData_.data() + block.packedOffset_ + BLOCK_HEADER_SIZE;
+        else
+        {
+            if (!inputBuffer_)
+                inputBuffer_ = new unsigned char[MAX_PACKED_BLOCK_SIZE];
+
+            SeekInternal(blockOffset + BLOCK_HEADER_SIZE);
+            if (!ReadInternal(inputBuffer_.get(), block.packedSize_))
+                return false;
+            packedBlock = inputBuffer_.get();
+        }
+
+        data = ea::make_shared<ByteVector>(block.unpackedSize_);
+        const int unpackedSize = LZ4_decompress_safe(reinterpret_cast<const char*>(packedBlock),
+            reinterpret_cast<char*>(data->data()), block.packedSize_, block.unpackedSize_);
+        if (unpackedSize != static_cast<int>(block.unpackedSize_))
+            return false;
+
+        package_->StoreCachedBlock(blockOffset, data);
+    }
+
+    blockData_ = data;
+    currentBlock_ = blockIndex;
+    return true;
 }
 
 void File::ReadBinary(ea::vector<unsigned char>& buffer)
@@ -26,6 +26,7 @@
 
 #include <EASTL/shared_array.h>
 
+#include "../Container/ByteVector.h"
 #include "../Core/Object.h"
 #include "../IO/AbstractFile.h"
 
@@ -51,6 +52,8 @@ static const char* APK = "";
 #endif
 
 class PackageFile;
+struct PackageBlock;
+struct PackageEntry;
 
 /// %File opened either through the filesystem or from within a package file.
 class URHO3D_API File : public Object, public AbstractFile
@@ -86,6 +89,8 @@ public:
     bool Open(PackageFile* package, const ea::string& fileName);
     /// Close the file.
     void Close() override;
+    /// Read multiple ranges of the file. Uncompressed files are read on WorkQueue threads in parallel, if supported.
+    void ReadAsync(WorkQueue* workQueue, ea::vector<AsyncReadRequest> requests, AsyncReadCallback callback) override;
     /// Flush any buffered output to the file.
     void Flush();
 
@@ -126,7 +131,11 @@ private:
     /// Perform the file read internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful. This does not handle compressed package file reading.
     bool ReadInternal(void* dest, unsigned size);
     /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
-    void SeekInternal(unsigned newPosition);
+    void SeekInternal(unsigned long long newPosition);
+    /// Get or build index of compressed blocks of the package entry.
+    bool OpenBlockIndex(PackageFile* package, const PackageEntry& entry);
+    /// Decompress the block containing the position, unless it is current already or cached by the package.
+    bool LoadBlock(unsigned position);
 
     /// Absolute file name.
     ea::string absoluteFileName_;
@@ -138,7 +147,7 @@ private:
     /// SDL RWops context for Android asset loading.
     SDL_RWops* assetHandle_;
 #endif
-    /// Read buffer for Android asset or compressed file loading.
+    /// Read buffer for Android asset loading.
     ea::shared_array<unsigned char> readBuffer_;
     /// Decompression input buffer for compressed file loading.
     ea::shared_array<unsigned char> inputBuffer_;
@@ -147,7 +156,7 @@ private:
     /// Bytes in the current read buffer.
     unsigned readBufferSize_;
     /// Start position within a package file, 0 for regular files.
-    unsigned offset_;
+    unsigned long long offset_;
     /// Content checksum.
     unsigned checksum_;
     /// Compression flag.
@@ -156,6 +165,17 @@ private:
     bool readSyncNeeded_;
     /// Synchronization needed before write -flag.
     bool writeSyncNeeded_;
+
+    /// Package of the compressed file. Owns block index and cache of decompressed blocks.
+    SharedPtr<PackageFile> package_;
+    /// Compressed data of the file if the package is memory-mapped.
+    ConstByteSpan packedData_;
+    /// Index of compressed blocks.
+    ea::shared_ptr<const ea::vector<PackageBlock>> blockIndex_;
+    /// Current decompressed block.
+    SharedByteVector blockData_;
+    /// Index of current decompressed block.
+    unsigned currentBlock_{M_MAX_UNSIGNED};
 };
 
 }
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/FileSystem.h"
+#include "../IO/MemoryMappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+#define URHO3D_POSIX_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+MemoryMappedFile::MemoryMappedFile() = default;
+
+MemoryMappedFile::MemoryMappedFile(const ea::string& fileName)
+{
+    Open(fileName);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open(const ea::string& fileName)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    fileHandle_ = fileHandle;
+    mappingHandle_ = mappingHandle;
+    data_ = static_cast<const unsigned char*>(data);
+    size_ = static_cast<unsigned long long>(fileSize.QuadPart);
+    return true;
+#elif defined(URHO3D_POSIX_MMAP)
+    const int fd = open(GetNativePath(fileName).c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // Mapping stays valid after the descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    data_ = static_cast<const unsigned char*>(data);
+    size_ = static_cast<unsigned long long>(fileStat.st_size);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MemoryMappedFile::Close()
+{
+    if (!data_)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    CloseHandle(static_cast<HANDLE>(fileHandle_));
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+#elif defined(URHO3D_POSIX_MMAP)
+    munmap(const_cast<unsigned char*>(data_), static_cast<size_t>(size_));
+#endif
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void MemoryMappedFile::Prefetch(unsigned long long offset, unsigned long long size) const
+{
+    if (!data_ || offset >= size_ || size == 0)
+        return;
+
+    size = ea::min(size, size_ - offset);
+
+#if defined(URHO3D_POSIX_MMAP)
+    // madvise requires page-aligned address
+    static const unsigned long long pageSize = static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+    const unsigned long long alignedOffset = offset / pageSize * pageSize;
+    madvise(const_cast<unsigned char*>(data_ + alignedOffset), static_cast<size_t>(size + offset - alignedOffset),
+        MADV_WILLNEED);
+#elif defined(_WIN32) && _WIN32_WINNT >= 0x0602
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<unsigned char*>(data_ + offset), static_cast<SIZE_T>(size)};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+}
+
+}
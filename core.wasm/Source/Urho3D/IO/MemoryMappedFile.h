@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "Urho3D/Container/RefCounted.h"
+
+#include <EASTL/string.h>
+
+namespace Urho3D
+{
+
+/// Read-only memory mapping of the whole file.
+/// Mapping is not supported on Android and Web platforms, IsOpen() returns false there.
+class URHO3D_API MemoryMappedFile : public RefCounted
+{
+public:
+    /// Construct.
+    MemoryMappedFile();
+    /// Construct and map the file.
+    explicit MemoryMappedFile(const ea::string& fileName);
+    /// Destruct. Unmap the file.
+    ~MemoryMappedFile() override;
+
+    /// Map the file. Return true if successful.
+    bool Open(const ea::string& fileName);
+    /// Unmap the file.
+    void Close();
+
+    /// Hint that the range of the file will be accessed soon. Does not block.
+    void Prefetch(unsigned long long offset, unsigned long long size) const;
+
+    /// Return whether the file is mapped.
+    bool IsOpen() const { return data_ != nullptr; }
+    /// Return mapped data.
+    const unsigned char* GetData() const { return data_; }
+    /// Return size of mapped data.
+    unsigned long long GetSize() const { return size_; }
+
+private:
+    /// Mapped data.
+    const unsigned char* data_{};
+    /// Size of mapped data.
+    unsigned long long size_{};
+#ifdef _WIN32
+    /// File and mapping handles.
+    void* fileHandle_{};
+    void* mappingHandle_{};
+#endif
+};
+
+}
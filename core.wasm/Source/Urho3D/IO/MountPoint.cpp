@@ -34,6 +34,20 @@ MountPoint::MountPoint(Context* context)
 
 MountPoint::~MountPoint() = default;
 
+bool MountPoint::ReadAsync(
+    WorkQueue* workQueue, const FileIdentifier& fileName, ea::vector<AsyncReadRequest> requests, AsyncReadCallback callback)
+{
+    AbstractFilePtr file = OpenFile(fileName, FILE_READ);
+    if (!file)
+        return false;
+
+    // Keep the file alive until completion
+    AbstractFile* filePtr = file;
+    filePtr->ReadAsync(workQueue, ea::move(requests),
+        [file = ea::move(file), callback = ea::move(callback)](ea::span<AsyncReadRequest> requests) { callback(requests); });
+    return true;
+}
+
 ea::optional<FileTime> MountPoint::GetLastModifiedTime(
     const FileIdentifier& fileName, bool creationIsModification) const
 {
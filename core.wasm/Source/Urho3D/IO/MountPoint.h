@@ -54,6 +54,11 @@ public:
     /// The file name may be be case-insensitive on Windows and case-sensitive on other platforms.
     virtual AbstractFilePtr OpenFile(const FileIdentifier& fileName, FileMode mode) = 0;
 
+    /// Open file and read multiple ranges of it. Callback is executed as WorkQueue task when all requests are completed.
+    /// Return false and don't execute the callback if file cannot be opened.
+    virtual bool ReadAsync(WorkQueue* workQueue, const FileIdentifier& fileName, ea::vector<AsyncReadRequest> requests,
+        AsyncReadCallback callback);
+
     /// Return modification time, or 0 if not supported.
     /// Return nullopt if file does not exist.
     virtual ea::optional<FileTime> GetLastModifiedTime(
@@ -0,0 +1,266 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../IO/AbstractFile.h"
+#include "../IO/Log.h"
+#include "../IO/PackageBuilder.h"
+
+#include <EASTL/sort.h>
+
+#include <LZ4/lz4.h>
+#include <LZ4/lz4hc.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Size of package header of version 2.
+const unsigned PackageHeaderSize = 40;
+
+void AppendUShort(ByteVector& buffer, unsigned value)
+{
+    buffer.push_back(static_cast<unsigned char>(value & 0xff));
+    buffer.push_back(static_cast<unsigned char>((value >> 8) & 0xff));
+}
+
+}
+
+PackageCodec PackageBuilder::GetSupportedCodec(PackageCodec codec)
+{
+    // Zstandard is reserved by the format but not supported by this build
+    return codec == PACKAGE_CODEC_ZSTD ? PACKAGE_CODEC_LZ4HC : codec;
+}
+
+bool PackageBuilder::EncodeBlocks(ConstByteSpan data, PackageCodec codec, ByteVector& result, unsigned maxSize)
+{
+    ByteVector compressBuffer(LZ4_compressBound(BlockSize));
+
+    const unsigned initialSize = result.size();
+    for (unsigned pos = 0; pos < data.size(); pos += BlockSize)
+    {
+        const auto unpackedSize = ea::min<unsigned>(BlockSize, data.size() - pos);
+        const auto source = reinterpret_cast<const char*>(data.data() + pos);
+        const auto dest = reinterpret_cast<char*>(compressBuffer.data());
+        const int capacity = static_cast<int>(compressBuffer.size());
+
+        const int packedSize = codec == PACKAGE_CODEC_LZ4HC
+            ? LZ4_compress_HC(source, dest, unpackedSize, capacity, 0)
+            : LZ4_compress_default(source, dest, unpackedSize, capacity);
+        if (packedSize <= 0)
+            return false;
+
+        AppendUShort(result, unpackedSize);
+        AppendUShort(result, packedSize);
+        result.insert(result.end(), compressBuffer.begin(), compressBuffer.begin() + packedSize);
+
+        // Don't bother if compression is not helping
+        if (result.size() - initialSize >= maxSize)
+            return false;
+    }
+    return true;
+}
+
+PackageEncodedFile PackageBuilder::EncodeFile(ConstByteSpan data, PackageCodec codec)
+{
+    PackageEncodedFile result;
+    result.size_ = data.size();
+    for (unsigned char byte : data)
+        result.checksum_ = SDBMHash(result.checksum_, byte);
+
+    if (codec == PACKAGE_CODEC_ZSTD)
+    {
+        URHO3D_LOGWARNING("Zstandard compression is not supported, LZ4HC is used instead");
+        codec = GetSupportedCodec(codec);
+    }
+
+    if (codec != PACKAGE_CODEC_NONE && !data.empty())
+    {
+        result.data_.reserve(data.size());
+        if (EncodeBlocks(data, codec, result.data_, data.size()))
+        {
+            result.codec_ = codec;
+            return result;
+        }
+    }
+
+    result.data_.assign(data.begin(), data.end());
+    result.codec_ = PACKAGE_CODEC_NONE;
+    return result;
+}
+
+bool PackageBuilder::Create(AbstractFile* dest, const ea::vector<ea::string>& fileNames)
+{
+    dest_ = dest;
+    startPosition_ = dest_->GetPosition();
+    entries_.clear();
+    appended_.clear();
+    entryIndices_.clear();
+    names_.clear();
+    checksum_ = 0;
+    compressed_ = false;
+
+    entries_.reserve(fileNames.size());
+    for (const ea::string& fileName : fileNames)
+    {
+        if (entryIndices_.contains(fileName))
+        {
+            URHO3D_LOGERROR("File {} is added to the package twice", fileName);
+            return false;
+        }
+        entryIndices_.emplace(fileName, entries_.size());
+
+        PackageEntry entry{};
+        entry.nameHash_ = PackageFile::GetEntryNameHash(fileName);
+        entry.nameOffset_ = names_.length();
+        entry.nameLength_ = fileName.length();
+        entries_.push_back(entry);
+
+        names_.append(fileName);
+        names_.push_back('\0');
+    }
+    appended_.resize(entries_.size(), false);
+
+    // Directory and names are written before file data, reserve the space now
+    directoryOffset_ = PackageHeaderSize;
+    namesOffset_ = directoryOffset_ + entries_.size() * sizeof(PackageEntry);
+    currentOffset_ = namesOffset_ + names_.length();
+    WriteHeader();
+    return true;
+}
+
+bool PackageBuilder::AppendFile(const ea::string& fileName, const PackageEncodedFile& encodedFile)
+{
+    return WriteFile(fileName, encodedFile.data_, encodedFile.size_, encodedFile.checksum_, encodedFile.codec_);
+}
+
+bool PackageBuilder::AppendFile(const ea::string& fileName, ConstByteSpan data, PackageCodec codec)
+{
+    return AppendFile(fileName, EncodeFile(data, codec));
+}
+
+bool PackageBuilder::AppendFile(const ea::string& fileName, const PackageEntry& entry, ConstByteSpan packedData)
+{
+    if (packedData.size() != entry.packedSize_)
+    {
+        URHO3D_LOGERROR("File {} has unexpected size of packed data", fileName);
+        return false;
+    }
+    return WriteFile(fileName, packedData, entry.size_, entry.checksum_, entry.codec_);
+}
+
+bool PackageBuilder::Finalize()
+{
+    if (!dest_)
+        return false;
+
+    for (unsigned i = 0; i < entries_.size(); ++i)
+    {
+        if (!appended_[i])
+        {
+            URHO3D_LOGERROR("File {} is missing in the package", names_.c_str() + entries_[i].nameOffset_);
+            return false;
+        }
+    }
+
+    const auto getName = [&](const PackageEntry& entry)
+    { return ea::string_view{names_.c_str() + entry.nameOffset_, entry.nameLength_}; };
+    ea::sort(entries_.begin(), entries_.end(), [&](const PackageEntry& lhs, const PackageEntry& rhs)
+    {
+        if (lhs.nameHash_ != rhs.nameHash_)
+            return lhs.nameHash_ < rhs.nameHash_;
+        return getName(lhs) < getName(rhs);
+    });
+
+    checksum_ = 0;
+    for (const PackageEntry& entry : entries_)
+    {
+        for (unsigned i = 0; i < 4; ++i)
+            checksum_ = SDBMHash(checksum_, static_cast<unsigned char>(entry.checksum_ >> (i * 8)));
+    }
+
+    // Write package size to the end of file to allow finding it linked to an executable file
+    currentOffset_ += sizeof(unsigned long long);
+    dest_->WriteUInt64(currentOffset_);
+
+    // Package is written sequentially, so only the header is required to be addressable by 32-bit position
+    dest_->Seek(static_cast<unsigned>(startPosition_));
+    WriteHeader();
+    const unsigned long long endPosition = startPosition_ + currentOffset_;
+    if (endPosition <= M_MAX_UNSIGNED)
+        dest_->Seek(static_cast<unsigned>(endPosition));
+
+    entryIndices_.clear();
+    appended_.clear();
+    dest_ = nullptr;
+    return true;
+}
+
+bool PackageBuilder::WriteFile(
+    const ea::string& fileName, ConstByteSpan packedData, unsigned size, unsigned checksum, unsigned codec)
+{
+    const auto iter = entryIndices_.find(fileName);
+    if (!dest_ || iter == entryIndices_.end() || appended_[iter->second])
+    {
+        URHO3D_LOGERROR("File {} is not expected in the package", fileName);
+        return false;
+    }
+
+    PackageEntry& entry = entries_[iter->second];
+    entry.offset_ = currentOffset_;
+    entry.size_ = size;
+    entry.checksum_ = checksum;
+    entry.packedSize_ = packedData.size();
+    entry.codec_ = codec;
+
+    if (dest_->Write(packedData.data(), packedData.size()) != packedData.size())
+    {
+        URHO3D_LOGERROR("Could not write file {} to the package", fileName);
+        return false;
+    }
+
+    currentOffset_ += packedData.size();
+    compressed_ |= codec != PACKAGE_CODEC_NONE;
+    appended_[iter->second] = true;
+    return true;
+}
+
+void PackageBuilder::WriteHeader()
+{
+    dest_->WriteFileID("UPK2");
+    dest_->WriteUInt(entries_.size());
+    dest_->WriteUInt(checksum_);
+    dest_->WriteUInt(compressed_ ? PACKAGE_FLAG_COMPRESSED : 0u);
+    dest_->WriteUInt64(directoryOffset_);
+    dest_->WriteUInt64(namesOffset_);
+    dest_->WriteUInt64(names_.length());
+    dest_->Write(entries_.data(), entries_.size() * sizeof(PackageEntry));
+    dest_->Write(names_.data(), names_.length());
+}
+
+}
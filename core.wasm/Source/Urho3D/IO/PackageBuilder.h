@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "Urho3D/Container/ByteVector.h"
+#include "Urho3D/Core/NonCopyable.h"
+#include "Urho3D/IO/PackageFile.h"
+
+#include <EASTL/string.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class AbstractFile;
+
+/// File data encoded for the package.
+struct PackageEncodedFile
+{
+    /// Data as stored in the package.
+    ByteVector data_;
+    /// Original size of the file.
+    unsigned size_{};
+    /// Checksum of the original file.
+    unsigned checksum_{};
+    /// Codec used to encode the data.
+    PackageCodec codec_{};
+};
+
+/// Writes package files of version 2.
+/// Header and directory are reserved on creation and written on finalization, so files are appended one by one.
+class URHO3D_API PackageBuilder : public NonCopyable
+{
+public:
+    /// Size of compressed block.
+    static constexpr unsigned BlockSize = 32768;
+
+    /// Return codec actually used to encode files when the codec is requested.
+    static PackageCodec GetSupportedCodec(PackageCodec codec);
+    /// Encode file using the codec. Falls back to storing the file as is if compression doesn't reduce the size.
+    /// Safe to call from any thread.
+    static PackageEncodedFile EncodeFile(ConstByteSpan data, PackageCodec codec);
+    /// Compress data as sequence of blocks and append them to the result.
+    /// Return false if compression failed or the result would exceed maximum size. Safe to call from any thread.
+    /// Sequences of blocks of the same file may be encoded independently and concatenated.
+    static bool EncodeBlocks(ConstByteSpan data, PackageCodec codec, ByteVector& result, unsigned maxSize = M_MAX_UNSIGNED);
+
+    PackageBuilder() = default;
+
+    /// Start writing package of the given files to the destination. Destination should stay alive until finalization.
+    bool Create(AbstractFile* dest, const ea::vector<ea::string>& fileNames);
+    /// Append encoded file. File name should be one of the names passed on creation.
+    bool AppendFile(const ea::string& fileName, const PackageEncodedFile& encodedFile);
+    /// Encode and append file.
+    bool AppendFile(const ea::string& fileName, ConstByteSpan data, PackageCodec codec);
+    /// Append file copied from another package as is.
+    bool AppendFile(const ea::string& fileName, const PackageEntry& entry, ConstByteSpan packedData);
+    /// Write directory and trailer. All files should be appended by now.
+    /// Destination is positioned at the end of the package, unless the end is beyond 4 GB and can't be addressed.
+    bool Finalize();
+
+    /// Return package checksum. Valid after finalization.
+    unsigned GetChecksum() const { return checksum_; }
+    /// Return whether any file is compressed.
+    bool IsCompressed() const { return compressed_; }
+    /// Return total size of the package.
+    unsigned long long GetTotalSize() const { return currentOffset_; }
+
+private:
+    /// Write header, directory and name table.
+    void WriteHeader();
+    /// Write file data and fill the entry.
+    bool WriteFile(const ea::string& fileName, ConstByteSpan packedData, unsigned size, unsigned checksum, unsigned codec);
+
+    /// Destination file.
+    AbstractFile* dest_{};
+    /// Position of the package in the destination file.
+    unsigned long long startPosition_{};
+    /// File entries in the order of creation.
+    ea::vector<PackageEntry> entries_;
+    /// Whether the file entry is appended.
+    ea::vector<bool> appended_;
+    /// Indices of entries by file name.
+    ea::unordered_map<ea::string, unsigned> entryIndices_;
+    /// Name table.
+    ea::string names_;
+    /// Offset of directory from the start of the package.
+    unsigned long long directoryOffset_{};
+    /// Offset of name table from the start of the package.
+    unsigned long long namesOffset_{};
+    /// Current offset from the start of the package.
+    unsigned long long currentOffset_{};
+    /// Package checksum.
+    unsigned checksum_{};
+    /// Whether any file is compressed.
+    bool compressed_{};
+};
+
+}
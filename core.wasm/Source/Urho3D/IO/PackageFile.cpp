@@ -24,141 +24,479 @@
 
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/MemoryMappedFile.h"
 #include "../IO/PackageFile.h"
 #include "../IO/FileSystem.h"
 
+#include <EASTL/sort.h>
+
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Read-only view of the file in memory-mapped package. Keeps the mapping alive.
+class MappedPackageEntry : public RefCounted, public MemoryBuffer
+{
+public:
+    MappedPackageEntry(MemoryMappedFile* mappedFile, const unsigned char* data, const PackageEntry& entry)
+        : MemoryBuffer(static_cast<const void*>(data), entry.size_)
+        , mappedFile_(mappedFile)
+        , checksum_(entry.checksum_)
+    {
+    }
+
+    unsigned GetChecksum() override { return checksum_; }
+
+private:
+    SharedPtr<MemoryMappedFile> mappedFile_;
+    unsigned checksum_{};
+};
+
+bool IsPackageID(const ea::string& id)
+{
+    return id == "UPAK" || id == "ULZ4" || id == "RPAK" || id == "RLZ4" || id == "UPK2";
+}
+
+bool CompareEntries(const PackageEntry& lhs, ea::string_view lhsName, const PackageEntry& rhs, ea::string_view rhsName)
+{
+    if (lhs.nameHash_ != rhs.nameHash_)
+        return lhs.nameHash_ < rhs.nameHash_;
+    return lhsName < rhsName;
+}
+
+}
+
 PackageFile::PackageFile(Context* context) :
-    MountPoint(context),
-    totalSize_(0),
-    totalDataSize_(0),
-    checksum_(0),
-    compressed_(false)
+    MountPoint(context)
 {
 }
 
 PackageFile::PackageFile(Context* context, const ea::string& fileName, unsigned startOffset) :
-    MountPoint(context),
-    totalSize_(0),
-    totalDataSize_(0),
-    checksum_(0),
-    compressed_(false)
+    MountPoint(context)
 {
     Open(fileName, startOffset);
 }
 
 PackageFile::~PackageFile() = default;
 
+unsigned long long PackageFile::GetEntryNameHash(ea::string_view fileName)
+{
+    // 64-bit FNV-1a
+    unsigned long long hash = 14695981039346656037ull;
+    for (const char ch : fileName)
+    {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 bool PackageFile::Open(const ea::string& fileName, unsigned startOffset)
 {
-    auto file = MakeShared<File>(context_, fileName);
-    if (!file->IsOpen())
-        return false;
+    // File can't read files larger than 4 GB. Such packages are read from the mapped memory only.
+    auto mappedFile = MakeShared<MemoryMappedFile>(fileName);
+    if (!mappedFile->IsOpen())
+        mappedFile = nullptr;
+
+    SharedPtr<File> file;
+    if (!mappedFile || mappedFile->GetSize() <= M_MAX_UNSIGNED)
+    {
+        file = MakeShared<File>(context_, fileName);
+        if (!file->IsOpen())
+            return false;
+    }
+
+    mappedFile_ = mappedFile;
+    totalSize_ = mappedFile_ ? mappedFile_->GetSize() : file->GetSize();
+
+    const auto readID = [&](unsigned long long offset)
+    {
+        char id[4]{};
+        return ReadData(file, offset, id, sizeof(id)) ? ea::string(id, sizeof(id)) : EMPTY_STRING;
+    };
 
     // Check ID, then read the directory
-    file->Seek(startOffset);
-    ea::string id = file->ReadFileID();
-    if (id != "UPAK" && id != "ULZ4" && id != "RPAK" && id != "RLZ4")
+    ea::string id = readID(startOffset);
+    if (!IsPackageID(id))
     {
         // If start offset has not been explicitly specified, also try to read package size from the end of file
-        // to know how much we must rewind to find the package start
+        // to know how much we must rewind to find the package start.
+        // Version 1 packages store 32-bit package size, version 2 packages store 64-bit package size.
         if (!startOffset)
         {
-            unsigned fileSize = file->GetSize();
-            file->Seek((unsigned)(fileSize - sizeof(unsigned)));
-            unsigned newStartOffset = fileSize - file->ReadUInt();
-            if (newStartOffset < fileSize)
+            for (const unsigned sizeOfSize : {4u, 8u})
             {
-                startOffset = newStartOffset;
-                file->Seek(startOffset);
-                id = file->ReadFileID();
+                if (totalSize_ < sizeOfSize)
+                    break;
+
+                unsigned long long packageSize = 0;
+                if (sizeOfSize == 4u)
+                {
+                    unsigned packageSize32 = 0;
+                    ReadData(file, totalSize_ - sizeOfSize, &packageSize32, sizeOfSize);
+                    packageSize = packageSize32;
+                }
+                else
+                    ReadData(file, totalSize_ - sizeOfSize, &packageSize, sizeOfSize);
+
+                // Start offset is limited to 32 bits by the interface
+                if (packageSize == 0 || packageSize >= totalSize_ || totalSize_ - packageSize > M_MAX_UNSIGNED)
+                    continue;
+
+                id = readID(totalSize_ - packageSize);
+                if (IsPackageID(id))
+                {
+                    startOffset = static_cast<unsigned>(totalSize_ - packageSize);
+                    break;
+                }
             }
         }
 
-        if (id != "UPAK" && id != "ULZ4" && id != "RPAK" && id != "RLZ4")
+        if (!IsPackageID(id))
         {
             URHO3D_LOGERROR(fileName + " is not a valid package file");
+            mappedFile_ = nullptr;
             return false;
         }
     }
 
     fileName_ = fileName;
     nameHash_ = fileName_;
-    totalSize_ = file->GetSize();
+    startOffset_ = startOffset;
+    version_ = id == "UPK2" ? 2 : 1;
     compressed_ = id == "ULZ4" || id == "RLZ4";
-    unsigned numFiles = file->ReadUInt();
-    checksum_ = file->ReadUInt();
+    directory_ = nullptr;
+    numEntries_ = 0;
+    names_ = nullptr;
+    namesSize_ = 0;
+    directoryStorage_.clear();
+    namesStorage_.clear();
+
+    {
+        MutexLock lock(blockMutex_);
+        blockIndices_.clear();
+        blockCache_.clear();
+    }
+
+    if (version_ == 2)
+        return ReadDirectoryV2(file);
+
+    // Version 1 packages are never larger than 4 GB. Compressed ones are read sequentially anyway.
+    if (!file)
+    {
+        URHO3D_LOGERROR(fileName + " is too large for package version 1");
+        mappedFile_ = nullptr;
+        return false;
+    }
+
+    if (compressed_)
+    {
+        mappedFile_ = nullptr;
+        totalSize_ = file->GetSize();
+    }
+
+    file->Seek(startOffset_ + 4);
+    return ReadDirectoryV1(*file, id);
+}
 
+bool PackageFile::ReadData(File* file, unsigned long long offset, void* dest, unsigned long long size) const
+{
+    if (offset > totalSize_ || size > totalSize_ - offset)
+        return false;
+
+    if (mappedFile_)
+    {
+        memcpy(dest, mappedFile_->GetData() + offset, static_cast<size_t>(size));
+        return true;
+    }
+
+    // Package is not larger than 4 GB if there is no mapping
+    file->Seek(static_cast<unsigned>(offset));
+    return file->Read(dest, static_cast<unsigned>(size)) == size;
+}
+
+bool PackageFile::ReadDirectoryV1(File& file, const ea::string& id)
+{
+    const unsigned numFiles = file.ReadUInt();
+    checksum_ = file.ReadUInt();
+
+    unsigned long long dataEnd = totalSize_ - startOffset_;
     if (id == "RPAK" || id == "RLZ4")
     {
         // New PAK file format includes two extra PAK header fields:
         // * Version. At this time this field is unused and is always 0. It will be used in the future if PAK format needs to be extended.
         // * File list offset. New format writes file list in the end of the file. This allows PAK creation without knowing entire file list
         //   beforehand.
-        unsigned version = file->ReadUInt();                        // Reserved for future use.
+        unsigned version = file.ReadUInt();                        // Reserved for future use.
         assert(version == 0);
-        int64_t fileListOffset = file->ReadInt64();                 // New format has file list at the end of the file.
-        file->Seek(fileListOffset);                                 // TODO: Serializer/Deserializer do not support files bigger than 4 GB
+        int64_t fileListOffset = file.ReadInt64();                 // New format has file list at the end of the file.
+        file.Seek(fileListOffset);                                 // TODO: Serializer/Deserializer do not support files bigger than 4 GB
+        dataEnd = static_cast<unsigned long long>(fileListOffset) - startOffset_;
+    }
+    else if (compressed_)
+    {
+        // Package size is written after the last file
+        dataEnd -= sizeof(unsigned);
     }
 
+    ea::vector<PackageEntry> entries;
+    ea::vector<ea::string> entryNames;
+    entries.reserve(numFiles);
+    entryNames.reserve(numFiles);
     for (unsigned i = 0; i < numFiles; ++i)
     {
-        ea::string entryName = file->ReadString();
+        ea::string entryName = file.ReadString();
         PackageEntry newEntry{};
-        newEntry.offset_ = file->ReadUInt() + startOffset;
-        totalDataSize_ += (newEntry.size_ = file->ReadUInt());
-        newEntry.checksum_ = file->ReadUInt();
-        if (!compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
+        newEntry.offset_ = file.ReadUInt();
+        newEntry.size_ = file.ReadUInt();
+        newEntry.checksum_ = file.ReadUInt();
+        newEntry.packedSize_ = newEntry.size_;
+        newEntry.codec_ = compressed_ ? PACKAGE_CODEC_LZ4 : PACKAGE_CODEC_NONE;
+        newEntry.nameHash_ = GetEntryNameHash(entryName);
+        newEntry.nameLength_ = entryName.length();
+        if (!compressed_ && GetDataOffset(newEntry) + newEntry.size_ > totalSize_)
         {
             URHO3D_LOGERROR("File entry " + entryName + " outside package file");
             return false;
         }
-        else
-            entries_[entryName] = newEntry;
+
+        entries.push_back(newEntry);
+        entryNames.push_back(ea::move(entryName));
     }
 
+    // Compressed files are written one after another
+    if (compressed_)
+    {
+        ea::vector<unsigned> order(numFiles);
+        for (unsigned i = 0; i < numFiles; ++i)
+            order[i] = i;
+        ea::sort(order.begin(), order.end(),
+            [&](unsigned lhs, unsigned rhs) { return entries[lhs].offset_ < entries[rhs].offset_; });
+
+        for (unsigned i = 0; i < numFiles; ++i)
+        {
+            PackageEntry& entry = entries[order[i]];
+            const unsigned long long nextOffset = i + 1 < numFiles ? entries[order[i + 1]].offset_ : dataEnd;
+            entry.packedSize_ = static_cast<unsigned>(nextOffset > entry.offset_ ? nextOffset - entry.offset_ : 0);
+        }
+    }
+
+    // Sort directory so files can be found by binary search
+    ea::vector<unsigned> sortedIndices(numFiles);
+    for (unsigned i = 0; i < numFiles; ++i)
+        sortedIndices[i] = i;
+    ea::sort(sortedIndices.begin(), sortedIndices.end(), [&](unsigned lhs, unsigned rhs)
+    {
+        return CompareEntries(entries[lhs], entryNames[lhs], entries[rhs], entryNames[rhs]);
+    });
+
+    directoryStorage_.reserve(numFiles);
+    for (unsigned index : sortedIndices)
+    {
+        PackageEntry& entry = entries[index];
+        entry.nameOffset_ = namesStorage_.length();
+        namesStorage_.append(entryNames[index]);
+        namesStorage_.push_back('\0');
+        directoryStorage_.push_back(entry);
+    }
+
+    directory_ = directoryStorage_.data();
+    numEntries_ = directoryStorage_.size();
+    names_ = namesStorage_.c_str();
+    namesSize_ = namesStorage_.length();
     return true;
 }
 
-bool PackageFile::Exists(const ea::string& fileName) const
+bool PackageFile::ReadDirectoryV2(File* file)
 {
-    bool found = entries_.find(fileName) != entries_.end();
+    // File ID, 3 32-bit fields and 3 64-bit fields
+    unsigned char header[4 + 3 * sizeof(unsigned) + 3 * sizeof(unsigned long long)];
+    if (!ReadData(file, startOffset_, header, sizeof(header)))
+    {
+        URHO3D_LOGERROR(fileName_ + " has corrupted header");
+        return false;
+    }
 
-#ifdef _WIN32
-    // On Windows perform a fallback case-insensitive search
-    if (!found)
+    MemoryBuffer headerBuffer(header, sizeof(header));
+    headerBuffer.ReadFileID();
+    const unsigned numFiles = headerBuffer.ReadUInt();
+    checksum_ = headerBuffer.ReadUInt();
+    const unsigned flags = headerBuffer.ReadUInt();
+    const unsigned long long directoryOffset = headerBuffer.ReadUInt64();
+    const unsigned long long namesOffset = headerBuffer.ReadUInt64();
+    const unsigned long long namesSize = headerBuffer.ReadUInt64();
+
+    compressed_ = (flags & PACKAGE_FLAG_COMPRESSED) != 0;
+
+    const unsigned long long directorySize = static_cast<unsigned long long>(numFiles) * sizeof(PackageEntry);
+    if (startOffset_ + directoryOffset + directorySize > totalSize_ || startOffset_ + namesOffset + namesSize > totalSize_)
+    {
+        URHO3D_LOGERROR(fileName_ + " has corrupted directory");
+        return false;
+    }
+
+    // Use directory from the mapped memory as is, if possible
+    const bool isAligned = (startOffset_ + directoryOffset) % alignof(PackageEntry) == 0;
+    if (mappedFile_ && isAligned)
     {
-        for (auto i = entries_.begin(); i != entries_.end(); ++i)
+        const unsigned char* packageData = mappedFile_->GetData() + startOffset_;
+        directory_ = reinterpret_cast<const PackageEntry*>(packageData + directoryOffset);
+        names_ = reinterpret_cast<const char*>(packageData + namesOffset);
+    }
+    else
+    {
+        directoryStorage_.resize(numFiles);
+        namesStorage_.resize(static_cast<unsigned>(namesSize));
+
+        if (!ReadData(file, startOffset_ + directoryOffset, directoryStorage_.data(), directorySize)
+            || !ReadData(file, startOffset_ + namesOffset, namesStorage_.data(), namesSize))
         {
-            if (!i->first.comparei(fileName))
-            {
-                found = true;
-                break;
-            }
+            URHO3D_LOGERROR(fileName_ + " has corrupted directory");
+            return false;
         }
+
+        directory_ = directoryStorage_.data();
+        names_ = namesStorage_.c_str();
     }
-#endif
 
-    return found;
+    numEntries_ = numFiles;
+    namesSize_ = namesSize;
+    return true;
+}
+
+bool PackageFile::IsEntryValid(const PackageEntry& entry) const
+{
+    if (entry.codec_ > PACKAGE_CODEC_ZSTD)
+        return false;
+    return GetDataOffset(entry) + entry.packedSize_ <= totalSize_;
+}
+
+unsigned long long PackageFile::GetTotalDataSize() const
+{
+    unsigned long long totalDataSize = 0;
+    for (const PackageEntry& entry : GetEntries())
+        totalDataSize += entry.size_;
+    return totalDataSize;
+}
+
+const ea::vector<ea::string> PackageFile::GetEntryNames() const
+{
+    ea::vector<ea::string> result;
+    result.reserve(numEntries_);
+    for (const PackageEntry& entry : GetEntries())
+        result.emplace_back(GetEntryName(entry));
+    return result;
+}
+
+void PackageFile::PrefetchFile(const ea::string& fileName) const
+{
+    if (!mappedFile_)
+        return;
+
+    if (const PackageEntry* entry = GetEntry(fileName))
+        mappedFile_->Prefetch(GetDataOffset(*entry), entry->packedSize_);
+}
+
+ConstByteSpan PackageFile::GetMappedData(const PackageEntry& entry) const
+{
+    if (!mappedFile_ || !IsEntryValid(entry))
+        return {};
+    return {mappedFile_->GetData() + GetDataOffset(entry), entry.packedSize_};
+}
+
+ea::shared_ptr<const PackageBlockIndex> PackageFile::GetBlockIndex(const PackageEntry& entry) const
+{
+    MutexLock lock(blockMutex_);
+    const auto iter = blockIndices_.find(GetDataOffset(entry));
+    return iter != blockIndices_.end() ? iter->second : nullptr;
+}
+
+ea::shared_ptr<const PackageBlockIndex> PackageFile::StoreBlockIndex(const PackageEntry& entry, PackageBlockIndex index)
+{
+    MutexLock lock(blockMutex_);
+    auto& storedIndex = blockIndices_[GetDataOffset(entry)];
+    if (!storedIndex)
+        storedIndex = ea::make_shared<const PackageBlockIndex>(ea::move(index));
+    return storedIndex;
+}
+
+SharedByteVector PackageFile::GetCachedBlock(unsigned long long blockOffset)
+{
+    MutexLock lock(blockMutex_);
+    for (CachedBlock& block : blockCache_)
+    {
+        if (block.offset_ == blockOffset)
+        {
+            block.lastUse_ = ++blockCacheTimestamp_;
+            return block.data_;
+        }
+    }
+    return nullptr;
+}
+
+void PackageFile::StoreCachedBlock(unsigned long long blockOffset, const SharedByteVector& data)
+{
+    MutexLock lock(blockMutex_);
+    if (blockCacheSize_ == 0)
+        return;
+
+    // Cache is small, linear search is good enough
+    CachedBlock* destBlock = nullptr;
+    for (CachedBlock& block : blockCache_)
+    {
+        if (block.offset_ == blockOffset)
+            return;
+        if (!destBlock || block.lastUse_ < destBlock->lastUse_)
+            destBlock = &block;
+    }
+
+    if (blockCache_.size() < blockCacheSize_)
+        destBlock = &blockCache_.emplace_back();
+
+    destBlock->offset_ = blockOffset;
+    destBlock->data_ = data;
+    destBlock->lastUse_ = ++blockCacheTimestamp_;
+}
+
+void PackageFile::SetBlockCacheSize(unsigned numBlocks)
+{
+    MutexLock lock(blockMutex_);
+    blockCacheSize_ = numBlocks;
+    if (blockCache_.size() > blockCacheSize_)
+    {
+        ea::sort(blockCache_.begin(), blockCache_.end(),
+            [](const CachedBlock& lhs, const CachedBlock& rhs) { return lhs.lastUse_ > rhs.lastUse_; });
+        blockCache_.resize(blockCacheSize_);
+    }
+}
+
+bool PackageFile::Exists(const ea::string& fileName) const
+{
+    return GetEntry(fileName) != nullptr;
 }
 
 const PackageEntry* PackageFile::GetEntry(const ea::string& fileName) const
 {
-    auto i = entries_.find(fileName);
-    if (i != entries_.end())
-        return &i->second;
+    const unsigned long long nameHash = GetEntryNameHash(fileName);
+    const PackageEntry* begin = directory_;
+    const PackageEntry* end = directory_ + numEntries_;
+    const PackageEntry* iter = ea::lower_bound(begin, end, nameHash,
+        [](const PackageEntry& entry, unsigned long long hash) { return entry.nameHash_ < hash; });
+    for (; iter != end && iter->nameHash_ == nameHash; ++iter)
+    {
+        if (GetEntryName(*iter) == fileName)
+            return IsEntryValid(*iter) ? iter : nullptr;
+    }
 
 #ifdef _WIN32
     // On Windows perform a fallback case-insensitive search
-    else
+    for (const PackageEntry& entry : GetEntries())
     {
-        for (auto j = entries_.begin(); j != entries_.end(); ++j)
-        {
-            if (!j->first.comparei(fileName))
-                return &j->second;
-        }
+        if (ea::string(GetEntryName(entry)).comparei(fileName) == 0)
+            return IsEntryValid(entry) ? &entry : nullptr;
     }
 #endif
 
@@ -217,9 +555,21 @@ AbstractFilePtr PackageFile::OpenFile(const FileIdentifier& fileName, FileMode m
         return {};
 
     // Quit if file doesn't exists in the package.
-    if (!Exists(fileName.fileName_))
+    const PackageEntry* entry = GetEntry(fileName.fileName_);
+    if (!entry)
         return {};
 
+    if (mappedFile_ && entry->codec_ == PACKAGE_CODEC_NONE)
+    {
+        // Start reading the pages now, the file is usually parsed a bit later
+        const unsigned long long dataOffset = GetDataOffset(*entry);
+        mappedFile_->Prefetch(dataOffset, entry->size_);
+
+        auto view = MakeShared<MappedPackageEntry>(mappedFile_, mappedFile_->GetData() + dataOffset, *entry);
+        view->SetName(fileName.ToUri());
+        return view;
+    }
+
     auto file = MakeShared<File>(context_, this, fileName.fileName_);
     file->SetName(fileName.ToUri());
     return file;
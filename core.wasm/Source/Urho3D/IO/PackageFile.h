@@ -22,24 +22,79 @@
 
 #pragma once
 
+#include "Urho3D/Container/ByteVector.h"
+#include "Urho3D/Core/Mutex.h"
 #include "Urho3D/IO/MountPoint.h"
 #include "Urho3D/IO/ScanFlags.h"
 
+#include <EASTL/span.h>
+#include <EASTL/string_view.h>
+
 namespace Urho3D
 {
 
+class File;
+class MemoryMappedFile;
+
+/// Compression codec of the file in the package.
+enum PackageCodec
+{
+    /// File is stored as is.
+    PACKAGE_CODEC_NONE = 0,
+    /// File is stored as sequence of LZ4 blocks.
+    PACKAGE_CODEC_LZ4,
+    /// File is stored as sequence of LZ4 blocks compressed in high compression mode.
+    PACKAGE_CODEC_LZ4HC,
+    /// Reserved for Zstandard compression. Not supported by this build.
+    PACKAGE_CODEC_ZSTD,
+};
+
+/// Header flag of package file version 2: some files in the package are compressed.
+static const unsigned PACKAGE_FLAG_COMPRESSED = 1u;
+
 /// %File entry within the package file.
+/// Package files of version 2 store array of entries as is, so the layout should not change.
 struct PackageEntry
 {
-    /// Offset from the beginning.
-    unsigned offset_;
+    /// Offset from the beginning of the package.
+    unsigned long long offset_;
     /// File size.
     unsigned size_;
     /// File checksum.
     unsigned checksum_;
+    /// Size of file data in the package. Equal to file size for uncompressed files.
+    unsigned packedSize_;
+    /// Compression codec.
+    unsigned codec_;
+    /// Hash of the file name. Entries are sorted by the hash.
+    unsigned long long nameHash_;
+    /// Offset of the null-terminated file name in the name table.
+    unsigned nameOffset_;
+    /// Length of the file name.
+    unsigned nameLength_;
 };
 
+static_assert(sizeof(PackageEntry) == 40, "PackageEntry layout is a part of package file format");
+
+/// Compressed block of the file in the package.
+struct PackageBlock
+{
+    /// Offset of the decompressed data from the beginning of the file.
+    unsigned unpackedOffset_;
+    /// Offset of the block header from the beginning of the file data in the package.
+    unsigned packedOffset_;
+    /// Size of the decompressed data.
+    unsigned unpackedSize_;
+    /// Size of the compressed data, not including the block header.
+    unsigned packedSize_;
+};
+
+/// Index of compressed blocks of the file in the package, sorted by offset.
+using PackageBlockIndex = ea::vector<PackageBlock>;
+
 /// Stores files of a directory tree sequentially for convenient access.
+/// Files are looked up by binary search in the directory sorted by name hash.
+/// Directory of version 2 packages is used directly from the memory-mapped package without parsing.
 class URHO3D_API PackageFile : public MountPoint
 {
     URHO3D_OBJECT(PackageFile, MountPoint);
@@ -52,30 +107,42 @@ public:
     /// Destruct.
     ~PackageFile() override;
 
+    /// Return hash of the file name used by the package directory.
+    static unsigned long long GetEntryNameHash(ea::string_view fileName);
+
     /// Open the package file. Return true if successful.
     bool Open(const ea::string& fileName, unsigned startOffset = 0);
     /// Check if a file exists within the package file. This will be case-insensitive on Windows and case-sensitive on other platforms.
     bool Exists(const ea::string& fileName) const;
     /// Return the file entry corresponding to the name, or null if not found. This will be case-insensitive on Windows and case-sensitive on other platforms.
     const PackageEntry* GetEntry(const ea::string& fileName) const;
+    /// Return offset of the file data from the beginning of the file containing the package.
+    unsigned long long GetDataOffset(const PackageEntry& entry) const { return startOffset_ + entry.offset_; }
 
-    /// Return all file entries.
-    const ea::unordered_map<ea::string, PackageEntry>& GetEntries() const { return entries_; }
+    /// Return all file entries, sorted by name hash.
+    ea::span<const PackageEntry> GetEntries() const { return {directory_, numEntries_}; }
+    /// Return name of the file entry.
+    ea::string_view GetEntryName(const PackageEntry& entry) const
+    {
+        if (static_cast<unsigned long long>(entry.nameOffset_) + entry.nameLength_ > namesSize_)
+            return {};
+        return {names_ + entry.nameOffset_, entry.nameLength_};
+    }
 
     /// Return hash of the package file name.
     StringHash GetNameHash() const { return nameHash_; }
 
     /// Return number of files.
     /// @property
-    unsigned GetNumFiles() const { return entries_.size(); }
+    unsigned GetNumFiles() const { return numEntries_; }
 
     /// Return total size of the package file.
     /// @property
-    unsigned GetTotalSize() const { return totalSize_; }
+    unsigned long long GetTotalSize() const { return totalSize_; }
 
     /// Return total data size from all the file entries in the package file.
     /// @property
-    unsigned GetTotalDataSize() const { return totalDataSize_; }
+    unsigned long long GetTotalDataSize() const;
 
     /// Return checksum of the package file contents.
     /// @property
@@ -85,19 +152,36 @@ public:
     /// @property
     bool IsCompressed() const { return compressed_; }
 
+    /// Return version of package file format.
+    unsigned GetVersion() const { return version_; }
+
+    /// Return whether the package is memory-mapped. Uncompressed files of mapped packages are opened as views of the mapped memory.
+    bool IsMemoryMapped() const { return mappedFile_ != nullptr; }
+    /// Hint that the file will be read soon. Does nothing if the package is not memory-mapped.
+    void PrefetchFile(const ea::string& fileName) const;
+    /// Return file data as stored in the package, possibly compressed. Empty if the package is not memory-mapped.
+    ConstByteSpan GetMappedData(const PackageEntry& entry) const;
+
+    /// Return block index of the compressed file if it was built already. Thread-safe.
+    ea::shared_ptr<const PackageBlockIndex> GetBlockIndex(const PackageEntry& entry) const;
+    /// Store block index of the compressed file. Return the index stored first if called concurrently. Thread-safe.
+    ea::shared_ptr<const PackageBlockIndex> StoreBlockIndex(const PackageEntry& entry, PackageBlockIndex index);
+    /// Return decompressed block from the cache, or null if not cached. Block is identified by its offset in the package. Thread-safe.
+    SharedByteVector GetCachedBlock(unsigned long long blockOffset);
+    /// Store decompressed block in the cache, evicting least recently used block. Thread-safe.
+    void StoreCachedBlock(unsigned long long blockOffset, const SharedByteVector& data);
+    /// Set maximum number of decompressed blocks shared by all files opened from the package.
+    void SetBlockCacheSize(unsigned numBlocks);
+    /// Return maximum number of cached decompressed blocks.
+    unsigned GetBlockCacheSize() const { return blockCacheSize_; }
+
     /// Return list of file names in the package.
-    const ea::vector<ea::string> GetEntryNames() const { return entries_.keys(); }
+    const ea::vector<ea::string> GetEntryNames() const;
 
     /// Return a file name in the package at the specified index
-    const ea::string& GetEntryName(unsigned index) const
+    ea::string GetEntryName(unsigned index) const
     {
-        unsigned nn = 0;
-        for (auto j = entries_.begin(); j != entries_.end(); ++j)
-        {
-            if (nn == index) return j->first;
-            nn++;
-        }
-        return EMPTY_STRING;
+        return index < numEntries_ ? ea::string(GetEntryName(directory_[index])) : EMPTY_STRING;
     }
 
     /// Implement MountPoint.
@@ -115,20 +199,62 @@ public:
     /// @}
 
 private:
-    /// File entries.
-    ea::unordered_map<ea::string, PackageEntry> entries_;
+    /// Read directory of version 1 package and sort it by name hash.
+    bool ReadDirectoryV1(File& file, const ea::string& id);
+    /// Read or map directory of version 2 package. File is null if the package is larger than 4 GB.
+    bool ReadDirectoryV2(File* file);
+    /// Read data at absolute offset from the mapped package if possible, from the file otherwise.
+    bool ReadData(File* file, unsigned long long offset, void* dest, unsigned long long size) const;
+    /// Return whether the entry is located inside the package.
+    bool IsEntryValid(const PackageEntry& entry) const;
+
+    /// Decompressed block in the cache.
+    struct CachedBlock
+    {
+        unsigned long long offset_{};
+        SharedByteVector data_;
+        unsigned lastUse_{};
+    };
+
+    /// Sorted file entries. Points either to mapped package or to directoryStorage_.
+    const PackageEntry* directory_{};
+    /// Number of file entries.
+    unsigned numEntries_{};
+    /// Table of null-terminated file names. Points either to mapped package or to namesStorage_.
+    const char* names_{};
+    /// Size of the name table.
+    unsigned long long namesSize_{};
+    /// Storage for file entries if package is not mapped.
+    ea::vector<PackageEntry> directoryStorage_;
+    /// Storage for file names if package is not mapped.
+    ea::string namesStorage_;
     /// File name.
     ea::string fileName_;
     /// Package file name hash.
     StringHash nameHash_;
+    /// Offset of the package in the file.
+    unsigned long long startOffset_{};
     /// Package file total size.
-    unsigned totalSize_;
-    /// Total data size in the package using each entry's actual size if it is a compressed package file.
-    unsigned totalDataSize_;
+    unsigned long long totalSize_{};
     /// Package file checksum.
-    unsigned checksum_;
+    unsigned checksum_{};
+    /// Package format version.
+    unsigned version_{};
     /// Compressed flag.
-    bool compressed_;
+    bool compressed_{};
+    /// Memory mapping of the package.
+    SharedPtr<MemoryMappedFile> mappedFile_;
+
+    /// Mutex for block indices and block cache.
+    mutable Mutex blockMutex_;
+    /// Block indices of compressed files, by file data offset.
+    ea::unordered_map<unsigned long long, ea::shared_ptr<const PackageBlockIndex>> blockIndices_;
+    /// Cache of decompressed blocks.
+    ea::vector<CachedBlock> blockCache_;
+    /// Maximum number of cached blocks.
+    unsigned blockCacheSize_{32};
+    /// Counter used to find least recently used block.
+    unsigned blockCacheTimestamp_{};
 };
 
 }
@@ -0,0 +1,416 @@
+//
+// Copyright (c) 2021 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "DenseKernels.h"
+
+#include "../Core/Assert.h"
+#include "../Math/MathDefs.h"
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Urho3D
+{
+
+namespace ParticleGraphNodes
+{
+
+namespace
+{
+
+/// Number of floats processed per iteration. It is divisible by all supported value widths.
+static constexpr unsigned BlockSize = 12;
+
+/// Reads operand values laid out as the output of given width.
+class OperandReader
+{
+public:
+    OperandReader(const DenseFloats& source, unsigned width)
+        : source_(source)
+        , width_(width)
+    {
+        URHO3D_ASSERT(source_.width_ == width_ || source_.width_ == 1);
+#ifdef URHO3D_SSE
+        if (source_.scalar_)
+        {
+            float pattern[BlockSize];
+            for (unsigned i = 0; i < BlockSize; ++i)
+                pattern[i] = Get(0, i % width_);
+            for (unsigned i = 0; i < 3; ++i)
+                pattern_[i] = _mm_loadu_ps(pattern + i * 4);
+        }
+#endif
+    }
+
+    /// Return value component for given particle.
+    float Get(unsigned particle, unsigned component) const
+    {
+        const unsigned index = source_.scalar_ ? 0 : particle;
+        return source_.width_ == 1 ? source_.data_[index] : source_.data_[index * width_ + component];
+    }
+
+#ifdef URHO3D_SSE
+    /// Load block of values starting from given particle.
+    void Load(unsigned particle, __m128 (&block)[3]) const
+    {
+        if (source_.scalar_)
+        {
+            block[0] = pattern_[0];
+            block[1] = pattern_[1];
+            block[2] = pattern_[2];
+        }
+        else if (source_.width_ == width_)
+        {
+            const float* ptr = source_.data_ + particle * width_;
+            block[0] = _mm_loadu_ps(ptr);
+            block[1] = _mm_loadu_ps(ptr + 4);
+            block[2] = _mm_loadu_ps(ptr + 8);
+        }
+        else
+        {
+            // Expand one float per particle to all components
+            const float* ptr = source_.data_ + particle;
+            switch (width_)
+            {
+            case 2:
+            {
+                const __m128 first = _mm_loadu_ps(ptr);
+                const __m128 last = _mm_loadu_ps(ptr + 2);
+                block[0] = _mm_unpacklo_ps(first, first);
+                block[1] = _mm_unpackhi_ps(first, first);
+                block[2] = _mm_unpackhi_ps(last, last);
+                break;
+            }
+            case 3:
+            {
+                const __m128 values = _mm_loadu_ps(ptr);
+                block[0] = _mm_shuffle_ps(values, values, _MM_SHUFFLE(1, 0, 0, 0));
+                block[1] = _mm_shuffle_ps(values, values, _MM_SHUFFLE(2, 2, 1, 1));
+                block[2] = _mm_shuffle_ps(values, values, _MM_SHUFFLE(3, 3, 3, 2));
+                break;
+            }
+            case 4:
+            {
+                block[0] = _mm_set1_ps(ptr[0]);
+                block[1] = _mm_set1_ps(ptr[1]);
+                block[2] = _mm_set1_ps(ptr[2]);
+                break;
+            }
+            default:
+                URHO3D_ASSERT(false);
+                break;
+            }
+        }
+    }
+#endif
+
+private:
+    DenseFloats source_;
+    unsigned width_{};
+#ifdef URHO3D_SSE
+    __m128 pattern_[3];
+#endif
+};
+
+#ifdef URHO3D_SSE
+/// Convert 4 consecutive Vector3 values into separate X, Y and Z registers.
+inline void TransposeVector3(const __m128 (&block)[3], __m128& x, __m128& y, __m128& z)
+{
+    // block: x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+    const __m128 z0x1z1x2 = _mm_shuffle_ps(block[0], block[1], _MM_SHUFFLE(2, 1, 3, 2));
+    const __m128 x2y2z2x3 = _mm_shuffle_ps(block[1], block[2], _MM_SHUFFLE(1, 0, 3, 2));
+    const __m128 y0y0y1y1 = _mm_shuffle_ps(block[0], block[1], _MM_SHUFFLE(0, 0, 1, 1));
+    const __m128 y2y2y3y3 = _mm_shuffle_ps(block[1], block[2], _MM_SHUFFLE(2, 2, 3, 3));
+    const __m128 z2z2z3z3 = _mm_shuffle_ps(block[2], block[2], _MM_SHUFFLE(3, 3, 0, 0));
+    x = _mm_shuffle_ps(block[0], x2y2z2x3, _MM_SHUFFLE(3, 0, 3, 0));
+    y = _mm_shuffle_ps(y0y0y1y1, y2y2y3y3, _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(z0x1z1x2, z2z2z3z3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// Load 4 consecutive Vector3 values.
+inline void LoadVector3Block(const float* ptr, __m128 (&block)[3])
+{
+    block[0] = _mm_loadu_ps(ptr);
+    block[1] = _mm_loadu_ps(ptr + 4);
+    block[2] = _mm_loadu_ps(ptr + 8);
+}
+
+/// Return length of 4 Vector3 values.
+inline __m128 LengthVector3(const __m128 (&block)[3])
+{
+    __m128 x, y, z;
+    TransposeVector3(block, x, y, z);
+    return _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+}
+#endif
+
+/// Apply unary operation to all value components.
+template <class Op> void RunUnary(float* out, const DenseFloats& x, unsigned numParticles, const Op& op)
+{
+    const unsigned width = x.width_;
+    const OperandReader xReader(x, width);
+
+    unsigned particle = 0;
+#ifdef URHO3D_SSE
+    const unsigned particlesPerBlock = BlockSize / width;
+    for (; particle + particlesPerBlock <= numParticles; particle += particlesPerBlock)
+    {
+        __m128 xBlock[3];
+        xReader.Load(particle, xBlock);
+
+        float* dest = out + particle * width;
+        for (unsigned i = 0; i < 3; ++i)
+            _mm_storeu_ps(dest + i * 4, op(xBlock[i]));
+    }
+#endif
+    for (; particle < numParticles; ++particle)
+    {
+        for (unsigned i = 0; i < width; ++i)
+            out[particle * width + i] = op(xReader.Get(particle, i));
+    }
+}
+
+/// Apply binary operation to all value components.
+template <class Op>
+void RunBinary(float* out, const DenseFloats& x, const DenseFloats& y, unsigned numParticles, const Op& op)
+{
+    const unsigned width = x.width_;
+    const OperandReader xReader(x, width);
+    const OperandReader yReader(y, width);
+
+    unsigned particle = 0;
+#ifdef URHO3D_SSE
+    const unsigned particlesPerBlock = BlockSize / width;
+    for (; particle + particlesPerBlock <= numParticles; particle += particlesPerBlock)
+    {
+        __m128 xBlock[3];
+        __m128 yBlock[3];
+        xReader.Load(particle, xBlock);
+        yReader.Load(particle, yBlock);
+
+        float* dest = out + particle * width;
+        for (unsigned i = 0; i < 3; ++i)
+            _mm_storeu_ps(dest + i * 4, op(xBlock[i], yBlock[i]));
+    }
+#endif
+    for (; particle < numParticles; ++particle)
+    {
+        for (unsigned i = 0; i < width; ++i)
+            out[particle * width + i] = op(xReader.Get(particle, i), yReader.Get(particle, i));
+    }
+}
+
+/// Apply ternary operation to all value components.
+template <class Op>
+void RunTernary(float* out, const DenseFloats& x, const DenseFloats& y, const DenseFloats& z, unsigned numParticles,
+    const Op& op)
+{
+    const unsigned width = x.width_;
+    const OperandReader xReader(x, width);
+    const OperandReader yReader(y, width);
+    const OperandReader zReader(z, width);
+
+    unsigned particle = 0;
+#ifdef URHO3D_SSE
+    const unsigned particlesPerBlock = BlockSize / width;
+    for (; particle + particlesPerBlock <= numParticles; particle += particlesPerBlock)
+    {
+        __m128 xBlock[3];
+        __m128 yBlock[3];
+        __m128 zBlock[3];
+        xReader.Load(particle, xBlock);
+        yReader.Load(particle, yBlock);
+        zReader.Load(particle, zBlock);
+
+        float* dest = out + particle * width;
+        for (unsigned i = 0; i < 3; ++i)
+            _mm_storeu_ps(dest + i * 4, op(xBlock[i], yBlock[i], zBlock[i]));
+    }
+#endif
+    for (; particle < numParticles; ++particle)
+    {
+        for (unsigned i = 0; i < width; ++i)
+            out[particle * width + i] = op(xReader.Get(particle, i), yReader.Get(particle, i), zReader.Get(particle, i));
+    }
+}
+
+struct AddOp
+{
+    float operator()(float x, float y) const { return x + y; }
+#ifdef URHO3D_SSE
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_add_ps(x, y); }
+#endif
+};
+
+struct DivideOp
+{
+    float operator()(float x, float y) const { return x / y; }
+#ifdef URHO3D_SSE
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_div_ps(x, y); }
+#endif
+};
+
+struct MultiplyAddOp
+{
+    explicit MultiplyAddOp(float scale)
+        : scale_(scale)
+#ifdef URHO3D_SSE
+        , scaleVector_(_mm_set1_ps(scale))
+#endif
+    {
+    }
+
+    float operator()(float x, float y) const { return x + y * scale_; }
+#ifdef URHO3D_SSE
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_add_ps(x, _mm_mul_ps(y, scaleVector_)); }
+#endif
+
+    float scale_{};
+#ifdef URHO3D_SSE
+    __m128 scaleVector_;
+#endif
+};
+
+struct LerpOp
+{
+    float operator()(float x, float y, float t) const { return x * (1.0f - t) + y * t; }
+#ifdef URHO3D_SSE
+    __m128 operator()(__m128 x, __m128 y, __m128 t) const
+    {
+        const __m128 oneMinusT = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+        return _mm_add_ps(_mm_mul_ps(x, oneMinusT), _mm_mul_ps(y, t));
+    }
+#endif
+};
+
+struct Clamp01Op
+{
+    float operator()(float x) const { return Clamp(x, 0.0f, 1.0f); }
+#ifdef URHO3D_SSE
+    __m128 operator()(__m128 x) const { return _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+#endif
+};
+
+} // namespace
+
+void DenseAdd(float* out, const DenseFloats& x, const DenseFloats& y, unsigned numParticles)
+{
+    RunBinary(out, x, y, numParticles, AddOp{});
+}
+
+void DenseDivide(float* out, const DenseFloats& x, const DenseFloats& y, unsigned numParticles)
+{
+    RunBinary(out, x, y, numParticles, DivideOp{});
+}
+
+void DenseMultiplyAdd(float* out, const DenseFloats& x, const DenseFloats& y, float scale, unsigned numParticles)
+{
+    RunBinary(out, x, y, numParticles, MultiplyAddOp{scale});
+}
+
+void DenseLerp(float* out, const DenseFloats& x, const DenseFloats& y, const DenseFloats& t, unsigned numParticles)
+{
+    RunTernary(out, x, y, t, numParticles, LerpOp{});
+}
+
+void DenseClamp01(float* out, const DenseFloats& x, unsigned numParticles)
+{
+    RunUnary(out, x, numParticles, Clamp01Op{});
+}
+
+void DenseLengthVector3(float* out, const DenseFloats& x, unsigned numParticles)
+{
+    URHO3D_ASSERT(x.width_ == 3);
+
+    unsigned particle = 0;
+#ifdef URHO3D_SSE
+    if (!x.scalar_)
+    {
+        for (; particle + 4 <= numParticles; particle += 4)
+        {
+            __m128 block[3];
+            LoadVector3Block(x.data_ + particle * 3, block);
+            _mm_storeu_ps(out + particle, LengthVector3(block));
+        }
+    }
+#endif
+    for (; particle < numParticles; ++particle)
+    {
+        const float* value = x.data_ + (x.scalar_ ? 0 : particle * 3);
+        out[particle] = sqrtf(value[0] * value[0] + value[1] * value[1] + value[2] * value[2]);
+    }
+}
+
+void DenseLimitVelocity(
+    float* out, const DenseFloats& velocity, const DenseFloats& limit, float t, unsigned numParticles)
+{
+    URHO3D_ASSERT(velocity.width_ == 3 && limit.width_ == 1);
+
+    unsigned particle = 0;
+#ifdef URHO3D_SSE
+    if (!velocity.scalar_)
+    {
+        const __m128 epsilon = _mm_set1_ps(1e-6f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 factorT = _mm_set1_ps(t);
+        const __m128 factorOneMinusT = _mm_set1_ps(1.0f - t);
+        for (; particle + 4 <= numParticles; particle += 4)
+        {
+            __m128 block[3];
+            LoadVector3Block(velocity.data_ + particle * 3, block);
+
+            const __m128 speed = LengthVector3(block);
+            const __m128 limitValue = limit.scalar_ ? _mm_set1_ps(limit.data_[0]) : _mm_loadu_ps(limit.data_ + particle);
+            const __m128 targetSpeed = _mm_add_ps(_mm_mul_ps(speed, factorOneMinusT), _mm_mul_ps(limitValue, factorT));
+
+            // Keep velocity as is if it is below the limit
+            const __m128 mask = _mm_cmpgt_ps(speed, _mm_add_ps(limitValue, epsilon));
+            const __m128 factor =
+                _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(targetSpeed, speed)), _mm_andnot_ps(mask, one));
+
+            float* dest = out + particle * 3;
+            _mm_storeu_ps(dest, _mm_mul_ps(block[0], _mm_shuffle_ps(factor, factor, _MM_SHUFFLE(1, 0, 0, 0))));
+            _mm_storeu_ps(dest + 4, _mm_mul_ps(block[1], _mm_shuffle_ps(factor, factor, _MM_SHUFFLE(2, 2, 1, 1))));
+            _mm_storeu_ps(dest + 8, _mm_mul_ps(block[2], _mm_shuffle_ps(factor, factor, _MM_SHUFFLE(3, 3, 3, 2))));
+        }
+    }
+#endif
+    for (; particle < numParticles; ++particle)
+    {
+        const float* value = velocity.data_ + (velocity.scalar_ ? 0 : particle * 3);
+        const float speed = sqrtf(value[0] * value[0] + value[1] * value[1] + value[2] * value[2]);
+        const float limitValue = limit.data_[limit.scalar_ ? 0 : particle];
+        const float factor = speed > limitValue + 1e-6f ? Lerp(speed, limitValue, t) / speed : 1.0f;
+
+        float* dest = out + particle * 3;
+        dest[0] = value[0] * factor;
+        dest[1] = value[1] * factor;
+        dest[2] = value[2] * factor;
+    }
+}
+
+} // namespace ParticleGraphNodes
+
+} // namespace Urho3D
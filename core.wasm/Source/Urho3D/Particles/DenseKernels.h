@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2021 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Urho3D.h"
+#include "Span.h"
+
+namespace Urho3D
+{
+
+namespace ParticleGraphNodes
+{
+
+/// Dense or scalar pin values reinterpreted as array of floats.
+struct DenseFloats
+{
+    /// Pointer to the first value.
+    const float* data_{};
+    /// Number of floats per particle.
+    unsigned width_{};
+    /// Whether the same value is shared by all particles.
+    bool scalar_{};
+};
+
+/// Make float view of dense span. Value type should consist of floats only.
+template <typename T> DenseFloats MakeDenseFloats(const DenseSpan<T>& span)
+{
+    static_assert(sizeof(T) % sizeof(float) == 0 && sizeof(T) <= 4 * sizeof(float), "Unsupported value type");
+    return DenseFloats{reinterpret_cast<const float*>(span.data_), sizeof(T) / sizeof(float), span.scalar_};
+}
+
+/// Return output pointer of dense span.
+template <typename T> float* GetDenseOutput(const DenseSpan<T>& span)
+{
+    return reinterpret_cast<float*>(span.data_);
+}
+
+/// Return number of particles to process for the output span.
+template <typename T> unsigned GetDenseCount(const DenseSpan<T>& out, unsigned numParticles)
+{
+    return out.scalar_ ? ea::min(numParticles, 1u) : numParticles;
+}
+
+/// Vectorized kernels for dense particle values.
+/// Output width is the width of the first operand. Other operands should either have the same width or width 1,
+/// in which case the value is applied to all components.
+/// @{
+/// Evaluate out = x + y.
+URHO3D_API void DenseAdd(float* out, const DenseFloats& x, const DenseFloats& y, unsigned numParticles);
+/// Evaluate out = x / y.
+URHO3D_API void DenseDivide(float* out, const DenseFloats& x, const DenseFloats& y, unsigned numParticles);
+/// Evaluate out = x + y * scale.
+URHO3D_API void DenseMultiplyAdd(
+    float* out, const DenseFloats& x, const DenseFloats& y, float scale, unsigned numParticles);
+/// Evaluate out = x * (1 - t) + y * t.
+URHO3D_API void DenseLerp(
+    float* out, const DenseFloats& x, const DenseFloats& y, const DenseFloats& t, unsigned numParticles);
+/// Evaluate out = clamp(x, 0, 1).
+URHO3D_API void DenseClamp01(float* out, const DenseFloats& x, unsigned numParticles);
+/// Evaluate length of Vector3 values.
+URHO3D_API void DenseLengthVector3(float* out, const DenseFloats& x, unsigned numParticles);
+/// Limit length of Vector3 velocity. The length is interpolated towards the limit by factor t.
+URHO3D_API void DenseLimitVelocity(
+    float* out, const DenseFloats& velocity, const DenseFloats& limit, float t, unsigned numParticles);
+/// @}
+
+} // namespace ParticleGraphNodes
+
+} // namespace Urho3D
@@ -46,10 +46,53 @@ template <typename T> struct GetPinType<ParticleGraphTypedPin<T>>
     typedef T Type;
 };
 
+/// Detect whether node instance has vectorized update for span and scalar pins.
+template <typename Instance, typename Enabled, typename... Values> struct HasDenseUpdateImpl : ea::false_type
+{
+};
+template <typename Instance, typename... Values>
+struct HasDenseUpdateImpl<Instance,
+    ea::void_t<decltype(ea::declval<Instance&>().UpdateDense(ea::declval<const UpdateContext&>(), 0u,
+        ea::declval<const DenseSpan<typename GetPinType<Values>::Type>&>()...))>,
+    Values...> : ea::true_type
+{
+};
+template <typename Instance, typename... Values>
+static constexpr bool HasDenseUpdate = HasDenseUpdateImpl<Instance, void, Values...>::value;
+
+/// Return whether all pins are stored contiguously.
+inline bool AreDensePins(const ParticleGraphPinRef* pinRefs, unsigned numPins)
+{
+    for (unsigned i = 0; i < numPins; ++i)
+    {
+        if (pinRefs[i].type_ != ParticleGraphContainerType::Span && pinRefs[i].type_ != ParticleGraphContainerType::Scalar)
+            return false;
+    }
+    return true;
+}
+
+/// Run vectorized update with dense spans.
+template <typename Instance, typename... Values, size_t... Indices>
+void RunDenseUpdate(const UpdateContext& context, Instance& instance, ParticleGraphPinRef* pinRefs, ea::index_sequence<Indices...>)
+{
+    instance.UpdateDense(context, static_cast<unsigned>(context.indices_.size()),
+        context.GetDenseSpan<typename GetPinType<Values>::Type>(pinRefs[Indices])...);
+}
+
 /// Abstract update runner.
+/// Uses vectorized update if instance provides it and no pin is sparse.
 template <typename Instance, typename... Values>
 void RunUpdate(const UpdateContext& context, Instance& instance, ParticleGraphPinRef* pinRefs)
 {
+    if constexpr (HasDenseUpdate<Instance, Values...>)
+    {
+        if (AreDensePins(pinRefs, sizeof...(Values)))
+        {
+            RunDenseUpdate<Instance, Values...>(context, instance, pinRefs, ea::index_sequence_for<Values...>{});
+            return;
+        }
+    }
+
     auto spans = SpanVariantTuple<Values...>::Make(context, pinRefs);
     ea::apply(instance, ea::tuple_cat(ea::tie(context), ea::make_tuple(static_cast<unsigned>(context.indices_.size())), spans));
 };
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../DenseKernels.h"
+
 namespace Urho3D
 {
 class ParticleGraphSystem;
@@ -38,6 +40,12 @@ template <typename Value0, typename Value1, typename Value2> struct AddInstance
             out[i] = x[i] + y[i];
         }
     }
+
+    void UpdateDense(const UpdateContext& context, unsigned numParticles, const DenseSpan<Value0>& x,
+        const DenseSpan<Value1>& y, const DenseSpan<Value2>& out)
+    {
+        DenseAdd(GetDenseOutput(out), MakeDenseFloats(x), MakeDenseFloats(y), GetDenseCount(out, numParticles));
+    }
 };
 
 } // namespace ParticleGraphNodes
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "ApplyForce.h"
+#include "../DenseKernels.h"
 
 namespace Urho3D
 {
@@ -42,6 +43,13 @@ public:
             result[i] = vel[i] + force[i] * context.timeStep_;
         }
     }
+
+    void UpdateDense(const UpdateContext& context, unsigned numParticles, const DenseSpan<Vector3>& vel,
+        const DenseSpan<Vector3>& force, const DenseSpan<Vector3>& result) const
+    {
+        DenseMultiplyAdd(GetDenseOutput(result), MakeDenseFloats(vel), MakeDenseFloats(force), context.timeStep_,
+            GetDenseCount(result, numParticles));
+    }
 };
 
 } // namespace ParticleGraphNodes
@@ -94,6 +94,9 @@ public:
         return new (ptr) Instance();
     }
 
+    /// Reads attribute value of each particle without side effects.
+    bool IsElementwise() const override { return true; }
+
 protected:
     ParticleGraphPin* LoadOutputPin(ParticleGraphReader& reader, GraphOutPin& pin) override;
 
@@ -138,6 +141,9 @@ public:
         return new (ptr) Instance(this);
     }
 
+    /// Each particle writes its own attribute slot, so chunks never overlap.
+    bool IsElementwise() const override { return true; }
+
 protected:
     ParticleGraphPin* LoadOutputPin(ParticleGraphReader& reader, GraphOutPin& pin) override;
 
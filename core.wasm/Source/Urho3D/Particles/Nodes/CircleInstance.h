@@ -45,17 +45,17 @@ public:
         for (unsigned i = 0; i < numParticles; ++i)
         {
             Vector3 p, v;
-            Generate(p, v);
+            Generate(*context.randomEngine_, p, v);
             pos[i] = m * p;
             vel[i] = md * v;
         }
     }
 
-    void Generate(Vector3& pos, Vector3& vel) const
+    void Generate(RandomEngine& random, Vector3& pos, Vector3& vel) const
     {
         const Circle* circle = static_cast<Circle*>(GetGraphNode());
 
-        const float angle = Urho3D::Random(360.0f);
+        const float angle = random.GetFloat(0.0f, 360.0f);
         const float cosinus = Cos(angle);
         const float sinus = Sin(angle);
         const Vector3 direction = Vector3(cosinus, sinus, 0.0f);
@@ -63,7 +63,7 @@ public:
         float r = circle->GetRadius();
         if (circle->GetRadiusThickness() > 0.0f)
         {
-            r *= 1.0f - Urho3D::Random() * circle->GetRadiusThickness();
+            r *= 1.0f - random.GetFloat() * circle->GetRadiusThickness();
         }
         vel = direction;
         pos = Vector3(cosinus * (r), sinus * (r), 0.0f);
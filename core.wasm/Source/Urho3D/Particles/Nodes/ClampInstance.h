@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../DenseKernels.h"
+
 namespace Urho3D
 {
 class ParticleGraphSystem;
@@ -38,6 +40,12 @@ template <typename Value0, typename Value1> struct ClampInstance
             out[i] = Urho3D::VectorClamp(x[i], Value1::ZERO, Value1::ONE);
         }
     }
+
+    void UpdateDense(
+        const UpdateContext& context, unsigned numParticles, const DenseSpan<Value0>& x, const DenseSpan<Value1>& out)
+    {
+        DenseClamp01(GetDenseOutput(out), MakeDenseFloats(x), GetDenseCount(out, numParticles));
+    }
 };
 
 template <> struct ClampInstance<float, float>
@@ -50,6 +58,12 @@ template <> struct ClampInstance<float, float>
             out[i] = Urho3D::Clamp(x[i], 0.0f, 1.0f);
         }
     }
+
+    void UpdateDense(
+        const UpdateContext& context, unsigned numParticles, const DenseSpan<float>& x, const DenseSpan<float>& out)
+    {
+        DenseClamp01(GetDenseOutput(out), MakeDenseFloats(x), GetDenseCount(out, numParticles));
+    }
 };
 } // namespace ParticleGraphNodes
 
@@ -45,18 +45,18 @@ public:
         for (unsigned i = 0; i < numParticles; ++i)
         {
             Vector3 p, v;
-            Generate(p, v);
+            Generate(*context.randomEngine_, p, v);
             pos[i] = m * p;
             vel[i] = md * v;
         }
     }
 
-    void Generate(Vector3& pos, Vector3& vel) const
+    void Generate(RandomEngine& random, Vector3& pos, Vector3& vel) const
     {
         const Cone* cone = static_cast<Cone*>(GetGraphNode());
 
-        const float angle = Urho3D::Random(360.0f);
-        const float radius = Sqrt(Urho3D::Random()) * Sin(Min(Max(cone->GetAngle(), 0.0f), 89.999f));
+        const float angle = random.GetFloat(0.0f, 360.0f);
+        const float radius = Sqrt(random.GetFloat()) * Sin(Min(Max(cone->GetAngle(), 0.0f), 89.999f));
         const float height = Sqrt(1.0f - radius * radius);
         const float cosinus = Cos(angle);
         const float sinus = Sin(angle);
@@ -65,7 +65,7 @@ public:
         float r = cone->GetRadius();
         if (cone->GetRadiusThickness() > 0.0f && static_cast<EmitFrom>(cone->GetFrom()) != EmitFrom::Surface)
         {
-            r *= 1.0f - Urho3D::Random() * cone->GetRadiusThickness();
+            r *= 1.0f - random.GetFloat() * cone->GetRadiusThickness();
         }
         switch (static_cast<EmitFrom>(cone->GetFrom()))
         {
@@ -75,7 +75,7 @@ public:
             break;
         default:
             vel = direction;
-            pos = direction * Urho3D::Random(cone->GetLength()) + Vector3(cosinus * r, sinus * r, 0.0f);
+            pos = direction * random.GetFloat(0.0f, cone->GetLength()) + Vector3(cosinus * r, sinus * r, 0.0f);
             break;
         }
     }
@@ -70,6 +70,9 @@ public:
         return new (ptr) Instance(this);
     }
 
+    /// Constant value is broadcast to every particle.
+    bool IsElementwise() const override { return true; }
+
     /// Serialize from/to archive. Return true if successful.
     //bool Serialize(Archive& archive) override;
 
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../DenseKernels.h"
+
 namespace Urho3D
 {
 class ParticleGraphSystem;
@@ -38,6 +40,14 @@ template <typename Value0, typename Value1> struct LengthInstance
             out[i] = x[i].Length();
         }
     }
+
+    /// Vectorized update is implemented only for Vector3.
+    template <typename T = Value0, typename = ea::enable_if_t<ea::is_same_v<T, Vector3>>>
+    void UpdateDense(
+        const UpdateContext& context, unsigned numParticles, const DenseSpan<Value0>& x, const DenseSpan<Value1>& out)
+    {
+        DenseLengthVector3(GetDenseOutput(out), MakeDenseFloats(x), GetDenseCount(out, numParticles));
+    }
 };
 } // namespace ParticleGraphNodes
 
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../DenseKernels.h"
+
 namespace Urho3D
 {
 class ParticleGraphSystem;
@@ -38,6 +40,13 @@ template <typename Value0, typename Value1, typename Value2, typename Value3> st
             out[i] = Urho3D::Lerp(x[i], y[i], t[i]);
         }
     }
+
+    void UpdateDense(const UpdateContext& context, unsigned numParticles, const DenseSpan<Value0>& x,
+        const DenseSpan<Value1>& y, const DenseSpan<Value2>& t, const DenseSpan<Value3>& out)
+    {
+        DenseLerp(GetDenseOutput(out), MakeDenseFloats(x), MakeDenseFloats(y), MakeDenseFloats(t),
+            GetDenseCount(out, numParticles));
+    }
 };
 
 } // namespace ParticleGraphNodes
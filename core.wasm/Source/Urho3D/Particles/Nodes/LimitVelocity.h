@@ -49,6 +49,9 @@ public:
     /// Place new instance at the provided address.
     ParticleGraphNodeInstance* CreateInstanceAt(void* ptr, ParticleGraphLayerInstance* layer) override;
 
+    /// Velocity is clamped per particle.
+    bool IsElementwise() const override { return true; }
+
     /// Set Dampen.
     void SetDampen(float value);
     /// Get Dampen.
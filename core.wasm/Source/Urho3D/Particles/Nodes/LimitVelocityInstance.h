@@ -23,6 +23,7 @@
 #pragma once
 
 #include "LimitVelocity.h"
+#include "../DenseKernels.h"
 
 namespace Urho3D
 {
@@ -56,8 +57,31 @@ public:
                 {
                     result[i] = vel[i] * (Urho3D::Lerp(speed, limitVal, t) / speed);
                 }
+                else
+                {
+                    result[i] = vel[i];
+                }
+            }
+        }
+    }
+
+    void UpdateDense(const UpdateContext& context, unsigned numParticles, const DenseSpan<Vector3>& vel,
+        const DenseSpan<float>& limit, const DenseSpan<Vector3>& result)
+    {
+        const float dampen = static_cast<LimitVelocity*>(GetGraphNode())->GetDampen();
+        const unsigned count = GetDenseCount(result, numParticles);
+        if (dampen <= 1e-6f || context.timeStep_ < 1e-6f)
+        {
+            for (unsigned i = 0; i < count; ++i)
+            {
+                result[i] = vel[i];
             }
         }
+        else
+        {
+            const auto t = 1.0f - powf(1.0f - dampen, 20.0f * context.timeStep_);
+            DenseLimitVelocity(GetDenseOutput(result), MakeDenseFloats(vel), MakeDenseFloats(limit), t, count);
+        }
     }
 };
 
@@ -44,7 +44,7 @@ struct Generate
         auto span = context.GetSpan<T>(pin0.GetMemoryReference());
         for (unsigned i = 0; i < context.indices_.size(); ++i)
         {
-            span[i] = min.Lerp(max, Urho3D::Random()).Get<T>();
+            span[i] = min.Lerp(max, context.randomEngine_->GetFloat()).Get<T>();
         }
     }
 };
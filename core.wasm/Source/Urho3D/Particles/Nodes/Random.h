@@ -70,6 +70,9 @@ public:
         return new (ptr) Instance(this);
     }
 
+    /// Random values are drawn per particle from the layer random engine.
+    bool IsElementwise() const override { return true; }
+
     const Variant& GetMin() const { return min_; }
     void SetMin(const Variant& val) { min_ = val; }
     const Variant& GetMax() const { return max_; }
@@ -49,6 +49,9 @@ public:
     /// Place new instance at the provided address.
     ParticleGraphNodeInstance* CreateInstanceAt(void* ptr, ParticleGraphLayerInstance* layer) override;
 
+    /// Interpolation uses inputs of the same particle only.
+    bool IsElementwise() const override { return true; }
+
 protected:
 };
 
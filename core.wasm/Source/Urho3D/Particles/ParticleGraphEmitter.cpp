@@ -31,15 +31,21 @@
 #include "../Scene/SceneEvents.h"
 #include "ParticleGraphLayer.h"
 #include "ParticleGraphLayerInstance.h"
+#include "ParticleGraphSystem.h"
 
 namespace Urho3D
 {
 ParticleGraphEmitter::ParticleGraphEmitter(Context* context)
     : Component(context)
+    , system_(context->GetSubsystem<ParticleGraphSystem>())
 {
 }
 
-ParticleGraphEmitter::~ParticleGraphEmitter() = default;
+ParticleGraphEmitter::~ParticleGraphEmitter()
+{
+    if (system_)
+        system_->RemoveEmitter(this);
+}
 
 void ParticleGraphEmitter::RegisterObject(Context* context)
 {
@@ -58,14 +64,18 @@ void ParticleGraphEmitter::OnSetEnabled()
 {
     Component::OnSetEnabled();
 
-    Scene* scene = GetScene();
-    if (scene)
-    {
-        if (IsEnabledEffective())
-            SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ParticleGraphEmitter, HandleScenePostUpdate));
-        else
-            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-    }
+    UpdateSystemRegistration();
+}
+
+void ParticleGraphEmitter::UpdateSystemRegistration()
+{
+    if (!system_)
+        return;
+
+    if (GetScene() && IsEnabledEffective())
+        system_->AddEmitter(this);
+    else
+        system_->RemoveEmitter(this);
 }
 
 void ParticleGraphEmitter::Reset()
@@ -148,7 +158,7 @@ void ParticleGraphEmitter::SetViewMask(unsigned mask)
     if (viewMask_ != mask)
     {
         viewMask_ = mask;
-        UpdateDrawables();
+        MarkDrawablesDirty();
     }
 }
 
@@ -157,7 +167,7 @@ void ParticleGraphEmitter::SetLightMask(unsigned mask)
     if (lightMask_ != mask)
     {
         lightMask_ = mask;
-        UpdateDrawables();
+        MarkDrawablesDirty();
     }
 }
 
@@ -166,7 +176,7 @@ void ParticleGraphEmitter::SetShadowMask(unsigned mask)
     if (shadowMask_ != mask)
     {
         shadowMask_ = mask;
-        UpdateDrawables();
+        MarkDrawablesDirty();
     }
 }
 
@@ -175,12 +185,13 @@ void ParticleGraphEmitter::SetZoneMask(unsigned mask)
     if (zoneMask_ != mask)
     {
         zoneMask_ = mask;
-        UpdateDrawables();
+        MarkDrawablesDirty();
     }
 }
 
 void ParticleGraphEmitter::UpdateDrawables()
 {
+    drawablesDirty_ = false;
     for (auto& layer : layers_)
     {
         layer.UpdateDrawables();
@@ -197,10 +208,7 @@ void ParticleGraphEmitter::OnSceneSet(Scene* scene)
 {
     Component::OnSceneSet(scene);
 
-    if (scene && IsEnabledEffective())
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ParticleGraphEmitter, HandleScenePostUpdate));
-    else if (!scene)
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+    UpdateSystemRegistration();
 
     for (unsigned i = 0; i < layers_.size(); ++i)
     {
@@ -251,47 +259,6 @@ bool ParticleGraphEmitter::CheckActiveParticles() const
     return false;
 }
 
-void ParticleGraphEmitter::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
-{
-    // Store scene's timestep and use it instead of global timestep, as time scale may be other than 1
-    using namespace ScenePostUpdate;
-
-    lastTimeStep_ = eventData[P_TIMESTEP].GetFloat();
-
-
-    Tick(lastTimeStep_);
-
-    //// If no invisible update, check that the billboardset is in view (framenumber has changed)
-    //if ((effect_ && effect_->GetUpdateInvisible()) || viewFrameNumber_ != lastUpdateFrameNumber_)
-    //{
-    //    lastUpdateFrameNumber_ = viewFrameNumber_;
-    //    needUpdate_ = true;
-    //    MarkForUpdate();
-    //}
-
-    //// Send finished event only once all particles are gone
-    //if (node_ && !emitting_ && sendFinishedEvent_ && !CheckActiveParticles())
-    //{
-    //    sendFinishedEvent_ = false;
-
-    //    // Make a weak pointer to self to check for destruction during event handling
-    //    WeakPtr<ParticleGraphEmitter> self(this);
-
-    //    using namespace ParticleEffectFinished;
-
-    //    VariantMap& eventData = GetEventDataMap();
-    //    eventData[P_NODE] = node_;
-    //    eventData[P_EFFECT] = effect_;
-
-    //    node_->SendEvent(E_PARTICLEEFFECTFINISHED, eventData);
-
-    //    if (self.Expired())
-    //        return;
-
-    //    DoAutoRemove(autoRemove_);
-    //}
-}
-
 void ParticleGraphEmitter::HandleEffectReloadFinished(StringHash eventType, VariantMap& eventData)
 {
     // When particle effect file is live-edited, remove existing particles and reapply the effect parameters
@@ -33,6 +33,7 @@ namespace Urho3D
 
 class ParticleGraphLayerInstance;
 class ParticleGraphNodeInstance;
+class ParticleGraphSystem;
 
 /// %Particle graph emitter component.
 class URHO3D_API ParticleGraphEmitter : public Component
@@ -115,10 +116,12 @@ protected:
     void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Add to or remove from the particle graph system depending on scene and enabled state.
+    void UpdateSystemRegistration();
     /// Handle live reload of the particle effect.
     void HandleEffectReloadFinished(StringHash eventType, VariantMap& eventData);
+    /// Mark drawable attributes for update on the next system update.
+    void MarkDrawablesDirty() { drawablesDirty_ = true; }
     /// Update all drawable attributes.
     void UpdateDrawables();
 
@@ -141,6 +144,15 @@ private:
 
     /// Currently emitting flag.
     bool emitting_{true};
+    /// Whether the drawable attributes should be updated on the main thread.
+    bool drawablesDirty_{};
+
+    /// System that updates the emitter.
+    WeakPtr<ParticleGraphSystem> system_;
+    /// Index in the system registry.
+    unsigned systemIndex_{M_MAX_UNSIGNED};
+
+    friend class ParticleGraphSystem;
 };
 
 }
@@ -50,6 +50,26 @@ template <typename T> ParticleGraphSpan Append(ParticleGraphLayer::AttributeBuff
     return Append(layout, sizeof(T) * count);
 }
 
+/// Split graph into stages of fused elementwise nodes and stages of regular nodes.
+void BuildExecutionPlan(const ParticleGraph& graph, ParticleGraphLayer::ExecutionPlan& plan)
+{
+    plan.clear();
+    for (unsigned i = 0; i < graph.GetNumNodes(); ++i)
+    {
+        const bool elementwise = graph.GetNode(i)->IsElementwise();
+        if (plan.empty() || plan.back().fused_ != elementwise)
+            plan.push_back(ParticleGraphLayer::ExecutionStage{i, 0, elementwise});
+        ++plan.back().numNodes_;
+    }
+
+    // There is nothing to gain from chunked execution of a single node.
+    for (ParticleGraphLayer::ExecutionStage& stage : plan)
+    {
+        if (stage.numNodes_ < 2)
+            stage.fused_ = false;
+    }
+}
+
 } // namespace
 
 struct ParticleGraphAttributeBuilder
@@ -316,6 +336,9 @@ bool ParticleGraphLayer::Commit()
         if (!builder.Build(*update_))
             return false;
     }
+    BuildExecutionPlan(*emit_, emitPlan_);
+    BuildExecutionPlan(*init_, initPlan_);
+    BuildExecutionPlan(*update_, updatePlan_);
     attributeBufferLayout_.attributeBufferSize_ = attributes_.GetRequiredMemory();
     ParticleGraphSpan& values = attributeBufferLayout_.values_;
     values = ParticleGraphSpan(values.offset_, attributeBufferLayout_.attributeBufferSize_ - values.offset_);
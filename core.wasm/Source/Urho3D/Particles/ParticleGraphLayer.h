@@ -70,6 +70,19 @@ public:
         void EvaluateLayout(const ParticleGraphLayer& layer);
     };
 
+    /// Consecutive range of graph nodes executed together.
+    struct ExecutionStage
+    {
+        /// Index of the first node in the graph.
+        unsigned firstNode_{};
+        /// Number of nodes in the stage.
+        unsigned numNodes_{};
+        /// Whether the nodes are elementwise and executed chunk by chunk.
+        bool fused_{};
+    };
+    /// Execution plan of a graph.
+    using ExecutionPlan = ea::vector<ExecutionStage>;
+
     /// Construct.
     explicit ParticleGraphLayer(Context* context);
     /// Destruct.
@@ -130,6 +143,13 @@ public:
     /// Return size of temp buffer in bytes.
     unsigned GetTempBufferSize() const;
 
+    /// Return execution plan of emit graph.
+    const ExecutionPlan& GetEmitPlan() const { return emitPlan_; }
+    /// Return execution plan of initialization graph.
+    const ExecutionPlan& GetInitPlan() const { return initPlan_; }
+    /// Return execution plan of update graph.
+    const ExecutionPlan& GetUpdatePlan() const { return updatePlan_; }
+
     /// Serialize from/to archive.
     void SerializeInBlock(Archive& archive) override;
 
@@ -156,6 +176,12 @@ private:
     ParticleGraphAttributeLayout attributes_;
     /// Intermediate memory layout.
     ParticleGraphBufferLayout tempMemory_;
+    /// Emit graph execution plan.
+    ExecutionPlan emitPlan_;
+    /// Initialization graph execution plan.
+    ExecutionPlan initPlan_;
+    /// Update graph execution plan.
+    ExecutionPlan updatePlan_;
 };
 
 } // namespace Urho3D
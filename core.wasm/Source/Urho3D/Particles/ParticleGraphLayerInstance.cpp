@@ -28,6 +28,7 @@
 #include "ParticleGraphNodeInstance.h"
 #include "Span.h"
 #include "UpdateContext.h"
+#include "../Math/Random.h"
 
 namespace Urho3D
 {
@@ -35,6 +36,7 @@ namespace Urho3D
 ParticleGraphLayerInstance::ParticleGraphLayerInstance()
     : activeParticles_(0)
     , destructionQueueSize_(0)
+    , randomEngine_(Rand())
 {
 }
 
@@ -112,7 +114,7 @@ bool ParticleGraphLayerInstance::EmitNewParticles(float numParticles)
 
     auto autoContext = MakeUpdateContext(0.0f);
     autoContext.indices_ = autoContext.indices_.subspan(startIndex, particlesToEmit);
-    RunGraph(initNodeInstances_, autoContext);
+    RunGraph(initNodeInstances_, layer_->GetInitPlan(), autoContext);
 
     return true;
 }
@@ -126,11 +128,11 @@ void ParticleGraphLayerInstance::Update(float timeStep, bool emitting)
     if (emitting)
     {
         emitContext.indices_ = indices_.subspan(0, 1);
-        RunGraph(emitNodeInstances_, emitContext);
+        RunGraph(emitNodeInstances_, layer_->GetEmitPlan(), emitContext);
     }
 
     auto updateContext = MakeUpdateContext(timeStep);
-    RunGraph(updateNodeInstances_, updateContext);
+    RunGraph(updateNodeInstances_, layer_->GetUpdatePlan(), updateContext);
     DestroyParticles();
     time_ += timeStep;
 }
@@ -229,14 +231,35 @@ UpdateContext ParticleGraphLayerInstance::MakeUpdateContext(float timeStep)
     context.timeStep_ = timeStep;
     context.time_ = time_;
     context.layer_ = this;
+    context.randomEngine_ = &randomEngine_;
     return context;
 }
 
-void ParticleGraphLayerInstance::RunGraph(ea::span<ParticleGraphNodeInstance*>& nodes, UpdateContext& updateContext)
+void ParticleGraphLayerInstance::RunGraph(ea::span<ParticleGraphNodeInstance*>& nodes,
+    const ParticleGraphLayer::ExecutionPlan& plan, UpdateContext& updateContext)
 {
-    for (ParticleGraphNodeInstance* node : nodes)
+    const unsigned numParticles = updateContext.indices_.size();
+    for (const ParticleGraphLayer::ExecutionStage& stage : plan)
     {
-        node->Update(updateContext);
+        const auto stageNodes = nodes.subspan(stage.firstNode_, stage.numNodes_);
+        if (!stage.fused_ || numParticles <= FusedChunkSize)
+        {
+            for (ParticleGraphNodeInstance* node : stageNodes)
+                node->Update(updateContext);
+            continue;
+        }
+
+        // Run all stage nodes over one chunk of particles before moving to the next one,
+        // so intermediate values are consumed while they are still in cache.
+        UpdateContext chunkContext = updateContext;
+        for (unsigned offset = 0; offset < numParticles; offset += FusedChunkSize)
+        {
+            const unsigned chunkSize = ea::min(FusedChunkSize, numParticles - offset);
+            chunkContext.indices_ = updateContext.indices_.subspan(offset, chunkSize);
+            chunkContext.spanOffset_ = updateContext.spanOffset_ + offset;
+            for (ParticleGraphNodeInstance* node : stageNodes)
+                node->Update(chunkContext);
+        }
     }
 }
 
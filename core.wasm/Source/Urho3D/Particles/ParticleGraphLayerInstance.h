@@ -24,6 +24,7 @@
 
 #include "ParticleGraphLayer.h"
 #include "ParticleGraphNodeInstance.h"
+#include "../Math/RandomEngine.h"
 #include <EASTL/sort.h>
 
 namespace Urho3D
@@ -62,6 +63,10 @@ private:
 class URHO3D_API ParticleGraphLayerInstance
 {
 public:
+    /// Number of particles processed at once by fused graph stages.
+    /// Chosen so that intermediate values of a stage stay in L1 cache.
+    static constexpr unsigned FusedChunkSize = 256;
+
     /// Construct.
     ParticleGraphLayerInstance();
 
@@ -93,7 +98,8 @@ public:
     template <typename ValueType>
     SparseSpan<ValueType> GetSparse(unsigned attributeIndex, const ea::span<unsigned>& indices);
     template <typename ValueType> SparseSpan<ValueType> GetScalar(unsigned pinIndex);
-    template <typename ValueType> SparseSpan<ValueType> GetSpan(unsigned pinIndex);
+    template <typename ValueType> SparseSpan<ValueType> GetSpan(unsigned pinIndex, unsigned offset = 0);
+    template <typename ValueType> DenseSpan<ValueType> GetDense(unsigned pinIndex, bool scalar, unsigned offset = 0);
 
     /// Get emitter.
     ParticleGraphEmitter* GetEmitter() const { return emitter_; }
@@ -127,8 +133,9 @@ protected:
     /// Initialize update context.
     UpdateContext MakeUpdateContext(float timeStep);
 
-    /// Run graph.
-    void RunGraph(ea::span<ParticleGraphNodeInstance*>& nodes, UpdateContext& updateContext);
+    /// Run graph according to execution plan.
+    void RunGraph(ea::span<ParticleGraphNodeInstance*>& nodes, const ParticleGraphLayer::ExecutionPlan& plan,
+        UpdateContext& updateContext);
 
     /// Destroy particles.
     void DestroyParticles();
@@ -168,6 +175,8 @@ private:
     ParticleGraphEmitter* emitter_{};
     /// Time since emitter start.
     float time_{};
+    /// Random number generator owned by the layer, so layers can be updated on different threads.
+    RandomEngine randomEngine_;
 
     friend class ParticleGraphEmitter;
 };
@@ -209,11 +218,19 @@ template <typename ValueType> SparseSpan<ValueType> ParticleGraphLayerInstance::
     return SparseSpan<ValueType>(values, scalarIndices_);
 }
 
-template <typename ValueType> SparseSpan<ValueType> ParticleGraphLayerInstance::GetSpan(unsigned pinIndex)
+template <typename ValueType> SparseSpan<ValueType> ParticleGraphLayerInstance::GetSpan(unsigned pinIndex, unsigned offset)
+{
+    const auto& attr = layer_->GetIntermediateValues()[pinIndex];
+    const auto values = attr.MakeSpan<ValueType>(temp_);
+    return SparseSpan<ValueType>(values, naturalIndices_.subspan(offset));
+}
+
+template <typename ValueType>
+DenseSpan<ValueType> ParticleGraphLayerInstance::GetDense(unsigned pinIndex, bool scalar, unsigned offset)
 {
     const auto& attr = layer_->GetIntermediateValues()[pinIndex];
     const auto values = attr.MakeSpan<ValueType>(temp_);
-    return SparseSpan<ValueType>(values, naturalIndices_);
+    return DenseSpan<ValueType>(values.data() + (scalar ? 0 : offset), scalar);
 }
 
 } // namespace Urho3D
@@ -84,6 +84,10 @@ public:
     /// Place new instance at the provided address.
     virtual ParticleGraphNodeInstance* CreateInstanceAt(void* ptr, ParticleGraphLayerInstance* layer) = 0;
 
+    /// Return true if the node evaluates each particle independently and has no side effects besides its outputs.
+    /// Chains of such nodes are fused and executed over small chunks of particles.
+    virtual bool IsElementwise() const { return false; }
+
     /// Load node.
     virtual bool Load(ParticleGraphReader& reader, GraphNode& node);
     /// Save node.
@@ -26,6 +26,13 @@
 
 #include "ParticleGraphEmitter.h"
 #include "ParticleGraphLayer.h"
+#include "ParticleGraphLayerInstance.h"
+
+#include "../Core/Assert.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
 namespace Urho3D
 {
@@ -41,10 +48,90 @@ ParticleGraphSystem::ParticleGraphSystem(Context* context)
     , ObjectReflectionRegistry(context)
 {
     RegisterParticleGraphLibrary(context, this);
+
+    SubscribeToEvent(E_SCENEPOSTUPDATE, URHO3D_HANDLER(ParticleGraphSystem, HandleScenePostUpdate));
 }
 
 ParticleGraphSystem::~ParticleGraphSystem()
 {
+    for (ParticleGraphEmitter* emitter : emitters_)
+        emitter->systemIndex_ = M_MAX_UNSIGNED;
+}
+
+void ParticleGraphSystem::AddEmitter(ParticleGraphEmitter* emitter)
+{
+    if (emitter->systemIndex_ != M_MAX_UNSIGNED)
+        return;
+
+    emitter->systemIndex_ = emitters_.size();
+    emitters_.push_back(emitter);
+}
+
+void ParticleGraphSystem::RemoveEmitter(ParticleGraphEmitter* emitter)
+{
+    const unsigned index = emitter->systemIndex_;
+    if (index == M_MAX_UNSIGNED)
+        return;
+
+    URHO3D_ASSERT(index < emitters_.size() && emitters_[index] == emitter);
+
+    emitters_[index] = emitters_.back();
+    emitters_[index]->systemIndex_ = index;
+    emitters_.pop_back();
+    emitter->systemIndex_ = M_MAX_UNSIGNED;
+}
+
+void ParticleGraphSystem::UpdateEmitters(Scene* scene, float timeStep)
+{
+    URHO3D_PROFILE("UpdateParticleGraphEmitters");
+
+    emittersToUpdate_.clear();
+    layersToUpdate_.clear();
+    for (ParticleGraphEmitter* emitter : emitters_)
+    {
+        if (emitter->GetScene() != scene)
+            continue;
+
+        emitter->lastTimeStep_ = timeStep;
+        emittersToUpdate_.push_back(emitter);
+
+        // Make sure world transform is not dirty so nodes may read it from worker threads
+        emitter->GetNode()->GetWorldTransform();
+
+        for (ParticleGraphLayerInstance& layer : emitter->layers_)
+        {
+            if (layer.GetLayer())
+                layersToUpdate_.push_back(LayerUpdate{&layer, emitter->IsEmitting()});
+        }
+    }
+
+    if (layersToUpdate_.empty())
+        return;
+
+    // Layers are independent from each other. Render nodes only touch their own drawables,
+    // octree update queue is protected while the scene is in threaded update.
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    scene->BeginThreadedUpdate();
+    ForEachParallel(workQueue, layersToUpdate_,
+        [timeStep](unsigned, const LayerUpdate& update) { update.layer_->Update(timeStep, update.emitting_); });
+    scene->EndThreadedUpdate();
+
+    // Synchronize drawable attributes on the main thread
+    for (ParticleGraphEmitter* emitter : emittersToUpdate_)
+    {
+        if (emitter->drawablesDirty_)
+            emitter->UpdateDrawables();
+    }
+}
+
+void ParticleGraphSystem::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ScenePostUpdate;
+
+    auto* scene = static_cast<Scene*>(eventData[P_SCENE].GetPtr());
+    const float timeStep = eventData[P_TIMESTEP].GetFloat();
+    if (scene)
+        UpdateEmitters(scene, timeStep);
 }
 
 void RegisterParticleGraphLibrary(Context* context, ParticleGraphSystem* system)
@@ -28,7 +28,13 @@
 
 namespace Urho3D
 {
+
+class ParticleGraphEmitter;
+class ParticleGraphLayerInstance;
+class Scene;
+
 /// %Particle graph effect definition.
+/// Also owns registry of active emitters and updates their layers in parallel on scene post-update.
 class URHO3D_API ParticleGraphSystem : public Object, public ObjectReflectionRegistry
 {
     URHO3D_OBJECT(ParticleGraphSystem, Object);
@@ -37,6 +43,35 @@ public:
     ParticleGraphSystem(Context* context);
 
     ~ParticleGraphSystem() override;
+
+    /// Add emitter to the registry of active emitters. Called by ParticleGraphEmitter.
+    void AddEmitter(ParticleGraphEmitter* emitter);
+    /// Remove emitter from the registry of active emitters. Called by ParticleGraphEmitter.
+    void RemoveEmitter(ParticleGraphEmitter* emitter);
+    /// Update all active emitters in the scene. Layers are updated on WorkQueue threads,
+    /// drawable attributes are synchronized on the main thread afterwards.
+    void UpdateEmitters(Scene* scene, float timeStep);
+
+    /// Return number of active emitters in all scenes.
+    unsigned GetNumEmitters() const { return emitters_.size(); }
+
+private:
+    /// Layer scheduled for update.
+    struct LayerUpdate
+    {
+        ParticleGraphLayerInstance* layer_{};
+        bool emitting_{};
+    };
+
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Active emitters in all scenes.
+    ea::vector<ParticleGraphEmitter*> emitters_;
+    /// Emitters updated this frame.
+    ea::vector<ParticleGraphEmitter*> emittersToUpdate_;
+    /// Layers updated this frame.
+    ea::vector<LayerUpdate> layersToUpdate_;
 };
 
 
@@ -102,6 +102,9 @@ public:
     /// Place new instance at the provided address.
     ParticleGraphNodeInstance* CreateInstanceAt(void* ptr, ParticleGraphLayerInstance* layer) override;
 
+    /// Pattern matching nodes are pure functions of their inputs.
+    bool IsElementwise() const override { return true; }
+
 protected:
     /// Load input pin.
     ParticleGraphPin* LoadInputPin(ParticleGraphReader& reader, GraphInPin& pin) override;
@@ -59,6 +59,24 @@ template <typename T> struct SparseSpan
     unsigned* indices_;
 };
 
+/// Contiguous view on span or scalar pin values. Used by vectorized node kernels.
+template <typename T> struct DenseSpan
+{
+    typedef T element_type;
+    typedef ea::remove_cv_t<T> value_type;
+
+    DenseSpan() = default;
+    DenseSpan(T* data, bool scalar)
+        : data_(data)
+        , scalar_(scalar)
+    {
+    }
+    inline T& operator[](unsigned index) const { return data_[scalar_ ? 0 : index]; }
+    T* data_{};
+    /// Whether the same value is shared by all particles.
+    bool scalar_{};
+};
+
 template <typename... Values> struct SpanVariantTuple;
 
 
@@ -24,6 +24,7 @@
 
 #include "ParticleGraphEmitter.h"
 #include "ParticleGraphPin.h"
+#include "../Math/RandomEngine.h"
 
 namespace Urho3D
 {
@@ -37,22 +38,33 @@ struct UpdateContext
     /// Time since emitter start.
     float time_{};
     ea::span<unsigned> indices_;
+    /// Offset of the first processed particle in intermediate spans. Non-zero when graph is executed in chunks.
+    unsigned spanOffset_{};
     ea::span<uint8_t> attributes_;
     ea::span<uint8_t> tempBuffer_;
     ParticleGraphLayerInstance* layer_;
+    /// Random number generator of the layer. Layers are updated in parallel, so global random state should not be used.
+    RandomEngine* randomEngine_{};
 
     template <typename ValueType> SparseSpan<ValueType> GetSpan(const ParticleGraphPinRef& pin) const;
+    template <typename ValueType> DenseSpan<ValueType> GetDenseSpan(const ParticleGraphPinRef& pin) const;
 };
 
 template <typename ValueType> SparseSpan<ValueType> UpdateContext::GetSpan(const ParticleGraphPinRef& pin) const
 {
     switch (pin.type_)
     {
-    case ParticleGraphContainerType::Span: return layer_->GetSpan<ValueType>(pin.index_);
+    case ParticleGraphContainerType::Span: return layer_->GetSpan<ValueType>(pin.index_, spanOffset_);
     case ParticleGraphContainerType::Scalar: return layer_->GetScalar<ValueType>(pin.index_);
     case ParticleGraphContainerType::Sparse: return layer_->GetSparse<ValueType>(pin.index_, indices_);
     default: assert(!"Invalid pin container type"); return layer_->GetSparse<ValueType>(pin.index_, indices_);
     }
 }
 
+template <typename ValueType> DenseSpan<ValueType> UpdateContext::GetDenseSpan(const ParticleGraphPinRef& pin) const
+{
+    assert(pin.type_ == ParticleGraphContainerType::Span || pin.type_ == ParticleGraphContainerType::Scalar);
+    return layer_->GetDense<ValueType>(pin.index_, pin.type_ == ParticleGraphContainerType::Scalar, spanOffset_);
+}
+
 } // namespace Urho3D
@@ -459,6 +459,8 @@ btCollisionShape* CreateCollisionGeometryDataShape(ShapeType shapeType, Collisio
     }
 }
 
+URHO3D_DEFINE_POOLED_ALLOCATION(CollisionShape, sizeof(CollisionShape), 64)
+
 CollisionShape::CollisionShape(Context* context) :
     Component(context),
     shapeType_(SHAPE_BOX),
@@ -26,6 +26,7 @@
 
 #include <EASTL/shared_array.h>
 
+#include "../Container/PoolAllocator.h"
 #include "../Math/BoundingBox.h"
 #include "../Math/Quaternion.h"
 #include "../Scene/Component.h"
@@ -146,6 +147,7 @@ struct HeightfieldData : public CollisionGeometryData
 class URHO3D_API CollisionShape : public Component
 {
     URHO3D_OBJECT(CollisionShape, Component);
+    URHO3D_POOLED_ALLOCATION();
 
 public:
     /// Construct.
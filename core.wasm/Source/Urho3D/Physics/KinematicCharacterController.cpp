@@ -97,6 +97,13 @@ void KinematicCharacterController::OnSetAttribute(const AttributeInfo& attr, con
     readdToWorld_ = true;
 }
 
+void KinematicCharacterController::OnSetAttributeTyped(const AttributeInfo& attr, const void* src)
+{
+    Serializable::OnSetAttributeTyped(attr, src);
+
+    readdToWorld_ = true;
+}
+
 void KinematicCharacterController::ApplyAttributes()
 {
     ActivateIfEnabled();
@@ -47,6 +47,7 @@ public:
     /// Register object factory and attributes.
     static void RegisterObject(Context* context);
     void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override;
+    void OnSetAttributeTyped(const AttributeInfo& attr, const void* src) override;
 
     /// Perform post-load after deserialization. Acquire the components from the scene nodes.
     void ApplyAttributes() override;
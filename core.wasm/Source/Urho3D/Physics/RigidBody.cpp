@@ -58,6 +58,8 @@ static const char* collisionEventModeNames[] =
     nullptr
 };
 
+URHO3D_DEFINE_POOLED_ALLOCATION(RigidBody, sizeof(RigidBody), 64)
+
 RigidBody::RigidBody(Context* context) :
     Component(context),
     gravityOverride_(Vector3::ZERO),
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "../Container/PoolAllocator.h"
 #include "../IO/VectorBuffer.h"
 #include "../Scene/Component.h"
 
@@ -51,6 +52,7 @@ enum CollisionEventMode
 class URHO3D_API RigidBody : public Component, public btMotionState
 {
     URHO3D_OBJECT(RigidBody, Component);
+    URHO3D_POOLED_ALLOCATION();
 
 public:
     /// Construct.
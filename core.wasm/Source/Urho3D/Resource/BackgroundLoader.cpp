@@ -26,8 +26,13 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Resource/BackgroundLoader.h"
+#include "../Resource/CookedResourceCache.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 
@@ -48,66 +53,244 @@ BackgroundLoader::~BackgroundLoader()
     backgroundLoadQueue_.clear();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::Shutdown()
 {
-    URHO3D_PROFILE_THREAD("BackgroundLoader Thread");
-
-    while (shouldRun_)
     {
-        backgroundLoadMutex_.Acquire();
+        MutexLock lock(backgroundLoadMutex_);
+        shutdown_ = true;
+        readQueue_.clear();
+        finishQueue_.clear();
+    }
 
-        // Search for a queued resource that has not been loaded yet
-        auto i = backgroundLoadQueue_.begin();
-        while (i != backgroundLoadQueue_.end())
+    // Tasks that are not started yet will exit immediately, wait for running ones
+    for (;;)
+    {
         {
-            if (i->second.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+            MutexLock lock(backgroundLoadMutex_);
+            if (numRunningTasks_ == 0)
+            {
+                backgroundLoadQueue_.clear();
                 break;
-            else
-                ++i;
+            }
         }
+        Time::Sleep(1);
+    }
+}
 
-        if (i == backgroundLoadQueue_.end())
+bool BackgroundLoader::BeginTask()
+{
+    MutexLock lock(backgroundLoadMutex_);
+    if (shutdown_)
+        return false;
+
+    ++numRunningTasks_;
+    return true;
+}
+
+void BackgroundLoader::EndTask()
+{
+    MutexLock lock(backgroundLoadMutex_);
+    --numRunningTasks_;
+}
+
+void BackgroundLoader::ScheduleReads()
+{
+    unsigned numNewTasks = 0;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        const unsigned maxReadTasks = owner_->GetMaxBackgroundReads();
+        while (numReadTasks_ < maxReadTasks && numReadTasks_ < readQueue_.size())
+        {
+            ++numReadTasks_;
+            ++numNewTasks;
+        }
+    }
+
+    auto workQueue = owner_->GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i < numNewTasks; ++i)
+    {
+        if (workQueue)
         {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
+            SharedPtr<BackgroundLoader> self(this);
+            workQueue->PostTask([self]() { self->ProcessReads(); }, TaskPriority::Low);
         }
         else
+            ProcessReads();
+    }
+}
+
+void BackgroundLoader::ProcessReads()
+{
+    const bool running = BeginTask();
+
+    for (;;)
+    {
+        ItemKey key;
         {
-            BackgroundLoadItem& item = i->second;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
-
-            bool success = false;
-            AbstractFilePtr file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
+            MutexLock lock(backgroundLoadMutex_);
+            if (!running || readQueue_.empty())
             {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
+                --numReadTasks_;
+                break;
             }
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.size())
+            key = readQueue_.front();
+            readQueue_.pop_front();
+        }
+
+        ReadResource(key);
+    }
+
+    if (running)
+        EndTask();
+}
+
+bool BackgroundLoader::ReadResource(const ItemKey& key)
+{
+    Resource* resource = nullptr;
+    bool sendEventOnFailure = false;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        auto i = backgroundLoadQueue_.find(key);
+        if (i == backgroundLoadQueue_.end() || i->second.resource_->GetAsyncLoadState() != ASYNC_QUEUED)
+            return false;
+
+        // We can be sure that the item is not removed from the queue as long as it is in the "loading" state
+        resource = i->second.resource_;
+        sendEventOnFailure = i->second.sendEventOnFailure_;
+        resource->SetAsyncLoadState(ASYNC_LOADING);
+    }
+
+    AbstractFilePtr file;
+    ByteVector fileData;
+    bool success = false;
+    {
+        URHO3D_PROFILE("ReadBackgroundResource");
+        file = owner_->GetFile(resource->GetName(), sendEventOnFailure);
+        if (file && dynamic_cast<MemoryBuffer*>(file.Get()))
+        {
+            // Files in memory (e.g. from memory-mapped packages) are passed to BeginLoad without copying
+            success = true;
+        }
+        else if (file)
+        {
+            fileData.resize(file->GetSize());
+            success = file->Read(fileData.data(), fileData.size()) == fileData.size();
+            // Don't keep file handles of many queued resources
+            file->Close();
+        }
+    }
+
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        auto i = backgroundLoadQueue_.find(key);
+        if (i == backgroundLoadQueue_.end())
+            return false;
+
+        BackgroundLoadItem& item = i->second;
+        if (success)
+        {
+            item.file_ = ea::move(file);
+            item.fileData_ = ea::move(fileData);
+            item.beginLoadPending_ = true;
+        }
+        else
+            CompleteBeginLoad(key, item, false);
+    }
+
+    if (success)
+        ScheduleBeginLoad(key);
+    return true;
+}
+
+void BackgroundLoader::ScheduleBeginLoad(const ItemKey& key)
+{
+    if (auto workQueue = owner_->GetSubsystem<WorkQueue>())
+    {
+        SharedPtr<BackgroundLoader> self(this);
+        workQueue->PostTask([self, key]()
+        {
+            if (self->BeginTask())
             {
-                for (auto i = item.dependents_.begin(); i != item.dependents_.end(); ++i)
-                {
-                    auto j = backgroundLoadQueue_.find(*i);
-                    if (j != backgroundLoadQueue_.end())
-                        j->second.dependencies_.erase(key);
-                }
-
-                item.dependents_.clear();
+                self->BeginLoadResource(key);
+                self->EndTask();
             }
+        }, TaskPriority::Low);
+    }
+    else
+        BeginLoadResource(key);
+}
+
+bool BackgroundLoader::BeginLoadResource(const ItemKey& key)
+{
+    Resource* resource = nullptr;
+    AbstractFilePtr file;
+    ByteVector fileData;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        auto i = backgroundLoadQueue_.find(key);
+        if (i == backgroundLoadQueue_.end() || !i->second.beginLoadPending_)
+            return false;
+
+        BackgroundLoadItem& item = i->second;
+        resource = item.resource_;
+        file = ea::move(item.file_);
+        fileData = ea::move(item.fileData_);
+        item.beginLoadPending_ = false;
+    }
+
+    CookedResourceCache* cookedCache = owner_->GetCookedResourceCache();
+    const auto beginLoad = [&](Deserializer& source)
+    { return cookedCache ? cookedCache->BeginLoad(resource, source) : resource->BeginLoad(source); };
+
+    bool success = false;
+    {
+        URHO3D_PROFILE("BeginLoadBackgroundResource");
+        if (dynamic_cast<MemoryBuffer*>(file.Get()))
+            success = beginLoad(*file);
+        else
+        {
+            MemoryBuffer buffer(fileData);
+            buffer.SetName(file->GetName());
+            success = beginLoad(buffer);
+        }
+    }
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        auto i = backgroundLoadQueue_.find(key);
+        if (i == backgroundLoadQueue_.end())
+            return false;
+
+        CompleteBeginLoad(key, i->second, success);
+    }
+    return true;
+}
+
+void BackgroundLoader::CompleteBeginLoad(const ItemKey& key, BackgroundLoadItem& item, bool success)
+{
+    item.resource_->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    if (IsReadyToFinish(item))
+        finishQueue_.push_back(key);
+
+    // Process dependencies now
+    for (const ItemKey& dependentKey : item.dependents_)
+    {
+        auto j = backgroundLoadQueue_.find(dependentKey);
+        if (j != backgroundLoadQueue_.end())
+        {
+            j->second.dependencies_.erase(key);
+            if (IsReadyToFinish(j->second))
+                finishQueue_.push_back(dependentKey);
         }
     }
+    item.dependents_.clear();
+}
+
+bool BackgroundLoader::IsReadyToFinish(const BackgroundLoadItem& item)
+{
+    const AsyncLoadState state = item.resource_->GetAsyncLoadState();
+    return item.dependencies_.empty() && (state == ASYNC_SUCCESS || state == ASYNC_FAIL);
 }
 
 bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller)
@@ -115,144 +298,158 @@ bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bo
     StringHash nameHash(name);
     ea::pair<StringHash, StringHash> key = ea::make_pair(type, nameHash);
 
-    MutexLock lock(backgroundLoadMutex_);
+    {
+        MutexLock lock(backgroundLoadMutex_);
 
-    // Check if already exists in the queue
-    if (backgroundLoadQueue_.find(key) != backgroundLoadQueue_.end())
-        return false;
+        if (shutdown_)
+            return false;
 
-    BackgroundLoadItem& item = backgroundLoadQueue_[key];
-    item.sendEventOnFailure_ = sendEventOnFailure;
+        // Check if already exists in the queue
+        if (backgroundLoadQueue_.find(key) != backgroundLoadQueue_.end())
+            return false;
 
-    // Make sure the pointer is non-null and is a Resource subclass
-    item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
-    if (!item.resource_)
-    {
-        URHO3D_LOGERROR("Could not load unknown resource type " + type.ToString());
+        BackgroundLoadItem& item = backgroundLoadQueue_[key];
+        item.sendEventOnFailure_ = sendEventOnFailure;
 
-        if (sendEventOnFailure && Thread::IsMainThread())
+        // Make sure the pointer is non-null and is a Resource subclass
+        item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
+        if (!item.resource_)
         {
-            using namespace UnknownResourceType;
+            URHO3D_LOGERROR("Could not load unknown resource type " + type.ToString());
 
-            VariantMap& eventData = owner_->GetEventDataMap();
-            eventData[P_RESOURCETYPE] = type;
-            owner_->SendEvent(E_UNKNOWNRESOURCETYPE, eventData);
-        }
+            if (sendEventOnFailure && Thread::IsMainThread())
+            {
+                using namespace UnknownResourceType;
 
-        backgroundLoadQueue_.erase(key);
-        return false;
-    }
+                VariantMap& eventData = owner_->GetEventDataMap();
+                eventData[P_RESOURCETYPE] = type;
+                owner_->SendEvent(E_UNKNOWNRESOURCETYPE, eventData);
+            }
 
-    URHO3D_LOGDEBUG("Background loading resource " + name);
+            backgroundLoadQueue_.erase(key);
+            return false;
+        }
 
-    item.resource_->SetName(name);
-    item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+        URHO3D_LOGDEBUG("Background loading resource " + name);
 
-    // If this is a resource calling for the background load of more resources, mark the dependency as necessary
-    if (caller)
-    {
-        ea::pair<StringHash, StringHash> callerKey = ea::make_pair(caller->GetType(), caller->GetNameHash());
-        auto j = backgroundLoadQueue_.find(
-            callerKey);
-        if (j != backgroundLoadQueue_.end())
+        item.resource_->SetName(name);
+        item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+
+        // If this is a resource calling for the background load of more resources, mark the dependency as necessary
+        bool isDependency = false;
+        if (caller)
         {
-            BackgroundLoadItem& callerItem = j->second;
-            item.dependents_.insert(callerKey);
-            callerItem.dependencies_.insert(key);
+            ea::pair<StringHash, StringHash> callerKey = ea::make_pair(caller->GetType(), caller->GetNameHash());
+            auto j = backgroundLoadQueue_.find(
+                callerKey);
+            if (j != backgroundLoadQueue_.end())
+            {
+                BackgroundLoadItem& callerItem = j->second;
+                item.dependents_.insert(callerKey);
+                callerItem.dependencies_.insert(key);
+                isDependency = true;
+            }
+            else
+                URHO3D_LOGWARNING("Resource " + caller->GetName() +
+                           " requested for a background loaded resource but was not in the background load queue");
         }
+
+        // Dependencies block loading of already started resources, so read them first
+        if (isDependency)
+            readQueue_.push_front(key);
         else
-            URHO3D_LOGWARNING("Resource " + caller->GetName() +
-                       " requested for a background loaded resource but was not in the background load queue");
+            readQueue_.push_back(key);
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
-
+    ScheduleReads();
     return true;
 }
 
 void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 {
-    backgroundLoadMutex_.Acquire();
-
     // Check if the resource in question is being background loaded
     ea::pair<StringHash, StringHash> key = ea::make_pair(type, nameHash);
-    auto i = backgroundLoadQueue_.find(key);
-    if (i != backgroundLoadQueue_.end())
-    {
-        backgroundLoadMutex_.Release();
+    BackgroundLoadItem* item = nullptr;
 
+    HiresTimer waitTimer;
+    bool didWait = false;
+    ea::vector<ItemKey> pendingKeys;
+    for (;;)
+    {
         {
-            Resource* resource = i->second.resource_;
-            HiresTimer waitTimer;
-            bool didWait = false;
+            MutexLock lock(backgroundLoadMutex_);
+            auto i = backgroundLoadQueue_.find(key);
+            if (i == backgroundLoadQueue_.end())
+                return;
 
-            for (;;)
-            {
-                unsigned numDeps = i->second.dependencies_.size();
-                AsyncLoadState state = resource->GetAsyncLoadState();
-                if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                {
-                    didWait = true;
-                    Time::Sleep(1);
-                }
-                else
-                    break;
-            }
+            item = &i->second;
+            if (IsReadyToFinish(*item))
+                break;
 
-            if (didWait)
-                URHO3D_LOGDEBUG("Waited " + ea::to_string(waitTimer.GetUSec(false) / 1000) + " ms for background loaded resource " +
-                         resource->GetName());
+            pendingKeys.clear();
+            pendingKeys.push_back(key);
+            pendingKeys.insert(pendingKeys.end(), item->dependencies_.begin(), item->dependencies_.end());
         }
 
-        // This may take a long time and may potentially wait on other resources, so it is important we do not hold the mutex during this
-        FinishBackgroundLoading(i->second);
+        // Load the resource and its dependencies on this thread instead of waiting for worker threads
+        bool progress = false;
+        for (const ItemKey& pendingKey : pendingKeys)
+        {
+            if (ReadResource(pendingKey))
+                progress = true;
+            if (BeginLoadResource(pendingKey))
+                progress = true;
+        }
 
-        backgroundLoadMutex_.Acquire();
-        // Erasing by key since queue may change since iterator been acquired.
-        backgroundLoadQueue_.erase(key);
-        backgroundLoadMutex_.Release();
+        if (!progress)
+        {
+            didWait = true;
+            Time::Sleep(1);
+        }
     }
-    else
-        backgroundLoadMutex_.Release();
+
+    if (didWait)
+        URHO3D_LOGDEBUG("Waited " + ea::to_string(waitTimer.GetUSec(false) / 1000) + " ms for background loaded resource " +
+                 item->resource_->GetName());
+
+    // This may take a long time and may potentially wait on other resources, so it is important we do not hold the mutex during this
+    FinishBackgroundLoading(*item);
+
+    MutexLock lock(backgroundLoadMutex_);
+    // Erasing by key since queue may change since iterator been acquired.
+    backgroundLoadQueue_.erase(key);
 }
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
-    {
-        HiresTimer timer;
+    HiresTimer timer;
 
-        backgroundLoadMutex_.Acquire();
+    backgroundLoadMutex_.Acquire();
 
-        for (auto i = backgroundLoadQueue_.begin(); i != backgroundLoadQueue_.end();
-             i = backgroundLoadQueue_.begin())
-        {
-            const auto key = i->first;
-            Resource* resource = i->second.resource_;
-            unsigned numDeps = i->second.dependencies_.size();
-            AsyncLoadState state = resource->GetAsyncLoadState();
-            if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                ++i;
-            else
-            {
-                // Finishing a resource may need it to wait for other resources to load, in which case we can not
-                // hold on to the mutex
-                backgroundLoadMutex_.Release();
-                FinishBackgroundLoading(i->second);
-                backgroundLoadMutex_.Acquire();
-                // Erasing by key because the queue may change since last time
-                backgroundLoadQueue_.erase(key);
-            }
+    while (!finishQueue_.empty())
+    {
+        const ItemKey key = finishQueue_.front();
+        finishQueue_.pop_front();
 
-            // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000LL)
-                break;
-        }
+        // Resource may be already finished by WaitForResource
+        auto i = backgroundLoadQueue_.find(key);
+        if (i == backgroundLoadQueue_.end() || !IsReadyToFinish(i->second))
+            continue;
 
+        // Finishing a resource may need it to wait for other resources to load, in which case we can not
+        // hold on to the mutex
         backgroundLoadMutex_.Release();
+        FinishBackgroundLoading(i->second);
+        backgroundLoadMutex_.Acquire();
+        // Erasing by key because the queue may change since last time
+        backgroundLoadQueue_.erase(key);
+
+        // Break when the time limit passed so that we keep sufficient FPS
+        if (timer.GetUSec(false) >= maxMs * 1000LL)
+            break;
     }
+
+    backgroundLoadMutex_.Release();
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -22,12 +22,14 @@
 
 #pragma once
 
+#include <EASTL/deque.h>
 #include <EASTL/hash_set.h>
 #include <EASTL/unordered_map.h>
 
 #include "../Core/Mutex.h"
+#include "../Container/ByteVector.h"
 #include "../Container/Ptr.h"
-#include "../Core/Thread.h"
+#include "../IO/AbstractFile.h"
 #include "../Math/StringHash.h"
 
 namespace Urho3D
@@ -47,11 +49,19 @@ struct URHO3D_API BackgroundLoadItem
     ea::hash_set<ea::pair<StringHash, StringHash> > dependents_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
+    /// File opened by I/O task. Files that are not in memory are read into fileData_.
+    AbstractFilePtr file_;
+    ByteVector fileData_;
+    /// Whether the file is read and BeginLoad is not started yet.
+    bool beginLoadPending_{};
 };
 
 /// Background loader of resources. Owned by the ResourceCache.
+/// Files are read and resources are loaded in WorkQueue tasks.
+/// Number of concurrent file reads is limited separately, BeginLoad of read files is spread across all worker threads.
+/// Files of resources requested by other queued resources are read first.
 /// @nobind
-class URHO3D_API BackgroundLoader : public RefCounted, public Thread
+class URHO3D_API BackgroundLoader : public RefCounted
 {
 public:
     /// Construct.
@@ -60,8 +70,8 @@ public:
     /// Destruct. Forcibly clear the load queue.
     ~BackgroundLoader() override;
 
-    /// Resource background loading loop.
-    void ThreadFunction() override;
+    /// Stop processing the queue and wait for running tasks. Should be called from the main thread before owner is destroyed.
+    void Shutdown();
 
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
     bool QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller);
@@ -74,6 +84,26 @@ public:
     unsigned GetNumQueuedResources() const;
 
 private:
+    using ItemKey = ea::pair<StringHash, StringHash>;
+
+    /// Start file reading tasks if there are queued resources and the limit of concurrent reads is not reached.
+    void ScheduleReads();
+    /// Read queued files until the queue is empty.
+    void ProcessReads();
+    /// Read file of queued resource. Return false if the resource is not in queued state.
+    bool ReadResource(const ItemKey& key);
+    /// Start BeginLoad task for the resource.
+    void ScheduleBeginLoad(const ItemKey& key);
+    /// Call BeginLoad for the resource which file is read. Return false if the resource is not waiting for BeginLoad.
+    bool BeginLoadResource(const ItemKey& key);
+    /// Store result of BeginLoad and notify dependents. Should be called with locked mutex.
+    void CompleteBeginLoad(const ItemKey& key, BackgroundLoadItem& item, bool success);
+    /// Return whether the item is ready to be finished on the main thread.
+    static bool IsReadyToFinish(const BackgroundLoadItem& item);
+    /// Run task from any thread. Return false if the loader is shut down.
+    bool BeginTask();
+    /// Mark task as completed.
+    void EndTask();
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -82,7 +112,17 @@ private:
     /// Mutex for thread-safe access to the background load queue.
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
-    ea::unordered_map<ea::pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    ea::unordered_map<ItemKey, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Resources waiting for file reading. Dependencies of other resources are in front.
+    ea::deque<ItemKey> readQueue_;
+    /// Resources that may be finished on the main thread, in order of readiness.
+    ea::deque<ItemKey> finishQueue_;
+    /// Number of file reading tasks, both posted and running.
+    unsigned numReadTasks_{};
+    /// Number of tasks executed at the moment.
+    unsigned numRunningTasks_{};
+    /// Whether the loader is shut down.
+    bool shutdown_{};
 };
 
 }
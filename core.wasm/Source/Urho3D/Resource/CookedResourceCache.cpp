@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Resource/CookedResourceCache.h"
+#include "../Resource/Resource.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Identifier of cooked files.
+const char* cookedFileID = "UCKD";
+
+unsigned long long MixHash(unsigned long long hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}
+
+CookedResourceCache::CookedResourceCache(Context* context, const ea::string& directory)
+    : Object(context)
+    , directory_(AddTrailingSlash(directory))
+{
+}
+
+unsigned long long CookedResourceCache::GetContentHash(ConstByteSpan data)
+{
+    // Four independent lanes of 8-byte words hide multiplication latency
+    unsigned long long lanes[4] = {0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull, 0x27d4eb2f165667c5ull};
+
+    const unsigned char* ptr = data.data();
+    size_t remaining = data.size();
+    while (remaining >= 32)
+    {
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            unsigned long long word;
+            memcpy(&word, ptr + i * 8, sizeof(word));
+            lanes[i] = (lanes[i] ^ word) * 0x100000001b3ull;
+            lanes[i] ^= lanes[i] >> 29;
+        }
+        ptr += 32;
+        remaining -= 32;
+    }
+
+    unsigned long long hash = data.size();
+    for (unsigned i = 0; i < 4; ++i)
+        hash = MixHash(hash ^ lanes[i]);
+    while (remaining > 0)
+    {
+        hash = (hash ^ *ptr++) * 0x100000001b3ull;
+        --remaining;
+    }
+    return MixHash(hash);
+}
+
+bool CookedResourceCache::BeginLoad(Resource* resource, Deserializer& source)
+{
+    if (resource->GetCookedVersion() == 0)
+        return resource->BeginLoad(source);
+
+    // Source is read anyway to compute the hash, so it is loaded from memory on cache miss
+    ByteVector data(source.GetSize() - source.GetPosition());
+    if (!data.empty() && source.Read(data.data(), data.size()) != data.size())
+    {
+        URHO3D_LOGERROR("Failed to read resource {}", source.GetName());
+        return false;
+    }
+
+    const unsigned long long contentHash = GetContentHash(data);
+    const ea::string fileName = GetCookedFileName(resource, contentHash);
+    if (LoadCooked(resource, fileName, contentHash, data.size()))
+    {
+        numHits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    numMisses_.fetch_add(1, std::memory_order_relaxed);
+
+    MemoryBuffer buffer(data);
+    buffer.SetName(source.GetName());
+    if (!resource->BeginLoad(buffer))
+        return false;
+
+    StoreCooked(resource, fileName, contentHash, data.size());
+    return true;
+}
+
+ea::string CookedResourceCache::GetCookedFileName(const Resource* resource, unsigned long long contentHash) const
+{
+    return Format("{}{}/{:016x}.cooked", directory_, resource->GetTypeName(), contentHash);
+}
+
+void CookedResourceCache::Clear()
+{
+    auto fileSystem = GetSubsystem<FileSystem>();
+    if (fileSystem->DirExists(directory_))
+        fileSystem->RemoveDir(directory_, true);
+}
+
+void CookedResourceCache::ResetStats()
+{
+    numHits_.store(0, std::memory_order_relaxed);
+    numMisses_.store(0, std::memory_order_relaxed);
+}
+
+bool CookedResourceCache::LoadCooked(
+    Resource* resource, const ea::string& fileName, unsigned long long contentHash, unsigned contentSize)
+{
+    auto fileSystem = GetSubsystem<FileSystem>();
+    if (!fileSystem->FileExists(fileName))
+        return false;
+
+    File file(context_, fileName, FILE_READ);
+    if (!file.IsOpen() || file.ReadFileID() != cookedFileID)
+        return false;
+
+    // Hash is checked as well in case of collision between lengths
+    if (file.ReadUInt() != resource->GetCookedVersion() || file.ReadStringHash() != resource->GetType()
+        || file.ReadUInt64() != contentHash || file.ReadUInt() != contentSize)
+        return false;
+
+    if (!resource->BeginLoadCooked(file))
+    {
+        URHO3D_LOGWARNING("Failed to load cooked file {}, loading from source", fileName);
+        return false;
+    }
+    return true;
+}
+
+void CookedResourceCache::StoreCooked(
+    const Resource* resource, const ea::string& fileName, unsigned long long contentHash, unsigned contentSize)
+{
+    auto fileSystem = GetSubsystem<FileSystem>();
+    const ea::string path = GetPath(fileName);
+    if (!fileSystem->DirExists(path) && !fileSystem->CreateDirsRecursive(path))
+        return;
+
+    const ea::string tempFileName = Format("{}.{}.tmp", fileName, tempFileCounter_.fetch_add(1, std::memory_order_relaxed));
+    bool success = false;
+    {
+        File file(context_, tempFileName, FILE_WRITE);
+        if (file.IsOpen())
+        {
+            file.WriteFileID(cookedFileID);
+            file.WriteUInt(resource->GetCookedVersion());
+            file.WriteStringHash(resource->GetType());
+            file.WriteUInt64(contentHash);
+            file.WriteUInt(contentSize);
+            success = resource->SaveCooked(file);
+        }
+    }
+
+    // Another thread may have stored the same file concurrently, any of the copies is good
+    if (!success || !fileSystem->Rename(tempFileName, fileName))
+        fileSystem->Delete(tempFileName);
+}
+
+}
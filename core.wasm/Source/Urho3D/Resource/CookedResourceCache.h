@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "Urho3D/Container/ByteVector.h"
+#include "Urho3D/Core/Object.h"
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Resource;
+
+/// Persistent on-disk cache of resources in cooked binary form.
+/// Cooked files are addressed by the hash of the source file contents, so renamed or moved files are still found,
+/// and modified files never match stale cooked data.
+/// Resources opt in by implementing Resource::GetCookedVersion, Resource::SaveCooked and Resource::BeginLoadCooked.
+class URHO3D_API CookedResourceCache : public Object
+{
+    URHO3D_OBJECT(CookedResourceCache, Object);
+
+public:
+    /// Construct with directory where the cooked files are stored.
+    CookedResourceCache(Context* context, const ea::string& directory);
+
+    /// Return hash of the source file contents.
+    static unsigned long long GetContentHash(ConstByteSpan data);
+
+    /// Load resource from cooked file if available, otherwise load it from the source and store the cooked file.
+    /// May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Resource* resource, Deserializer& source);
+    /// Return name of the cooked file for the resource loaded from the source with specified hash.
+    ea::string GetCookedFileName(const Resource* resource, unsigned long long contentHash) const;
+    /// Remove all cooked files.
+    void Clear();
+
+    /// Return cache directory.
+    const ea::string& GetDirectory() const { return directory_; }
+    /// Return number of resources loaded from cooked files.
+    unsigned GetNumHits() const { return numHits_.load(std::memory_order_relaxed); }
+    /// Return number of cookable resources loaded from the source.
+    unsigned GetNumMisses() const { return numMisses_.load(std::memory_order_relaxed); }
+    /// Reset hit and miss counters.
+    void ResetStats();
+
+private:
+    /// Try to load the resource from the cooked file.
+    bool LoadCooked(Resource* resource, const ea::string& fileName, unsigned long long contentHash, unsigned contentSize);
+    /// Save cooked form of the resource. Data is written into temporary file first, so partially written files are never read.
+    void StoreCooked(const Resource* resource, const ea::string& fileName, unsigned long long contentHash, unsigned contentSize);
+
+    /// Cache directory with trailing slash.
+    ea::string directory_;
+    /// Number of cache hits.
+    std::atomic<unsigned> numHits_{};
+    /// Number of cache misses.
+    std::atomic<unsigned> numMisses_{};
+    /// Counter used to generate unique names of temporary files.
+    std::atomic<unsigned> tempFileCounter_{};
+};
+
+}
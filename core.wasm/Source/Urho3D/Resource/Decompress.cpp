@@ -22,9 +22,16 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Resource/Decompress.h"
 
 #include <cstdint>
+#include <cstring>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 
 // ETC2 decompress
 typedef unsigned char uint8;
@@ -86,13 +93,9 @@ static int Unpack565(unsigned char const* packed, unsigned char* colour)
     return value;
 }
 
-static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isDxt1)
+static void DecodePaletteDXT(unsigned char* codes, unsigned char const* bytes, bool isDxt1)
 {
-    // get the block bytes
-    auto const* bytes = reinterpret_cast< unsigned char const* >( block );
-
     // unpack the endpoints
-    unsigned char codes[16];
     int a = Unpack565(bytes, codes);
     int b = Unpack565(bytes + 2, codes + 4);
 
@@ -117,30 +120,9 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
     // fill in alpha for the intermediate values
     codes[8 + 3] = 255;
     codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
-
-    // unpack the indices
-    unsigned char indices[16];
-    for (int i = 0; i < 4; ++i)
-    {
-        unsigned char* ind = indices + 4 * i;
-        unsigned char packed = bytes[4 + i];
-
-        ind[0] = (unsigned char)(packed & 0x3);
-        ind[1] = (unsigned char)((packed >> 2) & 0x3);
-        ind[2] = (unsigned char)((packed >> 4) & 0x3);
-        ind[3] = (unsigned char)((packed >> 6) & 0x3);
-    }
-
-    // store out the colours
-    for (int i = 0; i < 16; ++i)
-    {
-        auto offset = (unsigned char)(4 * indices[i]);
-        for (int j = 0; j < 4; ++j)
-            rgba[4 * i + j] = codes[offset + j];
-    }
 }
 
-static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
+static void DecodeAlphaDXT3(unsigned char* alpha, void const* block)
 {
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
 
@@ -155,12 +137,12 @@ static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
         auto hi = (unsigned char)(quant & 0xf0);
 
         // convert back up to bytes
-        rgba[8 * i + 3] = lo | (lo << 4);
-        rgba[8 * i + 7] = hi | (hi >> 4);
+        alpha[2 * i] = lo | (lo << 4);
+        alpha[2 * i + 1] = hi | (hi >> 4);
     }
 }
 
-static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
+static void DecodeAlphaDXT5(unsigned char* alpha, void const* block)
 {
     // get the two alpha values
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -186,99 +168,138 @@ static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
             codes[1 + i] = (unsigned char)(((7 - i) * alpha0 + i * alpha1) / 7);
     }
 
-    // decode the indices
-    unsigned char indices[16];
-    unsigned char const* src = bytes + 2;
-    unsigned char* dest = indices;
-    for (int i = 0; i < 2; ++i)
-    {
-        // grab 3 bytes
-        int value = 0;
-        for (int j = 0; j < 3; ++j)
-        {
-            int byte = *src++;
-            value |= (byte << 8 * j);
-        }
-
-        // unpack 8 3-bit values from it
-        for (int j = 0; j < 8; ++j)
-        {
-            int index = (value >> 3 * j) & 0x7;
-            *dest++ = (unsigned char)index;
-        }
-    }
+    // 16 3-bit indices are packed into 6 bytes
+    unsigned long long indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= static_cast<unsigned long long>(bytes[2 + i]) << (8 * i);
 
     // write out the indexed codebook values
     for (int i = 0; i < 16; ++i)
-        rgba[4 * i + 3] = codes[indices[i]];
+        alpha[i] = codes[(indices >> (3 * i)) & 0x7];
 }
 
-static void DecompressDXT(unsigned char* rgba, const void* block, CompressedFormat format)
+/// Decompress DXT block into 4 rows of 4 RGBA pixels separated by the stride in bytes.
+static void DecompressBlockDXT(unsigned char* rgba, int stride, const unsigned char* block, CompressedFormat format)
 {
     // get the block locations
-    void const* colourBlock = block;
-    void const* alphaBock = block;
-    if (format == CF_DXT3 || format == CF_DXT5)
-        colourBlock = reinterpret_cast< unsigned char const* >( block ) + 8;
+    const unsigned char* colourBlock = format == CF_DXT1 ? block : block + 8;
 
-    // decompress colour
-    DecompressColourDXT(rgba, colourBlock, format == CF_DXT1);
+    // decompress palette, each entry is one RGBA pixel
+    unsigned char codes[16];
+    DecodePaletteDXT(codes, colourBlock, format == CF_DXT1);
 
     // decompress alpha separately if necessary
+    const bool hasAlpha = format == CF_DXT3 || format == CF_DXT5;
+    unsigned char alpha[16];
     if (format == CF_DXT3)
-        DecompressAlphaDXT3(rgba, alphaBock);
+        DecodeAlphaDXT3(alpha, block);
     else if (format == CF_DXT5)
-        DecompressAlphaDXT5(rgba, alphaBock);
+        DecodeAlphaDXT5(alpha, block);
+
+#ifdef URHO3D_SSE
+    // Select palette entries with masks, 4 pixels at once
+    unsigned palette[4];
+    memcpy(palette, codes, sizeof(palette));
+    const __m128i entry0 = _mm_set1_epi32(static_cast<int>(palette[0]));
+    const __m128i entry1 = _mm_set1_epi32(static_cast<int>(palette[1]));
+    const __m128i entry2 = _mm_set1_epi32(static_cast<int>(palette[2]));
+    const __m128i entry3 = _mm_set1_epi32(static_cast<int>(palette[3]));
+    const __m128i indexMask = _mm_set1_epi32(0x3);
+    const __m128i colourMask = _mm_set1_epi32(0x00ffffff);
+    for (int row = 0; row < 4; ++row)
+    {
+        const int packed = colourBlock[4 + row];
+        const __m128i indices = _mm_and_si128(_mm_set_epi32(packed >> 6, packed >> 4, packed >> 2, packed), indexMask);
+
+        __m128i result = _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_setzero_si128()), entry0);
+        result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(1)), entry1));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_set1_epi32(2)), entry2));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_cmpeq_epi32(indices, indexMask), entry3));
+
+        if (hasAlpha)
+        {
+            const unsigned char* rowAlpha = alpha + 4 * row;
+            const __m128i alphaValues = _mm_slli_epi32(_mm_set_epi32(rowAlpha[3], rowAlpha[2], rowAlpha[1], rowAlpha[0]), 24);
+            result = _mm_or_si128(_mm_and_si128(result, colourMask), alphaValues);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + row * stride), result);
+    }
+#else
+    for (int row = 0; row < 4; ++row)
+    {
+        const unsigned char packed = colourBlock[4 + row];
+        unsigned char* dest = rgba + row * stride;
+        for (int i = 0; i < 4; ++i)
+        {
+            memcpy(dest + 4 * i, codes + 4 * ((packed >> (2 * i)) & 0x3), 4);
+            if (hasAlpha)
+                dest[4 * i + 3] = alpha[4 * row + i];
+        }
+    }
+#endif
+}
+
+/// Process rows of blocks in parallel if possible. Each row is processed by exactly one thread.
+template <class Callback>
+static void ForEachBlockRow(WorkQueue* workQueue, int numBlockRows, const Callback& callback)
+{
+    static const unsigned blockRowsPerTask = 8;
+
+    // Only the main thread may post Immediate tasks, block rows of images decoded inside tasks are processed serially
+    if (workQueue && numBlockRows > static_cast<int>(blockRowsPerTask) && Thread::IsMainThread())
+    {
+        ForEachParallel(workQueue, blockRowsPerTask, static_cast<unsigned>(numBlockRows),
+            [&callback](unsigned beginRow, unsigned endRow) { callback(static_cast<int>(beginRow), static_cast<int>(endRow)); });
+    }
+    else
+        callback(0, numBlockRows);
 }
 
-void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
+void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    WorkQueue* workQueue)
 {
     // initialise the block input
-    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
-    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    auto const* sourceBlocks = reinterpret_cast< unsigned char const* >( blocks );
+    const int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    const int blocksPerRow = (width + 3) / 4;
+    const int blockRowsPerSlice = (height + 3) / 4;
+    const int stride = width * 4;
 
-    // loop over blocks
-    for (int z = 0; z < depth; ++z)
+    // Block rows of all slices are stored sequentially
+    ForEachBlockRow(workQueue, blockRowsPerSlice * depth, [&](int beginRow, int endRow)
     {
-        int sz = width * height * 4 * z;
-        for (int y = 0; y < height; y += 4)
+        for (int blockRow = beginRow; blockRow < endRow; ++blockRow)
         {
+            const int z = blockRow / blockRowsPerSlice;
+            const int y = (blockRow % blockRowsPerSlice) * 4;
+            const int rows = Min(height - y, 4);
+            const unsigned char* sourceBlock = sourceBlocks + blockRow * blocksPerRow * bytesPerBlock;
+            unsigned char* targetRow = rgba + width * height * 4 * z + y * stride;
+
             for (int x = 0; x < width; x += 4)
             {
-                // decompress the block
-                unsigned char targetRgba[4 * 16];
-                DecompressDXT(targetRgba, sourceBlock, format);
-
-                // write the decompressed pixels to the correct image locations
-                unsigned char const* sourcePixel = targetRgba;
-                for (int py = 0; py < 4; ++py)
+                unsigned char* targetPixel = targetRow + x * 4;
+                const int columns = Min(width - x, 4);
+                if (rows == 4 && columns == 4)
                 {
-                    for (int px = 0; px < 4; ++px)
-                    {
-                        // get the target location
-                        int sx = x + px;
-                        int sy = y + py;
-                        if (sx < width && sy < height)
-                        {
-                            unsigned char* targetPixel = rgba + sz + 4 * (width * sy + sx);
-
-                            // copy the rgba value
-                            for (int i = 0; i < 4; ++i)
-                                *targetPixel++ = *sourcePixel++;
-                        }
-                        else
-                        {
-                            // skip this pixel as its outside the image
-                            sourcePixel += 4;
-                        }
-                    }
+                    // decompress the block directly into the image
+                    DecompressBlockDXT(targetPixel, stride, sourceBlock, format);
+                }
+                else
+                {
+                    // skip the pixels outside the image
+                    unsigned char targetRgba[4 * 16];
+                    DecompressBlockDXT(targetRgba, 16, sourceBlock, format);
+                    for (int py = 0; py < rows; ++py)
+                        memcpy(targetPixel + py * stride, targetRgba + py * 16, columns * 4);
                 }
 
                 // advance
                 sourceBlock += bytesPerBlock;
             }
         }
-    }
+    });
 }
 
 // PVRTC decompression based on the Oolong Engine, modified for Urho3D
@@ -634,7 +655,9 @@ static unsigned TwiddleUV(unsigned YSize, unsigned XSize, unsigned YPos, unsigne
     return Twiddled;
 }
 
-void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format)
+/// Decompress rows [beginY, endY) of PVRTC image. Rows are independent, so the image may be processed in parallel.
+static void DecompressRowsPVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format,
+    int beginY, int endY)
 {
     auto* pCompressedData = (AMTC_BLOCK_STRUCT*)blocks;
     int AssumeImageTiles = 1;
@@ -689,7 +712,7 @@ void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, in
     // Step through the pixels of the image decompressing each one in turn
     //
     // Note that this is a hideously inefficient way to do this!
-    for (y = 0; y < height; y++)
+    for (y = beginY; y < endY; y++)
     {
         for (x = 0; x < width; x++)
         {
@@ -780,6 +803,17 @@ void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, in
     }
 }
 
+void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format,
+    WorkQueue* workQueue)
+{
+    const int numBlockRows = (height + BLK_Y_SIZE - 1) / BLK_Y_SIZE;
+    ForEachBlockRow(workQueue, numBlockRows, [&](int beginRow, int endRow)
+    {
+        DecompressRowsPVRTC(rgba, blocks, width, height, format,
+            beginRow * BLK_Y_SIZE, Min(endRow * BLK_Y_SIZE, height));
+    });
+}
+
 void FlipBlockVertical(unsigned char* dest, const unsigned char* src, CompressedFormat format)
 {
     switch (format)
@@ -909,54 +943,52 @@ static void ReadBigEndian4byteWord(uint32_t* pBlock, const unsigned char *s)
 }
 
 // Use ETCPACK to decompress ETC texture.
-void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha)
+void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha,
+    WorkQueue* workQueue)
 {
     // ETCPACK initialization.
     static const bool placeholder = []() { setupAlphaTable(); return true; }();
 
     const int channelCount = hasAlpha ? 4 : 3;
-    unsigned char* src = (unsigned char*)blocks;
-    unsigned int blockPart1, blockPart2;
+    const int bytesPerBlock = hasAlpha ? 16 : 8;
 
     // ETCPACK write 4x4 blocks, so it needs padding.
     int w4 = ((width + 3) / 4);
     int h4 = ((height + 3) / 4);
 
-    unsigned char buffer4x4[4 * 4 * 4];
-
-    for (int y = 0; y < h4; ++y)
+    ForEachBlockRow(workQueue, h4, [&](int beginRow, int endRow)
     {
-        for (int x = 0; x < w4; ++x)
+        unsigned int blockPart1, blockPart2;
+        unsigned char buffer4x4[4 * 4 * 4];
+
+        for (int y = beginRow; y < endRow; ++y)
         {
-            memset(&buffer4x4[0], 0xFF, 4 * 4 * 4);
-            if (hasAlpha)
+            unsigned char* src = (unsigned char*)blocks + y * w4 * bytesPerBlock;
+            for (int x = 0; x < w4; ++x)
             {
-                decompressBlockAlphaC(src, &buffer4x4[3], 4, 4, 0, 0, channelCount);
-                src += 8;
-            }
+                memset(&buffer4x4[0], 0xFF, 4 * 4 * 4);
+                if (hasAlpha)
+                {
+                    decompressBlockAlphaC(src, &buffer4x4[3], 4, 4, 0, 0, channelCount);
+                    src += 8;
+                }
 
-            ReadBigEndian4byteWord(&blockPart1, src);
-            src += 4;
-            ReadBigEndian4byteWord(&blockPart2, src);
-            src += 4;
-            decompressBlockETC2c(blockPart1, blockPart2, &buffer4x4[0], 4, 4, 0, 0, 4);
+                ReadBigEndian4byteWord(&blockPart1, src);
+                src += 4;
+                ReadBigEndian4byteWord(&blockPart2, src);
+                src += 4;
+                decompressBlockETC2c(blockPart1, blockPart2, &buffer4x4[0], 4, 4, 0, 0, 4);
 
-            int wbuf = Min(width - x * 4, 4);
-            int hbuf = Min(height - y * 4, 4);
-            for(int dy = 0; dy < hbuf; ++dy)
-            {
-                for (int dx = 0; dx < wbuf; ++dx)
+                int wbuf = Min(width - x * 4, 4);
+                int hbuf = Min(height - y * 4, 4);
+                for (int dy = 0; dy < hbuf; ++dy)
                 {
-                    int idst = ((y * 4 + dy) * width + x * 4 + dx) * 4;
-                    int ibuf = (dy * 4 + dx) * 4;
-                    dstImage[idst] = buffer4x4[ibuf];
-                    dstImage[idst + 1] = buffer4x4[ibuf + 1];
-                    dstImage[idst + 2] = buffer4x4[ibuf + 2];
-                    dstImage[idst + 3] = buffer4x4[ibuf + 3];
+                    int idst = ((y * 4 + dy) * width + x * 4) * 4;
+                    memcpy(&dstImage[idst], &buffer4x4[dy * 4 * 4], wbuf * 4);
                 }
             }
         }
-    }
+    });
 }
 
 }
@@ -27,13 +27,18 @@
 namespace Urho3D
 {
 
+class WorkQueue;
+
 /// Decompress a DXT compressed image to RGBA.
-URHO3D_API void
-    DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format);
-/// Decompress an ETC1/ETC2 compressed image to RGBA.
-URHO3D_API void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha);
-/// Decompress a PVRTC compressed image to RGBA.
-URHO3D_API void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format);
+/// If work queue is specified, rows of blocks are decompressed in parallel. Result doesn't depend on the number of threads.
+URHO3D_API void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth,
+    CompressedFormat format, WorkQueue* workQueue = nullptr);
+/// Decompress an ETC1/ETC2 compressed image to RGBA. Rows of blocks are decompressed in parallel if work queue is specified.
+URHO3D_API void DecompressImageETC(
+    unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha, WorkQueue* workQueue = nullptr);
+/// Decompress a PVRTC compressed image to RGBA. Rows of blocks are decompressed in parallel if work queue is specified.
+URHO3D_API void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height,
+    CompressedFormat format, WorkQueue* workQueue = nullptr);
 /// Flip a compressed block vertically.
 URHO3D_API void FlipBlockVertical(unsigned char* dest, const unsigned char* src, CompressedFormat format);
 /// Flip a compressed block horizontally.
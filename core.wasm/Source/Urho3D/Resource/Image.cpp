@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -33,6 +35,9 @@
 #include <SDL_surface.h>
 #include <STB/stb_image.h>
 #include <STB/stb_image_write.h>
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 #ifdef URHO3D_WEBP
 #include <webp/decode.h>
 #include <webp/encode.h>
@@ -218,7 +223,7 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
-bool CompressedLevel::Decompress(unsigned char* dest) const
+bool CompressedLevel::Decompress(unsigned char* dest, WorkQueue* workQueue) const
 {
     if (!data_)
         return false;
@@ -232,23 +237,23 @@ bool CompressedLevel::Decompress(unsigned char* dest) const
     case CF_DXT1:
     case CF_DXT3:
     case CF_DXT5:
-        DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
+        DecompressImageDXT(dest, data_, width_, height_, depth_, format_, workQueue);
         return true;
 
     // ETC2 format is compatible with ETC1, so we just use the same function.
     case CF_ETC1:
     case CF_ETC2_RGB:
-        DecompressImageETC(dest, data_, width_, height_, false);
+        DecompressImageETC(dest, data_, width_, height_, false, workQueue);
         return true;
     case CF_ETC2_RGBA:
-        DecompressImageETC(dest, data_, width_, height_, true);
+        DecompressImageETC(dest, data_, width_, height_, true, workQueue);
         return true;
 
     case CF_PVRTC_RGB_2BPP:
     case CF_PVRTC_RGBA_2BPP:
     case CF_PVRTC_RGB_4BPP:
     case CF_PVRTC_RGBA_4BPP:
-        DecompressImagePVRTC(dest, data_, width_, height_, format_);
+        DecompressImagePVRTC(dest, data_, width_, height_, format_, workQueue);
         return true;
 
     default:
@@ -257,6 +262,162 @@ bool CompressedLevel::Decompress(unsigned char* dest) const
     }
 }
 
+namespace
+{
+
+/// Minimum number of output pixels to process image rows in parallel.
+const int minParallelImagePixels = 128 * 128;
+
+/// Process image rows in parallel if the image is big enough.
+template <class Callback> void ForEachImageRow(WorkQueue* workQueue, int numRows, int rowSize, const Callback& callback)
+{
+    // Only the main thread may post Immediate tasks: images decoded inside tasks (e.g. background loading)
+    // and on foreign threads are processed serially
+    if (workQueue && numRows > 1 && numRows * rowSize >= minParallelImagePixels && Thread::IsMainThread())
+    {
+        const unsigned rowsPerTask = Max(1, 8192 / rowSize);
+        ForEachParallel(workQueue, rowsPerTask, static_cast<unsigned>(numRows),
+            [&callback](unsigned beginRow, unsigned endRow) { callback(static_cast<int>(beginRow), static_cast<int>(endRow)); });
+    }
+    else
+        callback(0, numRows);
+}
+
+#ifdef URHO3D_SSE
+/// Average 2x2 blocks of RGBA pixels. Input is 4 pixels from each row, output is 2 pixels as 16-bit integers.
+inline __m128i AverageRGBA(__m128i upper, __m128i lower)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+    const __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+    const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+    return _mm_srli_epi16(sum, 2);
+}
+
+/// Average 2x2 blocks of single-component pixels. Input is 16 pixels from each row, output is 8 pixels as 16-bit integers.
+inline __m128i AverageR(__m128i upper, __m128i lower)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+    const __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+    const __m128i sum = _mm_packs_epi32(_mm_madd_epi16(left, ones), _mm_madd_epi16(right, ones));
+    return _mm_srli_epi16(sum, 2);
+}
+#endif
+
+/// Downsample rows of 2D image by 2x2 box filter.
+void DownsampleRows(const unsigned char* pixelDataIn, unsigned char* pixelDataOut, int width, int widthOut,
+    unsigned components, int beginY, int endY)
+{
+    const int rowSizeIn = width * components;
+    for (int y = beginY; y < endY; ++y)
+    {
+        const unsigned char* inUpper = &pixelDataIn[(y * 2) * rowSizeIn];
+        const unsigned char* inLower = inUpper + rowSizeIn;
+        unsigned char* out = &pixelDataOut[y * widthOut * components];
+
+        int x = 0;
+#ifdef URHO3D_SSE
+        if (components == 4)
+        {
+            for (; x + 4 <= widthOut; x += 4)
+            {
+                const auto* upper = reinterpret_cast<const __m128i*>(inUpper + x * 8);
+                const auto* lower = reinterpret_cast<const __m128i*>(inLower + x * 8);
+                const __m128i first = AverageRGBA(_mm_loadu_si128(upper), _mm_loadu_si128(lower));
+                const __m128i second = AverageRGBA(_mm_loadu_si128(upper + 1), _mm_loadu_si128(lower + 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(first, second));
+            }
+        }
+        else if (components == 1)
+        {
+            for (; x + 16 <= widthOut; x += 16)
+            {
+                const auto* upper = reinterpret_cast<const __m128i*>(inUpper + x * 2);
+                const auto* lower = reinterpret_cast<const __m128i*>(inLower + x * 2);
+                const __m128i first = AverageR(_mm_loadu_si128(upper), _mm_loadu_si128(lower));
+                const __m128i second = AverageR(_mm_loadu_si128(upper + 1), _mm_loadu_si128(lower + 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(first, second));
+            }
+        }
+#endif
+
+        for (; x < widthOut; ++x)
+        {
+            const unsigned char* upper = inUpper + x * 2 * components;
+            const unsigned char* lower = inLower + x * 2 * components;
+            for (unsigned i = 0; i < components; ++i)
+            {
+                out[x * components + i] = (unsigned char)(((unsigned)upper[i] + upper[i + components] +
+                                                           lower[i] + lower[i + components]) >> 2);
+            }
+        }
+    }
+}
+
+/// Lookup tables for conversion between sRGB and linear color.
+struct SRGBTables
+{
+    /// Number of entries in linear to sRGB table.
+    static const unsigned NumLinearValues = 65536;
+
+    SRGBTables()
+    {
+        for (unsigned i = 0; i < 256; ++i)
+            toLinear_[i] = Color::ConvertGammaToLinear(i / 255.0f);
+        for (unsigned i = 0; i < NumLinearValues; ++i)
+        {
+            const float gamma = Color::ConvertLinearToGamma(i / static_cast<float>(NumLinearValues - 1));
+            toSRGB_[i] = static_cast<unsigned char>(Clamp(RoundToInt(gamma * 255.0f), 0, 255));
+        }
+    }
+
+    float toLinear_[256];
+    unsigned char toSRGB_[NumLinearValues];
+};
+
+/// Downsample rows of 2D sRGB image by 2x2 box filter in linear space. Alpha is filtered as is.
+void DownsampleRowsSRGB(const unsigned char* pixelDataIn, unsigned char* pixelDataOut, int width, int widthOut,
+    unsigned components, int beginY, int endY)
+{
+    static const SRGBTables tables;
+    const float scale = 0.25f * (SRGBTables::NumLinearValues - 1);
+
+    // Luminance-alpha and RGBA images have alpha channel
+    const unsigned alphaIndex = components == 2 || components == 4 ? components - 1 : M_MAX_UNSIGNED;
+
+    const int rowSizeIn = width * components;
+    for (int y = beginY; y < endY; ++y)
+    {
+        const unsigned char* inUpper = &pixelDataIn[(y * 2) * rowSizeIn];
+        const unsigned char* inLower = inUpper + rowSizeIn;
+        unsigned char* out = &pixelDataOut[y * widthOut * components];
+
+        for (int x = 0; x < widthOut; ++x)
+        {
+            const unsigned char* upper = inUpper + x * 2 * components;
+            const unsigned char* lower = inLower + x * 2 * components;
+            for (unsigned i = 0; i < components; ++i)
+            {
+                if (i == alphaIndex)
+                {
+                    out[x * components + i] = (unsigned char)(((unsigned)upper[i] + upper[i + components] +
+                                                               lower[i] + lower[i + components]) >> 2);
+                }
+                else
+                {
+                    const float sum = tables.toLinear_[upper[i]] + tables.toLinear_[upper[i + components]]
+                        + tables.toLinear_[lower[i]] + tables.toLinear_[lower[i + components]];
+                    out[x * components + i] = tables.toSRGB_[static_cast<unsigned>(sum * scale + 0.5f)];
+                }
+            }
+        }
+    }
+}
+
+}
+
 Image::Image(Context* context) :
     Resource(context)
 {
@@ -921,6 +1082,82 @@ bool Image::Save(Serializer& dest) const
     return success;
 }
 
+bool Image::SaveCooked(Serializer& dest) const
+{
+    if (!data_ || IsCompressed() || cubemap_ || array_ || depth_ != 1 || nextSibling_ || components_ < 1)
+        return false;
+
+    URHO3D_PROFILE("SaveCookedImage");
+
+    unsigned numLevels = 1;
+    for (int size = Max(width_, height_); size > 1; size /= 2)
+        ++numLevels;
+
+    dest.WriteInt(width_);
+    dest.WriteInt(height_);
+    dest.WriteUInt(components_);
+    dest.WriteBool(sRGB_);
+    dest.WriteUInt(numLevels);
+
+    // Precalculated levels are reused if present
+    const Image* level = this;
+    SharedPtr<Image> nextLevel;
+    for (unsigned i = 0; i < numLevels; ++i)
+    {
+        const unsigned size = level->width_ * level->height_ * components_;
+        if (dest.Write(level->data_.get(), size) != size)
+            return false;
+
+        if (i + 1 < numLevels)
+        {
+            nextLevel = level->GetNextLevel();
+            if (!nextLevel)
+                return false;
+            level = nextLevel;
+        }
+    }
+    return true;
+}
+
+bool Image::BeginLoadCooked(Deserializer& source)
+{
+    URHO3D_PROFILE("LoadCookedImage");
+
+    const int width = source.ReadInt();
+    const int height = source.ReadInt();
+    const unsigned components = source.ReadUInt();
+    const bool sRGB = source.ReadBool();
+    const unsigned numLevels = source.ReadUInt();
+    if (width <= 0 || height <= 0 || components < 1 || components > 4 || numLevels == 0 || numLevels > 32)
+        return false;
+
+    cubemap_ = false;
+    array_ = false;
+    sRGB_ = sRGB;
+    nextLevel_.Reset();
+    nextSibling_.Reset();
+
+    Image* level = this;
+    for (unsigned i = 0; i < numLevels; ++i)
+    {
+        if (i > 0)
+        {
+            level->nextLevel_ = MakeShared<Image>(context_);
+            level = level->nextLevel_;
+        }
+
+        if (!level->SetSize(Max(width >> i, 1), Max(height >> i, 1), components))
+            return false;
+        const unsigned size = level->width_ * level->height_ * components;
+        if (source.Read(level->data_.get(), size) != size)
+            return false;
+        level->sRGB_ = sRGB;
+    }
+
+    levelsCooked_ = true;
+    return true;
+}
+
 bool Image::SaveFile(const FileIdentifier& fileName) const
 {
     // TODO(vfs): This function can save only to the host filesystem.
@@ -978,6 +1215,7 @@ bool Image::SetSize(int width, int height, int depth, unsigned components)
     compressedFormat_ = CF_NONE;
     numCompressedLevels_ = 0;
     nextLevel_.Reset();
+    levelsCooked_ = false;
 
     SetMemoryUse(width * height * depth * components);
     return true;
@@ -1040,6 +1278,7 @@ void Image::SetData(const unsigned char* pixelData)
     else
         memset(data_.get(), 0, size);
     nextLevel_.Reset();
+    levelsCooked_ = false;
 }
 
 bool Image::LoadColorLUT(Deserializer& source)
@@ -1241,34 +1480,38 @@ bool Image::Resize(int width, int height)
 
     /// \todo Reducing image size does not sample all needed pixels
     ea::shared_array<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
+    // Rows are resampled independently, source image is only read
+    ForEachImageRow(GetSubsystem<WorkQueue>(), height, width, [&](int beginY, int endY)
     {
-        for (int x = 0; x < width; ++x)
+        for (int y = beginY; y < endY; ++y)
         {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData.get() + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
-
-            switch (components_)
+            for (int x = 0; x < width; ++x)
             {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
+                // Calculate float coordinates between 0 - 1 for resampling
+                float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
+                float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
+                unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
+                unsigned char* dest = newData.get() + (y * width + x) * components_;
+                auto* src = (unsigned char*)&uintColor;
+
+                switch (components_)
+                {
+                case 4:
+                    dest[3] = src[3];
+                    // Fall through
+                case 3:
+                    dest[2] = src[2];
+                    // Fall through
+                case 2:
+                    dest[1] = src[1];
+                    // Fall through
+                default:
+                    dest[0] = src[0];
+                    break;
+                }
             }
         }
-    }
+    });
 
     width_ = width;
     height_ = height;
@@ -1277,6 +1520,16 @@ bool Image::Resize(int width, int height)
     return true;
 }
 
+void Image::SetSRGB(bool enable)
+{
+    if (sRGB_ != enable)
+    {
+        sRGB_ = enable;
+        // Mip levels should be filtered again
+        CleanupLevels();
+    }
+}
+
 void Image::Clear(const Color& color)
 {
     ClearInt(color.ToUInt());
@@ -1720,6 +1973,7 @@ SharedPtr<Image> Image::GetNextLevel() const
         mipImage->SetSize(widthOut, heightOut, depthOut, components_);
     else
         mipImage->SetSize(widthOut, heightOut, components_);
+    mipImage->sRGB_ = sRGB_;
 
     const unsigned char* pixelDataIn = data_.get();
     unsigned char* pixelDataOut = mipImage->data_.get();
@@ -1773,84 +2027,16 @@ SharedPtr<Image> Image::GetNextLevel() const
     // 2D case
     else if (depth_ == 1)
     {
-        switch (components_)
+        const int widthIn = width_;
+        const unsigned components = components_;
+        const bool sRGB = sRGB_;
+        ForEachImageRow(GetSubsystem<WorkQueue>(), heightOut, widthOut, [&](int beginY, int endY)
         {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+            if (sRGB)
+                DownsampleRowsSRGB(pixelDataIn, pixelDataOut, widthIn, widthOut, components, beginY, endY);
+            else
+                DownsampleRows(pixelDataIn, pixelDataOut, widthIn, widthOut, components, beginY, endY);
+        });
     }
     // 3D case
     else
@@ -2210,7 +2396,7 @@ SharedPtr<Image> Image::GetDecompressedImageLevel(unsigned index) const
 
         auto decompressedImage = MakeShared<Image>(context_);
         decompressedImage->SetSize(compressedLevel.width_, compressedLevel.height_, 4);
-        if (!compressedLevel.Decompress(decompressedImage->GetData()))
+        if (!compressedLevel.Decompress(decompressedImage->GetData(), GetSubsystem<WorkQueue>()))
         {
             URHO3D_LOGERROR("Failed to decompress image level");
             return nullptr;
@@ -2401,7 +2587,7 @@ SDL_Surface* Image::GetSDLSurface(const IntRect& rect) const
 
 void Image::PrecalculateLevels()
 {
-    if (!data_ || IsCompressed())
+    if (!data_ || IsCompressed() || levelsCooked_)
         return;
 
     URHO3D_PROFILE("PrecalculateImageMipLevels");
@@ -2423,6 +2609,7 @@ void Image::PrecalculateLevels()
 void Image::CleanupLevels()
 {
     nextLevel_.Reset();
+    levelsCooked_ = false;
 }
 
 void Image::GetLevels(ea::vector<Image*>& levels)
@@ -34,6 +34,8 @@ struct SDL_Surface;
 namespace Urho3D
 {
 
+class WorkQueue;
+
 static const int COLOR_LUT_SIZE = 16;
 
 /// Supported compressed image formats.
@@ -57,7 +59,8 @@ enum CompressedFormat
 struct URHO3D_API CompressedLevel
 {
     /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Return true if successful.
-    bool Decompress(unsigned char* dest) const;
+    /// Blocks are decompressed in parallel if work queue is specified.
+    bool Decompress(unsigned char* dest, WorkQueue* workQueue = nullptr) const;
 
     /// Compressed image data.
     unsigned char* data_{};
@@ -99,6 +102,12 @@ public:
     bool Save(Serializer& dest) const override;
     /// Save the image to a file. Format of the image is determined by file extension. JPG is saved with maximum quality.
     bool SaveFile(const FileIdentifier& fileName) const override;
+    /// Return version of the cooked binary form.
+    unsigned GetCookedVersion() const override { return 1; }
+    /// Save uncompressed 2D image with the complete mip chain. Compressed images, cubemaps and arrays are not cooked.
+    bool SaveCooked(Serializer& dest) const override;
+    /// Load uncompressed 2D image with the complete mip chain.
+    bool BeginLoadCooked(Deserializer& source) override;
 
     /// Set 2D size and number of color components. Old image data will be destroyed and new data is undefined. Return true if successful.
     bool SetSize(int width, int height, unsigned components);
@@ -122,6 +131,8 @@ public:
     bool FlipVertical();
     /// Resize image by bilinear resampling. Return true if successful.
     bool Resize(int width, int height);
+    /// Set whether the color data is in sRGB space. Mip levels of sRGB images are filtered in linear space.
+    void SetSRGB(bool enable);
     /// Clear the image with a color.
     void Clear(const Color& color);
     /// Clear the image with an integer color. R component is in the 8 lowest bits.
@@ -144,7 +155,7 @@ public:
     /// Whether this texture has been detected as a volume, only relevant for DDS.
     /// @property
     bool IsArray() const { return array_; }
-    /// Whether this texture is in sRGB, only relevant for DDS.
+    /// Whether this texture is in sRGB. Detected for DDS, may be set manually for other formats.
     /// @property
     bool IsSRGB() const { return sRGB_; }
 
@@ -198,7 +209,7 @@ public:
     /// @property
     unsigned GetNumCompressedLevels() const { return numCompressedLevels_; }
 
-    /// Return next mip level by bilinear filtering. Note that if the image is already 1x1x1, will keep returning an image of that size.
+    /// Return next mip level by box filtering. 2D images are filtered in parallel if possible. Note that if the image is already 1x1x1, will keep returning an image of that size.
     SharedPtr<Image> GetNextLevel() const;
     /// Return the next sibling image of an array or cubemap.
     SharedPtr<Image> GetNextSibling() const { return nextSibling_;  }
@@ -256,6 +267,8 @@ private:
     ea::shared_array<unsigned char> data_;
     /// Precalculated mip level image.
     SharedPtr<Image> nextLevel_;
+    /// Whether the mip levels were loaded from cooked file and don't need to be calculated.
+    bool levelsCooked_{};
     /// Next texture array or cube map image.
     SharedPtr<Image> nextSibling_;
 };
@@ -26,6 +26,9 @@
 
 #include "../Core/StringUtils.h"
 #include "../IO/ArchiveSerialization.h"
+#include "../IO/Deserializer.h"
+
+#include <rapidjson/reader.h>
 
 namespace Urho3D
 {
@@ -307,4 +310,562 @@ URHO3D_JSON_IN_IMPL(ea::string, GetString, JSON_STRING);
 
 #undef URHO3D_JSON_IN_IMPL
 
+/// Scalar JSON value read from the stream.
+struct JSONStreamValue
+{
+    JSONValueType type_{};
+    bool bool_{};
+    double number_{};
+    ea::string string_;
+};
+
+/// Buffered seekable stream over Deserializer. Implements rapidjson input stream concept.
+class JSONInputStream
+{
+public:
+    using Ch = char;
+
+    JSONInputStream(Deserializer& source, unsigned bufferSize)
+        : source_(source)
+        , buffer_(ea::max(bufferSize, 1u))
+        , bufferOffset_(source.Tell())
+    {
+    }
+
+    /// @name rapidjson stream interface
+    /// @{
+    Ch Peek() { return position_ < bufferSize_ || Fill() ? buffer_[position_] : '\0'; }
+    Ch Take()
+    {
+        const Ch ch = Peek();
+        if (ch != '\0')
+            ++position_;
+        return ch;
+    }
+    size_t Tell() const { return bufferOffset_ + position_; }
+
+    Ch* PutBegin() { URHO3D_ASSERT(0); return nullptr; }
+    void Put(Ch) { URHO3D_ASSERT(0); }
+    void Flush() {}
+    size_t PutEnd(Ch*) { URHO3D_ASSERT(0); return 0; }
+    /// @}
+
+    const ea::string& GetName() const { return source_.GetName(); }
+    unsigned GetOffset() const { return bufferOffset_ + position_; }
+
+    /// Move to the offset in the stream. Offsets within the buffer don't cause actual seek.
+    void Seek(unsigned offset)
+    {
+        if (offset >= bufferOffset_ && offset <= bufferOffset_ + bufferSize_)
+        {
+            position_ = offset - bufferOffset_;
+            return;
+        }
+
+        if (source_.Seek(offset) != offset)
+            throw ArchiveException("Cannot seek to offset {} in '{}'", offset, GetName());
+
+        bufferOffset_ = offset;
+        bufferSize_ = 0;
+        position_ = 0;
+    }
+
+    /// Skip whitespaces and comments.
+    void SkipWhitespace()
+    {
+        while (true)
+        {
+            const Ch ch = Peek();
+            if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t')
+                Take();
+            else if (ch == '/')
+                SkipComment();
+            else
+                break;
+        }
+    }
+
+    /// Skip whitespaces and the comma after the value.
+    void SkipSeparator()
+    {
+        SkipWhitespace();
+        if (Peek() == ',')
+        {
+            Take();
+            SkipWhitespace();
+        }
+    }
+
+    /// Take the character or throw if it doesn't match.
+    void Expect(Ch expected)
+    {
+        if (Peek() != expected)
+            throw ParseError();
+        Take();
+    }
+
+    /// Skip the value without parsing it.
+    void SkipValue()
+    {
+        SkipWhitespace();
+        const Ch ch = Take();
+        if (ch == '"')
+            SkipStringBody();
+        else if (ch == '{' || ch == '[')
+        {
+            unsigned depth = 1;
+            while (depth > 0)
+            {
+                switch (Take())
+                {
+                case '\0': throw ParseError();
+                case '"': SkipStringBody(); break;
+                case '/': --position_; SkipComment(); break;
+                case '{':
+                case '[': ++depth; break;
+                case '}':
+                case ']': --depth; break;
+                default: break;
+                }
+            }
+        }
+        else if (IsLiteralCharacter(ch))
+        {
+            while (IsLiteralCharacter(Peek()))
+                Take();
+        }
+        else
+            throw ParseError();
+    }
+
+    /// Parse scalar value. Containers are reported by type and not consumed.
+    const JSONStreamValue& ReadScalar()
+    {
+        SkipWhitespace();
+        const Ch ch = Peek();
+        if (ch == '{' || ch == '[')
+        {
+            value_.type_ = ch == '{' ? JSON_OBJECT : JSON_ARRAY;
+            return value_;
+        }
+
+        ScalarHandler handler{value_};
+        if (reader_.Parse<rapidjson::kParseCommentsFlag | rapidjson::kParseStopWhenDoneFlag>(*this, handler).IsError())
+            throw ParseError();
+        return value_;
+    }
+
+    /// Parse key of the object member.
+    const ea::string& ReadKey()
+    {
+        if (Peek() != '"' || ReadScalar().type_ != JSON_STRING)
+            throw ParseError();
+        return value_.string_;
+    }
+
+    /// Return exception for malformed JSON at the current offset.
+    ArchiveException ParseError() const
+    {
+        return ArchiveException("Invalid JSON in '{}' at offset {}", GetName(), GetOffset());
+    }
+
+private:
+    /// Handler that accepts only scalar values.
+    struct ScalarHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ScalarHandler>
+    {
+        explicit ScalarHandler(JSONStreamValue& value) : value_(value) {}
+
+        bool Default() { return false; }
+        bool Null() { value_.type_ = JSON_NULL; return true; }
+        bool Bool(bool value) { value_.type_ = JSON_BOOL; value_.bool_ = value; return true; }
+        bool Int(int value) { return Number(value); }
+        bool Uint(unsigned value) { return Number(value); }
+        bool Int64(int64_t value) { return Number(static_cast<double>(value)); }
+        bool Uint64(uint64_t value) { return Number(static_cast<double>(value)); }
+        bool Double(double value) { return Number(value); }
+        bool String(const char* value, rapidjson::SizeType length, bool)
+        {
+            value_.type_ = JSON_STRING;
+            value_.string_.assign(value, length);
+            return true;
+        }
+
+        bool Number(double value)
+        {
+            value_.type_ = JSON_NUMBER;
+            value_.number_ = value;
+            return true;
+        }
+
+        JSONStreamValue& value_;
+    };
+
+    static bool IsLiteralCharacter(Ch ch)
+    {
+        return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '-' || ch == '+'
+            || ch == '.';
+    }
+
+    bool Fill()
+    {
+        bufferOffset_ += bufferSize_;
+        position_ = 0;
+        bufferSize_ = source_.Read(buffer_.data(), buffer_.size());
+        return bufferSize_ > 0;
+    }
+
+    void SkipStringBody()
+    {
+        while (true)
+        {
+            const Ch ch = Take();
+            if (ch == '"')
+                return;
+            else if (ch == '\\')
+                Take();
+            else if (ch == '\0')
+                throw ParseError();
+        }
+    }
+
+    void SkipComment()
+    {
+        Take();
+        const Ch ch = Take();
+        if (ch == '/')
+        {
+            while (Peek() != '\n' && Peek() != '\0')
+                Take();
+        }
+        else if (ch == '*')
+        {
+            while (true)
+            {
+                const Ch commentCh = Take();
+                if (commentCh == '\0')
+                    throw ParseError();
+                if (commentCh == '*' && Peek() == '/')
+                {
+                    Take();
+                    return;
+                }
+            }
+        }
+        else
+            throw ParseError();
+    }
+
+    Deserializer& source_;
+    ea::vector<Ch> buffer_;
+    /// Offset of the buffer in the stream.
+    unsigned bufferOffset_{};
+    /// Number of valid bytes in the buffer.
+    unsigned bufferSize_{};
+    /// Current position in the buffer.
+    unsigned position_{};
+
+    rapidjson::Reader reader_;
+    JSONStreamValue value_;
+};
+
+JSONStreamInputArchiveBlock::JSONStreamInputArchiveBlock(const char* name, ArchiveBlockType type, JSONInputStream* stream)
+    : ArchiveBlockBase(name, type)
+    , stream_(stream)
+{
+}
+
+void JSONStreamInputArchiveBlock::Open(ArchiveBase& archive, unsigned offset)
+{
+    stream_->Seek(offset);
+    stream_->SkipWhitespace();
+
+    const char ch = stream_->Peek();
+    if (ch == 'n')
+    {
+        if (stream_->ReadScalar().type_ != JSON_NULL)
+            throw stream_->ParseError();
+
+        empty_ = true;
+        endOffset_ = stream_->GetOffset();
+        return;
+    }
+
+    if (ch != '{' && ch != '[')
+        throw archive.UnexpectedElementValueException(name_);
+    stream_->Take();
+
+    // Empty container of another kind is compatible with the block
+    if (IsArchiveBlockJSONArray(type_) != (ch == '['))
+    {
+        stream_->SkipWhitespace();
+        if (stream_->Peek() != (ch == '[' ? ']' : '}'))
+            throw archive.UnexpectedElementValueException(name_);
+        stream_->Take();
+
+        empty_ = true;
+        endOffset_ = stream_->GetOffset();
+        return;
+    }
+
+    stream_->SkipWhitespace();
+    nextOffset_ = stream_->GetOffset();
+
+    if (type_ == ArchiveBlockType::Array)
+    {
+        while (stream_->Peek() != ']')
+        {
+            stream_->SkipValue();
+            stream_->SkipSeparator();
+            ++sizeHint_;
+        }
+        stream_->Take();
+        endOffset_ = stream_->GetOffset();
+    }
+}
+
+unsigned JSONStreamInputArchiveBlock::ReadElement(ArchiveBase& archive, const char* elementName)
+{
+    if (type_ == ArchiveBlockType::Unordered)
+    {
+        const auto valueOffset = FindMember(elementName);
+        if (!valueOffset)
+            throw archive.ElementNotFoundException(elementName);
+
+        lastValueOffset_ = *valueOffset;
+        return *valueOffset;
+    }
+
+    if (empty_ || (type_ == ArchiveBlockType::Array && nextElementIndex_ >= sizeHint_))
+        throw archive.ElementNotFoundException(elementName, nextElementIndex_);
+
+    SkipPendingValue();
+
+    stream_->Seek(nextOffset_);
+    if (stream_->Peek() == ']')
+        throw archive.ElementNotFoundException(elementName, nextElementIndex_);
+
+    pendingValue_ = true;
+    lastValueOffset_ = nextOffset_;
+    ++nextElementIndex_;
+    return nextOffset_;
+}
+
+void JSONStreamInputArchiveBlock::EndElement(unsigned endOffset)
+{
+    // Continue from the end of the value if it was read in order
+    if (pendingValue_ && lastValueOffset_ == nextOffset_)
+    {
+        stream_->Seek(endOffset);
+        stream_->SkipSeparator();
+        nextOffset_ = stream_->GetOffset();
+        pendingValue_ = false;
+    }
+}
+
+bool JSONStreamInputArchiveBlock::HasElementOrBlock(const char* name) const
+{
+    return type_ == ArchiveBlockType::Unordered && FindMember(name).has_value();
+}
+
+void JSONStreamInputArchiveBlock::Close(ArchiveBase& archive)
+{
+    const unsigned endOffset = SkipToEnd();
+    static_cast<JSONStreamInputArchive&>(archive).OnBlockClosed(endOffset);
+}
+
+ea::optional<unsigned> JSONStreamInputArchiveBlock::FindMember(const char* name) const
+{
+    // Members are usually read in order, so the last found member is the most likely one
+    if (pendingValue_ && !members_.empty() && members_.back().first == name)
+        return members_.back().second;
+
+    for (const auto& [memberName, valueOffset] : members_)
+    {
+        if (memberName == name)
+            return valueOffset;
+    }
+
+    while (ScanNextMember())
+    {
+        if (members_.back().first == name)
+            return members_.back().second;
+    }
+    return ea::nullopt;
+}
+
+bool JSONStreamInputArchiveBlock::ScanNextMember() const
+{
+    if (empty_ || endOffset_ != M_MAX_UNSIGNED)
+        return false;
+
+    SkipPendingValue();
+
+    stream_->Seek(nextOffset_);
+    if (stream_->Peek() == '}')
+    {
+        stream_->Take();
+        endOffset_ = stream_->GetOffset();
+        return false;
+    }
+
+    ea::string name = stream_->ReadKey();
+    stream_->SkipWhitespace();
+    stream_->Expect(':');
+    stream_->SkipWhitespace();
+
+    nextOffset_ = stream_->GetOffset();
+    pendingValue_ = true;
+    members_.emplace_back(ea::move(name), nextOffset_);
+    return true;
+}
+
+void JSONStreamInputArchiveBlock::SkipPendingValue() const
+{
+    if (!pendingValue_)
+        return;
+
+    stream_->Seek(nextOffset_);
+    stream_->SkipValue();
+    stream_->SkipSeparator();
+    nextOffset_ = stream_->GetOffset();
+    pendingValue_ = false;
+}
+
+unsigned JSONStreamInputArchiveBlock::SkipToEnd() const
+{
+    if (endOffset_ != M_MAX_UNSIGNED)
+        return endOffset_;
+
+    if (type_ == ArchiveBlockType::Unordered)
+    {
+        while (ScanNextMember())
+        {
+        }
+        return endOffset_;
+    }
+
+    SkipPendingValue();
+
+    stream_->Seek(nextOffset_);
+    while (stream_->Peek() != ']')
+    {
+        stream_->SkipValue();
+        stream_->SkipSeparator();
+    }
+    stream_->Take();
+
+    endOffset_ = stream_->GetOffset();
+    return endOffset_;
+}
+
+JSONStreamInputArchive::JSONStreamInputArchive(Context* context, Deserializer& source, unsigned bufferSize)
+    : ArchiveBaseT(context)
+    , stream_(ea::make_unique<JSONInputStream>(source, bufferSize))
+{
+}
+
+JSONStreamInputArchive::~JSONStreamInputArchive() = default;
+
+ea::string_view JSONStreamInputArchive::GetName() const
+{
+    return stream_->GetName();
+}
+
+void JSONStreamInputArchive::BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type)
+{
+    CheckBeforeBlock(name);
+    CheckBlockOrElementName(name);
+
+    // Root block starts at the current position of the stream
+    const unsigned offset = stack_.empty() ? stream_->GetOffset() : GetCurrentBlock().ReadElement(*this, name);
+
+    Block block{name, type, stream_.get()};
+    block.Open(*this, offset);
+    sizeHint = block.GetSizeHint();
+    stack_.push_back(ea::move(block));
+}
+
+void JSONStreamInputArchive::Serialize(const char* name, long long& value)
+{
+    const JSONStreamValue& jsonValue = ReadElement(name, JSON_STRING);
+    value = ToInt64(jsonValue.string_);
+}
+
+void JSONStreamInputArchive::Serialize(const char* name, unsigned long long& value)
+{
+    const JSONStreamValue& jsonValue = ReadElement(name, JSON_STRING);
+    value = ToUInt64(jsonValue.string_);
+}
+
+void JSONStreamInputArchive::SerializeBytes(const char* name, void* bytes, unsigned size)
+{
+    const JSONStreamValue& jsonValue = ReadElement(name, JSON_STRING);
+    ReadBytesFromHexString(name, jsonValue.string_, bytes, size);
+}
+
+void JSONStreamInputArchive::SerializeVLE(const char* name, unsigned& value)
+{
+    const JSONStreamValue& jsonValue = ReadElement(name, JSON_NUMBER);
+    value = static_cast<unsigned>(jsonValue.number_);
+}
+
+ea::pair<unsigned, unsigned> JSONStreamInputArchive::SkipElement(const char* name)
+{
+    CheckBeforeElement(name);
+    CheckBlockOrElementName(name);
+
+    Block& block = GetCurrentBlock();
+    const unsigned beginOffset = block.ReadElement(*this, name);
+    stream_->Seek(beginOffset);
+    stream_->SkipValue();
+
+    const unsigned endOffset = stream_->GetOffset();
+    block.EndElement(endOffset);
+    return {beginOffset, endOffset};
+}
+
+const JSONStreamValue& JSONStreamInputArchive::ReadElement(const char* name, JSONValueType type)
+{
+    CheckBeforeElement(name);
+    CheckBlockOrElementName(name);
+
+    Block& block = GetCurrentBlock();
+    stream_->Seek(block.ReadElement(*this, name));
+
+    const JSONStreamValue& jsonValue = stream_->ReadScalar();
+    if (jsonValue.type_ != type)
+        throw UnexpectedElementValueException(name);
+
+    block.EndElement(stream_->GetOffset());
+    return jsonValue;
+}
+
+void JSONStreamInputArchive::OnBlockClosed(unsigned endOffset)
+{
+    // Current block is still on the stack
+    if (stack_.size() > 1)
+        stack_[stack_.size() - 2].EndElement(endOffset);
+}
+
+// Generate serialization implementation (JSON stream input)
+#define URHO3D_JSON_STREAM_IN_IMPL(type, jsonType, expression) \
+    void JSONStreamInputArchive::Serialize(const char* name, type& value) \
+    { \
+        const JSONStreamValue& jsonValue = ReadElement(name, jsonType); \
+        value = expression; \
+    }
+
+URHO3D_JSON_STREAM_IN_IMPL(bool, JSON_BOOL, jsonValue.bool_);
+URHO3D_JSON_STREAM_IN_IMPL(signed char, JSON_NUMBER, static_cast<int>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(short, JSON_NUMBER, static_cast<int>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(int, JSON_NUMBER, static_cast<int>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(unsigned char, JSON_NUMBER, static_cast<unsigned>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(unsigned short, JSON_NUMBER, static_cast<unsigned>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(unsigned int, JSON_NUMBER, static_cast<unsigned>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(float, JSON_NUMBER, static_cast<float>(jsonValue.number_));
+URHO3D_JSON_STREAM_IN_IMPL(double, JSON_NUMBER, jsonValue.number_);
+URHO3D_JSON_STREAM_IN_IMPL(ea::string, JSON_STRING, jsonValue.string_);
+
+#undef URHO3D_JSON_STREAM_IN_IMPL
+
 }
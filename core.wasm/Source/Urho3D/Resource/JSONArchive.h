@@ -27,6 +27,7 @@
 #include "../Resource/JSONValue.h"
 
 #include <EASTL/optional.h>
+#include <EASTL/unique_ptr.h>
 
 namespace Urho3D
 {
@@ -182,6 +183,110 @@ private:
     const JSONValue& rootValue_;
 };
 
+class Deserializer;
+class JSONInputStream;
+struct JSONStreamValue;
+
+/// JSON stream input archive block. Keeps only the offsets of items in the stream.
+class URHO3D_API JSONStreamInputArchiveBlock : public ArchiveBlockBase
+{
+public:
+    JSONStreamInputArchiveBlock(const char* name, ArchiveBlockType type, JSONInputStream* stream);
+    /// Open block at the value in the stream.
+    void Open(ArchiveBase& archive, unsigned offset);
+    /// Return size hint. Only Array blocks are counted when opened.
+    unsigned GetSizeHint() const { return sizeHint_; }
+    /// Find next element and return offset of its value in the stream.
+    unsigned ReadElement(ArchiveBase& archive, const char* elementName);
+    /// Notify that the value of the last element ends at the offset.
+    void EndElement(unsigned endOffset);
+
+    bool IsUnorderedAccessSupported() const { return type_ == ArchiveBlockType::Unordered; }
+    bool HasElementOrBlock(const char* name) const;
+    void Close(ArchiveBase& archive);
+
+private:
+    /// Find member of the object by name.
+    ea::optional<unsigned> FindMember(const char* name) const;
+    /// Scan next member of the object. Return false if there are no more members.
+    bool ScanNextMember() const;
+    /// Skip the pending value if it was not read completely.
+    void SkipPendingValue() const;
+    /// Skip remaining items. Return offset after the end of the block.
+    unsigned SkipToEnd() const;
+
+    JSONInputStream* stream_{};
+    /// Whether the block is empty. Null is read as empty block.
+    bool empty_{};
+    /// Offset of the next item, or of the pending value if there is one.
+    mutable unsigned nextOffset_{};
+    /// Whether the value at the next offset is found but not skipped yet.
+    mutable bool pendingValue_{};
+    /// Offset of the value of the last read element.
+    unsigned lastValueOffset_{M_MAX_UNSIGNED};
+    /// Offset after the end of the block, if known.
+    mutable unsigned endOffset_{M_MAX_UNSIGNED};
+    /// Object members found so far and offsets of their values.
+    mutable ea::vector<ea::pair<ea::string, unsigned>> members_;
+    /// Number of elements (for Array blocks).
+    unsigned sizeHint_{};
+    /// Next array index (for Sequential and Array blocks).
+    unsigned nextElementIndex_{};
+};
+
+/// JSON input archive that reads directly from the stream without building JSONValue tree.
+/// Values are parsed on demand, blocks remember only offsets of their items.
+/// Items of Unordered blocks are expected in the order of serialization, other items are found by scanning ahead.
+/// Array blocks are scanned once when opened to count the elements.
+/// Stream should support seeking.
+class URHO3D_API JSONStreamInputArchive : public ArchiveBaseT<JSONStreamInputArchiveBlock, true, true>
+{
+    friend class JSONStreamInputArchiveBlock;
+
+public:
+    /// Default size of the read buffer.
+    static constexpr unsigned DefaultBufferSize = 64 * 1024;
+
+    /// Construct from stream. Reading starts at the current position of the stream.
+    JSONStreamInputArchive(Context* context, Deserializer& source, unsigned bufferSize = DefaultBufferSize);
+    /// Destruct.
+    ~JSONStreamInputArchive() override;
+
+    /// @name Archive implementation
+    /// @{
+    ea::string_view GetName() const override;
+
+    void BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type) final;
+
+    void Serialize(const char* name, bool& value) final;
+    void Serialize(const char* name, signed char& value) final;
+    void Serialize(const char* name, unsigned char& value) final;
+    void Serialize(const char* name, short& value) final;
+    void Serialize(const char* name, unsigned short& value) final;
+    void Serialize(const char* name, int& value) final;
+    void Serialize(const char* name, unsigned int& value) final;
+    void Serialize(const char* name, long long& value) final;
+    void Serialize(const char* name, unsigned long long& value) final;
+    void Serialize(const char* name, float& value) final;
+    void Serialize(const char* name, double& value) final;
+    void Serialize(const char* name, ea::string& value) final;
+
+    void SerializeBytes(const char* name, void* bytes, unsigned size) final;
+    void SerializeVLE(const char* name, unsigned& value) final;
+    /// @}
+
+    /// Skip next element of the current block without parsing it.
+    /// Return the range of the element in the source, which may be read later by another archive.
+    ea::pair<unsigned, unsigned> SkipElement(const char* name);
+
+private:
+    const JSONStreamValue& ReadElement(const char* name, JSONValueType type);
+    /// Pass the end of the block being closed to the parent block.
+    void OnBlockClosed(unsigned endOffset);
+
+    ea::unique_ptr<JSONInputStream> stream_;
+};
+
 /// Save object to JSON string.
 template <class T> ea::optional<ea::string> ToJSONString(T& object)
 {
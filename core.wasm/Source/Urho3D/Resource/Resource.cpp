@@ -28,6 +28,7 @@
 #include "../IO/Log.h"
 #include "../IO/VirtualFileSystem.h"
 #include "../Precompiled.h"
+#include "../Resource/CookedResourceCache.h"
 #include "../Resource/JSONArchive.h"
 #include "../Resource/Resource.h"
 #include "../Resource/ResourceCache.h"
@@ -114,6 +115,11 @@ namespace Urho3D
     }
 
     bool Resource::Load( Deserializer& source )
+    {
+        return Load( source, nullptr );
+    }
+
+    bool Resource::Load( Deserializer& source, CookedResourceCache* cookedCache )
     {
         // Because BeginLoad() / EndLoad() can be called from worker threads, where profiling would be a no-op,
         // create a type name -based profile block here
@@ -124,7 +130,7 @@ namespace Urho3D
         // If we are loading synchronously in a non-main thread, behave as if async loading (for example use
         // GetTempResource() instead of GetResource() to load resource dependencies)
         SetAsyncLoadState( Thread::IsMainThread() ? ASYNC_DONE : ASYNC_LOADING );
-        bool success = BeginLoad( source );
+        bool success = cookedCache ? cookedCache->BeginLoad( this, source ) : BeginLoad( source );
         if ( success )
         {
             success &= EndLoad();
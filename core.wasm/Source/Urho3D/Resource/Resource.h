@@ -37,6 +37,7 @@
 namespace Urho3D
 {
 
+class CookedResourceCache;
 class Deserializer;
 class Serializer;
 class XMLElement;
@@ -95,6 +96,8 @@ public:
 
     /// Load resource synchronously. Call both BeginLoad() & EndLoad() and return true if both succeeded.
     bool Load(Deserializer& source);
+    /// Load resource synchronously, using cooked form from the cache if available. Cache is ignored if null.
+    bool Load(Deserializer& source, CookedResourceCache* cookedCache);
     /// Load resource from stream. May be called from a worker thread. Return true if successful.
     virtual bool BeginLoad(Deserializer& source);
     /// Finish resource loading. Always called from the main thread. Return true if successful.
@@ -102,6 +105,14 @@ public:
     /// Save resource. Return true if successful.
     virtual bool Save(Serializer& dest) const;
 
+    /// Return version of the cooked binary form, or 0 if the resource cannot be cooked.
+    /// Cooked files of another version are ignored.
+    virtual unsigned GetCookedVersion() const { return 0; }
+    /// Save cooked binary form of the loaded resource, optimized for loading. Return true if successful.
+    virtual bool SaveCooked(Serializer& dest) const { return false; }
+    /// Load resource from cooked binary form. May be called from a worker thread. Return true if successful.
+    virtual bool BeginLoadCooked(Deserializer& source) { return false; }
+
     /// Load resource from file.
     bool LoadFile(const FileIdentifier& fileName);
     /// Save resource to file.
@@ -23,6 +23,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Core/WorkQueue.h"
 #include "../DebugNew.h"
 #include "../IO/Log.h"
@@ -31,6 +32,7 @@
 #include "../Precompiled.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/BinaryFile.h"
+#include "../Resource/CookedResourceCache.h"
 #include "../Resource/Graph.h"
 #include "../Resource/GraphNode.h"
 #include "../Resource/Image.h"
@@ -58,13 +60,19 @@ namespace Urho3D
 
     static const SharedPtr< Resource > noResource;
 
+    /// Return key of the resource in the lookup index.
+    static unsigned long long GetLookupKey( StringHash type, StringHash nameHash )
+    {
+        return ( static_cast< unsigned long long >( type.Value() ) << 32 ) | nameHash.Value();
+    }
+
     ResourceCache::ResourceCache( Context* context ) : Object( context ), returnFailedResources_( false ), searchPackagesFirst_( true ), finishBackgroundResourcesMs_( 5 )
     {
         // Register Resource library object factories
         RegisterResourceLibrary( context_ );
 
 #ifdef URHO3D_THREADING
-        // Create resource background loader. Its thread will start on the first background request
+        // Create resource background loader. Loading tasks are posted to WorkQueue on the first background request
         backgroundLoader_ = new BackgroundLoader( this );
 #endif
 
@@ -82,6 +90,7 @@ namespace Urho3D
     {
 #ifdef URHO3D_THREADING
         // Shut down the background loader first
+        backgroundLoader_->Shutdown();
         backgroundLoader_.Reset();
 #endif
     }
@@ -102,7 +111,7 @@ namespace Urho3D
         }
 
         resource->ResetUseTimer();
-        resourceGroups_[ resource->GetType() ].resources_[ resource->GetNameHash() ] = resource;
+        StoreResource( resource->GetType(), resource->GetNameHash(), resource );
         UpdateResourceGroup( resource->GetType() );
         return true;
     }
@@ -117,6 +126,7 @@ namespace Urho3D
         // If other references exist, do not release, unless forced
         if ( ( existingRes.Refs() == 1 && existingRes.WeakRefs() == 0 ) || force )
         {
+            RemoveFromLookup( type, nameHash );
             resourceGroups_[ type ].resources_.erase( nameHash );
             UpdateResourceGroup( type );
         }
@@ -141,6 +151,7 @@ namespace Urho3D
                         // If other references exist, do not release, unless forced
                         if ( ( current->second.Refs() == 1 && current->second.WeakRefs() == 0 ) || force )
                         {
+                            RemoveFromLookup( i->first, current->first );
                             j        = i->second.resources_.erase( current );
                             released = true;
                             continue;
@@ -168,6 +179,7 @@ namespace Urho3D
                 // If other references exist, do not release, unless forced
                 if ( ( current->second.Refs() == 1 && current->second.WeakRefs() == 0 ) || force )
                 {
+                    RemoveFromLookup( i->first, current->first );
                     i->second.resources_.erase( current );
                     released = true;
                 }
@@ -193,6 +205,7 @@ namespace Urho3D
                     // If other references exist, do not release, unless forced
                     if ( ( current->second.Refs() == 1 && current->second.WeakRefs() == 0 ) || force )
                     {
+                        RemoveFromLookup( i->first, current->first );
                         i->second.resources_.erase( current );
                         released = true;
                     }
@@ -223,6 +236,7 @@ namespace Urho3D
                         // If other references exist, do not release, unless forced
                         if ( ( current->second.Refs() == 1 && current->second.WeakRefs() == 0 ) || force )
                         {
+                            RemoveFromLookup( i->first, current->first );
                             i->second.resources_.erase( current );
                             released = true;
                         }
@@ -250,6 +264,7 @@ namespace Urho3D
                     // If other references exist, do not release, unless forced
                     if ( ( current->second.Refs() == 1 && current->second.WeakRefs() == 0 ) || force )
                     {
+                        RemoveFromLookup( i->first, current->first );
                         i->second.resources_.erase( current );
                         released = true;
                     }
@@ -469,7 +484,7 @@ namespace Urho3D
         resource->SetName( sanitatedName );
         resource->SetAbsoluteFileName( file->GetAbsoluteName() );
 
-        if ( ! resource->Load( *( file.Get() ) ) )
+        if ( ! resource->Load( *( file.Get() ), cookedResourceCache_ ) )
         {
             // Error should already been logged by corresponding resource descendant class
             if ( sendEventOnFailure )
@@ -487,7 +502,7 @@ namespace Urho3D
 
         // Store to cache
         resource->ResetUseTimer();
-        resourceGroups_[ type ].resources_[ nameHash ] = resource;
+        StoreResource( type, nameHash, resource );
         UpdateResourceGroup( type );
 
         return resource;
@@ -502,8 +517,7 @@ namespace Urho3D
             return false;
 
         // First check if already exists as a loaded resource
-        StringHash nameHash( sanitatedName );
-        if ( FindResource( type, nameHash ) != noResource )
+        if ( FindCachedResource( { type, StringHash( sanitatedName ) } ) )
             return false;
 
         return backgroundLoader_->QueueResource( type, sanitatedName, sendEventOnFailure, caller );
@@ -552,7 +566,7 @@ namespace Urho3D
         resource->SetName( file->GetName() );
         resource->SetAbsoluteFileName( file->GetAbsoluteName() );
 
-        if ( ! resource->Load( *( file.Get() ) ) )
+        if ( ! resource->Load( *( file.Get() ), cookedResourceCache_ ) )
         {
             // Error should already been logged by corresponding resource descendant class
             if ( sendEventOnFailure )
@@ -728,10 +742,50 @@ namespace Urho3D
         return output;
     }
 
-    const SharedPtr< Resource >& ResourceCache::FindResource( StringHash type, StringHash nameHash )
+    ResourceCache::LookupShard& ResourceCache::GetLookupShard( StringHash type, StringHash nameHash ) const
     {
-        MutexLock lock( resourceMutex_ );
+        const unsigned hash = ( type.Value() ^ nameHash.Value() ) * 0x9e3779b1u;
+        return lookupShards_[ hash >> 28 ];
+    }
 
+    void ResourceCache::StoreResource( StringHash type, StringHash nameHash, Resource* resource )
+    {
+        // Keep the replaced resource alive until it is removed from the lookup index
+        SharedPtr< Resource >& slot = resourceGroups_[ type ].resources_[ nameHash ];
+        const SharedPtr< Resource > previous = slot;
+        slot = resource;
+
+        LookupShard& shard = GetLookupShard( type, nameHash );
+        std::unique_lock< std::shared_mutex > lock( shard.mutex_ );
+        shard.resources_[ GetLookupKey( type, nameHash ) ] = resource;
+    }
+
+    void ResourceCache::RemoveFromLookup( StringHash type, StringHash nameHash )
+    {
+        LookupShard& shard = GetLookupShard( type, nameHash );
+        std::unique_lock< std::shared_mutex > lock( shard.mutex_ );
+        shard.resources_.erase( GetLookupKey( type, nameHash ) );
+    }
+
+    SharedPtr< Resource > ResourceCache::FindCachedResource( const ResourceHandle& handle ) const
+    {
+        LookupShard& shard = GetLookupShard( handle.type_, handle.nameHash_ );
+        std::shared_lock< std::shared_mutex > lock( shard.mutex_ );
+        auto i = shard.resources_.find( GetLookupKey( handle.type_, handle.nameHash_ ) );
+        // Reference is acquired under the lock, so the resource cannot be destroyed concurrently
+        return i != shard.resources_.end() ? SharedPtr< Resource >( i->second ) : SharedPtr< Resource >();
+    }
+
+    ResourceHandle ResourceCache::GetResourceHandle( StringHash type, const ea::string& name ) const
+    {
+        const ea::string sanitatedName = SanitateResourceName( name );
+        if ( sanitatedName.empty() )
+            return {};
+        return { type, StringHash( sanitatedName ) };
+    }
+
+    const SharedPtr< Resource >& ResourceCache::FindResource( StringHash type, StringHash nameHash )
+    {
         auto i = resourceGroups_.find( type );
         if ( i == resourceGroups_.end() )
             return noResource;
@@ -744,8 +798,6 @@ namespace Urho3D
 
     const SharedPtr< Resource >& ResourceCache::FindResource( StringHash nameHash )
     {
-        MutexLock lock( resourceMutex_ );
-
         for ( auto i = resourceGroups_.begin(); i != resourceGroups_.end(); ++i )
         {
             auto j = i->second.resources_.find( nameHash );
@@ -760,10 +812,9 @@ namespace Urho3D
     {
         ea::hash_set< StringHash > affectedGroups;
 
-        const ea::unordered_map< ea::string, PackageEntry >& entries = package->GetEntries();
-        for ( auto i = entries.begin(); i != entries.end(); ++i )
+        for ( const PackageEntry& entry : package->GetEntries() )
         {
-            StringHash nameHash( i->first );
+            StringHash nameHash( package->GetEntryName( entry ) );
 
             // We do not know the actual resource type, so search all type containers
             for ( auto j = resourceGroups_.begin(); j != resourceGroups_.end(); ++j )
@@ -774,6 +825,7 @@ namespace Urho3D
                     // If other references exist, do not release, unless forced
                     if ( ( k->second.Refs() == 1 && k->second.WeakRefs() == 0 ) || force )
                     {
+                        RemoveFromLookup( j->first, k->first );
                         j->second.resources_.erase( k );
                         affectedGroups.insert( j->first );
                     }
@@ -816,6 +868,7 @@ namespace Urho3D
             if ( i->second.memoryBudget_ && i->second.memoryUse_ > i->second.memoryBudget_ && oldestResource != i->second.resources_.end() )
             {
                 URHO3D_LOGDEBUG( "Resource group " + oldestResource->second->GetTypeName() + " over memory budget, releasing resource " + oldestResource->second->GetName() );
+                RemoveFromLookup( i->first, oldestResource->first );
                 i->second.resources_.erase( oldestResource );
             }
             else
@@ -934,8 +987,26 @@ namespace Urho3D
         reentrancyGuard = false;
     }
 
+    void ResourceCache::SetCookedResourceDir( const ea::string& directory )
+    {
+        if ( directory.empty() )
+            cookedResourceCache_ = nullptr;
+        else
+            cookedResourceCache_ = MakeShared< CookedResourceCache >( context_, directory );
+    }
+
+    const ea::string& ResourceCache::GetCookedResourceDir() const
+    {
+        return cookedResourceCache_ ? cookedResourceCache_->GetDirectory() : EMPTY_STRING;
+    }
+
     void ResourceCache::Clear()
     {
+        for ( LookupShard& shard : lookupShards_ )
+        {
+            std::unique_lock< std::shared_mutex > lock( shard.mutex_ );
+            shard.resources_.clear();
+        }
         resourceGroups_.clear();
         dependentResources_.clear();
     }
@@ -34,10 +34,13 @@
 #include <EASTL/hash_set.h>
 #include <EASTL/unique_ptr.h>
 
+#include <shared_mutex>
+
 namespace Urho3D
 {
 
 class BackgroundLoader;
+class CookedResourceCache;
 class FileWatcher;
 class PackageFile;
 
@@ -62,6 +65,18 @@ struct ResourceGroup
     ea::unordered_map<StringHash, SharedPtr<Resource> > resources_;
 };
 
+/// Pre-computed key of the cached resource. Lookup by handle skips name sanitation and hashing.
+struct ResourceHandle
+{
+    /// Resource type.
+    StringHash type_;
+    /// Hash of the sanitated resource name.
+    StringHash nameHash_;
+
+    /// Return whether the handle refers to any resource.
+    bool IsValid() const { return type_ != StringHash::Empty && nameHash_ != StringHash::Empty; }
+};
+
 
 /// Optional resource request processor.
 /// Can deny requests, re-route resource file names, or perform other processing per request.
@@ -124,6 +139,12 @@ public:
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     /// @property
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set how many files may be read at the same time by background loading. BeginLoad of read files is not limited.
+    /// @property
+    void SetMaxBackgroundReads(unsigned num) { maxBackgroundReads_ = Max(num, 1u); }
+    /// Set directory of cooked resource cache. Cookable resources are loaded from cooked files and cooked on first load.
+    /// Empty directory disables the cache. Should not be changed while resources are loaded in background.
+    void SetCookedResourceDir(const ea::string& directory);
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -145,6 +166,10 @@ public:
     void GetResources(ea::vector<Resource*>& result, StringHash type) const;
     /// Return an already loaded resource of specific type & name, or null if not found. Will not load if does not exist. Specifying zero type will search all types.
     Resource* GetExistingResource(StringHash type, const ea::string& name);
+    /// Return handle of the resource of specific type & name. The name is sanitated once, the handle may be stored and reused.
+    ResourceHandle GetResourceHandle(StringHash type, const ea::string& name) const;
+    /// Return an already loaded resource by handle, or null if not found. Will not load if does not exist. Can be called from outside the main thread.
+    SharedPtr<Resource> FindCachedResource(const ResourceHandle& handle) const;
 
     /// Return all loaded resources.
     const ea::unordered_map<StringHash, ResourceGroup>& GetAllResources() const { return resourceGroups_; }
@@ -153,6 +178,10 @@ public:
     template <class T> T* GetResource(const ea::string& name, bool sendEventOnFailure = true);
     /// Template version of returning an existing resource by name.
     template <class T> T* GetExistingResource(const ea::string& name);
+    /// Template version of returning handle of the resource.
+    template <class T> ResourceHandle GetResourceHandle(const ea::string& name) const;
+    /// Template version of returning an already loaded resource by handle.
+    template <class T> SharedPtr<T> FindCachedResource(const ResourceHandle& handle) const;
     /// Template version of loading a resource without storing it to the cache.
     template <class T> SharedPtr<T> GetTempResource(const ea::string& name, bool sendEventOnFailure = true);
     /// Template version of releasing a resource by name.
@@ -183,9 +212,17 @@ public:
     /// @property
     bool GetSearchPackagesFirst() const { return searchPackagesFirst_; }
 
+    /// Return directory of cooked resource cache. Empty if disabled.
+    const ea::string& GetCookedResourceDir() const;
+
     /// Return how many milliseconds maximum to spend on finishing background loaded resources.
     /// @property
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
+    /// Return how many files may be read at the same time by background loading.
+    /// @property
+    unsigned GetMaxBackgroundReads() const { return maxBackgroundReads_; }
+    /// Return cache of cooked resources, or null if disabled.
+    CookedResourceCache* GetCookedResourceCache() const { return cookedResourceCache_; }
 
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
@@ -220,7 +257,24 @@ public:
     FileIdentifier GetResolvedIdentifier(const FileIdentifier& name) const;
 
 private:
-    /// Find a resource.
+    /// Shard of the concurrent resource lookup index.
+    struct LookupShard
+    {
+        /// Mutex for the shard. Locked exclusively only when resources are added or removed.
+        mutable std::shared_mutex mutex_;
+        /// Resources by combined type and name hash.
+        ea::unordered_map<unsigned long long, Resource*> resources_;
+    };
+    /// Number of lookup shards.
+    static const unsigned NUM_LOOKUP_SHARDS = 16;
+
+    /// Return lookup shard for the resource.
+    LookupShard& GetLookupShard(StringHash type, StringHash nameHash) const;
+    /// Store resource to the resource group and to the lookup index.
+    void StoreResource(StringHash type, StringHash nameHash, Resource* resource);
+    /// Remove resource from the lookup index. Should be called before the resource is removed from the resource group.
+    void RemoveFromLookup(StringHash type, StringHash nameHash);
+    /// Find a resource. Should be called from the main thread.
     const SharedPtr<Resource>& FindResource(StringHash type, StringHash nameHash);
     /// Find a resource by name only. Searches all type groups.
     const SharedPtr<Resource>& FindResource(StringHash nameHash);
@@ -237,12 +291,16 @@ private:
 
     /// Mutex for thread-safe access to the resource directories, resource packages and resource dependencies.
     mutable Mutex resourceMutex_;
-    /// Resources by type.
+    /// Resources by type. Modified only from the main thread.
     ea::unordered_map<StringHash, ResourceGroup> resourceGroups_;
+    /// Index of resources from all groups for lookup from any thread.
+    mutable LookupShard lookupShards_[NUM_LOOKUP_SHARDS];
     /// Dependent resources. Only used with automatic reload to eg. trigger reload of a cube texture when any of its faces change.
     ea::unordered_map<StringHash, ea::hash_set<StringHash> > dependentResources_;
     /// Resource background loader.
     SharedPtr<BackgroundLoader> backgroundLoader_;
+    /// Cache of cooked resources.
+    SharedPtr<CookedResourceCache> cookedResourceCache_;
     /// Resource routers.
     ea::vector<SharedPtr<ResourceRouter> > resourceRouters_;
     /// Return failed resources flag.
@@ -251,6 +309,8 @@ private:
     bool searchPackagesFirst_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// How many files may be read at the same time by background loading.
+    unsigned maxBackgroundReads_{2};
     /// List of resources that will not be auto-reloaded if reloading event triggers.
     ea::vector<ea::string> ignoreResourceAutoReload_;
 };
@@ -261,6 +321,19 @@ template <class T> T* ResourceCache::GetExistingResource(const ea::string& name)
     return static_cast<T*>(GetExistingResource(type, name));
 }
 
+template <class T> ResourceHandle ResourceCache::GetResourceHandle(const ea::string& name) const
+{
+    StringHash type = T::GetTypeStatic();
+    return GetResourceHandle(type, name);
+}
+
+template <class T> SharedPtr<T> ResourceCache::FindCachedResource(const ResourceHandle& handle) const
+{
+    if (handle.type_ != T::GetTypeStatic())
+        return nullptr;
+    return StaticCast<T>(FindCachedResource(handle));
+}
+
 template <class T> T* ResourceCache::GetResource(const ea::string& name, bool sendEventOnFailure)
 {
     StringHash type = T::GetTypeStatic();
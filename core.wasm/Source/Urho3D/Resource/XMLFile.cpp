@@ -85,11 +85,19 @@ bool XMLFile::BeginLoad(Deserializer& source)
         return false;
     }
 
-    ea::shared_array<char> buffer(new char[dataSize]);
-    if (source.Read(buffer.get(), dataSize) != dataSize)
+    // Read into the buffer owned by the document and parse in place.
+    // Strings of the document point into the buffer, so there is no extra copy of the data and no per-string allocations.
+    void* buffer = pugi::get_memory_allocation_function()(ea::max(dataSize, 1u));
+    if (!buffer)
         return false;
 
-    if (!document_->load_buffer(buffer.get(), dataSize))
+    if (source.Read(buffer, dataSize) != dataSize)
+    {
+        pugi::get_memory_deallocation_function()(buffer);
+        return false;
+    }
+
+    if (!document_->load_buffer_inplace_own(buffer, dataSize))
     {
         URHO3D_LOGERROR("Could not parse XML data from " + source.GetName());
         document_->reset();
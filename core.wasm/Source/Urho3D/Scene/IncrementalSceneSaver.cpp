@@ -0,0 +1,796 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/ArchiveSerialization.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Scene/Component.h>
+#include <Urho3D/Scene/IncrementalSceneSaver.h>
+#include <Urho3D/Scene/PrefabInstantiationPlan.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneResolver.h>
+
+#include <EASTL/sort.h>
+#include <EASTL/unordered_set.h>
+
+namespace Urho3D
+{
+
+const BinaryMagic SceneDeltaMagic{{'U', 'S', 'D', 'L'}};
+
+namespace
+{
+
+const PrefabArchiveFlags DeltaArchiveFlags = PrefabArchiveFlag::CompactTypeNames;
+const PrefabSaveFlags DeltaSaveFlags = PrefabSaveFlag::CompactAttributeNames;
+
+unsigned GetOwnerId(const SceneDelta::NodeRecord& record) { return record.parentId_; }
+unsigned GetOwnerId(const SceneDelta::ComponentRecord& record) { return record.nodeId_; }
+
+/// Replace existing records in place, so the order of siblings is preserved.
+/// Records moved to another owner are appended, same as they are appended to the new parent in the scene.
+template <class T> void MergeRecords(ea::vector<T>& records, const ea::vector<T>& newRecords,
+    const ea::vector<unsigned>& removedIds)
+{
+    ea::unordered_map<unsigned, unsigned> indices;
+    for (unsigned i = 0; i < records.size(); ++i)
+        indices.emplace(static_cast<unsigned>(records[i].prefab_.GetId()), i);
+
+    ea::unordered_set<unsigned> staleIndices;
+    for (unsigned removedId : removedIds)
+    {
+        const auto iter = indices.find(removedId);
+        if (iter != indices.end())
+        {
+            staleIndices.insert(iter->second);
+            indices.erase(iter);
+        }
+    }
+
+    for (const T& record : newRecords)
+    {
+        const auto [iter, inserted] = indices.emplace(static_cast<unsigned>(record.prefab_.GetId()), records.size());
+        if (!inserted && GetOwnerId(records[iter->second]) == GetOwnerId(record))
+        {
+            records[iter->second] = record;
+            continue;
+        }
+
+        if (!inserted)
+        {
+            staleIndices.insert(iter->second);
+            iter->second = records.size();
+        }
+        records.push_back(record);
+    }
+
+    if (!staleIndices.empty())
+    {
+        unsigned index = 0;
+        ea::erase_if(records, [&](const T&) { return staleIndices.contains(index++); });
+    }
+}
+
+void BuildPrefab(NodePrefab& prefab, unsigned nodeIndex, const ea::vector<SceneDelta::NodeRecord>& nodes,
+    const ea::vector<ea::vector<unsigned>>& childIndices,
+    const ea::unordered_map<unsigned, ea::vector<const SerializablePrefab*>>& componentsByNode)
+{
+    const SerializablePrefab& nodePrefab = nodes[nodeIndex].prefab_;
+    prefab.GetMutableNode() = nodePrefab;
+
+    const auto iter = componentsByNode.find(static_cast<unsigned>(nodePrefab.GetId()));
+    if (iter != componentsByNode.end())
+    {
+        auto& components = prefab.GetMutableComponents();
+        components.reserve(iter->second.size());
+        for (const SerializablePrefab* componentPrefab : iter->second)
+            components.push_back(*componentPrefab);
+    }
+
+    const ea::vector<unsigned>& children = childIndices[nodeIndex];
+    auto& childPrefabs = prefab.GetMutableChildren();
+    childPrefabs.resize(children.size());
+    for (unsigned i = 0; i < children.size(); ++i)
+        BuildPrefab(childPrefabs[i], children[i], nodes, childIndices, componentsByNode);
+}
+
+} // namespace
+
+void SceneDelta::SerializeInBlock(Archive& archive)
+{
+    SerializeValue(archive, "base", base_);
+    SerializeValue(archive, "sequence", sequence_);
+
+    SerializeVectorAsObjects(archive, "nodes", nodes_, "node",
+        [](Archive& archive, const char* name, NodeRecord& value)
+    {
+        ArchiveBlock block = archive.OpenUnorderedBlock(name);
+        SerializeValue(archive, "parent", value.parentId_);
+        SerializeValue(archive, "prefab", value.prefab_, ToNodeFlags(DeltaArchiveFlags));
+    });
+    SerializeVectorAsObjects(archive, "components", components_, "component",
+        [](Archive& archive, const char* name, ComponentRecord& value)
+    {
+        ArchiveBlock block = archive.OpenUnorderedBlock(name);
+        SerializeValue(archive, "node", value.nodeId_);
+        SerializeValue(archive, "prefab", value.prefab_, ToComponentFlags(DeltaArchiveFlags));
+    });
+
+    SerializeVectorAsPackedDeltas(archive, "removedNodes", removedNodes_, "id");
+    SerializeVectorAsPackedDeltas(archive, "removedComponents", removedComponents_, "id");
+    SerializeVectorAsBytes(archive, "auxiliary", auxiliaryData_);
+}
+
+void SceneDelta::Merge(const SceneDelta& delta)
+{
+    if (delta.base_)
+    {
+        *this = delta;
+        return;
+    }
+
+    if (delta.sequence_ != sequence_ + 1)
+        throw ArchiveException("Scene delta #{} cannot be applied after delta #{}", delta.sequence_, sequence_);
+
+    MergeRecords(nodes_, delta.nodes_, delta.removedNodes_);
+    MergeRecords(components_, delta.components_, delta.removedComponents_);
+    auxiliaryData_ = delta.auxiliaryData_;
+    sequence_ = delta.sequence_;
+}
+
+NodePrefab SceneDelta::ToPrefab() const
+{
+    if (!base_)
+        throw ArchiveException("Scene delta #{} is not merged with base", sequence_);
+
+    ea::unordered_map<unsigned, unsigned> nodeIndices;
+    for (unsigned i = 0; i < nodes_.size(); ++i)
+        nodeIndices.emplace(static_cast<unsigned>(nodes_[i].prefab_.GetId()), i);
+
+    unsigned rootIndex = M_MAX_UNSIGNED;
+    ea::vector<ea::vector<unsigned>> childIndices(nodes_.size());
+    for (unsigned i = 0; i < nodes_.size(); ++i)
+    {
+        const NodeRecord& record = nodes_[i];
+        if (record.parentId_ == 0)
+        {
+            if (rootIndex != M_MAX_UNSIGNED)
+                throw ArchiveException("Scene delta has more than one root node");
+            rootIndex = i;
+            continue;
+        }
+
+        const auto iter = nodeIndices.find(record.parentId_);
+        if (iter == nodeIndices.end())
+            throw ArchiveException("Parent node {} of node {} is missing in scene delta", record.parentId_,
+                static_cast<unsigned>(record.prefab_.GetId()));
+        childIndices[iter->second].push_back(i);
+    }
+
+    if (rootIndex == M_MAX_UNSIGNED)
+        throw ArchiveException("Scene delta has no root node");
+
+    ea::unordered_map<unsigned, ea::vector<const SerializablePrefab*>> componentsByNode;
+    for (const ComponentRecord& record : components_)
+    {
+        if (!nodeIndices.contains(record.nodeId_))
+            throw ArchiveException("Node {} of component {} is missing in scene delta", record.nodeId_,
+                static_cast<unsigned>(record.prefab_.GetId()));
+        componentsByNode[record.nodeId_].push_back(&record.prefab_);
+    }
+
+    NodePrefab prefab;
+    BuildPrefab(prefab, rootIndex, nodes_, childIndices, componentsByNode);
+    return prefab;
+}
+
+IncrementalSceneSaver::IncrementalSceneSaver(Scene* scene)
+    : scene_(scene)
+{
+}
+
+IncrementalSceneSaver::~IncrementalSceneSaver()
+{
+}
+
+SceneDelta IncrementalSceneSaver::CaptureBase()
+{
+    return Capture(true);
+}
+
+SceneDelta IncrementalSceneSaver::CaptureDelta()
+{
+    return Capture(!hasBase_);
+}
+
+bool IncrementalSceneSaver::ScanChanges(long long maxMicroseconds)
+{
+    if (!scene_ || !hasBase_)
+        return false;
+
+    URHO3D_PROFILE("ScanSceneChanges");
+
+    if (!scanInProgress_)
+        BeginScan();
+    return ContinueScan(ea::max(maxMicroseconds, 0ll));
+}
+
+bool IncrementalSceneSaver::SaveBase(Serializer& dest)
+{
+    HiresTimer timer;
+    SceneDelta delta = CaptureBase();
+    return Write(delta, dest, timer.GetUSec(false));
+}
+
+bool IncrementalSceneSaver::SaveDelta(Serializer& dest)
+{
+    HiresTimer timer;
+    SceneDelta delta = CaptureDelta();
+    return Write(delta, dest, timer.GetUSec(false));
+}
+
+void IncrementalSceneSaver::RevertCapture()
+{
+    if (!canRevert_)
+        return;
+
+    hasBase_ = previousHasBase_;
+    sequence_ = previousSequence_;
+
+    // Base capture starts from scratch, so the whole state is replaced
+    if (lastCaptureIsBase_)
+    {
+        nodeStates_ = ea::move(previousNodeStates_);
+        componentStates_ = ea::move(previousComponentStates_);
+    }
+
+    for (auto iter = stateChanges_.rbegin(); iter != stateChanges_.rend(); ++iter)
+    {
+        if (iter->previousState_)
+            (*iter->states_)[iter->id_] = *iter->previousState_;
+        else
+            iter->states_->erase(iter->id_);
+    }
+
+    canRevert_ = false;
+    previousNodeStates_.clear();
+    previousComponentStates_.clear();
+    stateChanges_.clear();
+
+    // Objects hashed after the capture were compared with the reverted state
+    CancelScan();
+}
+
+SceneDelta IncrementalSceneSaver::Capture(bool base)
+{
+    URHO3D_PROFILE("CaptureSceneDelta");
+
+    HiresTimer timer;
+
+    canRevert_ = false;
+
+    SceneDelta delta;
+    if (!scene_)
+    {
+        URHO3D_LOGERROR("Cannot capture scene delta: scene is expired");
+        return delta;
+    }
+
+    canRevert_ = true;
+    lastCaptureIsBase_ = base;
+    previousHasBase_ = hasBase_;
+    previousSequence_ = sequence_;
+    previousNodeStates_.clear();
+    previousComponentStates_.clear();
+    stateChanges_.clear();
+
+    delta.base_ = base;
+    if (base)
+    {
+        hasBase_ = true;
+        sequence_ = 0;
+        previousNodeStates_ = ea::move(nodeStates_);
+        previousComponentStates_ = ea::move(componentStates_);
+        nodeStates_.clear();
+        componentStates_.clear();
+
+        CancelScan();
+        ++captureIndex_;
+        CaptureNode(delta, scene_, 0, true);
+    }
+    else
+    {
+        ++sequence_;
+
+        // Hash the part of the scene not scanned yet
+        if (!scanInProgress_)
+            BeginScan();
+        ContinueScan(-1);
+        CaptureChangedObjects(delta);
+        CaptureStructureChanges(delta);
+        CancelScan();
+    }
+
+    delta.sequence_ = sequence_;
+    CollectRemoved(nodeStates_, delta.removedNodes_);
+    CollectRemoved(componentStates_, delta.removedComponents_);
+
+    // Keep in sync with Scene::SerializeInBlock
+    try
+    {
+        VectorBuffer auxiliaryData;
+        {
+            BinaryOutputArchive archive{scene_->GetContext(), auxiliaryData};
+            ArchiveBlock block = archive.OpenUnorderedBlock("auxiliary");
+            scene_->SerializeAuxiliaryData(archive);
+        }
+        delta.auxiliaryData_ = auxiliaryData.GetBuffer();
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR("Cannot save auxiliary data of the scene: {}", e.what());
+    }
+
+    lastNumChanges_ = delta.GetNumChanges();
+    lastCaptureTime_ = timer.GetUSec(false);
+    return delta;
+}
+
+void IncrementalSceneSaver::CaptureNode(SceneDelta& delta, Node* node, unsigned parentId, bool base)
+{
+    const unsigned nodeId = node->GetID();
+    CaptureNodeState(delta, node, parentId, base);
+
+    for (Component* component : node->GetComponents())
+    {
+        if (!component->IsTemporary())
+            CaptureComponentState(delta, component, nodeId, base);
+    }
+
+    for (Node* child : node->GetChildren())
+    {
+        if (!child->IsTemporary())
+            CaptureNode(delta, child, nodeId, base);
+    }
+}
+
+void IncrementalSceneSaver::CaptureChangedObjects(SceneDelta& delta)
+{
+    // Objects removed after they were scanned are collected by CaptureStructureChanges
+    for (const unsigned nodeId : changedNodes_)
+    {
+        Node* node = FindNode(nodeId);
+        if (!node || !IsSaved(node))
+            continue;
+
+        const Node* parent = node->GetParent();
+        CaptureNodeState(delta, node, parent ? parent->GetID() : 0, false);
+    }
+
+    for (const unsigned componentId : changedComponents_)
+    {
+        Component* component = scene_->GetComponent(componentId);
+        Node* node = component ? component->GetNode() : nullptr;
+        if (!node || component->IsTemporary() || !IsSaved(node))
+            continue;
+
+        CaptureComponentState(delta, component, node->GetID(), false);
+    }
+}
+
+void IncrementalSceneSaver::CaptureStructureChanges(SceneDelta& delta)
+{
+    // Only lookups here, attributes are hashed by the pass
+    ea::vector<unsigned> movedNodes;
+    for (auto& [nodeId, state] : nodeStates_)
+    {
+        Node* node = FindNode(nodeId);
+        if (!node || !IsSaved(node))
+        {
+            state.captureIndex_ = 0;
+            continue;
+        }
+
+        const Node* parent = node->GetParent();
+        if (state.captureIndex_ != captureIndex_ || state.ownerId_ != (parent ? parent->GetID() : 0))
+            movedNodes.push_back(nodeId);
+    }
+
+    for (auto& [componentId, state] : componentStates_)
+    {
+        Component* component = scene_->GetComponent(componentId);
+        Node* node = component ? component->GetNode() : nullptr;
+        if (!node || component->IsTemporary() || !IsSaved(node))
+            state.captureIndex_ = 0;
+    }
+
+    // Moved nodes are captured together with their children, which may be not visited by the pass
+    for (const unsigned nodeId : movedNodes)
+    {
+        Node* node = FindNode(nodeId);
+        const Node* parent = node->GetParent();
+        const unsigned parentId = parent ? parent->GetID() : 0;
+
+        const ObjectState& state = nodeStates_[nodeId];
+        if (state.captureIndex_ != captureIndex_ || state.ownerId_ != parentId)
+            CaptureNode(delta, node, parentId, false);
+    }
+}
+
+void IncrementalSceneSaver::CaptureNodeState(SceneDelta& delta, Node* node, unsigned parentId, bool base)
+{
+    const unsigned nodeId = node->GetID();
+    if (UpdateState(nodeStates_, nodeId, parentId, HashNode(node, parentId), base))
+    {
+        SceneDelta::NodeRecord& record = delta.nodes_.emplace_back();
+        record.parentId_ = parentId;
+        record.prefab_.SetId(static_cast<SerializableId>(nodeId));
+        record.prefab_.Import(node, DeltaSaveFlags);
+        record.prefab_.SetType(StringHash::Empty);
+    }
+}
+
+void IncrementalSceneSaver::CaptureComponentState(SceneDelta& delta, Component* component, unsigned nodeId, bool base)
+{
+    const unsigned componentId = component->GetID();
+    if (UpdateState(componentStates_, componentId, nodeId, HashComponent(component, nodeId), base))
+    {
+        SceneDelta::ComponentRecord& record = delta.components_.emplace_back();
+        record.nodeId_ = nodeId;
+        record.prefab_.SetId(static_cast<SerializableId>(componentId));
+        record.prefab_.Import(component, DeltaSaveFlags);
+    }
+}
+
+void IncrementalSceneSaver::BeginScan()
+{
+    CancelScan();
+    ++captureIndex_;
+    scanInProgress_ = true;
+    scanQueue_.push_back(ScanEntry{scene_->GetID(), 0});
+}
+
+bool IncrementalSceneSaver::ContinueScan(long long maxMicroseconds)
+{
+    HiresTimer timer;
+    while (!scanQueue_.empty())
+    {
+        const ScanEntry entry = scanQueue_.back();
+        scanQueue_.pop_back();
+        ScanNode(entry);
+
+        if (maxMicroseconds >= 0 && timer.GetUSec(false) >= maxMicroseconds)
+            break;
+    }
+    return scanQueue_.empty();
+}
+
+void IncrementalSceneSaver::ScanNode(const ScanEntry& entry)
+{
+    // Nodes removed or moved after they were queued are not visited, CaptureStructureChanges handles them
+    Node* node = entry.parentId_ == 0 ? scene_.Get() : scene_->GetNode(entry.nodeId_);
+    const Node* parent = node ? node->GetParent() : nullptr;
+    if (!node || node->IsTemporary() || (parent ? parent->GetID() : 0) != entry.parentId_)
+        return;
+
+    const unsigned nodeId = node->GetID();
+    if (MarkScanned(nodeStates_, nodeId, HashNode(node, entry.parentId_)))
+        changedNodes_.push_back(nodeId);
+
+    for (Component* component : node->GetComponents())
+    {
+        if (component->IsTemporary())
+            continue;
+
+        const unsigned componentId = component->GetID();
+        if (MarkScanned(componentStates_, componentId, HashComponent(component, nodeId)))
+            changedComponents_.push_back(componentId);
+    }
+
+    // Children are visited in order, so new siblings are saved in order too
+    const auto& children = node->GetChildren();
+    for (auto iter = children.rbegin(); iter != children.rend(); ++iter)
+    {
+        if (!(*iter)->IsTemporary())
+            scanQueue_.push_back(ScanEntry{(*iter)->GetID(), nodeId});
+    }
+}
+
+void IncrementalSceneSaver::CancelScan()
+{
+    scanInProgress_ = false;
+    scanQueue_.clear();
+    changedNodes_.clear();
+    changedComponents_.clear();
+}
+
+bool IncrementalSceneSaver::MarkScanned(ObjectStateMap& states, unsigned id, unsigned long long hash) const
+{
+    const auto iter = states.find(id);
+    if (iter == states.end())
+        return true;
+
+    iter->second.captureIndex_ = captureIndex_;
+    return iter->second.hash_ != hash;
+}
+
+bool IncrementalSceneSaver::IsSaved(const Node* node)
+{
+    for (; node; node = node->GetParent())
+    {
+        if (node->IsTemporary())
+            return false;
+    }
+    return true;
+}
+
+Node* IncrementalSceneSaver::FindNode(unsigned id) const
+{
+    return id == scene_->GetID() ? scene_.Get() : scene_->GetNode(id);
+}
+
+bool IncrementalSceneSaver::UpdateState(
+    ObjectStateMap& states, unsigned id, unsigned ownerId, unsigned long long hash, bool base)
+{
+    const auto [iter, inserted] = states.emplace(id, ObjectState{hash, ownerId, captureIndex_});
+    if (inserted)
+    {
+        // Base replaces the whole state, no need to track individual changes
+        if (!base)
+            stateChanges_.push_back(StateChange{&states, id, ea::nullopt});
+        return true;
+    }
+
+    // Capture index is not reverted: objects not visited by the next capture are removed regardless of it
+    ObjectState& state = iter->second;
+    state.captureIndex_ = captureIndex_;
+    if (!base && state.hash_ == hash)
+        return false;
+
+    if (!base)
+        stateChanges_.push_back(StateChange{&states, id, state});
+    state.hash_ = hash;
+    state.ownerId_ = ownerId;
+    return true;
+}
+
+void IncrementalSceneSaver::CollectRemoved(ObjectStateMap& states, ea::vector<unsigned>& removed)
+{
+    for (auto iter = states.begin(); iter != states.end();)
+    {
+        if (iter->second.captureIndex_ != captureIndex_)
+        {
+            stateChanges_.push_back(StateChange{&states, iter->first, iter->second});
+            removed.push_back(iter->first);
+            iter = states.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    // Sorted IDs are packed better
+    ea::sort(removed.begin(), removed.end());
+}
+
+bool IncrementalSceneSaver::Write(SceneDelta& delta, Serializer& dest, long long captureTime)
+{
+    if (!scene_)
+        return false;
+
+    HiresTimer timer;
+    VectorBuffer buffer;
+    bool success = WriteDelta(scene_->GetContext(), delta, buffer);
+    if (success)
+    {
+        lastSaveSize_ = buffer.GetSize();
+        if (dest.Write(buffer.GetData(), buffer.GetSize()) != buffer.GetSize())
+        {
+            URHO3D_LOGERROR("Cannot write scene delta #{}", delta.GetSequence());
+            success = false;
+        }
+    }
+
+    // Objects of the delta that was not written should be saved again
+    if (!success)
+        RevertCapture();
+
+    lastSaveTime_ = captureTime + timer.GetUSec(false);
+    return success;
+}
+
+unsigned long long IncrementalSceneSaver::HashNode(const Node* node, unsigned parentId)
+{
+    unsigned long long hash = HashAttributes(node);
+    CombineHash(hash, static_cast<unsigned long long>(parentId));
+    return hash;
+}
+
+unsigned long long IncrementalSceneSaver::HashComponent(const Component* component, unsigned nodeId)
+{
+    unsigned long long hash = HashAttributes(component);
+    CombineHash(hash, static_cast<unsigned long long>(nodeId));
+    CombineHash(hash, static_cast<unsigned long long>(component->GetType().Value()));
+    return hash;
+}
+
+unsigned long long IncrementalSceneSaver::HashAttributes(const Serializable* serializable)
+{
+    unsigned long long hash = 0;
+
+    const ObjectReflection* reflection = serializable->GetReflection();
+    if (!reflection)
+        return hash;
+
+    for (const AttributeInfo& attr : reflection->GetAttributes())
+    {
+        if (!attr.ShouldSave())
+            continue;
+
+        unsigned valueHash = 0;
+        const bool typed = attr.accessor_ && attr.accessor_->GetTypedAccessType() == attr.type_;
+        const bool visited = typed && VisitTypedAttributeType(attr.type_, [&](auto tag)
+        {
+            using ValueType = typename decltype(tag)::type;
+            ValueType value{};
+            serializable->OnGetAttributeTyped(attr, &value);
+            if constexpr (ea::is_same_v<ValueType, ea::string> || ea::is_same_v<ValueType, ResourceRef>)
+                valueHash = MakeHash(value);
+            else
+                valueHash = StringHash::Calculate(&value, sizeof(value));
+        });
+
+        if (!visited)
+        {
+            Variant value;
+            serializable->OnGetAttribute(attr, value);
+            valueHash = value.ToHash();
+        }
+
+        CombineHash(hash, static_cast<unsigned long long>(valueHash));
+    }
+    return hash;
+}
+
+bool IncrementalSceneSaver::WriteDelta(Context* context, SceneDelta& delta, Serializer& dest)
+{
+    URHO3D_PROFILE("WriteSceneDelta");
+
+    try
+    {
+        if (dest.Write(SceneDeltaMagic.data(), BinaryMagicSize) != BinaryMagicSize)
+            throw ArchiveException("Failed to write scene delta magic");
+
+        BinaryOutputArchive archive{context, dest};
+        SerializeValue(archive, "delta", delta);
+        return true;
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR("Cannot write scene delta: {}", e.what());
+        return false;
+    }
+}
+
+bool IncrementalSceneSaver::ReadDelta(Context* context, Deserializer& source, SceneDelta& delta)
+{
+    URHO3D_PROFILE("ReadSceneDelta");
+
+    try
+    {
+        BinaryMagic magic{};
+        if (source.Read(magic.data(), BinaryMagicSize) != BinaryMagicSize || magic != SceneDeltaMagic)
+            throw ArchiveException("'{}' is not a scene delta", source.GetName());
+
+        BinaryInputArchive archive{context, source};
+        SerializeValue(archive, "delta", delta);
+        return true;
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR("Cannot read scene delta: {}", e.what());
+        return false;
+    }
+}
+
+SceneDelta IncrementalSceneSaver::MergeChain(Context* context, ea::span<Deserializer* const> chain)
+{
+    URHO3D_PROFILE("MergeSceneDeltas");
+
+    SceneDelta result;
+    for (unsigned i = 0; i < chain.size(); ++i)
+    {
+        SceneDelta delta;
+        if (!ReadDelta(context, *chain[i], delta))
+            throw ArchiveException("Cannot read scene delta #{} of the chain", i);
+        if (i == 0 && !delta.IsBase())
+            throw ArchiveException("Chain of scene deltas should start with base");
+        result.Merge(delta);
+    }
+    return result;
+}
+
+bool IncrementalSceneSaver::CompactChain(Context* context, ea::span<Deserializer* const> chain, Serializer& dest)
+{
+    URHO3D_PROFILE("CompactSceneDeltas");
+
+    try
+    {
+        SceneDelta base = MergeChain(context, chain);
+        return WriteDelta(context, base, dest);
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR("Cannot compact scene deltas: {}", e.what());
+        return false;
+    }
+}
+
+bool IncrementalSceneSaver::LoadChain(Scene* scene, ea::span<Deserializer* const> chain)
+{
+    try
+    {
+        const SceneDelta base = MergeChain(scene->GetContext(), chain);
+        Load(scene, base);
+        return true;
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR("Cannot load scene from deltas: {}", e.what());
+        return false;
+    }
+}
+
+void IncrementalSceneSaver::Load(Scene* scene, const SceneDelta& base)
+{
+    URHO3D_PROFILE("LoadSceneDelta");
+
+    Context* context = scene->GetContext();
+    const NodePrefab prefab = base.ToPrefab();
+
+    // Keep in sync with Node::Load
+    SceneResolver resolver;
+    const PrefabInstantiationPlan plan{context, prefab};
+    plan.Instantiate(scene, resolver);
+    resolver.Resolve();
+
+    // Keep in sync with Scene::SerializeInBlock
+    const ByteVector& auxiliaryData = base.GetAuxiliaryData();
+    if (!auxiliaryData.empty())
+    {
+        MemoryBuffer buffer{auxiliaryData.data(), static_cast<unsigned>(auxiliaryData.size())};
+        BinaryInputArchive archive{context, buffer};
+        ArchiveBlock block = archive.OpenUnorderedBlock("auxiliary");
+        scene->SerializeAuxiliaryData(archive);
+    }
+
+    scene->ApplyAttributes();
+}
+
+} // namespace Urho3D
@@ -0,0 +1,274 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Container/ByteVector.h>
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Core/NonCopyable.h>
+#include <Urho3D/Resource/Resource.h>
+#include <Urho3D/Scene/NodePrefab.h>
+
+#include <EASTL/optional.h>
+#include <EASTL/span.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Archive;
+class Component;
+class Context;
+class Deserializer;
+class Node;
+class Scene;
+class Serializable;
+class Serializer;
+
+/// Magic of the scene delta file.
+URHO3D_API extern const BinaryMagic SceneDeltaMagic;
+
+/// Nodes and components of the scene changed since the previous save.
+/// Base delta contains the whole scene, other deltas are applied on top of it in sequence.
+/// Delta is plain data and may be serialized and merged on any thread.
+class URHO3D_API SceneDelta
+{
+public:
+    /// Saved node.
+    struct NodeRecord
+    {
+        /// ID of the parent node. Scene node has no parent.
+        unsigned parentId_{};
+        /// Node attributes and ID.
+        SerializablePrefab prefab_;
+    };
+
+    /// Saved component.
+    struct ComponentRecord
+    {
+        /// ID of the owner node.
+        unsigned nodeId_{};
+        /// Component type, attributes and ID.
+        SerializablePrefab prefab_;
+    };
+
+    /// Serialize content from/to archive. May throw ArchiveException.
+    void SerializeInBlock(Archive& archive);
+    /// Apply newer delta on top of this one. Newer delta should be next in sequence or base. May throw ArchiveException.
+    void Merge(const SceneDelta& delta);
+    /// Convert base delta into scene prefab. May throw ArchiveException.
+    NodePrefab ToPrefab() const;
+
+    /// Return whether the delta contains the whole scene.
+    bool IsBase() const { return base_; }
+    /// Return sequence number of the delta. Compacted base keeps the sequence number of the last merged delta.
+    unsigned GetSequence() const { return sequence_; }
+    /// Return saved nodes.
+    const ea::vector<NodeRecord>& GetNodes() const { return nodes_; }
+    /// Return saved components.
+    const ea::vector<ComponentRecord>& GetComponents() const { return components_; }
+    /// Return IDs of removed nodes.
+    const ea::vector<unsigned>& GetRemovedNodes() const { return removedNodes_; }
+    /// Return IDs of removed components.
+    const ea::vector<unsigned>& GetRemovedComponents() const { return removedComponents_; }
+    /// Return serialized auxiliary data of the scene.
+    const ByteVector& GetAuxiliaryData() const { return auxiliaryData_; }
+    /// Return total number of changed objects.
+    unsigned GetNumChanges() const
+    {
+        return nodes_.size() + components_.size() + removedNodes_.size() + removedComponents_.size();
+    }
+
+private:
+    friend class IncrementalSceneSaver;
+
+    bool base_{};
+    unsigned sequence_{};
+    ea::vector<NodeRecord> nodes_;
+    ea::vector<ComponentRecord> components_;
+    ea::vector<unsigned> removedNodes_;
+    ea::vector<unsigned> removedComponents_;
+    ByteVector auxiliaryData_;
+};
+
+/// Saves scene as base save followed by chain of deltas that contain only nodes and components changed since the previous save.
+/// Changes are detected by comparing hashes of attribute values with hashes taken at the previous save.
+/// Change detection reads every saved attribute of every object on the main thread, so it is O(scene).
+/// Call ScanChanges every frame to spread it over frames within a time budget: CaptureDelta then hashes
+/// only the part of the scene not scanned yet plus the changed objects. Otherwise CaptureDelta hashes the whole scene.
+/// Main thread is needed only to scan and capture the delta, writing and compaction of the chain may be done on any thread.
+/// Temporary nodes and components are not saved.
+/// Order of siblings created or reparented after the base save is the order in which they were first saved.
+class URHO3D_API IncrementalSceneSaver : public NonCopyable
+{
+public:
+    /// Construct.
+    explicit IncrementalSceneSaver(Scene* scene);
+    ~IncrementalSceneSaver();
+
+    /// Capture the whole scene and reset the chain.
+    SceneDelta CaptureBase();
+    /// Capture objects changed since the previous capture. Captures base if there was none.
+    SceneDelta CaptureDelta();
+    /// Hash part of the scene for the next delta within the time budget. Scans at least one node per call.
+    /// Attributes changed after they were hashed by the current pass are captured by the delta after the next one.
+    /// Removed and moved objects are always captured by the next delta.
+    /// Does nothing before the base is captured. Return whether the pass is complete and waits for CaptureDelta.
+    bool ScanChanges(long long maxMicroseconds);
+    /// Capture and write base. Return true on success. Capture is reverted on failure.
+    bool SaveBase(Serializer& dest);
+    /// Capture and write delta. Return true on success. Capture is reverted on failure.
+    bool SaveDelta(Serializer& dest);
+    /// Revert saved state to the one before the last capture, e.g. if the captured delta was not written.
+    /// Changes of the last capture will be captured again by the next delta. Does nothing if already reverted.
+    void RevertCapture();
+
+    /// Write delta. Thread-safe. Return true on success.
+    static bool WriteDelta(Context* context, SceneDelta& delta, Serializer& dest);
+    /// Read delta. Thread-safe. Return true on success.
+    static bool ReadDelta(Context* context, Deserializer& source, SceneDelta& delta);
+    /// Merge chain of deltas starting from the base. Thread-safe. May throw ArchiveException.
+    static SceneDelta MergeChain(Context* context, ea::span<Deserializer* const> chain);
+    /// Merge chain of deltas into single base and write it. Deltas saved later may be applied on top of it.
+    /// Thread-safe. Return true on success.
+    static bool CompactChain(Context* context, ea::span<Deserializer* const> chain, Serializer& dest);
+    /// Load scene from chain of deltas starting from the base. Existing nodes and components are removed.
+    /// Return true on success.
+    static bool LoadChain(Scene* scene, ea::span<Deserializer* const> chain);
+    /// Load scene from merged base delta. May throw ArchiveException.
+    static void Load(Scene* scene, const SceneDelta& base);
+
+    /// Return scene.
+    Scene* GetScene() const { return scene_; }
+    /// Return number of deltas saved after the base.
+    unsigned GetChainLength() const { return sequence_; }
+    /// Return main thread time of the last capture in microseconds, including the rest of the change detection pass.
+    long long GetLastCaptureTime() const { return lastCaptureTime_; }
+    /// Return total time of the last save in microseconds.
+    long long GetLastSaveTime() const { return lastSaveTime_; }
+    /// Return number of bytes written by the last save.
+    unsigned GetLastSaveSize() const { return lastSaveSize_; }
+    /// Return number of changed objects in the last capture.
+    unsigned GetLastNumChanges() const { return lastNumChanges_; }
+
+private:
+    /// Saved state of the object.
+    struct ObjectState
+    {
+        unsigned long long hash_{};
+        /// Parent node ID for nodes, node ID for components.
+        unsigned ownerId_{};
+        unsigned captureIndex_{};
+    };
+    using ObjectStateMap = ea::unordered_map<unsigned, ObjectState>;
+    /// Change of the saved state made by the last capture.
+    struct StateChange
+    {
+        ObjectStateMap* states_{};
+        unsigned id_{};
+        /// State before the capture. None if the state was added by the capture.
+        ea::optional<ObjectState> previousState_;
+    };
+
+    /// Node waiting to be scanned by the current pass.
+    struct ScanEntry
+    {
+        unsigned nodeId_{};
+        unsigned parentId_{};
+    };
+
+    /// Capture changes of the scene, or the whole scene if base.
+    SceneDelta Capture(bool base);
+    /// Capture node and its components and children recursively.
+    void CaptureNode(SceneDelta& delta, Node* node, unsigned parentId, bool base);
+    /// Capture objects found changed by the change detection pass.
+    void CaptureChangedObjects(SceneDelta& delta);
+    /// Mark removed objects as not visited and capture moved nodes and nodes not visited by the pass.
+    void CaptureStructureChanges(SceneDelta& delta);
+    /// Capture node attributes if they were changed.
+    void CaptureNodeState(SceneDelta& delta, Node* node, unsigned parentId, bool base);
+    /// Capture component if it was changed.
+    void CaptureComponentState(SceneDelta& delta, Component* component, unsigned nodeId, bool base);
+
+    /// Start new change detection pass.
+    void BeginScan();
+    /// Continue change detection pass within the time budget. Negative budget is unlimited. Return whether it is complete.
+    bool ContinueScan(long long maxMicroseconds);
+    /// Hash node and its components, queue children.
+    void ScanNode(const ScanEntry& entry);
+    /// Cancel change detection pass in progress.
+    void CancelScan();
+    /// Mark object as visited by the pass. Return whether the hash differs from the saved one.
+    bool MarkScanned(ObjectStateMap& states, unsigned id, unsigned long long hash) const;
+    /// Return node by ID, including the scene itself.
+    Node* FindNode(unsigned id) const;
+    /// Return whether the node and all its parents are not temporary.
+    static bool IsSaved(const Node* node);
+    /// Update saved state of the object. Return whether the object should be saved.
+    bool UpdateState(ObjectStateMap& states, unsigned id, unsigned ownerId, unsigned long long hash, bool base);
+    /// Remove states of objects not found during capture and return their IDs.
+    void CollectRemoved(ObjectStateMap& states, ea::vector<unsigned>& removed);
+    /// Write delta and update statistics.
+    bool Write(SceneDelta& delta, Serializer& dest, long long captureTime);
+
+    /// Return hash of the persistent attributes of the object.
+    static unsigned long long HashAttributes(const Serializable* serializable);
+    /// Return hash of the node state.
+    static unsigned long long HashNode(const Node* node, unsigned parentId);
+    /// Return hash of the component state.
+    static unsigned long long HashComponent(const Component* component, unsigned nodeId);
+
+    WeakPtr<Scene> scene_;
+    bool hasBase_{};
+    unsigned sequence_{};
+    unsigned captureIndex_{};
+    ObjectStateMap nodeStates_;
+    ObjectStateMap componentStates_;
+
+    /// Change detection pass.
+    /// @{
+    bool scanInProgress_{};
+    ea::vector<ScanEntry> scanQueue_;
+    ea::vector<unsigned> changedNodes_;
+    ea::vector<unsigned> changedComponents_;
+    /// @}
+
+    /// State before the last capture.
+    /// @{
+    bool canRevert_{};
+    bool lastCaptureIsBase_{};
+    bool previousHasBase_{};
+    unsigned previousSequence_{};
+    ObjectStateMap previousNodeStates_;
+    ObjectStateMap previousComponentStates_;
+    ea::vector<StateChange> stateChanges_;
+    /// @}
+
+    long long lastCaptureTime_{};
+    long long lastSaveTime_{};
+    unsigned lastSaveSize_{};
+    unsigned lastNumChanges_{};
+};
+
+} // namespace Urho3D
@@ -33,6 +33,9 @@
 namespace Urho3D
 {
 
+// Logic components are usually subclassed, so pool serves derived classes of various sizes
+URHO3D_DEFINE_POOLED_ALLOCATION(LogicComponent, 1024, 64)
+
 LogicComponent::LogicComponent(Context* context) :
     Component(context),
     updateEventMask_(USE_UPDATE | USE_POSTUPDATE | USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE),
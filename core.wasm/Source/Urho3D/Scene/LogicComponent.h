@@ -25,6 +25,7 @@
 #pragma once
 
 #include "../Container/FlagSet.h"
+#include "../Container/PoolAllocator.h"
 #include "../Scene/Component.h"
 
 namespace Urho3D
@@ -49,6 +50,7 @@ URHO3D_FLAGSET(UpdateEvent, UpdateEventFlags);
 class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
+    URHO3D_POOLED_ALLOCATION();
 
     /// Construct.
     explicit LogicComponent(Context* context);
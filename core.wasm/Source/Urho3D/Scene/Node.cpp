@@ -32,6 +32,7 @@
 #include "Urho3D/Resource/ResourceCache.h"
 #include "Urho3D/Resource/XMLFile.h"
 #include "Urho3D/Scene/Component.h"
+#include "Urho3D/Scene/PrefabInstantiationPlan.h"
 #include "Urho3D/Scene/PrefabReader.h"
 #include "Urho3D/Scene/PrefabResource.h"
 #include "Urho3D/Scene/PrefabWriter.h"
@@ -48,6 +49,8 @@
 namespace Urho3D
 {
 
+URHO3D_DEFINE_POOLED_ALLOCATION(Node, sizeof(Node), 64)
+
 Node::Node(Context* context) :
     Serializable(context),
     worldTransform_(Matrix3x4::IDENTITY),
@@ -254,7 +257,55 @@ Node* Node::InstantiatePrefab(const PrefabResource* prefabResource, const Vector
 {
     if (!prefabResource)
         return nullptr;
-    return InstantiatePrefab(prefabResource->GetNodePrefab(), position, rotation);
+
+    const PrefabInstantiationPlan& plan = prefabResource->GetInstantiationPlan();
+    if (plan.IsEmpty())
+        return nullptr;
+
+    Node* childNode = CreateChild();
+    try
+    {
+        plan.Instantiate(childNode);
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR(e.what());
+        childNode->Remove();
+        return nullptr;
+    }
+
+    childNode->SetPosition(position);
+    childNode->SetRotation(rotation);
+    return childNode;
+}
+
+ea::vector<Node*> Node::InstantiatePrefabs(const PrefabResource* prefabResource, ea::span<const Transform> transforms)
+{
+    ea::vector<Node*> instances;
+    if (!prefabResource || transforms.empty())
+        return instances;
+
+    URHO3D_PROFILE("InstantiatePrefabs");
+
+    const PrefabInstantiationPlan& plan = prefabResource->GetInstantiationPlan();
+    if (plan.IsEmpty())
+        return instances;
+
+    const unsigned numInstances = transforms.size();
+
+    instances.reserve(numInstances);
+    children_.reserve(children_.size() + numInstances);
+    if (scene_)
+        scene_->ReserveObjects(numInstances * plan.GetNumNodes(), numInstances * plan.GetNumComponents());
+
+    for (const Transform& transform : transforms)
+    {
+        Node* instance = CreateChild();
+        plan.Instantiate(instance);
+        instance->SetTransform(transform);
+        instances.push_back(instance);
+    }
+    return instances;
 }
 
 Node* Node::InstantiatePrefab(const NodePrefab& prefab, const Vector3& position, const Quaternion& rotation)
@@ -1080,6 +1131,22 @@ void Node::RemoveChildren(bool recursive)
     }
 }
 
+void Node::DestroyAllChildren()
+{
+    URHO3D_PROFILE("DestroyAllChildren");
+
+    // Send change events for direct children only. Do not send when this node is already being destroyed
+    if (Refs() > 0 && scene_)
+    {
+        for (unsigned i = children_.size() - 1; i < children_.size(); --i)
+            SendNodeRemovedEvent(children_[i]);
+    }
+
+    ea::vector<SharedPtr<Node>> nodes = ea::move(children_);
+    children_.clear();
+    DestroyNodes(nodes);
+}
+
 Component* Node::CreateComponent(StringHash type, unsigned id)
 {
     // Check that creation succeeds and that the object in fact is a component
@@ -1129,11 +1196,9 @@ Component* Node::CloneComponent(Component* component, unsigned id)
             const AttributeInfo& cloneAttr = cloneAttributes->at(i);
             if (attr.mode_ & AM_FILE)
             {
-                Variant value;
-                component->OnGetAttribute(attr, value);
                 // Note: when eg. a ScriptInstance component is cloned, its script object attributes are unique and therefore we
                 // can not simply refer to the source component's AttributeInfo
-                cloneComponent->OnSetAttribute(cloneAttr, value);
+                cloneComponent->CopyAttribute(cloneAttr, component, attr);
             }
         }
         cloneComponent->ApplyAttributes();
@@ -1253,6 +1318,23 @@ void Node::Remove()
         parent_->RemoveChild(this);
 }
 
+void Node::Destroy()
+{
+    URHO3D_PROFILE("DestroyNode");
+
+    // Prevent destruction until the subtree is detached
+    ea::vector<SharedPtr<Node>> nodes{SharedPtr<Node>(this)};
+    if (parent_)
+    {
+        // Send change event. Do not send when the parent is already being destroyed
+        if (parent_->Refs() > 0 && parent_->scene_)
+            parent_->SendNodeRemovedEvent(this);
+        parent_->children_.erase_first(nodes.front());
+    }
+
+    DestroyNodes(nodes);
+}
+
 void Node::SetParent(Node* parent)
 {
     if (parent)
@@ -2156,6 +2238,38 @@ void Node::RemoveChild(ea::vector<SharedPtr<Node> >::iterator i)
     children_.erase(i);
 }
 
+void Node::SendNodeRemovedEvent(Node* child)
+{
+    using namespace NodeRemoved;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_SCENE] = scene_;
+    eventData[P_PARENT] = this;
+    eventData[P_NODE] = child;
+
+    scene_->SendEvent(E_NODEREMOVED, eventData);
+}
+
+void Node::DestroyNodes(ea::vector<SharedPtr<Node>>& nodes)
+{
+    // Collect the subtrees breadth-first, so parents are detached before children and nothing is released early
+    for (unsigned i = 0; i < nodes.size(); ++i)
+    {
+        const ea::vector<SharedPtr<Node>>& children = nodes[i]->children_;
+        nodes.insert(nodes.end(), children.begin(), children.end());
+    }
+
+    // Detached nodes are not marked dirty recursively, their world transforms are recalculated on demand
+    for (const SharedPtr<Node>& node : nodes)
+    {
+        if (node->scene_)
+            node->scene_->NodeRemoved(node, false);
+        node->parent_ = nullptr;
+        node->dirty_ = true;
+        node->children_.clear();
+    }
+}
+
 void Node::GetChildrenRecursive(ea::vector<Node*>& dest) const
 {
     for (auto i = children_.begin(); i != children_.end(); ++i)
@@ -2226,11 +2340,7 @@ Node* Node::CloneRecursive(Node* parent, SceneResolver& resolver)
         const AttributeInfo& attr = attributes->at(j);
         // Do not copy network-only attributes, as they may have unintended side effects
         if (attr.mode_ & AM_FILE)
-        {
-            Variant value;
-            OnGetAttribute(attr, value);
-            cloneNode->OnSetAttribute(attr, value);
-        }
+            cloneNode->CopyAttribute(attr, this, attr);
     }
 
     // Clone components
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "../Container/PoolAllocator.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/Matrix3x4.h"
 #include "../Math/Transform.h"
@@ -31,6 +32,7 @@
 #include "../Scene/PrefabTypes.h"
 #include "../Scene/Serializable.h"
 
+#include <EASTL/span.h>
 #include <EASTL/type_traits.h>
 
 #include <atomic>
@@ -89,8 +91,10 @@ struct URHO3D_API NodeImpl
 class URHO3D_API Node : public Serializable
 {
     URHO3D_OBJECT(Node, Serializable);
+    URHO3D_POOLED_ALLOCATION();
 
     friend class Connection;
+    friend class PrefabInstantiationPlan;
 
 public:
     /// Construct.
@@ -125,6 +129,11 @@ public:
     Node* InstantiatePrefab(const PrefabResource* prefabResource, const Vector3& position = Vector3::ZERO,
         const Quaternion& rotation = Quaternion::IDENTITY);
 
+    /// Instantiate prefab once per transform as child nodes. Return created nodes.
+    /// Transforms replace position, rotation and scale of the root node of the prefab.
+    /// Storage for all instances is reserved at once, prefab is instantiated via compiled instantiation plan.
+    ea::vector<Node*> InstantiatePrefabs(const PrefabResource* prefabResource, ea::span<const Transform> transforms);
+
     /// Instantiate scene content from prefab. Return root node if successful.
     Node* InstantiatePrefab(const NodePrefab& prefab, const Vector3& position = Vector3::ZERO,
         const Quaternion& rotation = Quaternion::IDENTITY);
@@ -365,6 +374,11 @@ public:
     void RemoveAllChildren();
     /// Remove child scene nodes that match criteria.
     void RemoveChildren(bool recursive);
+    /// Remove all child scene nodes and destroy their subtrees at once.
+    /// Unlike RemoveAllChildren, E_NODEREMOVED is sent only for direct children,
+    /// and the whole subtree is detached from the scene in one flat pass without marking transforms dirty.
+    /// Descendants referenced elsewhere are detached from each other. Event handlers should not modify the subtree.
+    void DestroyAllChildren();
     /// Create a component to this node (with specified ID if provided).
     Component* CreateComponent(StringHash type, unsigned id = 0);
     /// Create a component to this node if it does not exist already.
@@ -389,6 +403,9 @@ public:
     Node* Clone(Node* parent = nullptr);
     /// Remove from the parent node. If no other shared pointer references exist, causes immediate deletion.
     void Remove();
+    /// Remove from the parent node and destroy the subtree at once.
+    /// E_NODEREMOVED is sent only for this node. See DestroyAllChildren.
+    void Destroy();
     /// Assign to a new parent scene node. Retains the world transform.
     /// @property
     void SetParent(Node* parent);
@@ -782,6 +799,10 @@ private:
     void UpdateWorldTransform() const;
     /// Remove child node by iterator.
     void RemoveChild(ea::vector<SharedPtr<Node> >::iterator i);
+    /// Send E_NODEREMOVED for the child node. Scene should be set.
+    void SendNodeRemovedEvent(Node* child);
+    /// Detach nodes and their subtrees from the scene and from each other without recursion.
+    static void DestroyNodes(ea::vector<SharedPtr<Node>>& nodes);
     /// Return child nodes recursively.
     void GetChildrenRecursive(ea::vector<Node*>& dest) const;
     /// Return child nodes with a specific component recursively.
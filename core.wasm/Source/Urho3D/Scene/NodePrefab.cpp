@@ -187,15 +187,10 @@ void SerializablePrefab::Import(const Serializable* serializable, PrefabSaveFlag
             continue;
 
         Variant value;
-        serializable->OnGetAttribute(attr, value);
-
-        // Skip defaults if allowed
-        if (!flags.Test(PrefabSaveFlag::SaveDefaultValues))
-        {
-            const Variant defaultValue = serializable->GetAttributeDefault(attributeIndex);
-            if (value == defaultValue)
-                continue;
-        }
+        if (flags.Test(PrefabSaveFlag::SaveDefaultValues))
+            serializable->OnGetAttribute(attr, value);
+        else if (!serializable->GetNonDefaultAttribute(attr, value))
+            continue;
 
         AttributePrefab& attributePrefab = flags.Test(PrefabSaveFlag::CompactAttributeNames)
             ? attributes_.emplace_back(attr.nameHash_)
@@ -261,6 +256,15 @@ void SerializablePrefab::Export(Serializable* serializable, PrefabLoadFlags flag
                     attr.name_, reflection->GetTypeName(), value.GetString());
             }
         }
+        else if (value.GetType() != VAR_NONE && value.GetType() == attr.accessor_->GetTypedAccessType())
+        {
+            VisitTypedAttributeType(value.GetType(), [&](auto typeTag)
+            {
+                using ValueType = typename decltype(typeTag)::type;
+                const auto& typedValue = GetTypedAttributeValue<ValueType>(value);
+                serializable->OnSetAttributeTyped(attr, &typedValue);
+            });
+        }
         else
             serializable->OnSetAttribute(attr, value);
     }
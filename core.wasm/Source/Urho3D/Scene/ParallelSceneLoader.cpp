@@ -0,0 +1,384 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/ArchiveSerialization.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/Resource/JSONArchive.h>
+#include <Urho3D/Scene/ParallelSceneLoader.h>
+#include <Urho3D/Scene/PrefabInstantiationPlan.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneResolver.h>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+unsigned CountNodes(const NodePrefab& prefab)
+{
+    unsigned count = 1;
+    for (const NodePrefab& child : prefab.GetChildren())
+        count += CountNodes(child);
+    return count;
+}
+
+unsigned CountNodes(const ea::vector<NodePrefab>& prefabs)
+{
+    unsigned count = 0;
+    for (const NodePrefab& prefab : prefabs)
+        count += CountNodes(prefab);
+    return count;
+}
+
+unsigned GetNumProcessingThreads(Context* context)
+{
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    return workQueue ? ea::max(workQueue->GetNumProcessingThreads(), 1u) : 1u;
+}
+
+} // namespace
+
+ParallelSceneLoader::ParallelSceneLoader(
+    Context* context, InternalResourceFormat format, ConstByteSpan data, const ea::string& name)
+    : context_(context)
+    , format_(format)
+    , data_(data)
+    , name_(name)
+    , archiveFlags_(format == InternalResourceFormat::Binary ? PrefabArchiveFlag::CompactTypeNames : PrefabArchiveFlag::None)
+{
+    URHO3D_ASSERT(format == InternalResourceFormat::Binary || format == InternalResourceFormat::Json);
+}
+
+ParallelSceneLoader::ParallelSceneLoader(Context* context, const ea::string& name)
+    : context_(context)
+    , format_(InternalResourceFormat::Json)
+    , name_(name)
+{
+}
+
+ParallelSceneLoader::~ParallelSceneLoader() = default;
+
+void ParallelSceneLoader::Load(Scene* scene, const char* rootBlockName)
+{
+    URHO3D_PROFILE("LoadSceneParallel");
+
+    MemoryBuffer buffer{data_.data(), static_cast<unsigned>(data_.size())};
+    buffer.SetName(name_);
+
+    if (format_ == InternalResourceFormat::Json)
+    {
+        JSONStreamInputArchive archive{context_, buffer};
+        LoadFromArchive(scene, archive, rootBlockName, &archive);
+    }
+    else
+    {
+        BinaryInputArchive archive{context_, buffer};
+        LoadFromArchive(scene, archive, rootBlockName, nullptr);
+    }
+}
+
+void ParallelSceneLoader::LoadFromArchive(
+    Scene* scene, Archive& archive, const char* rootBlockName, JSONStreamInputArchive* jsonArchive)
+{
+    subtrees_.clear();
+
+    ArchiveBlock block = archive.OpenUnorderedBlock(rootBlockName);
+
+    NodePrefab rootPrefab;
+    ReadNodeAndComponents(archive, rootPrefab);
+
+    if (jsonArchive)
+    {
+        const unsigned numSubtrees = GetNumProcessingThreads(context_) * SubtreesPerThread;
+        maxSubtreeSize_ = ea::max(data_.size() / numSubtrees, 1u);
+        IndexJSONChildren(*jsonArchive, data_, M_MAX_UNSIGNED, false);
+    }
+    else
+    {
+        ReadChildren(archive);
+    }
+
+    ProcessSubtrees();
+    InstantiateSubtrees(scene, rootPrefab);
+
+    // Keep in sync with Scene::SerializeInBlock
+    scene->SerializeAuxiliaryData(archive);
+    scene->ApplyAttributes();
+    scene->SetFileName(name_);
+}
+
+void ParallelSceneLoader::Read(Deserializer& source, const char* rootBlockName)
+{
+    URHO3D_ASSERT(format_ == InternalResourceFormat::Json && data_.empty());
+    URHO3D_PROFILE("ReadSceneStream");
+
+    subtrees_.clear();
+    rootPrefab_.Clear();
+    auxiliaryData_.clear();
+
+    ea::vector<ea::pair<unsigned, unsigned>> childRanges;
+    ea::optional<ea::pair<unsigned, unsigned>> auxiliaryRange;
+    {
+        JSONStreamInputArchive archive{context_, source};
+        ArchiveBlock block = archive.OpenUnorderedBlock(rootBlockName);
+
+        ReadNodeAndComponents(archive, rootPrefab_);
+
+        // Children are read by ranges below, so the stream is parsed only once
+        int placeholder{};
+        SerializeOptionalValue(archive, "nodes", placeholder, {},
+            [&](Archive&, const char* name, int&)
+        {
+            auto nodesBlock = archive.OpenArrayBlock(name);
+            const unsigned numChildren = nodesBlock.GetSizeHint();
+            for (unsigned i = 0; i < numChildren; ++i)
+                childRanges.push_back(archive.SkipElement("node"));
+        });
+
+        // Auxiliary data needs the components of the scene, so it is read on instantiation
+        if (archive.HasElementOrBlock("auxiliary"))
+            auxiliaryRange = archive.SkipElement("auxiliary");
+    }
+
+    if (auxiliaryRange)
+    {
+        const auto [beginOffset, endOffset] = *auxiliaryRange;
+        ea::string value(endOffset - beginOffset, '\0');
+        if (source.Seek(beginOffset) != beginOffset || source.Read(value.data(), value.size()) != value.size())
+            throw ArchiveException("Cannot read auxiliary data from '{}'", name_);
+
+        auxiliaryData_ = Format("{{\"auxiliary\":{}}}", value);
+    }
+
+    unsigned totalSize = 0;
+    for (const auto& [beginOffset, endOffset] : childRanges)
+        totalSize += endOffset - beginOffset;
+
+    const unsigned numSubtrees = GetNumProcessingThreads(context_) * SubtreesPerThread;
+    maxSubtreeSize_ = ea::max(totalSize / numSubtrees, 1u);
+
+    ByteVector childData;
+    for (const auto& [beginOffset, endOffset] : childRanges)
+    {
+        childData.resize(endOffset - beginOffset);
+        if (source.Seek(beginOffset) != beginOffset || source.Read(childData.data(), childData.size()) != childData.size())
+            throw ArchiveException("Cannot read node hierarchy from '{}'", name_);
+
+        AddJSONSubtree(childData, 0, childData.size(), M_MAX_UNSIGNED, true);
+    }
+}
+
+void ParallelSceneLoader::Instantiate(Scene* scene)
+{
+    URHO3D_PROFILE("InstantiateSceneStream");
+
+    ProcessSubtrees();
+    InstantiateSubtrees(scene, rootPrefab_);
+    rootPrefab_.Clear();
+
+    // Keep in sync with Scene::SerializeInBlock
+    if (!auxiliaryData_.empty())
+    {
+        MemoryBuffer buffer{ea::string_view{auxiliaryData_}};
+        buffer.SetName(name_);
+
+        JSONStreamInputArchive archive{context_, buffer};
+        ArchiveBlock block = archive.OpenUnorderedBlock("scene");
+        scene->SerializeAuxiliaryData(archive);
+    }
+    scene->ApplyAttributes();
+    scene->SetFileName(name_);
+}
+
+void ParallelSceneLoader::ReadNodeAndComponents(Archive& archive, NodePrefab& prefab) const
+{
+    // Keep in sync with NodePrefab::SerializeInBlock
+    prefab.GetMutableNode().SerializeInBlock(archive, ToNodeFlags(archiveFlags_));
+
+    SerializeOptionalValue(archive, "components", prefab.GetMutableComponents(), {},
+        [&](Archive& archive, const char* name, auto& value)
+    {
+        SerializeVectorAsObjects(archive, name, value, "component",
+            [&](Archive& archive, const char* name, SerializablePrefab& value)
+            { SerializeValue(archive, name, value, ToComponentFlags(archiveFlags_)); });
+    });
+}
+
+void ParallelSceneLoader::ReadChildren(Archive& archive)
+{
+    ea::vector<NodePrefab> children;
+    SerializeOptionalValue(archive, "nodes", children, {},
+        [&](Archive& archive, const char* name, auto& value)
+    {
+        SerializeVectorAsObjects(archive, name, value, "node",
+            [&](Archive& archive, const char* name, NodePrefab& value)
+            { SerializeValue(archive, name, value, archiveFlags_); });
+    });
+
+    const unsigned numSubtrees = GetNumProcessingThreads(context_) * SubtreesPerThread;
+    maxSubtreeSize_ = ea::max(CountNodes(children) / numSubtrees, 1u);
+    SplitChildren(children, M_MAX_UNSIGNED);
+}
+
+void ParallelSceneLoader::IndexJSONChildren(
+    JSONStreamInputArchive& archive, ConstByteSpan data, unsigned parentIndex, bool copyData)
+{
+    int placeholder{};
+    SerializeOptionalValue(archive, "nodes", placeholder, {},
+        [&](Archive&, const char* name, int&)
+    {
+        auto block = archive.OpenArrayBlock(name);
+        const unsigned numChildren = block.GetSizeHint();
+        for (unsigned i = 0; i < numChildren; ++i)
+        {
+            const auto [beginOffset, endOffset] = archive.SkipElement("node");
+            AddJSONSubtree(data, beginOffset, endOffset, parentIndex, copyData);
+        }
+    });
+}
+
+void ParallelSceneLoader::AddJSONSubtree(
+    ConstByteSpan data, unsigned beginOffset, unsigned endOffset, unsigned parentIndex, bool copyData)
+{
+    const unsigned index = subtrees_.size();
+    subtrees_.emplace_back().parentIndex_ = parentIndex;
+
+    if (endOffset - beginOffset <= maxSubtreeSize_)
+    {
+        // Deserialize later on worker thread
+        Subtree& subtree = subtrees_[index];
+        if (copyData)
+        {
+            subtree.data_.assign(data.begin() + beginOffset, data.begin() + endOffset);
+            subtree.offset_ = 0;
+        }
+        else
+            subtree.offset_ = beginOffset;
+        return;
+    }
+
+    // Read the node itself and index its children recursively
+    MemoryBuffer buffer{data.data(), static_cast<unsigned>(data.size())};
+    buffer.SetName(name_);
+    buffer.Seek(beginOffset);
+
+    JSONStreamInputArchive childArchive{context_, buffer};
+    ArchiveBlock childBlock = childArchive.OpenUnorderedBlock("node");
+    ReadNodeAndComponents(childArchive, subtrees_[index].prefab_);
+    IndexJSONChildren(childArchive, data, index, copyData);
+}
+
+void ParallelSceneLoader::SplitChildren(ea::vector<NodePrefab>& children, unsigned parentIndex)
+{
+    for (NodePrefab& child : children)
+    {
+        const unsigned index = subtrees_.size();
+        Subtree& subtree = subtrees_.emplace_back();
+        subtree.parentIndex_ = parentIndex;
+        subtree.prefab_ = ea::move(child);
+
+        if (CountNodes(subtree.prefab_) > maxSubtreeSize_)
+        {
+            ea::vector<NodePrefab> grandChildren = ea::move(subtree.prefab_.GetMutableChildren());
+            subtree.prefab_.GetMutableChildren().clear();
+            SplitChildren(grandChildren, index);
+        }
+    }
+}
+
+void ParallelSceneLoader::ProcessSubtrees()
+{
+    URHO3D_PROFILE("ProcessSubtrees");
+
+    auto workQueue = context_->GetSubsystem<WorkQueue>();
+    if (!workQueue)
+    {
+        for (Subtree& subtree : subtrees_)
+            ProcessSubtree(subtree);
+        return;
+    }
+
+    ForEachParallel(workQueue, subtrees_, [&](unsigned, Subtree& subtree) { ProcessSubtree(subtree); });
+}
+
+void ParallelSceneLoader::ProcessSubtree(Subtree& subtree) const
+{
+    try
+    {
+        if (subtree.offset_ != M_MAX_UNSIGNED)
+        {
+            const ConstByteSpan data = !subtree.data_.empty() ? ConstByteSpan{subtree.data_} : data_;
+            MemoryBuffer buffer{data.data(), static_cast<unsigned>(data.size())};
+            buffer.SetName(name_);
+            buffer.Seek(subtree.offset_);
+
+            JSONStreamInputArchive archive{context_, buffer};
+            SerializeValue(archive, "node", subtree.prefab_, archiveFlags_);
+            ByteVector{}.swap(subtree.data_);
+        }
+
+        subtree.id_ = static_cast<unsigned>(subtree.prefab_.GetNode().GetId());
+        subtree.plan_ = ea::make_unique<PrefabInstantiationPlan>(context_, subtree.prefab_);
+
+        // Plan has its own copy of the data
+        subtree.prefab_.Clear();
+    }
+    catch (const ArchiveException& e)
+    {
+        subtree.error_ = e.what();
+    }
+}
+
+void ParallelSceneLoader::InstantiateSubtrees(Scene* scene, const NodePrefab& rootPrefab)
+{
+    URHO3D_PROFILE("InstantiateSubtrees");
+
+    for (const Subtree& subtree : subtrees_)
+    {
+        if (!subtree.error_.empty())
+            throw ArchiveException("Failed to load node hierarchy from '{}': {}", name_, subtree.error_);
+    }
+
+    // Keep in sync with Node::Load
+    SceneResolver resolver;
+    const PrefabInstantiationPlan rootPlan{context_, rootPrefab};
+    rootPlan.Instantiate(scene, resolver);
+
+    for (Subtree& subtree : subtrees_)
+    {
+        Node* parent = subtree.parentIndex_ != M_MAX_UNSIGNED ? subtrees_[subtree.parentIndex_].node_ : scene;
+        subtree.node_ = parent->CreateChild(subtree.id_);
+        subtree.plan_->Instantiate(subtree.node_, resolver);
+    }
+
+    resolver.Resolve();
+}
+
+} // namespace Urho3D
@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Container/ByteVector.h>
+#include <Urho3D/Resource/Resource.h>
+#include <Urho3D/Scene/NodePrefab.h>
+
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Archive;
+class Deserializer;
+class JSONStreamInputArchive;
+class Node;
+class PrefabInstantiationPlan;
+class Scene;
+
+/// Loads scene saved in binary or JSON archive format, processing independent subtrees in parallel.
+/// The scene is split into subtrees, large subtrees are split further so one big root node doesn't serialize loading.
+/// Subtrees are deserialized and compiled into instantiation plans on WorkQueue threads.
+/// Nodes and components are created, attached and resolved on the main thread,
+/// because object creation, event subscription and resource requests are not thread-safe.
+/// Binary archives don't store subtree sizes, so binary subtrees are deserialized sequentially and only compiled in parallel.
+/// JSON may also be streamed from Deserializer without keeping the file in memory,
+/// in which case each subtree keeps only its own text until it is deserialized on WorkQueue threads.
+class URHO3D_API ParallelSceneLoader : public NonCopyable
+{
+public:
+    /// Number of subtrees per processing thread used to balance the load.
+    static constexpr unsigned SubtreesPerThread = 4;
+
+    /// Construct. Binary data should not include the file magic. Data should be alive until loading is finished.
+    ParallelSceneLoader(Context* context, InternalResourceFormat format, ConstByteSpan data, const ea::string& name);
+    /// Construct for JSON streamed by Read.
+    ParallelSceneLoader(Context* context, const ea::string& name);
+    ~ParallelSceneLoader();
+
+    /// Load scene from the root block. Existing nodes and components are removed. May throw ArchiveException.
+    void Load(Scene* scene, const char* rootBlockName);
+
+    /// Read JSON scene from the root block of the stream. Stream should be seekable.
+    /// Safe to call from any thread. May throw ArchiveException.
+    void Read(Deserializer& source, const char* rootBlockName);
+    /// Create scene read by Read. Existing nodes and components are removed. May throw ArchiveException.
+    void Instantiate(Scene* scene);
+
+    /// Return number of subtrees loaded independently by the last call to Load.
+    unsigned GetNumSubtrees() const { return subtrees_.size(); }
+
+private:
+    /// Independently loaded subtree.
+    struct Subtree
+    {
+        /// Index of the subtree that contains parent node. Scene is the parent if none.
+        unsigned parentIndex_{M_MAX_UNSIGNED};
+        /// Offset of the node in JSON data. Node is already deserialized if none.
+        unsigned offset_{M_MAX_UNSIGNED};
+        /// Text of the node streamed by Read. Offset is relative to this text if not empty.
+        ByteVector data_;
+        /// Node ID.
+        unsigned id_{};
+        /// Node prefab. Children are stored in separate subtrees if the subtree is split.
+        NodePrefab prefab_;
+        /// Compiled prefab.
+        ea::unique_ptr<PrefabInstantiationPlan> plan_;
+        /// Error that occurred during processing on the worker thread.
+        ea::string error_;
+        /// Instantiated node.
+        Node* node_{};
+    };
+
+    void LoadFromArchive(Scene* scene, Archive& archive, const char* rootBlockName, JSONStreamInputArchive* jsonArchive);
+    /// Read node attributes and components, but not children.
+    void ReadNodeAndComponents(Archive& archive, NodePrefab& prefab) const;
+    /// Deserialize all children of the current node and split them into subtrees.
+    void ReadChildren(Archive& archive);
+    /// Index children of the current node in JSON archive reading the data.
+    void IndexJSONChildren(JSONStreamInputArchive& archive, ConstByteSpan data, unsigned parentIndex, bool copyData);
+    /// Add subtree for the node in the range of JSON data, large nodes are split by children.
+    /// Subtree text is copied if the data is not alive until loading is finished.
+    void AddJSONSubtree(ConstByteSpan data, unsigned beginOffset, unsigned endOffset, unsigned parentIndex, bool copyData);
+    /// Split deserialized children into subtrees.
+    void SplitChildren(ea::vector<NodePrefab>& children, unsigned parentIndex);
+    /// Deserialize and compile subtrees on worker threads.
+    void ProcessSubtrees();
+    /// Deserialize and compile one subtree.
+    void ProcessSubtree(Subtree& subtree) const;
+    /// Create nodes and components on the main thread.
+    void InstantiateSubtrees(Scene* scene, const NodePrefab& rootPrefab);
+
+    Context* context_{};
+    const InternalResourceFormat format_{};
+    const ConstByteSpan data_;
+    const ea::string name_;
+    const PrefabArchiveFlags archiveFlags_{};
+
+    /// Subtrees in depth-first order: parent subtree is always before its children.
+    ea::vector<Subtree> subtrees_;
+    /// Subtrees larger than this are split. Measured in bytes for JSON and in nodes for binary data.
+    unsigned maxSubtreeSize_{M_MAX_UNSIGNED};
+
+    /// Root node read by Read.
+    NodePrefab rootPrefab_;
+    /// Auxiliary scene data read by Read, wrapped into JSON object.
+    ea::string auxiliaryData_;
+};
+
+} // namespace Urho3D
@@ -0,0 +1,285 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/PrefabInstantiationPlan.h>
+#include <Urho3D/Scene/SceneResolver.h>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+bool HasIdAttributes(const ObjectReflection* reflection)
+{
+    for (const AttributeInfo& attr : reflection->GetAttributes())
+    {
+        if (attr.mode_ & (AM_NODEID | AM_COMPONENTID | AM_NODEIDVECTOR))
+            return true;
+    }
+    return false;
+}
+
+template <class T> void SetTypedAttribute(Serializable* serializable, const AttributeInfo& attr, const Variant& value)
+{
+    const auto& typedValue = GetTypedAttributeValue<T>(value);
+    serializable->OnSetAttributeTyped(attr, &typedValue);
+}
+
+} // namespace
+
+PrefabInstantiationPlan::PrefabInstantiationPlan(Context* context, const NodePrefab& prefab)
+    : context_(context)
+    , nodeReflection_(context->GetReflection<Node>())
+    , rootPrefab_(prefab.GetNode())
+    , empty_(prefab.IsEmpty())
+{
+    CompileNode(prefab, M_MAX_UNSIGNED);
+}
+
+void PrefabInstantiationPlan::CompileNode(const NodePrefab& prefab, unsigned parentIndex)
+{
+    const unsigned nodeIndex = nodes_.size();
+    {
+        CompiledNode& compiledNode = nodes_.emplace_back();
+        compiledNode.reflection_ = nodeReflection_;
+        compiledNode.parentIndex_ = parentIndex;
+        CompileSerializable(compiledNode, prefab.GetNode());
+
+        compiledNode.componentsBegin_ = components_.size();
+        compiledNode.componentsEnd_ = components_.size() + prefab.GetComponents().size();
+    }
+
+    for (const SerializablePrefab& componentPrefab : prefab.GetComponents())
+    {
+        CompiledSerializable& compiledComponent = components_.emplace_back();
+
+        // Unknown types are created as UnknownComponent by Node
+        ObjectReflection* reflection = context_->GetReflection(componentPrefab.GetTypeNameHash());
+        if (reflection && reflection->HasObjectFactory() && reflection->GetTypeInfo()->IsTypeOf<Component>())
+            compiledComponent.reflection_ = reflection;
+
+        CompileSerializable(compiledComponent, componentPrefab);
+
+        if (!compiledComponent.reflection_ || HasIdAttributes(compiledComponent.reflection_))
+            hasIdAttributes_ = true;
+    }
+
+    for (const NodePrefab& childPrefab : prefab.GetChildren())
+        CompileNode(childPrefab, nodeIndex);
+}
+
+void PrefabInstantiationPlan::CompileSerializable(CompiledSerializable& compiled, const SerializablePrefab& prefab) const
+{
+    compiled.id_ = static_cast<unsigned>(prefab.GetId());
+    compiled.temporary_ = prefab.IsTemporary();
+
+    const ObjectReflection* reflection = compiled.reflection_;
+    if (!reflection)
+    {
+        compiled.prefab_ = prefab;
+        return;
+    }
+
+    // Keep in sync with SerializablePrefab::Export
+    const auto& objectAttributes = reflection->GetAttributes();
+    for (const AttributePrefab& attributePrefab : prefab.GetAttributes())
+    {
+        // Not supported
+        if (attributePrefab.GetId() != AttributeId::None)
+            continue;
+
+        const unsigned attributeIndex = reflection->GetAttributeIndex(attributePrefab.GetNameHash());
+        if (attributeIndex == M_MAX_UNSIGNED)
+            continue;
+
+        const AttributeInfo& attr = objectAttributes[attributeIndex];
+        const bool shouldLoad = attr.ShouldLoad() || !!(attr.mode_ & AM_TEMPORARY);
+        if (!shouldLoad)
+            continue;
+
+        const Variant& value = attributePrefab.GetValue();
+        if (value.GetType() == VAR_STRING && !attr.enumNames_.empty())
+        {
+            const unsigned enumValue = attr.ConvertEnumToUInt(value.GetString());
+            if (enumValue != M_MAX_UNSIGNED)
+            {
+                const Variant enumVariant{enumValue};
+                compiled.attributes_.push_back(
+                    CompiledAttribute{attributeIndex, enumVariant, GetTypedSetter(attr, enumVariant)});
+            }
+            else
+            {
+                URHO3D_LOGWARNING("Attribute '{}' of Serializable '{}' has unknown enum value '{}'",
+                    attr.name_, reflection->GetTypeName(), value.GetString());
+            }
+        }
+        else
+            compiled.attributes_.push_back(CompiledAttribute{attributeIndex, value, GetTypedSetter(attr, value)});
+    }
+}
+
+PrefabInstantiationPlan::TypedSetter PrefabInstantiationPlan::GetTypedSetter(const AttributeInfo& attr, const Variant& value)
+{
+    // Keep in sync with SerializablePrefab::Export
+    TypedSetter setter{};
+    if (value.GetType() != VAR_NONE && value.GetType() == attr.accessor_->GetTypedAccessType())
+    {
+        VisitTypedAttributeType(value.GetType(), [&](auto typeTag)
+        {
+            using ValueType = typename decltype(typeTag)::type;
+            setter = &SetTypedAttribute<ValueType>;
+        });
+    }
+    return setter;
+}
+
+void PrefabInstantiationPlan::ApplyAttributes(
+    const CompiledSerializable& compiled, Serializable* serializable, PrefabLoadFlags flags) const
+{
+    if (!compiled.reflection_)
+    {
+        compiled.prefab_.Export(serializable, flags);
+        return;
+    }
+
+    if (!flags.Test(PrefabLoadFlag::KeepTemporaryState))
+        serializable->SetTemporary(compiled.temporary_);
+
+    const auto& objectAttributes = compiled.reflection_->GetAttributes();
+    for (const CompiledAttribute& attribute : compiled.attributes_)
+    {
+        // Attributes may be removed from reflection after the plan is compiled
+        if (attribute.index_ >= objectAttributes.size())
+            continue;
+
+        const AttributeInfo& attr = objectAttributes[attribute.index_];
+        if (attribute.typedSetter_ && attr.accessor_->GetTypedAccessType() == attribute.value_.GetType())
+            attribute.typedSetter_(serializable, attr, attribute.value_);
+        else
+            serializable->OnSetAttribute(attr, attribute.value_);
+    }
+}
+
+Component* PrefabInstantiationPlan::CreateComponent(Node* node, const CompiledSerializable& compiled, bool discardIds) const
+{
+    const unsigned id = discardIds ? 0 : compiled.id_;
+    if (!compiled.reflection_)
+        return node->SafeCreateComponent(compiled.prefab_.GetTypeName(), compiled.prefab_.GetTypeNameHash(), id);
+
+    const SharedPtr<Component> component = StaticCast<Component>(compiled.reflection_->CreateObject());
+    node->AddComponent(component, id);
+    return component;
+}
+
+void PrefabInstantiationPlan::Instantiate(Node* node, PrefabLoadFlags flags) const
+{
+    URHO3D_PROFILE("InstantiatePrefab");
+
+    // Resolver is not needed if there are no ID attributes to remap
+    SceneResolver resolver;
+    InstantiateObjects(node, hasIdAttributes_ ? &resolver : nullptr, flags);
+
+    if (hasIdAttributes_)
+        resolver.Resolve();
+
+    if (!flags.Test(PrefabLoadFlag::SkipApplyAttributes))
+        node->ApplyAttributes();
+}
+
+void PrefabInstantiationPlan::Instantiate(Node* node, SceneResolver& resolver, PrefabLoadFlags flags) const
+{
+    URHO3D_PROFILE("InstantiatePrefab");
+
+    InstantiateObjects(node, &resolver, flags);
+}
+
+void PrefabInstantiationPlan::InstantiateObjects(Node* node, SceneResolver* resolver, PrefabLoadFlags flags) const
+{
+    // Keep in sync with Node::Load and Node::LoadInternal
+    const bool discardIds = flags.Test(PrefabLoadFlag::DiscardIds);
+    const bool loadAsTemporary = flags.Test(PrefabLoadFlag::LoadAsTemporary);
+    const PrefabLoadFlags childFlags = flags & ~PrefabLoadFlag::LoadAsTemporary & ~PrefabLoadFlag::IgnoreRootAttributes;
+
+    if (!flags.Test(PrefabLoadFlag::KeepExistingComponents))
+        node->RemoveAllComponents();
+    if (!flags.Test(PrefabLoadFlag::KeepExistingChildren))
+        node->RemoveAllChildren();
+
+    ea::vector<Node*> createdNodes;
+    createdNodes.reserve(nodes_.size());
+
+    for (unsigned nodeIndex = 0; nodeIndex < nodes_.size(); ++nodeIndex)
+    {
+        const CompiledNode& compiledNode = nodes_[nodeIndex];
+        const bool isRoot = nodeIndex == 0;
+
+        Node* currentNode = node;
+        if (isRoot)
+        {
+            if (!flags.Test(PrefabLoadFlag::IgnoreRootAttributes))
+            {
+                if (node->GetReflection() == compiledNode.reflection_)
+                    ApplyAttributes(compiledNode, node, flags);
+                else
+                    rootPrefab_.Export(node, flags);
+            }
+        }
+        else
+        {
+            Node* parentNode = createdNodes[compiledNode.parentIndex_];
+            currentNode = parentNode->CreateChild(discardIds ? 0 : compiledNode.id_);
+            ApplyAttributes(compiledNode, currentNode, childFlags);
+
+            if (loadAsTemporary && compiledNode.parentIndex_ == 0)
+                currentNode->SetTemporary(true);
+        }
+
+        createdNodes.push_back(currentNode);
+        if (resolver)
+            resolver->AddNode(compiledNode.id_, currentNode);
+
+        const PrefabLoadFlags componentFlags = isRoot ? flags : childFlags;
+        for (unsigned componentIndex = compiledNode.componentsBegin_; componentIndex < compiledNode.componentsEnd_;
+             ++componentIndex)
+        {
+            const CompiledSerializable& compiledComponent = components_[componentIndex];
+            Component* component = CreateComponent(currentNode, compiledComponent, discardIds);
+
+            if (resolver)
+                resolver->AddComponent(compiledComponent.id_, component);
+            ApplyAttributes(compiledComponent, component, componentFlags);
+
+            if (loadAsTemporary && isRoot)
+                component->SetTemporary(true);
+        }
+    }
+}
+
+} // namespace Urho3D
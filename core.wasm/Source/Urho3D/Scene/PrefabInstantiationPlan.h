@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Scene/NodePrefab.h>
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Component;
+class Node;
+class ObjectReflection;
+class SceneResolver;
+
+/// Prefab compiled for fast repeated instantiation.
+/// Object factories and attribute indices are resolved once, enum names are converted to values.
+/// Instantiation has the same effect as loading prefab via PrefabReaderFromMemory.
+class URHO3D_API PrefabInstantiationPlan
+{
+public:
+    /// Compile node prefab.
+    PrefabInstantiationPlan(Context* context, const NodePrefab& prefab);
+
+    /// Instantiate prefab into the node. Same as Node::Load from PrefabReaderFromMemory.
+    void Instantiate(Node* node, PrefabLoadFlags flags = {}) const;
+    /// Instantiate prefab into the node and add created objects to the resolver.
+    /// IDs are not resolved and attributes are not applied, caller is responsible for both.
+    /// Useful when the hierarchy is instantiated from several plans that may reference each other.
+    void Instantiate(Node* node, SceneResolver& resolver, PrefabLoadFlags flags = {}) const;
+
+    /// Return total number of nodes in the prefab, including the root node.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+    /// Return total number of components in the prefab.
+    unsigned GetNumComponents() const { return components_.size(); }
+    /// Return whether the prefab is empty.
+    bool IsEmpty() const { return empty_; }
+
+private:
+    /// Setter of the attribute value via typed access.
+    using TypedSetter = void (*)(Serializable* serializable, const AttributeInfo& attr, const Variant& value);
+
+    /// Attribute with resolved index and value.
+    struct CompiledAttribute
+    {
+        unsigned index_{};
+        Variant value_;
+        /// Typed setter, null if the attribute is set via Variant.
+        TypedSetter typedSetter_{};
+    };
+
+    /// Node or component with resolved attributes.
+    struct CompiledSerializable
+    {
+        /// Reflection of the object. Null if the type is unknown or is not a component.
+        ObjectReflection* reflection_{};
+        /// ID of the object in the prefab.
+        unsigned id_{};
+        /// Whether the object is temporary in the prefab.
+        bool temporary_{};
+        /// Resolved attributes.
+        ea::vector<CompiledAttribute> attributes_;
+        /// Original prefab. Stored only if reflection is not resolved.
+        SerializablePrefab prefab_;
+    };
+
+    /// Node with the range of components.
+    struct CompiledNode : CompiledSerializable
+    {
+        /// Index of parent node in the plan. Root node has no parent.
+        unsigned parentIndex_{M_MAX_UNSIGNED};
+        /// Index of first component.
+        unsigned componentsBegin_{};
+        /// Index past last component.
+        unsigned componentsEnd_{};
+    };
+
+    /// Compile node and its children recursively.
+    void CompileNode(const NodePrefab& prefab, unsigned parentIndex);
+    /// Compile attributes of the object.
+    void CompileSerializable(CompiledSerializable& compiled, const SerializablePrefab& prefab) const;
+    /// Return typed setter for the attribute value, or null if the value should be set via Variant.
+    static TypedSetter GetTypedSetter(const AttributeInfo& attr, const Variant& value);
+    /// Apply attributes to the object.
+    void ApplyAttributes(const CompiledSerializable& compiled, Serializable* serializable, PrefabLoadFlags flags) const;
+    /// Create component from compiled prefab.
+    Component* CreateComponent(Node* node, const CompiledSerializable& compiled, bool discardIds) const;
+    /// Create nodes and components. Objects are added to the resolver if it is not null.
+    void InstantiateObjects(Node* node, SceneResolver* resolver, PrefabLoadFlags flags) const;
+
+    Context* context_{};
+    /// Reflection of Node.
+    ObjectReflection* nodeReflection_{};
+    /// Original prefab of the root node. Used if the root node is not a plain Node.
+    SerializablePrefab rootPrefab_;
+    /// Nodes in depth-first order.
+    ea::vector<CompiledNode> nodes_;
+    /// Components of all nodes.
+    ea::vector<CompiledSerializable> components_;
+    /// Whether the prefab is empty.
+    bool empty_{};
+    /// Whether any component has node or component ID attributes that should be resolved.
+    bool hasIdAttributes_{};
+};
+
+} // namespace Urho3D
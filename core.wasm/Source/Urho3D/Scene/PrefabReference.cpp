@@ -26,6 +26,7 @@
 #include <Urho3D/Resource/ResourceCache.h>
 #include <Urho3D/Resource/ResourceEvents.h>
 #include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/PrefabInstantiationPlan.h>
 #include <Urho3D/Scene/PrefabReader.h>
 #include <Urho3D/Scene/PrefabReference.h>
 #include <Urho3D/Scene/PrefabWriter.h>
@@ -234,8 +235,14 @@ void PrefabReference::InstantiatePrefab(const NodePrefab& nodePrefab, PrefabInst
 {
     const auto flags = PrefabLoadFlag::KeepExistingComponents | PrefabLoadFlag::KeepExistingChildren
         | PrefabLoadFlag::LoadAsTemporary | PrefabLoadFlag::IgnoreRootAttributes;
-    PrefabReaderFromMemory reader{nodePrefab};
-    node_->Load(reader, flags);
+    // Use compiled plan for whole prefab, slices are rare
+    if (prefab_ && &nodePrefab == &prefab_->GetNodePrefab())
+        prefab_->GetInstantiationPlan().Instantiate(node_, flags);
+    else
+    {
+        PrefabReaderFromMemory reader{nodePrefab};
+        node_->Load(reader, flags);
+    }
 
     if (instanceFlags != PrefabInstanceFlag::None)
     {
@@ -24,6 +24,8 @@
 
 #include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/ResourceEvents.h>
+#include <Urho3D/Scene/PrefabInstantiationPlan.h>
 #include <Urho3D/Scene/PrefabReference.h>
 #include <Urho3D/Scene/PrefabResource.h>
 #include <Urho3D/Scene/Scene.h>
@@ -36,6 +38,8 @@ namespace Urho3D
 PrefabResource::PrefabResource(Context* context)
     : SimpleResource(context)
 {
+    // Subscribe before any PrefabReference so the plan is discarded before instances are recreated
+    SubscribeToEvent(this, E_RELOADFINISHED, [this] { ResetInstantiationPlan(); });
 }
 
 PrefabResource::~PrefabResource()
@@ -64,6 +68,7 @@ Node* PrefabResource::InstantiateReference(Node* parentNode, bool inplace)
 
 void PrefabResource::NormalizeIds()
 {
+    ResetInstantiationPlan();
     prefab_.NormalizeIds(context_);
 
     auto& sceneAttributes = prefab_.GetMutableNode().GetMutableAttributes();
@@ -79,6 +84,7 @@ void PrefabResource::SerializeInBlock(Archive& archive)
     const bool compactSave = false;
     const auto flags = PrefabArchiveFlag::None;
 
+    ResetInstantiationPlan();
     prefab_.SerializeInBlock(archive, flags, compactSave);
 }
 
@@ -93,8 +99,21 @@ const NodePrefab& PrefabResource::GetNodePrefabSlice(ea::string_view path) const
     return nodePrefab.FindChild(path);
 }
 
+const PrefabInstantiationPlan& PrefabResource::GetInstantiationPlan() const
+{
+    if (!instantiationPlan_)
+        instantiationPlan_ = ea::make_unique<PrefabInstantiationPlan>(context_, GetNodePrefab());
+    return *instantiationPlan_;
+}
+
+void PrefabResource::ResetInstantiationPlan()
+{
+    instantiationPlan_ = nullptr;
+}
+
 NodePrefab& PrefabResource::GetMutableNodePrefab()
 {
+    ResetInstantiationPlan();
     auto& children = prefab_.GetMutableChildren();
     if (children.empty())
         children.emplace_back();
@@ -111,6 +130,7 @@ bool PrefabResource::LoadLegacyXML(const XMLElement& source)
     if (!tempScene->LoadXML(source))
         return false;
 
+    ResetInstantiationPlan();
     tempScene->GeneratePrefab(prefab_);
 
     static const char* helpMessage =
@@ -25,10 +25,13 @@
 #include <Urho3D/Resource/Resource.h>
 #include <Urho3D/Scene/NodePrefab.h>
 
+#include <EASTL/unique_ptr.h>
+
 namespace Urho3D
 {
 
 class Node;
+class PrefabInstantiationPlan;
 
 /// Prefab resource.
 /// Constains representation of nodes and components with attributes, ready to be instantiated.
@@ -51,17 +54,27 @@ public:
     void SerializeInBlock(Archive& archive) override;
 
     const NodePrefab& GetScenePrefab() const { return prefab_; }
-    NodePrefab& GetMutableScenePrefab() { return prefab_; }
+    NodePrefab& GetMutableScenePrefab()
+    {
+        ResetInstantiationPlan();
+        return prefab_;
+    }
 
     const NodePrefab& GetNodePrefab() const;
     NodePrefab& GetMutableNodePrefab();
 
     const NodePrefab& GetNodePrefabSlice(ea::string_view path) const;
 
+    /// Return compiled instantiation plan of the node prefab. Plan is compiled on first use.
+    const PrefabInstantiationPlan& GetInstantiationPlan() const;
+
 private:
     bool LoadLegacyXML(const XMLElement& source) override;
+    /// Discard compiled instantiation plan when prefab is changed.
+    void ResetInstantiationPlan();
 
     NodePrefab prefab_;
+    mutable ea::unique_ptr<PrefabInstantiationPlan> instantiationPlan_;
 };
 
 } // namespace Urho3D
@@ -136,7 +136,19 @@ void Scene::SerializeInBlock(
     Archive& archive, bool serializeTemporary, PrefabSaveFlags saveFlags, PrefabLoadFlags loadFlags)
 {
     Node::SerializeInBlock(archive, serializeTemporary, saveFlags, loadFlags | PrefabLoadFlag::SkipApplyAttributes);
+    SerializeAuxiliaryData(archive);
 
+    if (archive.IsInput())
+        ApplyAttributes();
+
+    if (!archive.GetName().empty())
+        fileName_ = archive.GetName();
+    if (archive.GetChecksum() != 0)
+        checksum_ = archive.GetChecksum();
+}
+
+void Scene::SerializeAuxiliaryData(Archive& archive)
+{
     int placeholder{};
     SerializeOptionalValue(archive, "auxiliary", placeholder, AlwaysSerialize{},
         [&](Archive& archive, const char* name, int&)
@@ -160,14 +172,6 @@ void Scene::SerializeInBlock(
             }
         }, false);
     });
-
-    if (archive.IsInput())
-        ApplyAttributes();
-
-    if (!archive.GetName().empty())
-        fileName_ = archive.GetName();
-    if (archive.GetChecksum() != 0)
-        checksum_ = archive.GetChecksum();
 }
 
 void Scene::SerializeInBlock(Archive& archive)
@@ -868,6 +872,12 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.push_back(component);
 }
 
+void Scene::ReserveObjects(unsigned numNodes, unsigned numComponents)
+{
+    replicatedNodes_.reserve(replicatedNodes_.size() + numNodes);
+    replicatedComponents_.reserve(replicatedComponents_.size() + numComponents);
+}
+
 unsigned Scene::GetFreeNodeID()
 {
     for (;;)
@@ -955,7 +965,7 @@ void Scene::NodeTagRemoved(Node* node, const ea::string& tag)
     taggedNodes_[tag].erase_first(node);
 }
 
-void Scene::NodeRemoved(Node* node)
+void Scene::NodeRemoved(Node* node, bool recursive)
 {
     if (!node || node->GetScene() != this)
         return;
@@ -977,6 +987,8 @@ void Scene::NodeRemoved(Node* node)
     const ea::vector<SharedPtr<Component> >& components = node->GetComponents();
     for (auto i = components.begin(); i != components.end(); ++i)
         ComponentRemoved(*i);
+    if (!recursive)
+        return;
     const ea::vector<SharedPtr<Node> >& children = node->GetChildren();
     for (auto i = children.begin(); i != children.end(); ++i)
         NodeRemoved(*i);
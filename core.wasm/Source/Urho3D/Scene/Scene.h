@@ -125,6 +125,8 @@ public:
     void SerializeInBlock(Archive& archive) override;
     void SerializeInBlock(
         Archive& archive, bool serializeTemporary, PrefabSaveFlags saveFlags, PrefabLoadFlags loadFlags);
+    /// Serialize auxiliary data of scene components. Stored after the node hierarchy. May throw ArchiveException.
+    void SerializeAuxiliaryData(Archive& archive);
 
     /// Load from binary data. Removes all existing child nodes and components first. Return true if successful.
     bool Load(Deserializer& source) override;
@@ -267,6 +269,8 @@ public:
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
 
+    /// Reserve storage for nodes and components that are about to be added.
+    void ReserveObjects(unsigned numNodes, unsigned numComponents);
     /// Get free node ID.
     unsigned GetFreeNodeID();
     /// Get free component ID.
@@ -279,8 +283,8 @@ public:
 
     /// Node added. Assign scene pointer and add to ID map.
     void NodeAdded(Node* node);
-    /// Node removed. Remove from ID map.
-    void NodeRemoved(Node* node);
+    /// Node removed. Remove from ID map. Child nodes are removed as well if recursive.
+    void NodeRemoved(Node* node, bool recursive = true);
     /// Component added. Add to ID map.
     void ComponentAdded(Component* component);
     /// Component removed. Remove from ID map.
@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/SceneFork.h>
+
+#include <EASTL/unordered_set.h>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const StringHash EnabledAttribute{"Is Enabled"};
+const StringHash PositionAttribute{"Position"};
+const StringHash RotationAttribute{"Rotation"};
+const StringHash ScaleAttribute{"Scale"};
+
+} // namespace
+
+SceneFork::SceneFork(Node* root)
+    : root_(root)
+{
+}
+
+SceneFork::SceneFork(Node* root, ea::vector<ea::shared_ptr<const Layer>> sharedLayers)
+    : root_(root)
+    , sharedLayers_(ea::move(sharedLayers))
+{
+}
+
+SceneFork::~SceneFork() = default;
+
+SharedPtr<SceneFork> SceneFork::Fork()
+{
+    // Own layer becomes immutable and is shared with the child
+    if (ownLayer_)
+    {
+        sharedLayers_.insert(sharedLayers_.begin(), ea::move(ownLayer_));
+        ownLayer_ = nullptr;
+    }
+
+    if (sharedLayers_.size() > MaxSharedLayers)
+        MergeSharedLayers();
+
+    return SharedPtr<SceneFork>(new SceneFork(root_, sharedLayers_));
+}
+
+void SceneFork::Discard()
+{
+    ownLayer_ = nullptr;
+}
+
+void SceneFork::Apply()
+{
+    ea::vector<const Layer*> layers;
+    for (auto iter = sharedLayers_.rbegin(); iter != sharedLayers_.rend(); ++iter)
+        layers.push_back(iter->get());
+    if (ownLayer_)
+        layers.push_back(ownLayer_.get());
+
+    // Apply from the oldest to the newest layer, so newer values win
+    ea::unordered_set<Serializable*> changedObjects;
+    for (const Layer* layer : layers)
+    {
+        for (const auto& [key, entry] : layer->attributes_)
+        {
+            if (Serializable* object = entry.object_)
+            {
+                object->SetAttribute(key.second, entry.value_);
+                changedObjects.insert(object);
+            }
+        }
+
+        for (const auto& [key, entry] : layer->variables_)
+        {
+            if (Serializable* object = entry.object_)
+                static_cast<Node*>(object)->SetVar(entry.name_, entry.value_);
+        }
+    }
+
+    for (Serializable* object : changedObjects)
+        object->ApplyAttributes();
+}
+
+Variant SceneFork::GetAttribute(const Serializable* object, unsigned index) const
+{
+    if (const Variant* value = FindValue(&Layer::attributes_, AttributeKey{object, index}))
+        return *value;
+    return object->GetAttribute(index);
+}
+
+Variant SceneFork::GetAttribute(const Serializable* object, const ea::string& name) const
+{
+    const unsigned index = GetAttributeIndex(object, name);
+    return index != M_MAX_UNSIGNED ? GetAttribute(object, index) : Variant::EMPTY;
+}
+
+bool SceneFork::SetAttribute(Serializable* object, unsigned index, const Variant& value)
+{
+    const auto* attributes = object->GetAttributes();
+    if (!attributes || index >= attributes->size())
+        return false;
+
+    const AttributeInfo& attr = attributes->at(index);
+    if (value.GetType() != attr.type_)
+        return false;
+
+    Entry& entry = GetOwnLayer().attributes_[AttributeKey{object, index}];
+    entry.object_ = object;
+    entry.value_ = value;
+    return true;
+}
+
+bool SceneFork::SetAttribute(Serializable* object, const ea::string& name, const Variant& value)
+{
+    const unsigned index = GetAttributeIndex(object, name);
+    return index != M_MAX_UNSIGNED && SetAttribute(object, index, value);
+}
+
+bool SceneFork::IsEnabled(const Node* node) const
+{
+    const Variant* value = FindValue(&Layer::attributes_, AttributeKey{node, GetAttributeIndex(node, EnabledAttribute)});
+    return value ? value->GetBool() : node->IsEnabled();
+}
+
+void SceneFork::SetEnabled(Node* node, bool enable)
+{
+    SetAttribute(node, GetAttributeIndex(node, EnabledAttribute), enable);
+}
+
+Vector3 SceneFork::GetPosition(const Node* node) const
+{
+    const Variant* value = FindValue(&Layer::attributes_, AttributeKey{node, GetAttributeIndex(node, PositionAttribute)});
+    return value ? value->GetVector3() : node->GetPosition();
+}
+
+void SceneFork::SetPosition(Node* node, const Vector3& position)
+{
+    SetAttribute(node, GetAttributeIndex(node, PositionAttribute), position);
+}
+
+Quaternion SceneFork::GetRotation(const Node* node) const
+{
+    const Variant* value = FindValue(&Layer::attributes_, AttributeKey{node, GetAttributeIndex(node, RotationAttribute)});
+    return value ? value->GetQuaternion() : node->GetRotation();
+}
+
+void SceneFork::SetRotation(Node* node, const Quaternion& rotation)
+{
+    SetAttribute(node, GetAttributeIndex(node, RotationAttribute), rotation);
+}
+
+Vector3 SceneFork::GetScale(const Node* node) const
+{
+    const Variant* value = FindValue(&Layer::attributes_, AttributeKey{node, GetAttributeIndex(node, ScaleAttribute)});
+    return value ? value->GetVector3() : node->GetScale();
+}
+
+void SceneFork::SetScale(Node* node, const Vector3& scale)
+{
+    SetAttribute(node, GetAttributeIndex(node, ScaleAttribute), scale);
+}
+
+Matrix3x4 SceneFork::GetWorldTransform(const Node* node) const
+{
+    if (!node)
+        return Matrix3x4::IDENTITY;
+
+    // Nodes outside of the hierarchy are not affected by the fork
+    const Node* root = root_;
+    if (!root || (node != root && !node->IsChildOf(root)))
+        return node->GetWorldTransform();
+
+    Matrix3x4 transform{GetPosition(node), GetRotation(node), GetScale(node)};
+    for (const Node* parent = node; parent != root;)
+    {
+        parent = parent->GetParent();
+        transform = Matrix3x4{GetPosition(parent), GetRotation(parent), GetScale(parent)} * transform;
+    }
+
+    if (const Node* rootParent = root->GetParent())
+        transform = rootParent->GetWorldTransform() * transform;
+    return transform;
+}
+
+const Variant& SceneFork::GetVar(const Node* node, const ea::string& key) const
+{
+    if (const Variant* value = FindValue(&Layer::variables_, VariableKey{node, StringHash{key}}))
+        return *value;
+    return node->GetVar(key);
+}
+
+void SceneFork::SetVar(Node* node, const ea::string& key, const Variant& value)
+{
+    Entry& entry = GetOwnLayer().variables_[VariableKey{node, StringHash{key}}];
+    entry.object_ = node;
+    entry.name_ = key;
+    entry.value_ = value;
+}
+
+unsigned SceneFork::GetNumChanges() const
+{
+    return ownLayer_ ? ownLayer_->attributes_.size() + ownLayer_->variables_.size() : 0;
+}
+
+SceneFork::Layer& SceneFork::GetOwnLayer()
+{
+    if (!ownLayer_)
+        ownLayer_ = ea::make_shared<Layer>();
+    return *ownLayer_;
+}
+
+template <class Key>
+const Variant* SceneFork::FindValue(ea::unordered_map<Key, Entry> Layer::*map, const Key& key) const
+{
+    const auto findInLayer = [&](const Layer& layer) -> const Variant*
+    {
+        const auto& entries = layer.*map;
+        const auto iter = entries.find(key);
+        // Object may be destroyed and another one created at the same address
+        if (iter != entries.end() && iter->second.object_)
+            return &iter->second.value_;
+        return nullptr;
+    };
+
+    if (ownLayer_)
+    {
+        if (const Variant* value = findInLayer(*ownLayer_))
+            return value;
+    }
+
+    for (const auto& layer : sharedLayers_)
+    {
+        if (const Variant* value = findInLayer(*layer))
+            return value;
+    }
+
+    return nullptr;
+}
+
+unsigned SceneFork::GetAttributeIndex(const Serializable* object, StringHash name)
+{
+    const ObjectReflection* reflection = object->GetReflection();
+    return reflection ? reflection->GetAttributeIndex(name) : M_MAX_UNSIGNED;
+}
+
+void SceneFork::MergeSharedLayers()
+{
+    auto mergedLayer = ea::make_shared<Layer>();
+    for (auto iter = sharedLayers_.rbegin(); iter != sharedLayers_.rend(); ++iter)
+    {
+        for (const auto& [key, entry] : (*iter)->attributes_)
+        {
+            if (entry.object_)
+                mergedLayer->attributes_[key] = entry;
+        }
+        for (const auto& [key, entry] : (*iter)->variables_)
+        {
+            if (entry.object_)
+                mergedLayer->variables_[key] = entry;
+        }
+    }
+
+    sharedLayers_.clear();
+    sharedLayers_.push_back(ea::move(mergedLayer));
+}
+
+} // namespace Urho3D
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Core/Variant.h>
+#include <Urho3D/Math/Matrix3x4.h>
+#include <Urho3D/Scene/Serializable.h>
+
+#include <EASTL/shared_ptr.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Node;
+
+/// Copy-on-write view of the node hierarchy for short-lived simulations.
+/// Fork doesn't copy nodes and components. Reads fall through to the hierarchy until the value is written in the fork.
+/// Writes are stored in the layer owned by the fork, layers of the parent fork are shared and never modified.
+/// Forking and discarding costs O(1) regardless of hierarchy size.
+/// Fork stores only attribute values and node variables, components are not updated while the fork is simulated.
+/// Objects may be removed from the hierarchy while the fork is alive, their values in the fork are ignored then.
+class URHO3D_API SceneFork : public RefCounted
+{
+public:
+    /// Maximum number of shared layers. Layers are merged on fork if there are more.
+    static constexpr unsigned MaxSharedLayers = 8;
+
+    /// Construct fork of the node hierarchy.
+    explicit SceneFork(Node* root);
+    ~SceneFork() override;
+
+    /// Create child fork that sees all changes made in this fork so far.
+    /// Changes made after the call are not visible to the child fork and vice versa.
+    SharedPtr<SceneFork> Fork();
+    /// Discard changes made in this fork since the last call to Fork. Earlier changes are shared with child forks.
+    void Discard();
+    /// Write all changes, including inherited ones, to the hierarchy. Attributes are applied to changed objects.
+    void Apply();
+
+    /// Return attribute value. Return empty value if the attribute is not found.
+    Variant GetAttribute(const Serializable* object, unsigned index) const;
+    Variant GetAttribute(const Serializable* object, const ea::string& name) const;
+    /// Set attribute value in the fork. Return true if successful.
+    bool SetAttribute(Serializable* object, unsigned index, const Variant& value);
+    bool SetAttribute(Serializable* object, const ea::string& name, const Variant& value);
+
+    /// Node attributes.
+    /// @{
+    bool IsEnabled(const Node* node) const;
+    void SetEnabled(Node* node, bool enable);
+    Vector3 GetPosition(const Node* node) const;
+    void SetPosition(Node* node, const Vector3& position);
+    Quaternion GetRotation(const Node* node) const;
+    void SetRotation(Node* node, const Quaternion& rotation);
+    Vector3 GetScale(const Node* node) const;
+    void SetScale(Node* node, const Vector3& scale);
+    /// @}
+
+    /// Return world transform of the node. Local transforms of the root and its descendants are taken from the fork.
+    Matrix3x4 GetWorldTransform(const Node* node) const;
+    /// Return world position of the node.
+    Vector3 GetWorldPosition(const Node* node) const { return GetWorldTransform(node).Translation(); }
+
+    /// Return node variable. Return empty value if not found.
+    const Variant& GetVar(const Node* node, const ea::string& key) const;
+    /// Set node variable in the fork.
+    void SetVar(Node* node, const ea::string& key, const Variant& value);
+
+    /// Return root node of the hierarchy.
+    Node* GetRoot() const { return root_; }
+    /// Return number of values written in this fork and not yet shared.
+    unsigned GetNumChanges() const;
+    /// Return number of immutable layers shared with other forks.
+    unsigned GetNumSharedLayers() const { return sharedLayers_.size(); }
+
+private:
+    /// Value written in the fork.
+    struct Entry
+    {
+        /// Used to ignore values of objects that were destroyed.
+        WeakPtr<Serializable> object_;
+        /// Name of the variable. Empty for attributes.
+        ea::string name_;
+        /// Value.
+        Variant value_;
+    };
+
+    using AttributeKey = ea::pair<const Serializable*, unsigned>;
+    using VariableKey = ea::pair<const Serializable*, StringHash>;
+
+    /// Layer of written values.
+    struct Layer
+    {
+        ea::unordered_map<AttributeKey, Entry> attributes_;
+        ea::unordered_map<VariableKey, Entry> variables_;
+    };
+
+    /// Construct child fork.
+    SceneFork(Node* root, ea::vector<ea::shared_ptr<const Layer>> sharedLayers);
+
+    /// Return layer owned by the fork, create if needed.
+    Layer& GetOwnLayer();
+    /// Find value written in the fork or inherited from the parent.
+    template <class Key> const Variant* FindValue(ea::unordered_map<Key, Entry> Layer::*map, const Key& key) const;
+    /// Return index of the attribute or M_MAX_UNSIGNED if not found.
+    static unsigned GetAttributeIndex(const Serializable* object, StringHash name);
+    /// Merge shared layers into one.
+    void MergeSharedLayers();
+
+    /// Root of the hierarchy.
+    WeakPtr<Node> root_;
+    /// Immutable layers shared with other forks, newest first.
+    ea::vector<ea::shared_ptr<const Layer>> sharedLayers_;
+    /// Layer owned by the fork. Created on first write.
+    ea::shared_ptr<Layer> ownLayer_;
+};
+
+} // namespace Urho3D
@@ -23,11 +23,14 @@
 #include <Urho3D/Precompiled.h>
 
 #include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/File.h>
 #include <Urho3D/IO/Log.h>
 #include <Urho3D/IO/MemoryBuffer.h>
 #include <Urho3D/IO/VirtualFileSystem.h>
+#include <Urho3D/Scene/ParallelSceneLoader.h>
 #include <Urho3D/Scene/PrefabResource.h>
 #include <Urho3D/Scene/SceneResource.h>
+#include <Urho3D/Scene/SceneSnapshot.h>
 #include <Urho3D/Resource/BinaryFile.h>
 #include <Urho3D/Resource/JSONArchive.h>
 #include <Urho3D/Resource/JSONFile.h>
@@ -107,7 +110,7 @@ bool SceneResource::Save(Serializer& dest, InternalResourceFormat format, bool a
     }
     catch (const ArchiveException& e)
     {
-        URHO3D_LOGERROR("Cannot save SimpleResource: ", e.what());
+        URHO3D_LOGERROR("Cannot save SceneResource: {}", e.what());
         return false;
     }
 }
@@ -122,17 +125,46 @@ bool SceneResource::SaveFile(const FileIdentifier& fileName, InternalResourceFor
 bool SceneResource::BeginLoad(Deserializer& source)
 {
     loadBinaryFile_ = nullptr;
-    loadJsonFile_ = nullptr;
     loadXmlFile_ = nullptr;
+    loadJsonLoader_ = nullptr;
+    loadSnapshot_ = nullptr;
+
+    // Baked snapshots are saved back as binary scenes
+    if (PeekResourceFormat(source, SceneSnapshotMagic) == InternalResourceFormat::Binary)
+    {
+        // Loose files are memory-mapped, packaged and in-memory files are read
+        loadSnapshot_ = ea::make_unique<SceneSnapshot>(context_);
+        const auto file = dynamic_cast<File*>(&source);
+        const bool success = file && !file->IsPackaged() && file->GetPosition() == 0
+            ? loadSnapshot_->Open(file->GetAbsoluteName())
+            : loadSnapshot_->Read(source);
+        if (!success)
+        {
+            loadSnapshot_ = nullptr;
+            return false;
+        }
+
+        loadFormat_ = InternalResourceFormat::Binary;
+        return true;
+    }
 
     const auto format = PeekResourceFormat(source, DefaultBinaryMagic);
     switch (format)
     {
     case InternalResourceFormat::Json:
     {
-        loadJsonFile_ = MakeShared<JSONFile>(context_);
-        if (!loadJsonFile_->Load(source))
+        // JSON is streamed from the source without building the document tree or keeping the file in memory
+        loadJsonLoader_ = ea::make_unique<ParallelSceneLoader>(context_, GetName());
+        try
+        {
+            loadJsonLoader_->Read(source, GetXmlRootName());
+        }
+        catch (const ArchiveException& e)
+        {
+            URHO3D_LOGERROR("Cannot load SceneResource: {}", e.what());
+            loadJsonLoader_ = nullptr;
             return false;
+        }
 
         loadFormat_ = format;
         return true;
@@ -173,15 +205,17 @@ bool SceneResource::EndLoad()
         bool cancelReload = false;
         OnReloadBegin(this, cancelReload);
 
-        if (!cancelReload)
+        if (!cancelReload && loadSnapshot_)
+        {
+            loadSnapshot_->Load(scene_);
+        }
+        else if (!cancelReload)
         {
             switch (*loadFormat_)
             {
             case InternalResourceFormat::Json:
             {
-                JSONInputArchive archive{context_, loadJsonFile_->GetRoot(), loadJsonFile_};
-                ArchiveBlock block = archive.OpenUnorderedBlock(GetXmlRootName());
-                scene_->SerializeInBlock(archive, false, PrefabSaveFlag::None, PrefabLoadFlag::None);
+                loadJsonLoader_->Instantiate(scene_);
                 break;
             }
             case InternalResourceFormat::Xml:
@@ -202,13 +236,9 @@ bool SceneResource::EndLoad()
             }
             case InternalResourceFormat::Binary:
             {
-                MemoryBuffer readBuffer{loadBinaryFile_->GetData()};
-                readBuffer.SeekRelative(BinaryMagicSize);
-
-                BinaryInputArchive archive{GetContext(), readBuffer};
-                ArchiveBlock block = archive.OpenUnorderedBlock(GetXmlRootName());
-                scene_->SerializeInBlock(archive, false, PrefabSaveFlag::None, PrefabLoadFlag::None);
-
+                const ConstByteSpan data{loadBinaryFile_->GetData()};
+                ParallelSceneLoader loader{context_, *loadFormat_, data.subspan(BinaryMagicSize), GetName()};
+                loader.Load(scene_, GetXmlRootName());
                 break;
             }
             default:
@@ -218,9 +248,10 @@ bool SceneResource::EndLoad()
             }
         }
 
-        loadJsonFile_ = nullptr;
         loadBinaryFile_ = nullptr;
         loadXmlFile_ = nullptr;
+        loadJsonLoader_ = nullptr;
+        loadSnapshot_ = nullptr;
 
         OnReloadEnd(this, !cancelReload);
 
@@ -228,7 +259,7 @@ bool SceneResource::EndLoad()
     }
     catch (const ArchiveException& e)
     {
-        URHO3D_LOGERROR("Cannot load SimpleResource: ", e.what());
+        URHO3D_LOGERROR("Cannot load SceneResource: {}", e.what());
         return false;
     }
 }
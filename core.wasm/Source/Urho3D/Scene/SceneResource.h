@@ -26,11 +26,15 @@
 #include <Urho3D/Resource/Resource.h>
 #include <Urho3D/Scene/Scene.h>
 
+#include <EASTL/unique_ptr.h>
+
 namespace Urho3D
 {
 
 class BinaryFile;
 class JSONFile;
+class ParallelSceneLoader;
+class SceneSnapshot;
 class XMLFile;
 
 /// Scene resource.
@@ -75,8 +79,9 @@ private:
     bool isPrefab_{};
 
     SharedPtr<BinaryFile> loadBinaryFile_;
-    SharedPtr<JSONFile> loadJsonFile_;
     SharedPtr<XMLFile> loadXmlFile_;
+    ea::unique_ptr<ParallelSceneLoader> loadJsonLoader_;
+    ea::unique_ptr<SceneSnapshot> loadSnapshot_;
 };
 
 } // namespace Urho3D
@@ -0,0 +1,742 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/IO/ArchiveSerializationVariant.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/MemoryMappedFile.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Scene/Component.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneResolver.h>
+#include <Urho3D/Scene/SceneSnapshot.h>
+
+#include <EASTL/unordered_map.h>
+
+namespace Urho3D
+{
+
+const BinaryMagic SceneSnapshotMagic{{'U', 'S', 'N', 'P'}};
+
+namespace
+{
+
+const unsigned ByteOrderMark = 0x01020304u;
+
+/// Return size of the value if it is stored in the column as is, zero otherwise.
+unsigned GetRawValueSize(VariantType type)
+{
+    unsigned size = 0;
+    VisitTypedAttributeType(type, [&](auto typeTag)
+    {
+        using ValueType = typename decltype(typeTag)::type;
+        if constexpr (ea::is_trivially_copyable_v<ValueType>)
+            size = sizeof(ValueType);
+    });
+    return size;
+}
+
+unsigned long long AlignOffset(unsigned long long offset)
+{
+    return (offset + SceneSnapshot::Alignment - 1) / SceneSnapshot::Alignment * SceneSnapshot::Alignment;
+}
+
+bool IsSectionValid(const SceneSnapshotSection& section, unsigned long long totalSize, unsigned elementSize)
+{
+    return section.offset_ <= totalSize && section.size_ <= totalSize - section.offset_
+        && section.size_ % elementSize == 0;
+}
+
+template <class T> ea::span<const T> GetSectionSpan(ConstByteSpan data, const SceneSnapshotSection& section)
+{
+    const auto begin = reinterpret_cast<const T*>(data.data() + section.offset_);
+    return {begin, static_cast<unsigned>(section.size_ / sizeof(T))};
+}
+
+/// Collects scene objects into tables and columns.
+class SceneSnapshotBuilder
+{
+public:
+    explicit SceneSnapshotBuilder(Context* context)
+        : context_(context)
+    {
+    }
+
+    void AddNode(Node* node, unsigned parentIndex)
+    {
+        const unsigned nodeIndex = nodes_.size();
+        {
+            SceneSnapshotNode& record = nodes_.emplace_back();
+            record.id_ = node->GetID();
+            record.parentIndex_ = parentIndex;
+            record.typeIndex_ = GetTypeIndex(node->GetReflection());
+            record.row_ = AddRow(record.typeIndex_, node);
+            record.firstComponent_ = components_.size();
+        }
+
+        for (Component* component : node->GetComponents())
+        {
+            if (component->IsTemporary())
+                continue;
+
+            SceneSnapshotComponent& record = components_.emplace_back();
+            record.id_ = component->GetID();
+            record.typeIndex_ = GetTypeIndex(component->GetReflection());
+            record.row_ = AddRow(record.typeIndex_, component);
+            record.flags_ = 0;
+        }
+        nodes_[nodeIndex].numComponents_ = components_.size() - nodes_[nodeIndex].firstComponent_;
+
+        for (Node* child : node->GetChildren())
+        {
+            if (!child->IsTemporary())
+                AddNode(child, nodeIndex);
+        }
+    }
+
+    /// Serialize columns of non-plain values. Should be called after all objects are added.
+    void SerializeValueColumns()
+    {
+        for (TypeData& type : types_)
+        {
+            for (AttributeData& attribute : type.attributes_)
+            {
+                if (attribute.valueSize_ != 0)
+                    continue;
+
+                BinaryOutputArchive archive{context_, attribute.data_};
+                ArchiveBlock block = archive.OpenArrayBlock("column", attribute.values_.size());
+                for (Variant& value : attribute.values_)
+                    SerializeVariantAsType(archive, "value", value, attribute.info_->type_);
+                attribute.values_.clear();
+            }
+        }
+    }
+
+    void Write(Serializer& dest, ConstByteSpan auxiliaryData)
+    {
+        SceneSnapshotHeader header{};
+        header.magic_ = SceneSnapshotMagic;
+        header.byteOrderMark_ = ByteOrderMark;
+        header.version_ = SceneSnapshot::Version;
+
+        ea::vector<SceneSnapshotType> typeRecords;
+        ea::vector<SceneSnapshotAttribute> attributeRecords;
+        for (const TypeData& type : types_)
+        {
+            SceneSnapshotType& typeRecord = typeRecords.emplace_back();
+            typeRecord.nameHash_ = type.reflection_->GetTypeNameHash().Value();
+            typeRecord.nameOffset_ = AddString(type.reflection_->GetTypeName());
+            typeRecord.firstAttribute_ = attributeRecords.size();
+            typeRecord.numAttributes_ = type.attributes_.size();
+            typeRecord.numObjects_ = type.numObjects_;
+            typeRecord.flags_ = 0;
+
+            for (const AttributeData& attribute : type.attributes_)
+            {
+                SceneSnapshotAttribute& attributeRecord = attributeRecords.emplace_back();
+                attributeRecord.nameHash_ = attribute.info_->nameHash_.Value();
+                attributeRecord.nameOffset_ = AddString(attribute.info_->name_);
+                attributeRecord.type_ = attribute.info_->type_;
+                attributeRecord.valueSize_ = attribute.valueSize_;
+            }
+        }
+
+        // Lay out sections
+        unsigned long long offset = AlignOffset(sizeof(SceneSnapshotHeader));
+        const auto allocateSection = [&](SceneSnapshotSection& section, unsigned long long size)
+        {
+            section.offset_ = offset;
+            section.size_ = size;
+            offset = AlignOffset(offset + size);
+        };
+
+        allocateSection(header.nodes_, nodes_.size() * sizeof(SceneSnapshotNode));
+        allocateSection(header.components_, components_.size() * sizeof(SceneSnapshotComponent));
+        allocateSection(header.types_, typeRecords.size() * sizeof(SceneSnapshotType));
+        allocateSection(header.attributes_, attributeRecords.size() * sizeof(SceneSnapshotAttribute));
+
+        header.columns_.offset_ = offset;
+        unsigned attributeIndex = 0;
+        for (const TypeData& type : types_)
+        {
+            for (const AttributeData& attribute : type.attributes_)
+                allocateSection(attributeRecords[attributeIndex++].column_, attribute.data_.GetSize());
+        }
+        header.columns_.size_ = offset - header.columns_.offset_;
+
+        allocateSection(header.strings_, strings_.size());
+        allocateSection(header.auxiliaryData_, auxiliaryData.size());
+        header.totalSize_ = offset;
+
+        // Write sections in the same order
+        VectorBuffer buffer;
+        buffer.Resize(static_cast<unsigned>(header.totalSize_));
+        unsigned char* data = buffer.GetModifiableData();
+        ea::fill_n(data, buffer.GetSize(), 0);
+
+        const auto writeSection = [&](const SceneSnapshotSection& section, const void* source)
+        {
+            if (section.size_ > 0)
+                memcpy(data + section.offset_, source, section.size_);
+        };
+
+        memcpy(data, &header, sizeof(header));
+        writeSection(header.nodes_, nodes_.data());
+        writeSection(header.components_, components_.data());
+        writeSection(header.types_, typeRecords.data());
+        writeSection(header.attributes_, attributeRecords.data());
+
+        attributeIndex = 0;
+        for (const TypeData& type : types_)
+        {
+            for (const AttributeData& attribute : type.attributes_)
+                writeSection(attributeRecords[attributeIndex++].column_, attribute.data_.GetData());
+        }
+
+        writeSection(header.strings_, strings_.data());
+        writeSection(header.auxiliaryData_, auxiliaryData.data());
+
+        if (dest.Write(data, buffer.GetSize()) != buffer.GetSize())
+            throw ArchiveException("Failed to write scene snapshot");
+    }
+
+private:
+    struct AttributeData
+    {
+        const AttributeInfo* info_{};
+        unsigned valueSize_{};
+        bool typed_{};
+        VectorBuffer data_;
+        ea::vector<Variant> values_;
+    };
+
+    struct TypeData
+    {
+        ObjectReflection* reflection_{};
+        unsigned numObjects_{};
+        ea::vector<AttributeData> attributes_;
+    };
+
+    unsigned GetTypeIndex(ObjectReflection* reflection)
+    {
+        if (!reflection)
+            throw ArchiveException("Cannot save object without reflection to scene snapshot");
+
+        const auto iter = typeIndices_.find(reflection);
+        if (iter != typeIndices_.end())
+            return iter->second;
+
+        const unsigned index = types_.size();
+        TypeData& type = types_.emplace_back();
+        type.reflection_ = reflection;
+        for (const AttributeInfo& attr : reflection->GetAttributes())
+        {
+            if (!attr.ShouldSave())
+                continue;
+
+            AttributeData& attribute = type.attributes_.emplace_back();
+            attribute.info_ = &attr;
+            attribute.valueSize_ = GetRawValueSize(attr.type_);
+            attribute.typed_ = attribute.valueSize_ != 0 && attr.accessor_->GetTypedAccessType() == attr.type_;
+        }
+
+        typeIndices_.emplace(reflection, index);
+        return index;
+    }
+
+    unsigned AddRow(unsigned typeIndex, const Serializable* object)
+    {
+        TypeData& type = types_[typeIndex];
+        for (AttributeData& attribute : type.attributes_)
+        {
+            const AttributeInfo& attr = *attribute.info_;
+            if (attribute.valueSize_ == 0)
+            {
+                Variant& value = attribute.values_.emplace_back();
+                object->OnGetAttribute(attr, value);
+                continue;
+            }
+
+            VisitTypedAttributeType(attr.type_, [&](auto typeTag)
+            {
+                using ValueType = typename decltype(typeTag)::type;
+                if constexpr (ea::is_trivially_copyable_v<ValueType>)
+                {
+                    ValueType value{};
+                    if (attribute.typed_)
+                        object->OnGetAttributeTyped(attr, &value);
+                    else
+                    {
+                        Variant variantValue;
+                        object->OnGetAttribute(attr, variantValue);
+                        if (variantValue.GetType() == attr.type_)
+                            value = GetTypedAttributeValue<ValueType>(variantValue);
+                    }
+                    attribute.data_.Write(&value, sizeof(value));
+                }
+            });
+        }
+        return type.numObjects_++;
+    }
+
+    unsigned AddString(const ea::string& value)
+    {
+        const auto iter = stringOffsets_.find(value);
+        if (iter != stringOffsets_.end())
+            return iter->second;
+
+        const unsigned offset = strings_.size();
+        strings_.insert(strings_.end(), value.c_str(), value.c_str() + value.length() + 1);
+        stringOffsets_.emplace(value, offset);
+        return offset;
+    }
+
+    Context* context_{};
+    ea::vector<SceneSnapshotNode> nodes_;
+    ea::vector<SceneSnapshotComponent> components_;
+    ea::vector<TypeData> types_;
+    ea::unordered_map<ObjectReflection*, unsigned> typeIndices_;
+    ea::vector<char> strings_;
+    ea::unordered_map<ea::string, unsigned> stringOffsets_;
+};
+
+} // namespace
+
+SceneSnapshot::SceneSnapshot(Context* context)
+    : context_(context)
+{
+}
+
+SceneSnapshot::~SceneSnapshot() = default;
+
+bool SceneSnapshot::Save(Scene* scene, Serializer& dest)
+{
+    URHO3D_PROFILE("SaveSceneSnapshot");
+
+    Context* context = scene->GetContext();
+    try
+    {
+        SceneSnapshotBuilder builder{context};
+        builder.AddNode(scene, M_MAX_UNSIGNED);
+        builder.SerializeValueColumns();
+
+        // Keep in sync with Scene::SerializeInBlock
+        VectorBuffer auxiliaryData;
+        {
+            BinaryOutputArchive archive{context, auxiliaryData};
+            ArchiveBlock block = archive.OpenUnorderedBlock("auxiliary");
+            scene->SerializeAuxiliaryData(archive);
+        }
+
+        builder.Write(dest, auxiliaryData.GetBuffer());
+        return true;
+    }
+    catch (const ArchiveException& e)
+    {
+        URHO3D_LOGERROR("Cannot save scene snapshot: {}", e.what());
+        return false;
+    }
+}
+
+bool SceneSnapshot::Open(const ea::string& fileName)
+{
+    Close();
+
+    auto mappedFile = MakeShared<MemoryMappedFile>(fileName);
+    if (mappedFile->IsOpen())
+    {
+        mappedFile_ = mappedFile;
+        const ConstByteSpan data{mappedFile_->GetData(), static_cast<unsigned>(mappedFile_->GetSize())};
+        return SetData(data, fileName);
+    }
+
+    // Mapping is not supported on some platforms
+    File file(context_);
+    if (!file.Open(fileName))
+    {
+        URHO3D_LOGERROR("Cannot open scene snapshot '{}'", fileName);
+        return false;
+    }
+
+    return Read(file);
+}
+
+bool SceneSnapshot::Read(Deserializer& source)
+{
+    Close();
+
+    storage_.resize(source.GetSize() - source.GetPosition());
+    if (source.Read(storage_.data(), storage_.size()) != storage_.size())
+    {
+        URHO3D_LOGERROR("Cannot read scene snapshot '{}'", source.GetName());
+        storage_.clear();
+        return false;
+    }
+
+    name_ = source.GetName();
+    data_ = storage_;
+    return ResolveSections();
+}
+
+bool SceneSnapshot::SetData(ConstByteSpan data, const ea::string& name)
+{
+    SharedPtr<MemoryMappedFile> mappedFile = ea::move(mappedFile_);
+    Close();
+    mappedFile_ = ea::move(mappedFile);
+
+    name_ = name;
+
+    // Sections are accessed in place, so they should be aligned
+    if (reinterpret_cast<uintptr_t>(data.data()) % alignof(SceneSnapshotHeader) == 0)
+        data_ = data;
+    else
+    {
+        storage_.assign(data.begin(), data.end());
+        data_ = storage_;
+    }
+
+    return ResolveSections();
+}
+
+void SceneSnapshot::Close()
+{
+    mappedFile_ = nullptr;
+    storage_.clear();
+    data_ = {};
+    name_.clear();
+
+    header_ = nullptr;
+    nodes_ = {};
+    components_ = {};
+    types_ = {};
+    attributes_ = {};
+    strings_ = {};
+    reflections_.clear();
+    resolvedAttributes_.clear();
+}
+
+bool SceneSnapshot::ResolveSections()
+{
+    const auto fail = [&](const char* reason)
+    {
+        URHO3D_LOGERROR("Cannot load scene snapshot '{}': {}", name_, reason);
+        header_ = nullptr;
+        return false;
+    };
+
+    if (data_.size() < sizeof(SceneSnapshotHeader))
+        return fail("file is too small");
+
+    const auto header = reinterpret_cast<const SceneSnapshotHeader*>(data_.data());
+    if (header->magic_ != SceneSnapshotMagic)
+        return fail("file is not a scene snapshot");
+    if (header->byteOrderMark_ != ByteOrderMark)
+        return fail("snapshot is saved with different byte order");
+    if (header->version_ != Version)
+        return fail("snapshot version is not supported");
+    if (header->totalSize_ > data_.size())
+        return fail("file is truncated");
+
+    const unsigned long long totalSize = header->totalSize_;
+    if (!IsSectionValid(header->nodes_, totalSize, sizeof(SceneSnapshotNode))
+        || !IsSectionValid(header->components_, totalSize, sizeof(SceneSnapshotComponent))
+        || !IsSectionValid(header->types_, totalSize, sizeof(SceneSnapshotType))
+        || !IsSectionValid(header->attributes_, totalSize, sizeof(SceneSnapshotAttribute))
+        || !IsSectionValid(header->columns_, totalSize, 1)
+        || !IsSectionValid(header->strings_, totalSize, 1)
+        || !IsSectionValid(header->auxiliaryData_, totalSize, 1))
+        return fail("section is out of bounds");
+
+    if (header->nodes_.offset_ % alignof(SceneSnapshotNode) != 0
+        || header->components_.offset_ % alignof(SceneSnapshotComponent) != 0
+        || header->types_.offset_ % alignof(SceneSnapshotType) != 0
+        || header->attributes_.offset_ % alignof(SceneSnapshotAttribute) != 0)
+        return fail("section is not aligned");
+
+    const auto nodes = GetSectionSpan<SceneSnapshotNode>(data_, header->nodes_);
+    const auto components = GetSectionSpan<SceneSnapshotComponent>(data_, header->components_);
+    const auto types = GetSectionSpan<SceneSnapshotType>(data_, header->types_);
+    const auto attributes = GetSectionSpan<SceneSnapshotAttribute>(data_, header->attributes_);
+    const auto strings = GetSectionSpan<char>(data_, header->strings_);
+
+    if (strings.empty() || strings.back() != '\0')
+        return fail("name table is corrupted");
+
+    for (const SceneSnapshotType& type : types)
+    {
+        if (type.nameOffset_ >= strings.size())
+            return fail("type name is out of bounds");
+        if (type.firstAttribute_ > attributes.size() || type.numAttributes_ > attributes.size() - type.firstAttribute_)
+            return fail("type attributes are out of bounds");
+
+        for (const SceneSnapshotAttribute& attribute : attributes.subspan(type.firstAttribute_, type.numAttributes_))
+        {
+            if (attribute.nameOffset_ >= strings.size())
+                return fail("attribute name is out of bounds");
+
+            const auto& column = attribute.column_;
+            if (!IsSectionValid(column, totalSize, 1) || column.offset_ < header->columns_.offset_
+                || column.offset_ + column.size_ > header->columns_.offset_ + header->columns_.size_)
+                return fail("attribute column is out of bounds");
+
+            if (attribute.valueSize_ != 0)
+            {
+                if (attribute.valueSize_ != GetRawValueSize(static_cast<VariantType>(attribute.type_)))
+                    return fail("attribute type is not supported");
+                if (column.size_ != static_cast<unsigned long long>(attribute.valueSize_) * type.numObjects_)
+                    return fail("attribute column has wrong size");
+            }
+            else if (attribute.type_ >= MAX_VAR_TYPES)
+                return fail("attribute type is not supported");
+        }
+    }
+
+    if (nodes.empty() || nodes[0].parentIndex_ != M_MAX_UNSIGNED)
+        return fail("scene node is missing");
+
+    for (unsigned nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+    {
+        const SceneSnapshotNode& node = nodes[nodeIndex];
+        if (nodeIndex != 0 && node.parentIndex_ >= nodeIndex)
+            return fail("node hierarchy is corrupted");
+        if (node.typeIndex_ >= types.size() || node.row_ >= types[node.typeIndex_].numObjects_)
+            return fail("node type is out of bounds");
+        if (node.firstComponent_ > components.size() || node.numComponents_ > components.size() - node.firstComponent_)
+            return fail("node components are out of bounds");
+    }
+
+    for (const SceneSnapshotComponent& component : components)
+    {
+        if (component.typeIndex_ >= types.size() || component.row_ >= types[component.typeIndex_].numObjects_)
+            return fail("component type is out of bounds");
+    }
+
+    header_ = header;
+    nodes_ = nodes;
+    components_ = components;
+    types_ = types;
+    attributes_ = attributes;
+    strings_ = strings;
+
+    ResolveTypes();
+    return true;
+}
+
+void SceneSnapshot::ResolveTypes()
+{
+    reflections_.clear();
+    resolvedAttributes_.clear();
+    resolvedAttributes_.resize(attributes_.size());
+
+    for (const SceneSnapshotType& type : types_)
+    {
+        ObjectReflection* reflection = context_->GetReflection(StringHash{type.nameHash_});
+        reflections_.push_back(reflection);
+        if (!reflection)
+            continue;
+
+        const auto& objectAttributes = reflection->GetAttributes();
+        for (unsigned i = type.firstAttribute_; i < type.firstAttribute_ + type.numAttributes_; ++i)
+        {
+            const SceneSnapshotAttribute& attribute = attributes_[i];
+            const unsigned attributeIndex = reflection->GetAttributeIndex(StringHash{attribute.nameHash_});
+            if (attributeIndex == M_MAX_UNSIGNED)
+                continue;
+
+            // Skip attributes that changed type since the snapshot was baked
+            const AttributeInfo& attr = objectAttributes[attributeIndex];
+            if (!attr.ShouldLoad() || attr.type_ != static_cast<VariantType>(attribute.type_))
+            {
+                URHO3D_LOGWARNING("Attribute '{}' of '{}' in scene snapshot '{}' is ignored",
+                    GetName(attribute.nameOffset_), GetName(type.nameOffset_), name_);
+                continue;
+            }
+
+            ResolvedAttribute& resolved = resolvedAttributes_[i];
+            resolved.index_ = attributeIndex;
+            resolved.typed_ = attribute.valueSize_ != 0 && attr.accessor_->GetTypedAccessType() == attr.type_;
+        }
+    }
+}
+
+const char* SceneSnapshot::GetName(unsigned offset) const
+{
+    return offset < strings_.size() ? &strings_[offset] : "";
+}
+
+void SceneSnapshot::Load(Scene* scene) const
+{
+    URHO3D_PROFILE("LoadSceneSnapshot");
+
+    if (!header_)
+        throw ArchiveException("Scene snapshot is not opened");
+
+    // Objects of each type in the order of rows
+    ea::vector<ea::vector<Serializable*>> objectsByType(types_.size());
+    for (unsigned typeIndex = 0; typeIndex < types_.size(); ++typeIndex)
+        objectsByType[typeIndex].resize(types_[typeIndex].numObjects_);
+
+    // Keep in sync with PrefabInstantiationPlan::InstantiateObjects
+    scene->RemoveAllComponents();
+    scene->RemoveAllChildren();
+
+    // Create nodes first and apply their attributes before any component is created
+    SceneResolver resolver;
+    ea::vector<Node*> createdNodes;
+    createdNodes.reserve(nodes_.size());
+    for (const SceneSnapshotNode& nodeRecord : nodes_)
+    {
+        Node* node = nodeRecord.parentIndex_ == M_MAX_UNSIGNED
+            ? scene : createdNodes[nodeRecord.parentIndex_]->CreateChild(nodeRecord.id_);
+        if (node->GetReflection() != reflections_[nodeRecord.typeIndex_])
+            throw ArchiveException("Node type mismatch in scene snapshot '{}'", name_);
+
+        createdNodes.push_back(node);
+        objectsByType[nodeRecord.typeIndex_][nodeRecord.row_] = node;
+        resolver.AddNode(nodeRecord.id_, node);
+    }
+
+    ea::vector<bool> isComponentType(types_.size());
+    for (const SceneSnapshotComponent& componentRecord : components_)
+        isComponentType[componentRecord.typeIndex_] = true;
+
+    for (unsigned typeIndex = 0; typeIndex < types_.size(); ++typeIndex)
+    {
+        if (!isComponentType[typeIndex])
+            ApplyColumns(typeIndex, objectsByType[typeIndex]);
+    }
+
+    for (unsigned nodeIndex = 0; nodeIndex < nodes_.size(); ++nodeIndex)
+    {
+        const SceneSnapshotNode& nodeRecord = nodes_[nodeIndex];
+        Node* node = createdNodes[nodeIndex];
+        for (const SceneSnapshotComponent& componentRecord :
+            components_.subspan(nodeRecord.firstComponent_, nodeRecord.numComponents_))
+        {
+            ObjectReflection* reflection = reflections_[componentRecord.typeIndex_];
+            if (!reflection || !reflection->HasObjectFactory() || !reflection->GetTypeInfo()->IsTypeOf<Component>())
+            {
+                URHO3D_LOGWARNING("Component of unknown type '{}' in scene snapshot '{}' is ignored",
+                    GetName(types_[componentRecord.typeIndex_].nameOffset_), name_);
+                continue;
+            }
+
+            const SharedPtr<Component> component = StaticCast<Component>(reflection->CreateObject());
+            node->AddComponent(component, componentRecord.id_);
+            objectsByType[componentRecord.typeIndex_][componentRecord.row_] = component;
+            resolver.AddComponent(componentRecord.id_, component);
+        }
+    }
+
+    for (unsigned typeIndex = 0; typeIndex < types_.size(); ++typeIndex)
+    {
+        if (isComponentType[typeIndex])
+            ApplyColumns(typeIndex, objectsByType[typeIndex]);
+    }
+
+    resolver.Resolve();
+
+    // Keep in sync with Scene::SerializeInBlock
+    const SceneSnapshotSection& auxiliaryData = header_->auxiliaryData_;
+    MemoryBuffer buffer{data_.data() + auxiliaryData.offset_, static_cast<unsigned>(auxiliaryData.size_)};
+    buffer.SetName(name_);
+    BinaryInputArchive archive{context_, buffer};
+    {
+        ArchiveBlock block = archive.OpenUnorderedBlock("auxiliary");
+        scene->SerializeAuxiliaryData(archive);
+    }
+
+    scene->ApplyAttributes();
+    scene->SetFileName(name_);
+}
+
+void SceneSnapshot::ApplyColumns(unsigned typeIndex, const ea::vector<Serializable*>& objects) const
+{
+    const SceneSnapshotType& type = types_[typeIndex];
+    const ObjectReflection* reflection = reflections_[typeIndex];
+    if (!reflection)
+        return;
+
+    const auto& objectAttributes = reflection->GetAttributes();
+    for (unsigned i = type.firstAttribute_; i < type.firstAttribute_ + type.numAttributes_; ++i)
+    {
+        const ResolvedAttribute& resolved = resolvedAttributes_[i];
+        // Attributes may be removed from reflection after the snapshot is opened
+        if (resolved.index_ >= objectAttributes.size())
+            continue;
+
+        const AttributeInfo& attr = objectAttributes[resolved.index_];
+        const SceneSnapshotAttribute& attribute = attributes_[i];
+        const unsigned char* column = data_.data() + attribute.column_.offset_;
+
+        if (attribute.valueSize_ != 0)
+        {
+            // Copy plain values directly from the column
+            VisitTypedAttributeType(attr.type_, [&](auto typeTag)
+            {
+                using ValueType = typename decltype(typeTag)::type;
+                if constexpr (ea::is_trivially_copyable_v<ValueType>)
+                {
+                    for (unsigned row = 0; row < objects.size(); ++row)
+                    {
+                        if (!objects[row])
+                            continue;
+
+                        ValueType value;
+                        memcpy(&value, column + row * sizeof(ValueType), sizeof(ValueType));
+                        if (resolved.typed_)
+                            objects[row]->OnSetAttributeTyped(attr, &value);
+                        else
+                            objects[row]->OnSetAttribute(attr, Variant{value});
+                    }
+                }
+            });
+        }
+        else
+        {
+            MemoryBuffer buffer{column, static_cast<unsigned>(attribute.column_.size_)};
+            buffer.SetName(name_);
+            BinaryInputArchive archive{context_, buffer};
+            ArchiveBlock block = archive.OpenArrayBlock("column");
+            if (block.GetSizeHint() != objects.size())
+                throw ArchiveException("Attribute column '{}' in scene snapshot '{}' is corrupted", attr.name_, name_);
+
+            Variant value;
+            for (Serializable* object : objects)
+            {
+                SerializeVariantAsType(archive, "value", value, attr.type_);
+                if (object)
+                    object->OnSetAttribute(attr, value);
+            }
+        }
+    }
+}
+
+} // namespace Urho3D
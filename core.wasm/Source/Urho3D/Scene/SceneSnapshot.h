@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2023-2023 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR rhs
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR rhsWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR rhs DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Container/ByteVector.h>
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Resource/Resource.h>
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Deserializer;
+class MemoryMappedFile;
+class ObjectReflection;
+class Scene;
+class Serializable;
+class Serializer;
+
+/// Magic of the scene snapshot file.
+URHO3D_API extern const BinaryMagic SceneSnapshotMagic;
+
+/// Range of the scene snapshot data, relative to the beginning of the snapshot.
+struct SceneSnapshotSection
+{
+    /// Offset of the data.
+    unsigned long long offset_;
+    /// Size of the data.
+    unsigned long long size_;
+};
+
+/// Header of the scene snapshot.
+/// Snapshot is stored as is, so the layout of this and other snapshot structures should not change.
+struct SceneSnapshotHeader
+{
+    /// Snapshot magic.
+    BinaryMagic magic_;
+    /// Used to reject snapshots saved on platforms with different byte order.
+    unsigned byteOrderMark_;
+    /// Format version.
+    unsigned version_;
+    /// Reserved for future use.
+    unsigned flags_;
+    /// Total size of the snapshot.
+    unsigned long long totalSize_;
+    /// Nodes in depth-first order, array of SceneSnapshotNode. The first node is the Scene itself.
+    SceneSnapshotSection nodes_;
+    /// Components of all nodes, array of SceneSnapshotComponent.
+    SceneSnapshotSection components_;
+    /// Types of nodes and components, array of SceneSnapshotType.
+    SceneSnapshotSection types_;
+    /// Attributes of all types, array of SceneSnapshotAttribute.
+    SceneSnapshotSection attributes_;
+    /// Attribute columns.
+    SceneSnapshotSection columns_;
+    /// Table of null-terminated type and attribute names.
+    SceneSnapshotSection strings_;
+    /// Auxiliary data of scene components serialized with BinaryOutputArchive.
+    SceneSnapshotSection auxiliaryData_;
+};
+
+static_assert(sizeof(SceneSnapshotHeader) == 136, "SceneSnapshotHeader layout is a part of snapshot format");
+
+/// Node in the scene snapshot.
+struct SceneSnapshotNode
+{
+    /// Node ID.
+    unsigned id_;
+    /// Index of the parent node. Root node has no parent.
+    unsigned parentIndex_;
+    /// Index of the node type.
+    unsigned typeIndex_;
+    /// Index of the node in the attribute columns of the type.
+    unsigned row_;
+    /// Index of the first component.
+    unsigned firstComponent_;
+    /// Number of components.
+    unsigned numComponents_;
+};
+
+static_assert(sizeof(SceneSnapshotNode) == 24, "SceneSnapshotNode layout is a part of snapshot format");
+
+/// Component in the scene snapshot.
+struct SceneSnapshotComponent
+{
+    /// Component ID.
+    unsigned id_;
+    /// Index of the component type.
+    unsigned typeIndex_;
+    /// Index of the component in the attribute columns of the type.
+    unsigned row_;
+    /// Reserved for future use.
+    unsigned flags_;
+};
+
+static_assert(sizeof(SceneSnapshotComponent) == 16, "SceneSnapshotComponent layout is a part of snapshot format");
+
+/// Type of nodes or components in the scene snapshot.
+struct SceneSnapshotType
+{
+    /// Hash of the type name.
+    unsigned nameHash_;
+    /// Offset of the type name in the name table.
+    unsigned nameOffset_;
+    /// Index of the first attribute.
+    unsigned firstAttribute_;
+    /// Number of attributes.
+    unsigned numAttributes_;
+    /// Number of objects of this type, i.e. number of rows in each attribute column.
+    unsigned numObjects_;
+    /// Reserved for future use.
+    unsigned flags_;
+};
+
+static_assert(sizeof(SceneSnapshotType) == 24, "SceneSnapshotType layout is a part of snapshot format");
+
+/// Attribute column in the scene snapshot.
+/// Values of plain types are stored as array of raw values, one per row.
+/// Other values are serialized one after another with BinaryOutputArchive.
+struct SceneSnapshotAttribute
+{
+    /// Hash of the attribute name.
+    unsigned nameHash_;
+    /// Offset of the attribute name in the name table.
+    unsigned nameOffset_;
+    /// Variant type of the attribute.
+    unsigned type_;
+    /// Size of the raw value. Zero if the values are serialized.
+    unsigned valueSize_;
+    /// Column data.
+    SceneSnapshotSection column_;
+};
+
+static_assert(sizeof(SceneSnapshotAttribute) == 32, "SceneSnapshotAttribute layout is a part of snapshot format");
+
+/// Scene baked into flat binary image that can be memory-mapped and loaded without parsing.
+/// Hierarchy and component type tables are used in place, attributes are stored in per-type columns.
+/// Attributes of plain types are copied directly from columns without Variant if attribute supports typed access.
+/// Snapshot references types and attributes by name hashes, so it stays loadable when reflection changes,
+/// but it is not a replacement for source scene files. Temporary nodes and components are not stored.
+class URHO3D_API SceneSnapshot : public NonCopyable
+{
+public:
+    /// Current format version.
+    static constexpr unsigned Version = 1;
+    /// Alignment of snapshot sections and columns.
+    static constexpr unsigned Alignment = 16;
+
+    /// Construct.
+    explicit SceneSnapshot(Context* context);
+    ~SceneSnapshot();
+
+    /// Bake scene into the snapshot. Return true if successful.
+    static bool Save(Scene* scene, Serializer& dest);
+
+    /// Memory-map snapshot file, or read it into memory if mapping is not supported. Return true if successful.
+    bool Open(const ea::string& fileName);
+    /// Read snapshot from the current position to the end of the stream into memory. Return true if successful.
+    bool Read(Deserializer& source);
+    /// Use snapshot data in place. Data should be alive while the snapshot is used. Return true if successful.
+    /// Data is copied only if it is not aligned.
+    bool SetData(ConstByteSpan data, const ea::string& name = EMPTY_STRING);
+    /// Release snapshot data.
+    void Close();
+
+    /// Load scene from the snapshot. Existing nodes and components are removed. May throw ArchiveException.
+    void Load(Scene* scene) const;
+
+    /// Return whether the snapshot is valid.
+    bool IsOpen() const { return header_ != nullptr; }
+    /// Return whether the snapshot is memory-mapped.
+    bool IsMemoryMapped() const { return mappedFile_ != nullptr; }
+    /// Return number of nodes, including the scene.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+    /// Return number of components.
+    unsigned GetNumComponents() const { return components_.size(); }
+    /// Return number of node and component types.
+    unsigned GetNumTypes() const { return types_.size(); }
+
+private:
+    /// Attribute column resolved against current reflection.
+    struct ResolvedAttribute
+    {
+        /// Index of the attribute in reflection. None if the attribute is not loaded.
+        unsigned index_{M_MAX_UNSIGNED};
+        /// Whether the attribute supports typed access.
+        bool typed_{};
+    };
+
+    /// Validate snapshot data and resolve sections. Return true if successful.
+    bool ResolveSections();
+    /// Resolve types and attributes against current reflection.
+    void ResolveTypes();
+    /// Return name from the name table.
+    const char* GetName(unsigned offset) const;
+    /// Apply attribute columns of the type to objects.
+    void ApplyColumns(unsigned typeIndex, const ea::vector<Serializable*>& objects) const;
+
+    Context* context_{};
+    /// Name used in error messages.
+    ea::string name_;
+    /// Memory mapping of the snapshot file.
+    SharedPtr<MemoryMappedFile> mappedFile_;
+    /// Snapshot data if it is not used in place.
+    ByteVector storage_;
+    /// Snapshot data.
+    ConstByteSpan data_;
+
+    /// Sections of the snapshot.
+    /// @{
+    const SceneSnapshotHeader* header_{};
+    ea::span<const SceneSnapshotNode> nodes_;
+    ea::span<const SceneSnapshotComponent> components_;
+    ea::span<const SceneSnapshotType> types_;
+    ea::span<const SceneSnapshotAttribute> attributes_;
+    ea::span<const char> strings_;
+    /// @}
+
+    /// Reflections of types, null if type is unknown.
+    ea::vector<ObjectReflection*> reflections_;
+    /// Resolved attribute columns.
+    ea::vector<ResolvedAttribute> resolvedAttributes_;
+};
+
+} // namespace Urho3D
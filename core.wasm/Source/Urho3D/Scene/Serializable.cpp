@@ -79,6 +79,27 @@ namespace Urho3D
         attr.accessor_->Get( this, dest );
     }
 
+    void Serializable::OnSetAttributeTyped( const AttributeInfo& attr, const void* src )
+    {
+        // Instance defaults are stored as Variants
+        if ( setInstanceDefault_ )
+        {
+            VisitTypedAttributeType( attr.accessor_->GetTypedAccessType(),
+                                     [ & ]( auto typeTag )
+                                     {
+                                         using ValueType = typename decltype( typeTag )::type;
+                                         OnSetAttribute( attr, Variant( *static_cast< const ValueType* >( src ) ) );
+                                     } );
+            return;
+        }
+        attr.accessor_->SetTyped( this, src );
+    }
+
+    void Serializable::OnGetAttributeTyped( const AttributeInfo& attr, void* dest ) const
+    {
+        attr.accessor_->GetTyped( this, dest );
+    }
+
     ObjectReflection* Serializable::GetReflection() const
     {
         return context_->GetReflection( GetType() );
@@ -570,8 +591,8 @@ namespace Urho3D
             return Variant::EMPTY;
         }
 
-        AttributeInfo attr         = attributes->at( index );
-        Variant       defaultValue = GetInstanceDefault( attr.name_ );
+        const AttributeInfo& attr         = attributes->at( index );
+        Variant              defaultValue = GetInstanceDefault( attr.name_ );
         return defaultValue.IsEmpty() ? attr.defaultValue_ : defaultValue;
     }
 
@@ -625,11 +646,59 @@ namespace Urho3D
         for ( unsigned i = 0; i < sourceAttributes->size(); ++i )
         {
             const AttributeInfo& attr = sourceAttributes->at( i );
+            CopyAttribute( attr, source, attr );
+        }
+    }
 
-            Variant value;
-            source->OnGetAttribute( attr, value );
-            OnSetAttribute( attr, value );
+    void Serializable::CopyAttribute( const AttributeInfo& attr, const Serializable* source, const AttributeInfo& sourceAttr )
+    {
+        const VariantType typedType = attr.accessor_->GetTypedAccessType();
+        if ( typedType != VAR_NONE && typedType == sourceAttr.accessor_->GetTypedAccessType() )
+        {
+            VisitTypedAttributeType( typedType,
+                                     [ & ]( auto typeTag )
+                                     {
+                                         typename decltype( typeTag )::type value{};
+                                         source->OnGetAttributeTyped( sourceAttr, &value );
+                                         OnSetAttributeTyped( attr, &value );
+                                     } );
+            return;
+        }
+
+        Variant value;
+        source->OnGetAttribute( sourceAttr, value );
+        OnSetAttribute( attr, value );
+    }
+
+    bool Serializable::GetNonDefaultAttribute( const AttributeInfo& attr, Variant& dest ) const
+    {
+        const Variant* defaultValue = &attr.defaultValue_;
+        Variant        instanceDefaultValue;
+        if ( instanceDefaultValues_ )
+        {
+            instanceDefaultValue = GetInstanceDefault( attr.name_ );
+            if ( ! instanceDefaultValue.IsEmpty() )
+                defaultValue = &instanceDefaultValue;
+        }
+
+        bool isDefault = false;
+        const bool isTyped = VisitTypedAttributeType( attr.accessor_->GetTypedAccessType(),
+                                                      [ & ]( auto typeTag )
+                                                      {
+                                                          typename decltype( typeTag )::type value{};
+                                                          OnGetAttributeTyped( attr, &value );
+                                                          // Most attributes are default, don't box them
+                                                          isDefault = *defaultValue == value;
+                                                          if ( ! isDefault )
+                                                              dest = ea::move( value );
+                                                      } );
+
+        if ( ! isTyped )
+        {
+            OnGetAttribute( attr, dest );
+            isDefault = dest == *defaultValue;
         }
+        return ! isDefault;
     }
 
     void Serializable::SetInstanceDefault( const ea::string& name, const Variant& defaultValue )
@@ -53,6 +53,10 @@ public:
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
     /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor.
     virtual void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const;
+    /// Handle attribute write access without Variant. Attribute accessor should support typed access.
+    virtual void OnSetAttributeTyped(const AttributeInfo& attr, const void* src);
+    /// Handle attribute read access without Variant. Attribute accessor should support typed access.
+    virtual void OnGetAttributeTyped(const AttributeInfo& attr, void* dest) const;
     /// Return reflection used for serialization.
     virtual ObjectReflection* GetReflection() const;
     /// Return attribute descriptions, or null if none defined.
@@ -124,6 +128,11 @@ public:
 
     /// Copy all attributes from another serializable.
     void CopyAttributes(const Serializable* source, bool resetToDefault = true);
+    /// Copy attribute value from another serializable. Variant is not used if both attributes have the same typed access type.
+    void CopyAttribute(const AttributeInfo& attr, const Serializable* source, const AttributeInfo& sourceAttr);
+    /// Read attribute value if it is not equal to the default value. Return whether the value was read.
+    /// Attribute value is compared with default value without Variant if the attribute supports typed access.
+    bool GetNonDefaultAttribute(const AttributeInfo& attr, Variant& dest) const;
 
     /// Return whether is temporary.
     /// @property
@@ -181,15 +190,88 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     return SharedPtr<AttributeAccessor>(new VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>(getFunction, setFunction));
 }
 
+/// Template implementation of the attribute accessor that may be used without Variant.
+/// Typed access is enabled if the value type supports it and the getter returns exactly the value type.
+template <class TClassType, class TValueType, class TGetFunction, class TSetFunction>
+class TypedAttributeAccessorImpl : public AttributeAccessor
+{
+public:
+    /// Whether typed access is supported.
+    static constexpr bool IsTyped = IsTypedAttributeType<TValueType>
+        && ea::is_same_v<ea::decay_t<decltype(ea::declval<TGetFunction>()(ea::declval<const TClassType&>()))>, TValueType>;
+
+    /// Construct.
+    TypedAttributeAccessorImpl(TGetFunction getFunction, TSetFunction setFunction) : getFunction_(getFunction), setFunction_(setFunction)
+    {
+        if constexpr (IsTyped)
+            typedAccessType_ = GetVariantType<TValueType>();
+    }
+
+    /// Invoke getter function.
+    void Get(const Serializable* ptr, Variant& value) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        value = getFunction_(*classPtr);
+    }
+
+    /// Invoke setter function.
+    void Set(Serializable* ptr, const Variant& value) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        setFunction_(*classPtr, value.Get<TValueType>());
+    }
+
+    /// Invoke getter function without Variant.
+    void GetTyped(const Serializable* ptr, void* dest) const override
+    {
+        if constexpr (IsTyped)
+        {
+            assert(ptr && dest);
+            const auto classPtr = static_cast<const TClassType*>(ptr);
+            *static_cast<TValueType*>(dest) = getFunction_(*classPtr);
+        }
+    }
+
+    /// Invoke setter function without Variant.
+    void SetTyped(Serializable* ptr, const void* src) override
+    {
+        if constexpr (IsTyped)
+        {
+            assert(ptr && src);
+            auto classPtr = static_cast<TClassType*>(ptr);
+            setFunction_(*classPtr, *static_cast<const TValueType*>(src));
+        }
+    }
+
+private:
+    /// Get functor.
+    TGetFunction getFunction_;
+    /// Set functor.
+    TSetFunction setFunction_;
+};
+
+/// Make typed attribute accessor implementation.
+/// \tparam TClassType Serializable class type.
+/// \tparam TValueType Attribute value type.
+/// \tparam TGetFunction Functional object with call signature `TValueType getFunction(const TClassType& self)`
+/// \tparam TSetFunction Functional object with call signature `void setFunction(TClassType& self, const TValueType& value)`
+template <class TClassType, class TValueType, class TGetFunction, class TSetFunction>
+SharedPtr<AttributeAccessor> MakeTypedAttributeAccessor(TGetFunction getFunction, TSetFunction setFunction)
+{
+    return SharedPtr<AttributeAccessor>(new TypedAttributeAccessorImpl<TClassType, TValueType, TGetFunction, TSetFunction>(getFunction, setFunction));
+}
+
 /// Make member attribute accessor.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); })
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(auto) { return (self.variable); }, \
+    [](ClassName& self, const typeName& value) { self.variable = value; })
 
 /// Make member attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); self.postSetCallback(); })
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(auto) { return (self.variable); }, \
+    [](ClassName& self, const typeName& value) { self.variable = value; self.postSetCallback(); })
 
 /// Make custom member attribute accessor.
 #define URHO3D_MAKE_CUSTOM_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
@@ -197,9 +279,9 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.GetCustom<typeName>(); })
 
 /// Make get/set attribute accessor.
-#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.getFunction(); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(value.Get<typeName>()); })
+#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(auto) { return self.getFunction(); }, \
+    [](ClassName& self, const typeName& value) { self.setFunction(value); })
 
 /// Make member enum attribute accessor.
 #define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \